@@ -0,0 +1,1157 @@
+/*
+ Host benchmark for LovyanGFX.
+
+ Runs the primitive set of examples/Test/TFT_graphicstest_PDQ plus text,
+ pushImage, rotate/zoom and image decode against LGFX_Sprite and the
+ headless Panel_Memory, for every color depth each target accepts.
+ Results are written as JSON (default) or CSV with pixels per second so
+ that runs can be compared between releases.
+ When the library is built with LGFX_PANEL_STATS, the JSON output also
+ carries the panel entry point counters for each test.
+ The hub75 target times HUB75_Encoder on a 128x64 chain, comparing the
+ bit-plane encoder against the scalar per-pixel reference; a mismatch
+ makes the run exit with status 2.
+ The dither target times the Ditherer row kernels used by the monochrome
+ and grayscale panels on a width x height grayscale image.
+ The unitlcd target encodes UI frames row by row the way Panel_M5UnitLCD
+ sends them, always raw, always RLE and adaptively, and reports the bytes
+ put on the I2C bus. Frames come from a Panel_Recorder file given with
+ --frames (FrameBuffer platform only), or from a built-in 135x240 UI animation. A decoded frame that
+ differs from its source makes the run exit with status 2.
+ The shm target (FrameBuffer platform only) draws rectangles into a
+ Panel_shm and times how fast frames are published. Every draw must
+ advance the frame sequence number by 2 and publish its dirty rect;
+ otherwise the run exits with status 2.
+
+ usage: LGFX_Benchmark [--format json|csv] [--out FILE] [--width W] [--height H]
+                       [--min-time MS] [--filter TEXT] [--frames FILE]
+                       [--target sprite|memory|hub75|dither|unitlcd|shm]
+*/
+
+#include <LovyanGFX.hpp>
+#include <lgfx/utility/lgfx_qoi.h>
+#include <lgfx/v1/misc/DividedFrameBuffer.hpp>
+#include <lgfx/v1/misc/HUB75_Encoder.hpp>
+#include <lgfx/v1/misc/dither.hpp>
+#include <lgfx/v1/misc/M5UnitLCD_Encoder.hpp>
+
+#include <assets.h>   // examples/Sprite/TransitionFX : dog_200_200_jpg
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+  struct result_t
+  {
+    std::string target;
+    std::string depth;
+    std::string test;
+    uint32_t iterations;
+    double seconds;
+    uint64_t pixels;
+    /// 転送量を計測するテストのみ 0 以外 ; only set by tests that measure transferred bytes
+    uint64_t bytes = 0;
+#if defined ( LGFX_PANEL_STATS )
+    lgfx::panel_stats_t stats;
+#endif
+  };
+
+  struct options_t
+  {
+    const char* format = "json";
+    const char* out = nullptr;
+    const char* filter = nullptr;
+    const char* target = nullptr;
+    const char* frames = nullptr;
+    int width = 320;
+    int height = 240;
+    int min_time_ms = 100;
+  };
+
+  struct depth_entry_t
+  {
+    lgfx::color_depth_t depth;
+    const char* name;
+  };
+
+  static constexpr depth_entry_t depth_list[] =
+  { { lgfx::grayscale_1bit     , "grayscale_1bit"      }
+  , { lgfx::grayscale_2bit     , "grayscale_2bit"      }
+  , { lgfx::grayscale_4bit     , "grayscale_4bit"      }
+  , { lgfx::grayscale_8bit     , "grayscale_8bit"      }
+  , { lgfx::palette_1bit       , "palette_1bit"        }
+  , { lgfx::palette_2bit       , "palette_2bit"        }
+  , { lgfx::palette_4bit       , "palette_4bit"        }
+  , { lgfx::palette_8bit       , "palette_8bit"        }
+  , { lgfx::rgb332_1Byte       , "rgb332_1Byte"        }
+  , { lgfx::rgb565_2Byte       , "rgb565_2Byte"        }
+  , { lgfx::rgb666_3Byte       , "rgb666_3Byte"        }
+  , { lgfx::rgb888_3Byte       , "rgb888_3Byte"        }
+  , { lgfx::argb8888_4Byte     , "argb8888_4Byte"      }
+  , { lgfx::rgb565_nonswapped  , "rgb565_nonswapped"   }
+  , { lgfx::rgb666_nonswapped  , "rgb666_nonswapped"   }
+  , { lgfx::rgb888_nonswapped  , "rgb888_nonswapped"   }
+  , { lgfx::argb8888_nonswapped, "argb8888_nonswapped" }
+  };
+
+//----------------------------------------------------------------------------
+// test assets
+
+  static constexpr int image_size = 128;
+  static constexpr int icon_size = 16;
+
+  struct assets_t
+  {
+    std::vector<lgfx::rgb332_t>    img332;
+    std::vector<lgfx::swap565_t>   img565;
+    std::vector<lgfx::bgr888_t>    img888;
+    std::vector<lgfx::argb8888_t>  img8888;
+    std::vector<lgfx::grayscale_t> imggray;
+    LGFX_Sprite src_sprite;
+    LGFX_Sprite icon_sprite;
+
+    const uint8_t* jpg_data = dog_200_200_jpg;
+    uint32_t jpg_len = sizeof(dog_200_200_jpg);
+    std::vector<uint8_t> png;
+    std::vector<uint8_t> qoi;
+    std::vector<uint8_t> qoi_alpha;
+    std::vector<uint8_t> bmp;
+    int decode_w = 0;
+    int decode_h = 0;
+  };
+
+  static uint8_t* qoi_get_row(uint8_t* lineBuffer, int flip, int w, int h, int y, void* user)
+  {
+    auto gfx = static_cast<LGFX_Sprite*>(user);
+    gfx->readRectRGB(0, flip ? (h - 1 - y) : y, w, 1, lineBuffer);
+    return lineBuffer;
+  }
+
+  /// 50x50 のアイコン状のアルファ (外側は透明、縁は半透明、中心は不透明) を付けた RGBA の行を返す;
+  /// Returns an RGBA row with icon-like alpha: transparent outside, translucent rim, opaque core.
+  static uint8_t* qoi_get_row_alpha(uint8_t* lineBuffer, int flip, int w, int h, int y, void* user)
+  {
+    auto gfx = static_cast<LGFX_Sprite*>(user);
+    if (flip) { y = h - 1 - y; }
+    gfx->readRectRGB(0, y, w, 1, lineBuffer);
+    for (int x = w - 1; x >= 0; --x)
+    {
+      int dx = (x % 50) - 25, dy = (y % 50) - 25;
+      int d = 24 * 24 - (dx * dx + dy * dy);
+      uint8_t alpha = d <= 0 ? 0 : d >= 192 ? 255 : d * 255 / 192;
+      lineBuffer[x * 4 + 3] = alpha;
+      lineBuffer[x * 4 + 2] = lineBuffer[x * 3 + 2];
+      lineBuffer[x * 4 + 1] = lineBuffer[x * 3 + 1];
+      lineBuffer[x * 4    ] = lineBuffer[x * 3    ];
+    }
+    return lineBuffer;
+  }
+
+  static void put_le(std::vector<uint8_t>& v, uint32_t value, int bytes)
+  {
+    for (int i = 0; i < bytes; ++i) { v.push_back(value >> (i * 8)); }
+  }
+
+  static bool make_assets(assets_t& a)
+  {
+    size_t len = image_size * image_size;
+    a.img332.resize(len);
+    a.img565.resize(len);
+    a.img888.resize(len);
+    a.img8888.resize(len);
+    a.imggray.resize(len);
+    for (int y = 0; y < image_size; ++y)
+    {
+      for (int x = 0; x < image_size; ++x)
+      {
+        size_t i = y * image_size + x;
+        uint8_t r = x * 2, g = y * 2, b = (x ^ y) * 2;
+        a.img332[i].set(r, g, b);
+        a.img565[i].set(r, g, b);
+        a.img888[i].set(r, g, b);
+        a.img8888[i].set(r, g, b);
+        a.img8888[i].a = (x + y) & 0xFF;  // every alpha value, incl. fully transparent / opaque runs
+        a.imggray[i].set(r, g, b);
+      }
+    }
+
+    a.src_sprite.setColorDepth(lgfx::rgb565_2Byte);
+    if (!a.src_sprite.createSprite(image_size, image_size)) { return false; }
+    a.src_sprite.pushImage(0, 0, image_size, image_size, a.img565.data());
+
+    a.icon_sprite.setColorDepth(lgfx::rgb565_2Byte);
+    if (!a.icon_sprite.createSprite(icon_size, icon_size)) { return false; }
+    a.icon_sprite.pushImage(0, 0, icon_size, icon_size, a.img565.data());
+
+    /// JPEG をデコードしたものを元に PNG / QOI / BMP の各データを生成する;
+    LGFX_Sprite canvas;
+    canvas.setColorDepth(lgfx::rgb888_3Byte);
+    if (!canvas.createSprite(200, 200)) { return false; }
+    canvas.drawJpg(a.jpg_data, a.jpg_len);
+    a.decode_w = canvas.width();
+    a.decode_h = canvas.height();
+
+    size_t png_len = 0;
+    if (auto p = (uint8_t*)canvas.createPng(&png_len, 0, 0, a.decode_w, a.decode_h))
+    {
+      a.png.assign(p, p + png_len);
+      free(p);
+    }
+
+    std::vector<uint8_t> line(a.decode_w * 3);
+    size_t qoi_len = 0;
+    if (auto p = (uint8_t*)lgfx_qoi_encoder_write_fb(line.data(), a.decode_w, a.decode_h, 3, &qoi_len, 0, qoi_get_row, &canvas))
+    {
+      a.qoi.assign(p, p + qoi_len);
+      free(p);
+    }
+
+    std::vector<uint8_t> line_alpha(a.decode_w * 4);
+    if (auto p = (uint8_t*)lgfx_qoi_encoder_write_fb(line_alpha.data(), a.decode_w, a.decode_h, 4, &qoi_len, 0, qoi_get_row_alpha, &canvas))
+    {
+      a.qoi_alpha.assign(p, p + qoi_len);
+      free(p);
+    }
+
+    /// 24bit bottom-up BMP;
+    uint32_t stride = (a.decode_w * 3 + 3) & ~3u;
+    uint32_t image_len = stride * a.decode_h;
+    auto& b = a.bmp;
+    b.push_back('B'); b.push_back('M');
+    put_le(b, 54 + image_len, 4);
+    put_le(b, 0, 4);
+    put_le(b, 54, 4);
+    put_le(b, 40, 4);
+    put_le(b, a.decode_w, 4);
+    put_le(b, a.decode_h, 4);
+    put_le(b, 1, 2);
+    put_le(b, 24, 2);
+    put_le(b, 0, 4);
+    put_le(b, image_len, 4);
+    put_le(b, 2835, 4);
+    put_le(b, 2835, 4);
+    put_le(b, 0, 4);
+    put_le(b, 0, 4);
+    std::vector<uint8_t> rgb(stride);
+    for (int y = a.decode_h - 1; y >= 0; --y)
+    {
+      canvas.readRectRGB(0, y, a.decode_w, 1, rgb.data());
+      for (int x = 0; x < a.decode_w; ++x) { std::swap(rgb[x * 3], rgb[x * 3 + 2]); }
+      b.insert(b.end(), rgb.begin(), rgb.end());
+    }
+    return !a.png.empty() && !a.qoi.empty() && !a.qoi_alpha.empty();
+  }
+
+//----------------------------------------------------------------------------
+// test cases (each returns the number of pixels it touched)
+
+  typedef uint64_t (*test_fn_t)(LovyanGFX* gfx, const assets_t& a);
+  typedef uint64_t (*sprite_test_fn_t)(LGFX_Sprite* gfx, const assets_t& a);
+
+  static uint64_t line_pixels(int x0, int y0, int x1, int y1)
+  {
+    return std::max(std::abs(x1 - x0), std::abs(y1 - y0)) + 1;
+  }
+
+  static uint64_t test_fillScreen(LovyanGFX* gfx, const assets_t&)
+  {
+    gfx->fillScreen(TFT_RED);
+    gfx->fillScreen(TFT_GREEN);
+    gfx->fillScreen(TFT_BLUE);
+    gfx->fillScreen(TFT_BLACK);
+    return 4ull * gfx->width() * gfx->height();
+  }
+
+  static uint64_t test_pixels(LovyanGFX* gfx, const assets_t&)
+  {
+    int w = gfx->width(), h = gfx->height();
+    for (int y = 0; y < h; ++y)
+    {
+      for (int x = 0; x < w; ++x)
+      {
+        gfx->drawPixel(x, y, gfx->color565(x << 3, y << 3, x * y));
+      }
+    }
+    return (uint64_t)w * h;
+  }
+
+  static uint64_t test_lines(LovyanGFX* gfx, const assets_t&)
+  {
+    int w = gfx->width() - 1, h = gfx->height() - 1;
+    uint64_t px = 0;
+    static constexpr int corners[4][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+    for (auto& c : corners)
+    {
+      int x0 = c[0] * w, y0 = c[1] * h;
+      for (int x = 0; x <= w; x += 6) { gfx->drawLine(x0, y0, x, h - y0, TFT_BLUE); px += line_pixels(x0, y0, x, h - y0); }
+      for (int y = 0; y <= h; y += 6) { gfx->drawLine(x0, y0, w - x0, y, TFT_BLUE); px += line_pixels(x0, y0, w - x0, y); }
+    }
+    return px;
+  }
+
+  static uint64_t test_fastLines(LovyanGFX* gfx, const assets_t&)
+  {
+    int w = gfx->width(), h = gfx->height();
+    uint64_t px = 0;
+    for (int y = 0; y < h; y += 5) { gfx->drawFastHLine(0, y, w, TFT_RED);  px += w; }
+    for (int x = 0; x < w; x += 5) { gfx->drawFastVLine(x, 0, h, TFT_BLUE); px += h; }
+    return px;
+  }
+
+  static uint64_t test_rects(LovyanGFX* gfx, const assets_t&)
+  {
+    int cx = gfx->width() >> 1, cy = gfx->height() >> 1;
+    int n = std::min(gfx->width(), gfx->height());
+    uint64_t px = 0;
+    for (int i = 2; i < n; i += 6)
+    {
+      gfx->drawRect(cx - (i >> 1), cy - (i >> 1), i, i, TFT_GREEN);
+      px += 4 * (i - 1);
+    }
+    return px;
+  }
+
+  static uint64_t test_filledRects(LovyanGFX* gfx, const assets_t&)
+  {
+    int cx = gfx->width() >> 1, cy = gfx->height() >> 1;
+    int n = std::min(gfx->width(), gfx->height());
+    uint64_t px = 0;
+    for (int i = n; i > 0; i -= 6)
+    {
+      gfx->fillRect(cx - (i >> 1), cy - (i >> 1), i, i, TFT_YELLOW);
+      gfx->drawRect(cx - (i >> 1), cy - (i >> 1), i, i, TFT_MAGENTA);
+      px += (uint64_t)i * i + 4 * (i - 1);
+    }
+    return px;
+  }
+
+  static uint64_t test_circles(LovyanGFX* gfx, const assets_t&)
+  {
+    int r = 10, r2 = r * 2;
+    int w = gfx->width() + r, h = gfx->height() + r;
+    uint64_t px = 0;
+    for (int x = 0; x < w; x += r2)
+    {
+      for (int y = 0; y < h; y += r2)
+      {
+        gfx->drawCircle(x, y, r, TFT_WHITE);
+        px += (uint64_t)(2 * M_PI * r);
+      }
+    }
+    return px;
+  }
+
+  static uint64_t test_filledCircles(LovyanGFX* gfx, const assets_t&)
+  {
+    int r = 10, r2 = r * 2;
+    int w = gfx->width(), h = gfx->height();
+    uint64_t px = 0;
+    for (int x = r; x < w; x += r2)
+    {
+      for (int y = r; y < h; y += r2)
+      {
+        gfx->fillCircle(x, y, r, TFT_MAGENTA);
+        px += (uint64_t)(M_PI * r * r);
+      }
+    }
+    return px;
+  }
+
+  static uint64_t test_triangles(LovyanGFX* gfx, const assets_t&)
+  {
+    int cx = gfx->width() >> 1, cy = gfx->height() >> 1;
+    int n = std::min(cx, cy);
+    uint64_t px = 0;
+    for (int i = 0; i < n; i += 5)
+    {
+      gfx->drawTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i, gfx->color565(i, i, i));
+      px += line_pixels(cx, cy - i, cx - i, cy + i) * 2 + 2 * i + 1;
+    }
+    return px;
+  }
+
+  static uint64_t test_filledTriangles(LovyanGFX* gfx, const assets_t&)
+  {
+    int cx = gfx->width() >> 1, cy = gfx->height() >> 1;
+    uint64_t px = 0;
+    for (int i = std::min(cx, cy); i > 10; i -= 5)
+    {
+      gfx->fillTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i, gfx->color565(0, i, i));
+      gfx->drawTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i, gfx->color565(i, i, 0));
+      px += (uint64_t)2 * i * i;
+    }
+    return px;
+  }
+
+  static uint64_t test_roundRects(LovyanGFX* gfx, const assets_t&)
+  {
+    int cx = gfx->width() >> 1, cy = gfx->height() >> 1;
+    int w = std::min(gfx->width(), gfx->height());
+    uint64_t px = 0;
+    for (int i = 0; i < w; i += 6)
+    {
+      int i2 = i >> 1;
+      gfx->drawRoundRect(cx - i2, cy - i2, i, i, i >> 3, gfx->color565(i, 0, 0));
+      px += 4 * i;
+    }
+    return px;
+  }
+
+  static uint64_t test_filledRoundRects(LovyanGFX* gfx, const assets_t&)
+  {
+    int cx = gfx->width() >> 1, cy = gfx->height() >> 1;
+    uint64_t px = 0;
+    for (int i = std::min(gfx->width(), gfx->height()); i > 20; i -= 6)
+    {
+      int i2 = i >> 1;
+      gfx->fillRoundRect(cx - i2, cy - i2, i, i, i >> 3, gfx->color565(0, i, 0));
+      px += (uint64_t)i * i;
+    }
+    return px;
+  }
+
+  static uint64_t draw_text(LovyanGFX* gfx, const lgfx::IFont* font)
+  {
+    static constexpr const char text[] = "The quick brown fox jumps over the lazy dog 0123456789";
+    gfx->setFont(font);
+    gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+    int fh = gfx->fontHeight();
+    int tw = gfx->textWidth(text);
+    uint64_t px = 0;
+    for (int y = 0; y < gfx->height(); y += fh)
+    {
+      gfx->drawString(text, 0, y);
+      px += (uint64_t)std::min(tw, (int)gfx->width()) * std::min(fh, gfx->height() - y);
+    }
+    return px;
+  }
+
+  static uint64_t test_text_glcd    (LovyanGFX* gfx, const assets_t&) { return draw_text(gfx, &fonts::Font0); }
+  static uint64_t test_text_bmp     (LovyanGFX* gfx, const assets_t&) { return draw_text(gfx, &fonts::Font2); }
+  static uint64_t test_text_fixedbmp(LovyanGFX* gfx, const assets_t&) { return draw_text(gfx, &fonts::AsciiFont8x16); }
+  static uint64_t test_text_rle     (LovyanGFX* gfx, const assets_t&) { return draw_text(gfx, &fonts::Font4); }
+  static uint64_t test_text_gfx     (LovyanGFX* gfx, const assets_t&) { return draw_text(gfx, &fonts::FreeSans9pt7b); }
+
+  /// TGfx が LGFX_Sprite の場合は型を確定させた LGFX_Sprite::pushImage が使われる;
+  /// With TGfx = LGFX_Sprite the statically dispatched LGFX_Sprite::pushImage is used.
+  template <typename TGfx, typename T>
+  static uint64_t push_image_tiles(TGfx* gfx, const T* data, int size = image_size)
+  {
+    uint64_t px = 0;
+    for (int y = 0; y < gfx->height(); y += size)
+    {
+      for (int x = 0; x < gfx->width(); x += size)
+      {
+        gfx->pushImage(x, y, size, size, data);
+        px += (uint64_t)std::min(size, gfx->width() - x) * std::min(size, gfx->height() - y);
+      }
+    }
+    return px;
+  }
+
+  static uint64_t test_pushImage_rgb332  (LovyanGFX* gfx, const assets_t& a) { return push_image_tiles(gfx, a.img332.data()); }
+  static uint64_t test_pushImage_swap565 (LovyanGFX* gfx, const assets_t& a) { return push_image_tiles(gfx, a.img565.data()); }
+  static uint64_t test_pushImage_bgr888  (LovyanGFX* gfx, const assets_t& a) { return push_image_tiles(gfx, a.img888.data()); }
+  static uint64_t test_pushImage_argb8888(LovyanGFX* gfx, const assets_t& a) { return push_image_tiles(gfx, a.img8888.data()); }
+  static uint64_t test_pushImage_gray8   (LovyanGFX* gfx, const assets_t& a) { return push_image_tiles(gfx, a.imggray.data()); }
+
+  static uint64_t test_icon_pushImage_rgb332 (LovyanGFX* gfx, const assets_t& a) { return push_image_tiles(gfx, a.img332.data(), icon_size); }
+  static uint64_t test_icon_pushImage_swap565(LovyanGFX* gfx, const assets_t& a) { return push_image_tiles(gfx, a.img565.data(), icon_size); }
+
+  static uint64_t test_icon_pushImage_rgb332_direct (LGFX_Sprite* gfx, const assets_t& a) { return push_image_tiles(gfx, a.img332.data(), icon_size); }
+  static uint64_t test_icon_pushImage_swap565_direct(LGFX_Sprite* gfx, const assets_t& a) { return push_image_tiles(gfx, a.img565.data(), icon_size); }
+
+  template <typename TGfx>
+  static uint64_t push_sprite_tiles(TGfx* gfx, const LGFX_Sprite& src)
+  {
+    int size = src.width();
+    uint64_t px = 0;
+    for (int y = 0; y < gfx->height(); y += size)
+    {
+      for (int x = 0; x < gfx->width(); x += size)
+      {
+        const_cast<LGFX_Sprite&>(src).pushSprite(gfx, x, y);
+        px += (uint64_t)std::min(size, gfx->width() - x) * std::min(size, gfx->height() - y);
+      }
+    }
+    return px;
+  }
+
+  static uint64_t test_icon_pushSprite       (LovyanGFX*   gfx, const assets_t& a) { return push_sprite_tiles(gfx, a.icon_sprite); }
+  static uint64_t test_icon_pushSprite_direct(LGFX_Sprite* gfx, const assets_t& a) { return push_sprite_tiles(gfx, a.icon_sprite); }
+
+  static uint64_t test_pushSprite(LovyanGFX* gfx, const assets_t& a)
+  {
+    uint64_t px = 0;
+    for (int y = 0; y < gfx->height(); y += image_size)
+    {
+      for (int x = 0; x < gfx->width(); x += image_size)
+      {
+        const_cast<LGFX_Sprite&>(a.src_sprite).pushSprite(gfx, x, y);
+        px += (uint64_t)std::min(image_size, gfx->width() - x) * std::min(image_size, gfx->height() - y);
+      }
+    }
+    return px;
+  }
+
+  static uint64_t test_pushSprite_transp(LovyanGFX* gfx, const assets_t& a)
+  {
+    uint64_t px = 0;
+    for (int y = 0; y < gfx->height(); y += image_size)
+    {
+      for (int x = 0; x < gfx->width(); x += image_size)
+      {
+        const_cast<LGFX_Sprite&>(a.src_sprite).pushSprite(gfx, x, y, 0);
+        px += (uint64_t)std::min(image_size, gfx->width() - x) * std::min(image_size, gfx->height() - y);
+      }
+    }
+    return px;
+  }
+
+  static constexpr float rz_angle = 30.0f;
+  static constexpr float rz_zoom  = 1.5f;
+
+  static uint64_t test_rotateZoom(LovyanGFX* gfx, const assets_t& a)
+  {
+    const_cast<LGFX_Sprite&>(a.src_sprite).pushRotateZoom(gfx, gfx->width() >> 1, gfx->height() >> 1, rz_angle, rz_zoom, rz_zoom);
+    return (uint64_t)(image_size * image_size * rz_zoom * rz_zoom);
+  }
+
+  static uint64_t test_rotateZoomAA(LovyanGFX* gfx, const assets_t& a)
+  {
+    const_cast<LGFX_Sprite&>(a.src_sprite).pushRotateZoomWithAA(gfx, gfx->width() >> 1, gfx->height() >> 1, rz_angle, rz_zoom, rz_zoom);
+    return (uint64_t)(image_size * image_size * rz_zoom * rz_zoom);
+  }
+
+  static uint64_t test_rotateZoom_transp(LovyanGFX* gfx, const assets_t& a)
+  {
+    const_cast<LGFX_Sprite&>(a.src_sprite).pushRotateZoom(gfx, gfx->width() >> 1, gfx->height() >> 1, rz_angle, rz_zoom, rz_zoom, 0);
+    return (uint64_t)(image_size * image_size * rz_zoom * rz_zoom);
+  }
+
+  static uint64_t test_rotateZoomAA_transp(LovyanGFX* gfx, const assets_t& a)
+  {
+    const_cast<LGFX_Sprite&>(a.src_sprite).pushRotateZoomWithAA(gfx, gfx->width() >> 1, gfx->height() >> 1, rz_angle, rz_zoom, rz_zoom, 0);
+    return (uint64_t)(image_size * image_size * rz_zoom * rz_zoom);
+  }
+
+  static uint64_t decoded_pixels(LovyanGFX* gfx, const assets_t& a)
+  {
+    return (uint64_t)std::min(a.decode_w, (int)gfx->width()) * std::min(a.decode_h, (int)gfx->height());
+  }
+
+  static uint64_t test_decode_jpg(LovyanGFX* gfx, const assets_t& a) { return gfx->drawJpg(a.jpg_data, a.jpg_len) ? decoded_pixels(gfx, a) : 0; }
+  static uint64_t test_decode_png(LovyanGFX* gfx, const assets_t& a) { return gfx->drawPng(a.png.data(), a.png.size()) ? decoded_pixels(gfx, a) : 0; }
+  static uint64_t test_decode_qoi(LovyanGFX* gfx, const assets_t& a) { return gfx->drawQoi(a.qoi.data(), a.qoi.size()) ? decoded_pixels(gfx, a) : 0; }
+  static uint64_t test_decode_qoi_alpha(LovyanGFX* gfx, const assets_t& a) { return gfx->drawQoi(a.qoi_alpha.data(), a.qoi_alpha.size()) ? decoded_pixels(gfx, a) : 0; }
+  static uint64_t test_decode_bmp(LovyanGFX* gfx, const assets_t& a) { return gfx->drawBmp(a.bmp.data(), a.bmp.size()) ? decoded_pixels(gfx, a) : 0; }
+
+  template <typename TFn>
+  struct test_entry_base_t
+  {
+    const char* name;
+    TFn fn;
+    bool rgb_only;  // RGB ソースの変換転送に対応した色深度の出力先でのみ実行する;
+                    // only run on targets pixelcopy_t can convert RGB sources into.
+  };
+  typedef test_entry_base_t<test_fn_t> test_entry_t;
+  typedef test_entry_base_t<sprite_test_fn_t> sprite_test_entry_t;
+
+  static constexpr test_entry_t test_list[] =
+  { { "fillScreen"             , test_fillScreen           , false }
+  , { "pixels"                 , test_pixels               , false }
+  , { "lines"                  , test_lines                , false }
+  , { "fastLines"              , test_fastLines            , false }
+  , { "rects"                  , test_rects                , false }
+  , { "filledRects"            , test_filledRects          , false }
+  , { "circles"                , test_circles              , false }
+  , { "filledCircles"          , test_filledCircles        , false }
+  , { "triangles"              , test_triangles            , false }
+  , { "filledTriangles"        , test_filledTriangles      , false }
+  , { "roundRects"             , test_roundRects           , false }
+  , { "filledRoundRects"       , test_filledRoundRects     , false }
+  , { "text_glcd"              , test_text_glcd            , false }
+  , { "text_bmp"               , test_text_bmp             , false }
+  , { "text_fixedbmp"          , test_text_fixedbmp        , false }
+  , { "text_rle"               , test_text_rle             , false }
+  , { "text_gfx"               , test_text_gfx             , false }
+  , { "pushImage_rgb332"       , test_pushImage_rgb332     , true  }
+  , { "pushImage_swap565"      , test_pushImage_swap565    , true  }
+  , { "pushImage_bgr888"       , test_pushImage_bgr888     , true  }
+  , { "pushImage_argb8888"     , test_pushImage_argb8888   , true  }
+  , { "pushImage_grayscale"    , test_pushImage_gray8      , true  }
+  , { "icon_pushImage_rgb332"  , test_icon_pushImage_rgb332 , true }
+  , { "icon_pushImage_swap565" , test_icon_pushImage_swap565, true }
+  , { "icon_pushSprite"        , test_icon_pushSprite      , true  }
+  , { "pushSprite"             , test_pushSprite           , true  }
+  , { "pushSprite_transp"      , test_pushSprite_transp    , true  }
+  , { "rotateZoom"             , test_rotateZoom           , true  }
+  , { "rotateZoom_transp"      , test_rotateZoom_transp    , true  }
+  , { "rotateZoomAA"           , test_rotateZoomAA         , true  }
+  , { "rotateZoomAA_transp"    , test_rotateZoomAA_transp  , true  }
+  , { "decode_jpg"             , test_decode_jpg           , true  }
+  , { "decode_png"             , test_decode_png           , true  }
+  , { "decode_qoi"             , test_decode_qoi           , true  }
+  , { "decode_qoi_alpha"       , test_decode_qoi_alpha     , true  }
+  , { "decode_bmp"             , test_decode_bmp           , true  }
+  };
+
+  /// LGFX_Sprite の静的な型で呼び出すテスト (LovyanGFX* 経由の同名テストとの比較用) ;
+  /// Tests called through the static LGFX_Sprite type, to compare with their LovyanGFX* twins.
+  static constexpr sprite_test_entry_t sprite_test_list[] =
+  { { "icon_pushImage_rgb332_direct" , test_icon_pushImage_rgb332_direct , true }
+  , { "icon_pushImage_swap565_direct", test_icon_pushImage_swap565_direct, true }
+  , { "icon_pushSprite_direct"       , test_icon_pushSprite_direct       , true }
+  };
+
+//----------------------------------------------------------------------------
+
+  template <typename TGfx, typename TEntry, size_t N>
+  static void run_tests(TGfx* gfx, const TEntry (&list)[N], const char* target, const char* depth, const assets_t& a, const options_t& opt, std::vector<result_t>& results)
+  {
+    typedef std::chrono::steady_clock clock;
+    auto min_time = std::chrono::milliseconds(opt.min_time_ms);
+
+    bool rgb_target = nullptr != lgfx::pixelcopy_t::get_fp_copy_rgb_affine<lgfx::rgb332_t>(gfx->getColorDepth());
+
+    gfx->startWrite();
+    for (auto& t : list)
+    {
+      if (opt.filter && nullptr == strstr(t.name, opt.filter)) { continue; }
+      if (t.rgb_only && !rgb_target) { continue; }
+
+      gfx->fillScreen(TFT_BLACK);
+      t.fn(gfx, a);  // warm up
+
+      uint32_t iterations = 0;
+      uint64_t pixels = 0;
+#if defined ( LGFX_PANEL_STATS )
+      gfx->resetPanelStats();
+#endif
+      auto start = clock::now();
+      auto elapsed = clock::duration::zero();
+      do
+      {
+        pixels += t.fn(gfx, a);
+        ++iterations;
+        elapsed = clock::now() - start;
+      } while (elapsed < min_time);
+
+      double sec = std::chrono::duration<double>(elapsed).count();
+      results.push_back({ target, depth, t.name, iterations, sec, pixels });
+#if defined ( LGFX_PANEL_STATS )
+      results.back().stats = gfx->getPanelStats();
+#endif
+      fprintf(stderr, "%-7s %-20s %-22s %12.0f px/s\n", target, depth, t.name, pixels / sec);
+    }
+    gfx->endWrite();
+  }
+
+  static void run_sprite(const assets_t& a, const options_t& opt, std::vector<result_t>& results)
+  {
+    for (auto& d : depth_list)
+    {
+      LGFX_Sprite sprite;
+      sprite.setColorDepth(d.depth);
+      if (!sprite.createSprite(opt.width, opt.height) || sprite.getColorDepth() != d.depth)
+      {
+        fprintf(stderr, "sprite  %-20s skipped (not supported)\n", d.name);
+        continue;
+      }
+      run_tests(&sprite, test_list       , "sprite", d.name, a, opt, results);
+      run_tests(&sprite, sprite_test_list, "sprite", d.name, a, opt, results);
+    }
+  }
+
+  static void run_memory(const assets_t& a, const options_t& opt, std::vector<result_t>& results)
+  {
+    lgfx::Panel_Memory panel;
+    {
+      auto cfg = panel.config();
+      cfg.memory_width  = cfg.panel_width  = opt.width;
+      cfg.memory_height = cfg.panel_height = opt.height;
+      panel.config(cfg);
+    }
+    lgfx::LGFX_Device gfx;
+    gfx.setPanel(&panel);
+    if (!gfx.init()) { fprintf(stderr, "memory  init failed\n"); return; }
+
+    for (auto& d : depth_list)
+    {
+      gfx.setColorDepth(d.depth);
+      if (gfx.getColorDepth() != d.depth) { continue; }
+      run_tests(&gfx, test_list, "memory", d.name, a, opt, results);
+    }
+  }
+
+  /// フレームバッファから HUB75 の DMA 形式への変換速度。戻り値は高速版と参照版の結果が一致したか;
+  static bool run_hub75(const options_t& opt, std::vector<result_t>& results)
+  {
+    typedef std::chrono::steady_clock clock;
+    static constexpr const int panel_width = 128;
+    static constexpr const int panel_height = 64;
+    static constexpr const depth_entry_t hub75_depth_list[] =
+    { { lgfx::color_depth_t::rgb332_1Byte, "rgb332_1Byte" }
+    , { lgfx::color_depth_t::rgb565_2Byte, "rgb565_2Byte" }
+    };
+    auto min_time = std::chrono::milliseconds(opt.min_time_ms);
+    bool match = true;
+
+    for (auto& d : hub75_depth_list)
+    {
+      lgfx::HUB75_Encoder encoder;
+      lgfx::HUB75_Encoder::config_t cfg;
+      cfg.panel_width = panel_width;
+      cfg.panel_height = panel_height;
+      cfg.depth = d.depth;
+      lgfx::DividedFrameBuffer fb;
+      size_t line_size = panel_width * (d.depth & lgfx::color_depth_t::bit_mask) >> 3;
+      if (!encoder.init(cfg) || !fb.create(line_size, panel_height, panel_height >> 1))
+      {
+        fprintf(stderr, "hub75   %-20s init failed\n", d.name);
+        match = false;
+        continue;
+      }
+      uint32_t seed = 1;
+      for (int y = 0; y < panel_height; ++y)
+      {
+        auto line = fb.getLineBuffer(y);
+        for (size_t i = 0; i < line_size; ++i)
+        {
+          seed = seed * 1103515245u + 12345u;
+          line[i] = seed >> 24;
+        }
+      }
+
+      std::vector<uint32_t> reference(encoder.getLineLength() * (panel_height >> 1));
+      std::vector<uint32_t> frame(reference.size());
+      encoder.encodeFrame(reference.data(), &fb, false);
+      encoder.encodeFrame(frame.data(), &fb, true);
+      if (frame != reference)
+      {
+        fprintf(stderr, "hub75   %-20s bit-plane output differs from the scalar reference\n", d.name);
+        match = false;
+      }
+
+      for (int fast = 0; fast < 2; ++fast)
+      {
+        const char* name = fast ? "encode_frame_fast" : "encode_frame_scalar";
+        if (opt.filter && nullptr == strstr(name, opt.filter)) { continue; }
+        uint32_t iterations = 0;
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do
+        {
+          encoder.encodeFrame(frame.data(), &fb, fast);
+          ++iterations;
+          elapsed = clock::now() - start;
+        } while (elapsed < min_time);
+
+        double sec = std::chrono::duration<double>(elapsed).count();
+        uint64_t pixels = (uint64_t)iterations * panel_width * panel_height;
+        results.push_back({ "hub75", d.name, name, iterations, sec, pixels });
+        fprintf(stderr, "%-7s %-20s %-22s %12.0f px/s\n", "hub75", d.name, name, pixels / sec);
+      }
+      fb.release();
+    }
+    return match;
+  }
+
+  /// 8bit グレースケール画像を 2 階調 / 16 階調へ減色する速度;
+  static void run_dither(const options_t& opt, std::vector<result_t>& results)
+  {
+    typedef std::chrono::steady_clock clock;
+    static constexpr const struct { lgfx::dither_mode_t mode; const char* name; } mode_list[] =
+    { { lgfx::dither_mode_t::dither_bayer4         , "dither_bayer4"          }
+    , { lgfx::dither_mode_t::dither_bayer8         , "dither_bayer8"          }
+    , { lgfx::dither_mode_t::dither_blue_noise     , "dither_blue_noise"      }
+    , { lgfx::dither_mode_t::dither_floyd_steinberg, "dither_floyd_steinberg" }
+    , { lgfx::dither_mode_t::dither_atkinson       , "dither_atkinson"        }
+    };
+    auto min_time = std::chrono::milliseconds(opt.min_time_ms);
+    int width = opt.width;
+    int height = opt.height;
+
+    std::vector<uint8_t> gray(width * height);
+    std::vector<uint8_t> levels(width);
+    uint32_t seed = 1;
+    for (int y = 0; y < height; ++y)
+    {
+      for (int x = 0; x < width; ++x)
+      {
+        seed = seed * 1103515245u + 12345u;
+        gray[x + y * width] = ((x * 255 / width) + (seed >> 29)) & 0xFF;
+      }
+    }
+
+    lgfx::Ditherer ditherer;
+    for (int bits = 1; bits <= 4; bits += 3)
+    {
+      const char* depth = bits == 1 ? "levels_2" : "levels_16";
+      ditherer.setLevels(1 << bits);
+      for (auto& m : mode_list)
+      {
+        if (opt.filter && nullptr == strstr(m.name, opt.filter)) { continue; }
+        uint32_t iterations = 0;
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do
+        {
+          ditherer.resetError();
+          for (int y = 0; y < height; ++y)
+          {
+            ditherer.imageRow(m.mode, levels.data(), &gray[y * width], 0, y, width);
+          }
+          ++iterations;
+          elapsed = clock::now() - start;
+        } while (elapsed < min_time);
+
+        double sec = std::chrono::duration<double>(elapsed).count();
+        uint64_t pixels = (uint64_t)iterations * width * height;
+        results.push_back({ "dither", depth, m.name, iterations, sec, pixels });
+        fprintf(stderr, "%-7s %-20s %-22s %12.0f px/s\n", "dither", depth, m.name, pixels / sec);
+      }
+    }
+  }
+
+  /// UI の画面を模したフレームを描く (135x240 、M5UnitLCD の解像度) ;
+  static void draw_ui_frame(LGFX_Sprite& canvas, const assets_t& a, int frame)
+  {
+    int w = canvas.width();
+    canvas.fillScreen(TFT_BLACK);
+    canvas.fillRect(0, 0, w, 20, TFT_NAVY);
+    canvas.setTextColor(TFT_WHITE);
+    canvas.setFont(&fonts::Font2);
+    canvas.drawString("Settings", 4, 2);
+    canvas.drawNumber(frame % 60, w - 24, 2);
+    static constexpr const char* item[] = { "Wi-Fi", "Bluetooth", "Display", "Sound", "Battery", "About" };
+    for (int i = 0; i < 6; ++i)
+    {
+      int y = 24 + i * 26;
+      bool selected = (i == (frame / 8) % 6);
+      canvas.fillRoundRect(2, y, w - 4, 24, 4, selected ? TFT_DARKCYAN : TFT_DARKGREY);
+      canvas.setTextColor(selected ? TFT_YELLOW : TFT_WHITE);
+      canvas.drawString(item[i], 8, y + 4);
+      canvas.fillCircle(w - 14, y + 12, 5, (i & 1) ? TFT_GREEN : TFT_RED);
+    }
+    canvas.drawRect(4, 184, w - 8, 12, TFT_WHITE);
+    canvas.fillRect(6, 186, (w - 12) * (frame % 32) / 31, 8, TFT_ORANGE);
+    canvas.drawJpg(a.jpg_data, a.jpg_len, 0, 200, w, 40, (frame * 3) % 100, 80);
+  }
+
+  /// UnitLCD へ送る形式 (1行毎の画素列) で全フレームを集める;
+  static bool collect_unitlcd_frames(const assets_t& a, const options_t& opt, lgfx::color_depth_t depth, std::vector<uint8_t>& data, std::vector<uint32_t>& spans)
+  {
+    size_t bytes = (depth & lgfx::color_depth_t::bit_mask) >> 3;
+    LGFX_Sprite canvas;
+    canvas.setColorDepth(depth);
+    auto add_rows = [&](int x, int y, int w, int h)
+    {
+      auto buf = static_cast<const uint8_t*>(canvas.getBuffer());
+      for (int j = y; j < y + h; ++j)
+      {
+        auto row = &buf[(j * canvas.width() + x) * bytes];
+        data.insert(data.end(), row, row + w * bytes);
+        spans.push_back(w);
+      }
+    };
+
+    if (opt.frames)
+    {
+#if defined ( LGFX_LINUX_FB )
+      lgfx::FrameRecordReader reader;
+      if (!reader.open(opt.frames) || !canvas.createSprite(reader.width(), reader.height())) { return false; }
+      while (reader.readFrame(&canvas))
+      {
+        auto& r = reader.getDirtyRect();
+        if (!r.empty()) { add_rows(r.left, r.top, r.width(), r.height()); }
+      }
+      return !spans.empty();
+#else
+      /// Panel_Recorder / FrameRecordReader は FrameBuffer プラットフォームのみ;
+      return false;
+#endif
+    }
+
+    if (!canvas.createSprite(135, 240)) { return false; }
+    for (int frame = 0; frame < 60; ++frame)
+    {
+      draw_ui_frame(canvas, a, frame);
+      add_rows(0, 0, canvas.width(), canvas.height());
+    }
+    return true;
+  }
+
+  /// Panel_M5UnitLCD と同じ行単位の送信で、生データ / RLE / 適応的な選択の転送量と符号化速度を比べる;
+  static bool run_unitlcd(const assets_t& a, const options_t& opt, std::vector<result_t>& results)
+  {
+    typedef std::chrono::steady_clock clock;
+    typedef lgfx::M5UnitLCD_Encoder encoder_t;
+    static constexpr const depth_entry_t unitlcd_depth_list[] =
+    { { lgfx::color_depth_t::rgb332_1Byte, "rgb332_1Byte" }
+    , { lgfx::color_depth_t::rgb565_2Byte, "rgb565_2Byte" }
+    , { lgfx::color_depth_t::rgb888_3Byte, "rgb888_3Byte" }
+    };
+    static constexpr const char* method_name[] = { "raw", "rle", "adaptive" };
+    auto min_time = std::chrono::milliseconds(opt.min_time_ms);
+    bool match = true;
+
+    for (auto& d : unitlcd_depth_list)
+    {
+      size_t bytes = (d.depth & lgfx::color_depth_t::bit_mask) >> 3;
+      std::vector<uint8_t> data;
+      std::vector<uint32_t> spans;
+      if (!collect_unitlcd_frames(a, opt, d.depth, data, spans))
+      {
+        fprintf(stderr, "unitlcd %-20s no frames\n", d.name);
+        match = false;
+        continue;
+      }
+      uint32_t max_span = 0;
+      for (auto w : spans) { max_span = std::max(max_span, w); }
+      uint32_t margin = encoder_t::encodeMargin(max_span) + 1;
+      std::vector<uint8_t> buf(margin + max_span * bytes);
+      std::vector<uint8_t> decoded(max_span * bytes);
+
+      for (int method = 0; method < 3; ++method)
+      {
+        if (opt.filter && nullptr == strstr(method_name[method], opt.filter)) { continue; }
+        uint64_t sent = 0;
+        uint32_t iterations = 0;
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do
+        {
+          // パネルと同様に、DMA バッファへ画素を置いてからその場で符号化する;
+          sent = 0;
+          auto current = encoder_t::method_t::method_none;
+          auto src = data.data();
+          for (auto w : spans)
+          {
+            memcpy(&buf[margin], src, w * bytes);
+            auto m = (method == 0) ? encoder_t::method_t::method_raw
+                   : (method == 1) ? encoder_t::method_t::method_rle
+                   : encoder_t::select(&buf[margin], w, bytes, current);
+            if (m != current && current != encoder_t::method_t::method_none) { sent += encoder_t::command_switch_cost; }
+            if (m == encoder_t::method_t::method_raw)
+            {
+              sent += w * bytes;
+            }
+            else
+            {
+              size_t len = encoder_t::encodeRLE(buf.data(), &buf[margin], w, bytes);
+              sent += len;
+              if (iterations == 0
+               && (w != encoder_t::decodeRLE(decoded.data(), buf.data(), len, bytes, w)
+                || memcmp(decoded.data(), src, w * bytes)))
+              {
+                match = false;
+              }
+            }
+            current = m;
+            src += w * bytes;
+          }
+          ++iterations;
+          elapsed = clock::now() - start;
+        } while (elapsed < min_time);
+
+        double sec = std::chrono::duration<double>(elapsed).count();
+        uint64_t frame_pixels = data.size() / bytes;
+        uint64_t pixels = (uint64_t)iterations * frame_pixels;
+        results.push_back({ "unitlcd", d.name, method_name[method], iterations, sec, pixels, (uint64_t)iterations * sent });
+        fprintf(stderr, "%-7s %-20s %-22s %12.0f px/s %8.3f px/byte\n", "unitlcd", d.name, method_name[method], pixels / sec, (double)frame_pixels / sent);
+      }
+      if (!match) { fprintf(stderr, "unitlcd %-20s RLE output does not decode to the source\n", d.name); }
+    }
+    return match;
+  }
+
+#if defined ( LGFX_LINUX_FB )
+  /// Panel_shm の描画と公開の速度。描画毎にシーケンス番号が2進み、変更範囲が公開されることも確認する;
+  static bool run_shm(const options_t& opt, std::vector<result_t>& results)
+  {
+    typedef std::chrono::steady_clock clock;
+    static constexpr const depth_entry_t shm_depth_list[] =
+    { { lgfx::color_depth_t::rgb565_2Byte, "rgb565_2Byte" }
+    , { lgfx::color_depth_t::rgb888_3Byte, "rgb888_3Byte" }
+    };
+    static constexpr const char* name = "publish_fill_rect";
+    auto min_time = std::chrono::milliseconds(opt.min_time_ms);
+    bool match = true;
+    if (opt.filter && nullptr == strstr(name, opt.filter)) { return match; }
+
+    for (auto& d : shm_depth_list)
+    {
+      lgfx::Panel_shm panel;
+      {
+        auto cfg = panel.config();
+        cfg.panel_width  = opt.width;
+        cfg.panel_height = opt.height;
+        panel.config(cfg);
+        auto detail = panel.config_detail();
+        detail.shm_name = "/lgfx_benchmark";
+        panel.config_detail(detail);
+      }
+      lgfx::LGFX_Device gfx;
+      gfx.setPanel(&panel);
+      gfx.setColorDepth(d.depth);
+      if (!gfx.init()) { fprintf(stderr, "shm     init failed\n"); return false; }
+      auto header = panel.getHeader();
+
+      uint32_t iterations = 0;
+      uint64_t pixels = 0;
+      auto start = clock::now();
+      auto elapsed = clock::duration::zero();
+      do
+      {
+        int w = 8 + (iterations % 32);
+        int x = (iterations * 7) % (opt.width  - w);
+        int y = (iterations * 5) % (opt.height - w);
+        uint32_t seq = header->sequence;
+        gfx.fillRect(x, y, w, w, iterations * 0x010203u);
+        if (header->sequence     != seq + 2
+         || header->dirty_left   != x         || header->dirty_top    != y
+         || header->dirty_right  != x + w - 1 || header->dirty_bottom != y + w - 1)
+        {
+          match = false;
+        }
+        pixels += w * w;
+        ++iterations;
+        elapsed = clock::now() - start;
+      } while (elapsed < min_time);
+
+      double sec = std::chrono::duration<double>(elapsed).count();
+      results.push_back({ "shm", d.name, name, iterations, sec, pixels });
+      fprintf(stderr, "%-7s %-20s %-22s %12.0f px/s %10.0f frames/s\n", "shm", d.name, name, pixels / sec, iterations / sec);
+      if (!match) { fprintf(stderr, "shm     %-20s a draw did not publish a frame with its dirty rect\n", d.name); }
+    }
+    return match;
+  }
+#endif
+
+//----------------------------------------------------------------------------
+
+  static void write_json(FILE* fp, const options_t& opt, const std::vector<result_t>& results)
+  {
+    fprintf(fp, "{\n  \"library\": \"LovyanGFX\",\n  \"version\": \"%d.%d.%d\",\n", LGFX_VERSION_MAJOR, LGFX_VERSION_MINOR, LGFX_VERSION_PATCH);
+    fprintf(fp, "  \"simd\": \"%s\",\n", lgfx::get_convert_row_table().isa);
+    fprintf(fp, "  \"width\": %d,\n  \"height\": %d,\n  \"min_time_ms\": %d,\n  \"results\": [\n", opt.width, opt.height, opt.min_time_ms);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      auto& r = results[i];
+      fprintf(fp, "    { \"target\": \"%s\", \"depth\": \"%s\", \"test\": \"%s\", \"iterations\": %u, \"seconds\": %.6f, \"pixels\": %llu, \"pixels_per_sec\": %.0f, \"ns_per_iteration\": %.0f"
+             , r.target.c_str(), r.depth.c_str(), r.test.c_str(), r.iterations, r.seconds, (unsigned long long)r.pixels
+             , r.pixels / r.seconds, r.seconds * 1e9 / r.iterations);
+      if (r.bytes)
+      {
+        fprintf(fp, ", \"bytes\": %llu, \"pixels_per_byte\": %.3f", (unsigned long long)r.bytes, (double)r.pixels / r.bytes);
+      }
+#if defined ( LGFX_PANEL_STATS )
+      /// エントリポイント毎の [呼出し回数, ピクセル数, 時間(ns)] ; [calls, pixels, ns] per panel entry point
+      const struct { const char* name; const lgfx::panel_stats_t::entry_t& e; } entries[] =
+      { { "setWindow"              , r.stats.setWindow               }
+      , { "writeBlock"             , r.stats.writeBlock              }
+      , { "drawPixelPreclipped"    , r.stats.drawPixelPreclipped     }
+      , { "writeFillRectPreclipped", r.stats.writeFillRectPreclipped }
+      , { "writeImage"             , r.stats.writeImage              }
+      , { "writeImageARGB"         , r.stats.writeImageARGB          }
+      , { "writePixels"            , r.stats.writePixels             }
+      , { "copyRect"               , r.stats.copyRect                }
+      , { "readRect"               , r.stats.readRect                }
+      , { "display"                , r.stats.display                 }
+      };
+      fprintf(fp, ", \"panel\": {");
+      const char* sep = " ";
+      for (auto& e : entries)
+      {
+        if (e.e.calls == 0) { continue; }
+        fprintf(fp, "%s\"%s\": [%u, %llu, %llu]", sep, e.name, e.e.calls, (unsigned long long)e.e.pixels, (unsigned long long)e.e.time_ns);
+        sep = ", ";
+      }
+      fprintf(fp, " }");
+#endif
+      fprintf(fp, " }%s\n", (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+  }
+
+  static void write_csv(FILE* fp, const options_t&, const std::vector<result_t>& results)
+  {
+    fprintf(fp, "target,depth,test,iterations,seconds,pixels,pixels_per_sec,ns_per_iteration\n");
+    for (auto& r : results)
+    {
+      fprintf(fp, "%s,%s,%s,%u,%.6f,%llu,%.0f,%.0f\n"
+             , r.target.c_str(), r.depth.c_str(), r.test.c_str(), r.iterations, r.seconds, (unsigned long long)r.pixels
+             , r.pixels / r.seconds, r.seconds * 1e9 / r.iterations);
+    }
+  }
+
+  static bool parse_args(int argc, char** argv, options_t& opt)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      const char* arg = argv[i];
+      const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+      if (val == nullptr) { return false; }
+      if      (!strcmp(arg, "--format"  )) { opt.format = val; }
+      else if (!strcmp(arg, "--out"     )) { opt.out = val; }
+      else if (!strcmp(arg, "--filter"  )) { opt.filter = val; }
+      else if (!strcmp(arg, "--target"  )) { opt.target = val; }
+      else if (!strcmp(arg, "--frames"  )) { opt.frames = val; }
+      else if (!strcmp(arg, "--width"   )) { opt.width = atoi(val); }
+      else if (!strcmp(arg, "--height"  )) { opt.height = atoi(val); }
+      else if (!strcmp(arg, "--min-time")) { opt.min_time_ms = atoi(val); }
+      else { return false; }
+      ++i;
+    }
+    return opt.width > 0 && opt.height > 0 && opt.min_time_ms >= 0
+        && (!strcmp(opt.format, "json") || !strcmp(opt.format, "csv"));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  options_t opt;
+  if (!parse_args(argc, argv, opt))
+  {
+    fprintf(stderr, "usage: %s [--format json|csv] [--out FILE] [--width W] [--height H] [--min-time MS] [--filter TEXT] [--frames FILE] [--target sprite|memory|hub75|dither|unitlcd|shm]\n", argv[0]);
+    return 1;
+  }
+
+  assets_t assets;
+  if (!make_assets(assets))
+  {
+    fprintf(stderr, "failed to prepare test assets\n");
+    return 1;
+  }
+
+  std::vector<result_t> results;
+  if (opt.target == nullptr || !strcmp(opt.target, "sprite")) { run_sprite(assets, opt, results); }
+  if (opt.target == nullptr || !strcmp(opt.target, "memory")) { run_memory(assets, opt, results); }
+  bool hub75_match = true;
+  if (opt.target == nullptr || !strcmp(opt.target, "hub75" )) { hub75_match = run_hub75(opt, results); }
+  if (opt.target == nullptr || !strcmp(opt.target, "dither")) { run_dither(opt, results); }
+  bool unitlcd_match = true;
+  if (opt.target == nullptr || !strcmp(opt.target, "unitlcd")) { unitlcd_match = run_unitlcd(assets, opt, results); }
+  bool shm_match = true;
+#if defined ( LGFX_LINUX_FB )
+  if (opt.target == nullptr || !strcmp(opt.target, "shm"   )) { shm_match = run_shm(opt, results); }
+#endif
+
+  FILE* fp = stdout;
+  if (opt.out && nullptr == (fp = fopen(opt.out, "w")))
+  {
+    fprintf(stderr, "cannot open %s\n", opt.out);
+    return 1;
+  }
+  if (!strcmp(opt.format, "csv")) { write_csv(fp, opt, results); }
+  else                            { write_json(fp, opt, results); }
+  if (fp != stdout) { fclose(fp); }
+  return (hub75_match && unitlcd_match && shm_match) ? 0 : 2;
+}
@@ -27,6 +27,7 @@ Contributors:
 #include "../utility/pgmspace.h"
 #include "panel/Panel_Device.hpp"
 #include "misc/bitmap.hpp"
+#include "misc/Allocator.hpp"
 
 #include <stdarg.h>
 #include <stdint.h>
@@ -101,6 +102,7 @@ namespace lgfx
     if (y < 0) { h += y; y = 0; }
     if (h > height() - y) h = height() - y;
     if (h < 1) { y = 0; h = 0; }
+    LGFX_PANEL_STATS_SCOPE(_panel, display, w * h);
     _panel->display(x, y, w, h);
   }
 
@@ -1162,7 +1164,10 @@ namespace lgfx
     param->src_y = dy;
 
     startWrite();
-    _panel->writeImage(x, y, dw, dh, param, use_dma);
+    {
+      LGFX_PANEL_STATS_SCOPE(_panel, writeImage, dw * dh);
+      _panel->writeImage(x, y, dw, dh, param, use_dma);
+    }
     endWrite();
   }
 
@@ -1193,6 +1198,34 @@ namespace lgfx
     return true;
   }
 
+  static inline int32_t floor_div(int32_t n, int32_t d) { return (n >= 0) ? n / d : ~(~n / d); }
+  static inline int32_t ceil_div( int32_t n, int32_t d) { return (n >  0) ? (n - 1) / d + 1 : -(-n / d); }
+
+  /// pos = base + x * step が lo <= pos <= hi となる x の範囲に [left, right) を狭める;
+  /// Narrows [left, right) to the x for which lo <= base + x * step <= hi.
+  static inline void narrow_affine_span(int32_t& left, int32_t& right, int32_t base, int32_t step, int32_t lo, int32_t hi)
+  {
+    int32_t l, r;
+    if (step > 0)
+    {
+      l = ceil_div( lo - base, step);
+      r = floor_div(hi - base, step) + 1;
+    }
+    else if (step < 0)
+    {
+      l = ceil_div( base - hi, -step);
+      r = floor_div(base - lo, -step) + 1;
+    }
+    else
+    {
+      if (lo <= base && base <= hi) { return; }
+      right = left;
+      return;
+    }
+    if (left  < l) { left  = l; }
+    if (right > r) { right = r; }
+  }
+
   void LGFXBase::push_image_rotate_zoom(float dst_x, float dst_y, float src_x, float src_y, float angle, float zoom_x, float zoom_y, int32_t w, int32_t h, pixelcopy_t* pc)
   {
     float matrix[6];
@@ -1278,19 +1311,12 @@ namespace lgfx
     iA[2] += ((iA[0] + iA[1] * offset) >> 1);
     iA[5] += ((iA[3] + iA[4] * offset) >> 1);
 
-    int32_t scale_w = w << FP_SCALE;
-    int32_t xs1 = (iA[0] < 0 ?   - scale_w :   1) - iA[0];
-    int32_t xs2 = (iA[0] < 0 ? 0 : (1 - scale_w)) - iA[0];
-
-    int32_t scale_h = h << FP_SCALE;
-    int32_t ys1 = (iA[3] < 0 ?   - scale_h :   1) - iA[3];
-    int32_t ys2 = (iA[3] < 0 ? 0 : (1 - scale_h)) - iA[3];
+    int32_t x_max = (w << FP_SCALE) - 1;
+    int32_t y_max = (h << FP_SCALE) - 1;
 
     int32_t cl = _clip_l    ;
     int32_t cr = _clip_r + 1;
 
-    int32_t div1 = iA[0] ? - iA[0] : -1;
-    int32_t div2 = iA[3] ? - iA[3] : -1;
     int32_t y = min_y - max_y;
 
     startWrite();
@@ -1298,8 +1324,10 @@ namespace lgfx
     {
       iA[2] += iA[1];
       iA[5] += iA[4];
-      int32_t left  = std::max(cl, std::max((iA[2] + xs1) / div1, (iA[5] + ys1) / div2));
-      int32_t right = std::min(cr, std::min((iA[2] + xs2) / div1, (iA[5] + ys2) / div2));
+      int32_t left  = cl;
+      int32_t right = cr;
+      narrow_affine_span(left, right, iA[2], iA[0], 0, x_max);
+      narrow_affine_span(left, right, iA[5], iA[3], 0, y_max);
       if (left < right)
       {
         writeFillRectPreclipped(left, y + max_y, right - left, 1);
@@ -1337,13 +1365,8 @@ namespace lgfx
     iA[2] += ((iA[0] + iA[1] * offset) >> 1);
     iA[5] += ((iA[3] + iA[4] * offset) >> 1);
 
-    int32_t scale_w = pc->src_width << FP_SCALE;
-    int32_t xs1 = (iA[0] < 0 ?   - scale_w :   1) - iA[0];
-    int32_t xs2 = (iA[0] < 0 ? 0 : (1 - scale_w)) - iA[0];
-
-    int32_t scale_h = pc->src_height << FP_SCALE;
-    int32_t ys1 = (iA[3] < 0 ?   - scale_h :   1) - iA[3];
-    int32_t ys2 = (iA[3] < 0 ? 0 : (1 - scale_h)) - iA[3];
+    int32_t x_max = (pc->src_width  << FP_SCALE) - 1;
+    int32_t y_max = (pc->src_height << FP_SCALE) - 1;
 
     int32_t cl = _clip_l    ;
     int32_t cr = _clip_r + 1;
@@ -1355,21 +1378,19 @@ namespace lgfx
     {
       iA[2] += iA[1];
       iA[5] += iA[4];
-      int32_t left  = std::max(cl, std::max(iA[0] ? (iA[2] + xs1) / - iA[0] : cl, iA[3] ? (iA[5] + ys1) / - iA[3] : cl));
-      int32_t right = std::min(cr, std::min(iA[0] ? (iA[2] + xs2) / - iA[0] : cr, iA[3] ? (iA[5] + ys2) / - iA[3] : cr));
+      // 転送元の範囲に入る区間を行ごとに求めるので、区間内の画素は範囲チェック不要;
+      int32_t left  = cl;
+      int32_t right = cr;
+      narrow_affine_span(left, right, iA[2], iA[0], 0, x_max);
+      narrow_affine_span(left, right, iA[5], iA[3], 0, y_max);
       if (left < right)
       {
         pc->src_x32 = iA[2] + left * iA[0];
-        if (static_cast<uint32_t>(pc->src_x) < static_cast<uint32_t>(pc->src_width))
-        {
-          pc->src_y32 = iA[5] + left * iA[3];
-          if (static_cast<uint32_t>(pc->src_y) < static_cast<uint32_t>(pc->src_height))
-          {
-            pc->src_x32_add = iA[0];
-            pc->src_y32_add = iA[3];
-            _panel->writeImage(left, y + max_y, right - left, 1, pc, true);
-          }
-        }
+        pc->src_y32 = iA[5] + left * iA[3];
+        pc->src_x32_add = iA[0];
+        pc->src_y32_add = iA[3];
+        LGFX_PANEL_STATS_SCOPE(_panel, writeImage, right - left);
+        _panel->writeImage(left, y + max_y, right - left, 1, pc, true);
       }
     } while (++y);
     endWrite();
@@ -1408,13 +1429,11 @@ namespace lgfx
     iA[2] += ((iA[0] + iA[1] * offset) >> 1);
     iA[5] += ((iA[3] + iA[4] * offset) >> 1);
 
-    int32_t scale_w = (pc->src_width << FP_SCALE) + (x32_diff << 1);
-    int32_t xs1 = (iA[0] < 0 ?   - scale_w :   1) - iA[0] + x32_diff;
-    int32_t xs2 = (iA[0] < 0 ? 0 : (1 - scale_w)) - iA[0] + x32_diff;
-
-    int32_t scale_h = (pc->src_height << FP_SCALE) + (y32_diff << 1);
-    int32_t ys1 = (iA[3] < 0 ?   - scale_h :   1) - iA[3] + y32_diff;
-    int32_t ys2 = (iA[3] < 0 ? 0 : (1 - scale_h)) - iA[3] + y32_diff;
+    // 参照範囲 (中心 ± diff) が転送元と重なる区間を行ごとに求める;
+    int32_t x_min = - (int32_t)x32_diff;
+    int32_t y_min = - (int32_t)y32_diff;
+    int32_t x_max = (pc->src_width  << FP_SCALE) - 1 + x32_diff;
+    int32_t y_max = (pc->src_height << FP_SCALE) - 1 + y32_diff;
 
     int32_t cl = _clip_l    ;
     int32_t cr = _clip_r + 1;
@@ -1427,8 +1446,10 @@ namespace lgfx
     {
       iA[2] += iA[1];
       iA[5] += iA[4];
-      int32_t left  = std::max(cl, std::max(iA[0] ? (iA[2] + xs1) / - iA[0] : cl, iA[3] ? (iA[5] + ys1) / - iA[3] : cl));
-      int32_t right = std::min(cr, std::min(iA[0] ? (iA[2] + xs2) / - iA[0] : cr, iA[3] ? (iA[5] + ys2) / - iA[3] : cr));
+      int32_t left  = cl;
+      int32_t right = cr;
+      narrow_affine_span(left, right, iA[2], iA[0], x_min, x_max);
+      narrow_affine_span(left, right, iA[5], iA[3], y_min, y_max);
       if (left < right)
       {
         int32_t len = right - left;
@@ -1445,6 +1466,7 @@ namespace lgfx
         pc2->src_y32_add = 0;
         pc2->src_x32 = 0;
         pc2->src_y32 = 0;
+        LGFX_PANEL_STATS_SCOPE(_panel, writeImageARGB, len);
         _panel->writeImageARGB(left, min_y, len, 1, pc2);
       }
     } while (++min_y != max_y);
@@ -1494,6 +1516,7 @@ namespace lgfx
     startWrite();
     if (w && h)
     {
+      LGFX_PANEL_STATS_SCOPE(_panel, copyRect, w * h);
       _panel->copyRect(dst_x, dst_y, w, h, src_x, src_y);
     }
 
@@ -1530,6 +1553,7 @@ namespace lgfx
     else               { if (dst_y < 0) { h += dst_y; src_y -= dst_y; dst_y = 0; } if (h > hei - src_y)  h = hei - src_y; }
     if (h < 1) return;
 
+    LGFX_PANEL_STATS_SCOPE(_panel, copyRect, w * h);
     _panel->copyRect(dst_x, dst_y, w, h, src_x, src_y);
   }
 
@@ -1545,6 +1569,7 @@ namespace lgfx
     if (h > height() - y) h = height() - y;
     if (h < 1) return;
 
+    LGFX_PANEL_STATS_SCOPE(_panel, readRect, w * h);
     _panel->readRect(x, y, w, h, dst, param);
   }
 
@@ -1589,9 +1614,14 @@ namespace lgfx
     const int32_t cl = _clip_l;
     const int32_t w = _clip_r - cl + 1;
     size_t bufIdx = 0;
-    uint8_t* linebufs[3] = { new uint8_t[w], new uint8_t[w], new uint8_t[w] };
+    ScratchBuffer linebuf(w * 3);
+    if (!linebuf) { return; }
+    uint8_t* linebufs[3] = { linebuf.get(), &linebuf.get()[w], &linebuf.get()[w * 2] };
     int32_t bufY[3] = {y, -2, -2};  // 3 line buffer (default: out of range.)
-    _panel->readRect(cl, y, w, 1, linebufs[0], &p);
+    {
+      LGFX_PANEL_STATS_SCOPE(_panel, readRect, w);
+      _panel->readRect(cl, y, w, 1, linebufs[0], &p);
+    }
     std::list<paint_point_t> points;
     points.push_back({x, x, y, y});
 
@@ -1622,6 +1652,7 @@ namespace lgfx
           bufY[0] = it->y;
           p.src_x32_add = 1 << FP_SCALE;
           p.src_y32_add = 0;
+          LGFX_PANEL_STATS_SCOPE(_panel, readRect, w);
           _panel->readRect(cl, it->y, w, 1, linebufs[0], &p);
         }
         else
@@ -1664,13 +1695,12 @@ namespace lgfx
           bufY[bidx] = newy;
           p.src_x32_add = 1 << FP_SCALE;
           p.src_y32_add = 0;
+          LGFX_PANEL_STATS_SCOPE(_panel, readRect, w);
           _panel->readRect(cl, newy, w, 1, linebufs[bidx], &p);
         }
         paint_add_points(points, lx ,rx, newy, ly, &linebufs[bidx][- cl]);
       } while (++i < 2);
     }
-    size_t i = 0;
-    do { delete[] linebufs[i]; } while (++i != 3);
     endWrite();
   }
 
@@ -2486,7 +2516,9 @@ namespace lgfx
 
     auto dst_depth = this->_write_conv.depth;
     uint32_t buffersize = ((w * bpp + 31) >> 5) << 2;  // readline 4Byte align.
-    auto lineBuffer = (uint8_t*)alloca(buffersize + 4);
+    // アリーナが無いか足りない場合は従来どおりスタックに確保する;
+    ScratchBuffer line(buffersize + 4, false);
+    auto lineBuffer = line ? line.get() : (uint8_t*)alloca(buffersize + 4);
 
     pixelcopy_t p(lineBuffer, dst_depth, (color_depth_t)bpp, this->_palette_count, palette);
     p.no_convert = false;
@@ -2758,6 +2790,12 @@ namespace lgfx
           p->lineBuffer = (bgra8888_t*)heap_alloc_dma(sizeof(bgra8888_t) * p->maxWidth);
         }
         p->gfx->readRect(p->x, p->y + y0, p->maxWidth, 1, p->lineBuffer);
+        auto blend = (div_x == 1) ? get_convert_row_table().bgra8888_blend_bgra8888 : nullptr;
+        if (blend != nullptr)
+        {
+          blend(&p->lineBuffer[x], argb, std::min<uint32_t>(len, p->maxWidth - x));
+        }
+        else
         do
         {
           uint_fast8_t a = argb[0];
@@ -3151,15 +3189,12 @@ namespace lgfx
     if (h > height() - y) h = height() - y;
     if (h < 1) return nullptr;
 
-    void* rgbBuffer = heap_alloc_dma(w * 3);
+    ScratchBuffer rgbBuffer(w * 3);
+    if (!rgbBuffer) return nullptr;
 
     png_encoder_t enc = { this, x, y };
 
-    auto res = tdefl_write_image_to_png_file_in_memory_ex_with_cb(rgbBuffer, w, h, 3, datalen, 6, 0, (tdefl_get_png_row_func)png_encoder_get_row, &enc);
-
-    heap_free(rgbBuffer);
-
-    return res;
+    return tdefl_write_image_to_png_file_in_memory_ex_with_cb(rgbBuffer.get(), w, h, 3, datalen, 6, 0, (tdefl_get_png_row_func)png_encoder_get_row, &enc);
   }
 
 //----------------------------------------------------------------------------
@@ -141,7 +141,7 @@ namespace lgfx
     LGFX_INLINE   void endTransaction(void)                { _panel->endTransaction(); }
     LGFX_INLINE   uint32_t getStartCount(void) const  { return _panel->getStartCount(); }
 
-    LGFX_INLINE   void setWindow(uint_fast16_t xs, uint_fast16_t ys, uint_fast16_t xe, uint_fast16_t ye) { _panel->setWindow(xs, ys, xe, ye); }
+    LGFX_INLINE   void setWindow(uint_fast16_t xs, uint_fast16_t ys, uint_fast16_t xe, uint_fast16_t ye) { LGFX_PANEL_STATS_SCOPE(_panel, setWindow, 0); _panel->setWindow(xs, ys, xe, ye); }
     LGFX_INLINE   void writePixel(int32_t x, int32_t y)  { if (x >= _clip_l && x <= _clip_r && y >= _clip_t && y <= _clip_b) writeFillRectPreclipped(x, y, 1, 1); }
     LGFX_INLINE_T void writePixel      ( int32_t x, int32_t y                      , const T& color) { setColor(color); writePixel    (x, y      ); }
     LGFX_INLINE_T void writeFastVLine  ( int32_t x, int32_t y           , int32_t h, const T& color) { setColor(color); writeFastVLine(x, y   , h); }
@@ -151,15 +151,15 @@ namespace lgfx
     LGFX_INLINE_T void writeFillRect   ( int32_t x, int32_t y, int32_t w, int32_t h, const T& color) { setColor(color); writeFillRect (x, y, w, h); }
                   void writeFillRect   ( int32_t x, int32_t y, int32_t w, int32_t h);
     LGFX_INLINE_T void writeFillRectPreclipped( int32_t x, int32_t y, int32_t w, int32_t h, const T& color) { setColor(color); writeFillRectPreclipped(x, y, w, h); }
-    LGFX_INLINE   void writeFillRectPreclipped( int32_t x, int32_t y, int32_t w, int32_t h)                 { _panel->writeFillRectPreclipped(x, y, w, h, getRawColor()); }
-    LGFX_INLINE_T void writeColor      ( const T& color, uint32_t length) { if (0 == length) return; setColor(color);               _panel->writeBlock(getRawColor(), length); }
-    LGFX_INLINE_T void pushBlock       ( const T& color, uint32_t length) { if (0 == length) return; setColor(color); startWrite(); _panel->writeBlock(getRawColor(), length); endWrite(); }
+    LGFX_INLINE   void writeFillRectPreclipped( int32_t x, int32_t y, int32_t w, int32_t h)                 { LGFX_PANEL_STATS_SCOPE(_panel, writeFillRectPreclipped, w * h); _panel->writeFillRectPreclipped(x, y, w, h, getRawColor()); }
+    LGFX_INLINE_T void writeColor      ( const T& color, uint32_t length) { if (0 == length) return; setColor(color);               LGFX_PANEL_STATS_SCOPE(_panel, writeBlock, length); _panel->writeBlock(getRawColor(), length); }
+    LGFX_INLINE_T void pushBlock       ( const T& color, uint32_t length) { if (0 == length) return; setColor(color); startWrite(); { LGFX_PANEL_STATS_SCOPE(_panel, writeBlock, length); _panel->writeBlock(getRawColor(), length); } endWrite(); }
 
     /// @brief Draw a pixel.
     /// @param x X-coordinate
     /// @param y Y-coordinate
     /// @note Draws in the color specified by setColor().
-    LGFX_INLINE   void drawPixel       ( int32_t x, int32_t y) { if (x >= _clip_l && x <= _clip_r && y >= _clip_t && y <= _clip_b) { _panel->drawPixelPreclipped(x, y, getRawColor()); } }
+    LGFX_INLINE   void drawPixel       ( int32_t x, int32_t y) { if (x >= _clip_l && x <= _clip_r && y >= _clip_t && y <= _clip_b) { LGFX_PANEL_STATS_SCOPE(_panel, drawPixelPreclipped, 1); _panel->drawPixelPreclipped(x, y, getRawColor()); } }
     /// @brief Draw a pixel.
     /// @param x X-coordinate
     /// @param y Y-coordinate
@@ -294,7 +294,7 @@ namespace lgfx
     [[deprecated("use isBusShared()")]]
     LGFX_INLINE   bool isSPIShared(void) const { return _panel->isBusShared(); }
                   void display(int32_t x, int32_t y, int32_t w, int32_t h);
-    LGFX_INLINE   void display(void) { _panel->display(0, 0, 0, 0); }
+    LGFX_INLINE   void display(void) { LGFX_PANEL_STATS_SCOPE(_panel, display, 0); _panel->display(0, 0, 0, 0); }
     LGFX_INLINE   void waitDisplay(void) { _panel->waitDisplay(); }
     LGFX_INLINE   bool displayBusy(void) { return _panel->displayBusy(); }
     LGFX_INLINE   void setAutoDisplay(bool flg) { _panel->setAutoDisplay(flg); }
@@ -302,15 +302,22 @@ namespace lgfx
     LGFX_INLINE   void waitDMA(void) { _panel->waitDMA(); }
     LGFX_INLINE   bool dmaBusy(void) { return _panel->dmaBusy(); }
 
+#if defined ( LGFX_PANEL_STATS )
+    /// パネルのエントリポイント毎の計測値を取得/リセットする (LGFX_PANEL_STATS 定義時のみ);
+    /// Per entry point counters of the panel (only with LGFX_PANEL_STATS).
+    LGFX_INLINE const panel_stats_t& getPanelStats(void) const { return _panel->getStats(); }
+    LGFX_INLINE   void resetPanelStats(void) { _panel->resetStats(); }
+#endif
+
     LGFX_INLINE_T void setScrollRect(int32_t x, int32_t y, int32_t w, int32_t h, const T& color) { setBaseColor(color); setScrollRect(x, y, w, h); }
 
-    LGFX_INLINE_T void writePixels(const T*        data, int32_t len           ) { auto pc = create_pc_fast(data      ); _panel->writePixels(&pc, len, false); }
-    LGFX_INLINE   void writePixels(const uint16_t* data, int32_t len, bool swap) { auto pc = create_pc_fast(data, swap); _panel->writePixels(&pc, len, false); }
-    LGFX_INLINE   void writePixels(const void*     data, int32_t len, bool swap) { auto pc = create_pc_fast(data, swap); _panel->writePixels(&pc, len, false); }
+    LGFX_INLINE_T void writePixels(const T*        data, int32_t len           ) { auto pc = create_pc_fast(data      ); LGFX_PANEL_STATS_SCOPE(_panel, writePixels, len); _panel->writePixels(&pc, len, false); }
+    LGFX_INLINE   void writePixels(const uint16_t* data, int32_t len, bool swap) { auto pc = create_pc_fast(data, swap); LGFX_PANEL_STATS_SCOPE(_panel, writePixels, len); _panel->writePixels(&pc, len, false); }
+    LGFX_INLINE   void writePixels(const void*     data, int32_t len, bool swap) { auto pc = create_pc_fast(data, swap); LGFX_PANEL_STATS_SCOPE(_panel, writePixels, len); _panel->writePixels(&pc, len, false); }
 
-    LGFX_INLINE_T void writePixelsDMA(const T*        data, int32_t len           ) { auto pc = create_pc_fast(data      ); _panel->writePixels(&pc, len, true); }
-    LGFX_INLINE   void writePixelsDMA(const uint16_t* data, int32_t len, bool swap) { auto pc = create_pc_fast(data, swap); _panel->writePixels(&pc, len, true); }
-    LGFX_INLINE   void writePixelsDMA(const void*     data, int32_t len, bool swap) { auto pc = create_pc_fast(data, swap); _panel->writePixels(&pc, len, true); }
+    LGFX_INLINE_T void writePixelsDMA(const T*        data, int32_t len           ) { auto pc = create_pc_fast(data      ); LGFX_PANEL_STATS_SCOPE(_panel, writePixels, len); _panel->writePixels(&pc, len, true); }
+    LGFX_INLINE   void writePixelsDMA(const uint16_t* data, int32_t len, bool swap) { auto pc = create_pc_fast(data, swap); LGFX_PANEL_STATS_SCOPE(_panel, writePixels, len); _panel->writePixels(&pc, len, true); }
+    LGFX_INLINE   void writePixelsDMA(const void*     data, int32_t len, bool swap) { auto pc = create_pc_fast(data, swap); LGFX_PANEL_STATS_SCOPE(_panel, writePixels, len); _panel->writePixels(&pc, len, true); }
 
     LGFX_INLINE_T void pushPixels(T*              data, int32_t len           ) { startWrite(); writePixels(data, len      ); endWrite(); }
     LGFX_INLINE   void pushPixels(const uint16_t* data, int32_t len, bool swap) { startWrite(); writePixels(data, len, swap); endWrite(); }
@@ -344,6 +351,7 @@ namespace lgfx
     {
       auto src_depth = (color_depth_t)(depth | color_depth_t::has_palette);
       auto pc = create_pc_fast(data, palette, src_depth);
+      LGFX_PANEL_STATS_SCOPE(_panel, writePixels, len);
       _panel->writePixels(&pc, len, false);
     }
 
@@ -413,6 +421,18 @@ namespace lgfx
 
     void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, pixelcopy_t *param, bool use_dma = false);
 
+    /// pixelcopy_t を直接渡す版。独自の fp_copy で画素を読む画像形式 (LGFX_PackedSprite 等) の回転・拡縮に使う;
+    /// Rotate / zoom / affine pushes taking a prepared pixelcopy_t, for image formats that read
+    /// their pixels through their own fp_copy (such as LGFX_PackedSprite).
+    void pushImageRotateZoom(float dst_x, float dst_y, float src_x, float src_y, float angle, float zoom_x, float zoom_y, int32_t w, int32_t h, pixelcopy_t* param)
+    {
+      push_image_rotate_zoom(dst_x, dst_y, src_x, src_y, angle, zoom_x, zoom_y, w, h, param);
+    }
+    void pushImageAffine(const float matrix[6], int32_t w, int32_t h, pixelcopy_t* param)
+    {
+      push_image_affine(matrix, w, h, param);
+    }
+
 //----------------------------------------------------------------------------
 
     template<typename T>
@@ -547,6 +567,7 @@ namespace lgfx
       pixelcopy_t p(nullptr, swap565_t::depth, _read_conv.depth, false, getPalette());
       uint16_t data = 0;
 
+      LGFX_PANEL_STATS_SCOPE(_panel, readRect, 1);
       _panel->readRect(x, y, 1, 1, &data, &p);
 
       return (data<<8)+(data>>8);
@@ -560,6 +581,7 @@ namespace lgfx
 
       pixelcopy_t p(nullptr, bgr888_t::depth, _read_conv.depth, false, getPalette());
 
+      LGFX_PANEL_STATS_SCOPE(_panel, readRect, 1);
       _panel->readRect(x, y, 1, 1, data, &p);
 
       return data[0];
@@ -920,9 +942,9 @@ namespace lgfx
     [[deprecated("use pushImage")]] void pushRect( int32_t x, int32_t y, int32_t w, int32_t h, const T* data) { pushImage(x, y, w, h, data); }
 
     template<typename T>
-    [[deprecated("use pushBlock")]] void pushColor(const T& color, uint32_t length) { if (0 != length) { setColor(color); startWrite(); _panel->writeBlock(getRawColor(), length); endWrite(); } }
+    [[deprecated("use pushBlock")]] void pushColor(const T& color, uint32_t length) { if (0 != length) { setColor(color); startWrite(); { LGFX_PANEL_STATS_SCOPE(_panel, writeBlock, length); _panel->writeBlock(getRawColor(), length); } endWrite(); } }
     template<typename T>
-    [[deprecated("use pushBlock")]] void pushColor(const T& color                     ) {                     setColor(color); startWrite(); _panel->writeBlock(getRawColor(), 1);      endWrite(); }
+    [[deprecated("use pushBlock")]] void pushColor(const T& color                     ) {                     setColor(color); startWrite(); { LGFX_PANEL_STATS_SCOPE(_panel, writeBlock, 1); _panel->writeBlock(getRawColor(), 1); } endWrite(); }
 
     template<typename T>
     [[deprecated("use pushPixels")]] void pushColors(T*              data, int32_t len           ) { startWrite(); writePixels(data, len            ); endWrite(); }
@@ -1334,6 +1356,8 @@ namespace lgfx
 
     void setEpdMode(epd_mode_t epd_mode) { _panel->setEpdMode(epd_mode); }
     epd_mode_t getEpdMode(void) const { return _panel->getEpdMode(); }
+    void setDitherMode(dither_mode_t dither_mode) { _panel->setDitherMode(dither_mode); }
+    dither_mode_t getDitherMode(void) const { return _panel->getDitherMode(); }
     inline void invertDisplay(bool i) { _panel->setInvert(i); }
     inline bool getInvert(void) const { return _panel->getInvert(); }
 
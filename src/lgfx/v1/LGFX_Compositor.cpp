@@ -0,0 +1,422 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "LGFX_Compositor.hpp"
+
+#include "platforms/common.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  static inline int32_t rect_area(const range_rect_t& r)
+  {
+    return (int32_t)r.width() * r.height();
+  }
+
+  static inline range_rect_t rect_union(const range_rect_t& a, const range_rect_t& b)
+  {
+    range_rect_t res;
+    res.left   = std::min(a.left  , b.left  );
+    res.right  = std::max(a.right , b.right );
+    res.top    = std::min(a.top   , b.top   );
+    res.bottom = std::max(a.bottom, b.bottom);
+    return res;
+  }
+
+  /// 2つの矩形を統合した場合に増える面積 (重なりがあれば負になり得る) ;
+  static inline int32_t rect_waste(const range_rect_t& a, const range_rect_t& b)
+  {
+    return rect_area(rect_union(a, b)) - rect_area(a) - rect_area(b);
+  }
+
+  static inline bool rect_covers(const range_rect_t& outer, const range_rect_t& inner)
+  {
+    return outer.left <= inner.left && inner.right  <= outer.right
+        && outer.top  <= inner.top  && inner.bottom <= outer.bottom;
+  }
+
+//----------------------------------------------------------------------------
+
+  bool LGFX_Compositor::init(LovyanGFX* dst, int32_t x, int32_t y, int32_t w, int32_t h, size_t max_layers, uint_fast16_t band_lines)
+  {
+    release();
+    if (dst == nullptr || w <= 0 || h <= 0 || max_layers == 0 || band_lines == 0) { return false; }
+    if (max_layers > 255) { max_layers = 255; }
+    if ((int32_t)band_lines > h) { band_lines = h; }
+
+    /// 合成用の帯は合成先と同じ色深度とする。パレットや8bit未満の場合は RGB565 で合成する;
+    auto depth = dst->getColorDepth();
+    if ((depth & color_depth_t::has_palette) || (depth & color_depth_t::bit_mask) < 16)
+    {
+      depth = color_depth_t::rgb565_2Byte;
+    }
+    _band.setColorDepth(depth);
+    size_t bytes = (_band.getColorDepth() & color_depth_t::bit_mask) >> 3;
+
+    _layers   = static_cast<layer_t*>(heap_alloc(max_layers * sizeof(layer_t)));
+    _order    = static_cast<uint8_t*>(heap_alloc(max_layers));
+    _band_buf = static_cast<uint8_t*>(heap_alloc_dma(w * band_lines * bytes));
+    _line_buf = static_cast<bgr888_t*>(heap_alloc(w * 2 * sizeof(bgr888_t)));
+    if (!_layers || !_order || !_band_buf || !_line_buf)
+    {
+      release();
+      return false;
+    }
+    memset(_layers, 0, max_layers * sizeof(layer_t));
+
+    _dst = dst;
+    _area_x = x;
+    _area_y = y;
+    _area_w = w;
+    _area_h = h;
+    _band_lines = band_lines;
+    _max_layers = max_layers;
+    _layer_count = 0;
+    _order_dirty = true;
+    invalidate();
+    return true;
+  }
+
+  void LGFX_Compositor::release(void)
+  {
+    _band.deleteSprite();
+    if (_layers  ) { heap_free(_layers  ); _layers   = nullptr; }
+    if (_order   ) { heap_free(_order   ); _order    = nullptr; }
+    if (_band_buf) { heap_free(_band_buf); _band_buf = nullptr; }
+    if (_line_buf) { heap_free(_line_buf); _line_buf = nullptr; }
+    _dst = nullptr;
+    _max_layers = 0;
+    _layer_count = 0;
+    _damage_count = 0;
+  }
+
+  int LGFX_Compositor::addLayer(LGFX_Sprite* sprite, int32_t x, int32_t y, int_fast16_t z)
+  {
+    if (sprite == nullptr) { return -1; }
+    for (size_t i = 0; i < _max_layers; ++i)
+    {
+      auto& l = _layers[i];
+      if (l.sprite) { continue; }
+      memset(&l, 0, sizeof(layer_t));
+      l.sprite = sprite;
+      l.x = x;
+      l.y = y;
+      l.z = z;
+      l.transp = pixelcopy_t::NON_TRANSP;
+      l.alpha = 255;
+      l.visible = true;
+      l.dirty = true;
+      ++_layer_count;
+      _order_dirty = true;
+      return i;
+    }
+    return -1;
+  }
+
+  void LGFX_Compositor::removeLayer(int id)
+  {
+    auto l = _get(id);
+    if (l == nullptr) { return; }
+    if (l->drawn) { _add_damage(l->drawn_rect); }
+    l->sprite = nullptr;
+    --_layer_count;
+    _order_dirty = true;
+  }
+
+  void LGFX_Compositor::setLayerPosition(int id, int32_t x, int32_t y)
+  {
+    auto l = _get(id);
+    if (l == nullptr) { return; }
+    l->x = x;
+    l->y = y;
+  }
+
+  void LGFX_Compositor::setLayerZ(int id, int_fast16_t z)
+  {
+    auto l = _get(id);
+    if (l == nullptr || l->z == z) { return; }
+    l->z = z;
+    l->dirty = true;
+    _order_dirty = true;
+  }
+
+  void LGFX_Compositor::setLayerVisible(int id, bool visible)
+  {
+    auto l = _get(id);
+    if (l == nullptr) { return; }
+    l->visible = visible;
+  }
+
+  void LGFX_Compositor::setLayerAlpha(int id, uint8_t alpha)
+  {
+    auto l = _get(id);
+    if (l == nullptr || l->alpha == alpha) { return; }
+    l->alpha = alpha;
+    l->dirty = true;
+  }
+
+  void LGFX_Compositor::_set_transparent(int id, uint32_t raw)
+  {
+    auto l = _get(id);
+    if (l == nullptr || l->transp == raw) { return; }
+    l->transp = raw;
+    l->dirty = true;
+  }
+
+  void LGFX_Compositor::invalidateLayer(int id)
+  {
+    auto l = _get(id);
+    if (l == nullptr) { return; }
+    l->dirty = true;
+  }
+
+  void LGFX_Compositor::invalidate(void)
+  {
+    _damage_count = 0;
+    invalidateRect(0, 0, _area_w, _area_h);
+  }
+
+  void LGFX_Compositor::invalidateRect(int32_t x, int32_t y, int32_t w, int32_t h)
+  {
+    if (w <= 0 || h <= 0) { return; }
+    range_rect_t r;
+    r.left   = x;
+    r.right  = x + w - 1;
+    r.top    = y;
+    r.bottom = y + h - 1;
+    _add_damage(r);
+  }
+
+  bool LGFX_Compositor::_layer_rect(const layer_t& l, range_rect_t& rect) const
+  {
+    if (!l.visible || l.alpha == 0) { return false; }
+    int32_t w = l.sprite->width();
+    int32_t h = l.sprite->height();
+    if (w <= 0 || h <= 0) { return false; }
+    rect.left   = l.x;
+    rect.right  = l.x + w - 1;
+    rect.top    = l.y;
+    rect.bottom = l.y + h - 1;
+    return true;
+  }
+
+  void LGFX_Compositor::_add_damage(range_rect_t rect)
+  {
+    if (rect.left < 0) { rect.left = 0; }
+    if (rect.top  < 0) { rect.top  = 0; }
+    if (rect.right  >= _area_w) { rect.right  = _area_w - 1; }
+    if (rect.bottom >= _area_h) { rect.bottom = _area_h - 1; }
+    if (rect.empty()) { return; }
+
+    /// 統合しても損をしない矩形は吸収する;
+    /// absorb rectangles that are cheaper to merge than to composite separately.
+    size_t i = 0;
+    while (i < _damage_count)
+    {
+      if (rect_waste(rect, _damage[i]) <= (int32_t)_merge_threshold)
+      {
+        rect = rect_union(rect, _damage[i]);
+        _damage[i] = _damage[--_damage_count];
+        i = 0;
+      }
+      else
+      {
+        ++i;
+      }
+    }
+    if (_damage_count < max_damage)
+    {
+      _damage[_damage_count++] = rect;
+      return;
+    }
+
+    /// 上限に達している場合は、増える面積が最小の組を統合する;
+    /// the list is full: merge the pair adding the least area.
+    size_t best_i = 0;
+    size_t best_j = max_damage;
+    int32_t best = INT32_MAX;
+    for (size_t j = 0; j <= max_damage; ++j)
+    {
+      auto& rj = (j == max_damage) ? rect : _damage[j];
+      for (i = 0; i < j; ++i)
+      {
+        int32_t waste = rect_waste(_damage[i], rj);
+        if (best > waste)
+        {
+          best = waste;
+          best_i = i;
+          best_j = j;
+        }
+      }
+    }
+    auto& rj = (best_j == max_damage) ? rect : _damage[best_j];
+    _damage[best_i] = rect_union(_damage[best_i], rj);
+    if (best_j != max_damage) { _damage[best_j] = rect; }
+  }
+
+  void LGFX_Compositor::_sort_layers(void)
+  {
+    _order_dirty = false;
+    size_t count = 0;
+    for (size_t i = 0; i < _max_layers; ++i)
+    {
+      if (_layers[i].sprite == nullptr) { continue; }
+      /// z が同じ場合は追加した順 (番号順) とする;
+      size_t j = count++;
+      while (j && _layers[_order[j - 1]].z > _layers[i].z)
+      {
+        _order[j] = _order[j - 1];
+        --j;
+      }
+      _order[j] = i;
+    }
+  }
+
+  size_t LGFX_Compositor::update(void)
+  {
+    if (_dst == nullptr) { return 0; }
+
+    for (size_t i = 0; i < _max_layers; ++i)
+    {
+      auto& l = _layers[i];
+      if (l.sprite == nullptr) { continue; }
+      range_rect_t rect;
+      bool show = _layer_rect(l, rect);
+      bool moved = (show != l.drawn)
+                || (show && memcmp(&rect, &l.drawn_rect, sizeof(range_rect_t)));
+      if (moved || l.dirty)
+      {
+        if (l.drawn) { _add_damage(l.drawn_rect); }
+        if (show) { _add_damage(rect); }
+      }
+      l.drawn = show;
+      if (show) { l.drawn_rect = rect; }
+      l.dirty = false;
+    }
+
+    size_t count = _damage_count;
+    if (count == 0) { return 0; }
+    if (_order_dirty) { _sort_layers(); }
+
+    _dst->startWrite();
+    for (size_t i = 0; i < count; ++i)
+    {
+      _composite(_damage[i]);
+    }
+    _dst->endWrite();
+    _damage_count = 0;
+    return count;
+  }
+
+  void LGFX_Compositor::_composite(const range_rect_t& rect)
+  {
+    int32_t rw = rect.width();
+    for (int32_t y = rect.top; y <= rect.bottom; y += _band_lines)
+    {
+      int32_t rh = std::min<int32_t>(_band_lines, rect.bottom + 1 - y);
+      _band.setBuffer(_band_buf, rw, rh);
+
+      range_rect_t band;
+      band.left   = rect.left;
+      band.right  = rect.right;
+      band.top    = y;
+      band.bottom = y + rh - 1;
+
+      /// 帯全体を覆う不透明なレイヤーより下は描く必要が無い;
+      /// nothing below an opaque layer covering the whole band needs drawing.
+      size_t start = 0;
+      bool covered = false;
+      for (size_t i = _layer_count; i--; )
+      {
+        auto& l = _layers[_order[i]];
+        if (l.drawn && l.alpha == 255 && l.transp == pixelcopy_t::NON_TRANSP && rect_covers(l.drawn_rect, band))
+        {
+          start = i;
+          covered = true;
+          break;
+        }
+      }
+      if (!covered) { _band.fillScreen(_bg_color); }
+
+      for (size_t i = start; i < _layer_count; ++i)
+      {
+        auto& l = _layers[_order[i]];
+        if (!l.drawn || !l.drawn_rect.intersectsWith(band)) { continue; }
+        int32_t bx = l.x - rect.left;
+        int32_t by = l.y - y;
+        if (l.alpha != 255)
+        {
+          _blend_layer(l, bx, by, rw, rh);
+        }
+        else if (l.transp == pixelcopy_t::NON_TRANSP)
+        {
+          l.sprite->pushSprite(&_band, bx, by);
+        }
+        else
+        {
+          auto sprite = l.sprite;
+          pixelcopy_t p(sprite->getBuffer(), _band.getColorDepth(), sprite->getColorDepth(), _band.hasPalette(), sprite->getPalette(), l.transp);
+          _band.pushImage(bx, by, sprite->width(), sprite->height(), &p);
+        }
+      }
+
+      _band.pushSprite(_dst, _area_x + rect.left, _area_y + y);
+      _pushed_pixels += rw * rh;
+    }
+  }
+
+  void LGFX_Compositor::_blend_layer(const layer_t& l, int32_t band_x, int32_t band_y, int32_t band_w, int32_t band_h)
+  {
+    auto sprite = l.sprite;
+    int32_t x0 = std::max<int32_t>(0, band_x);
+    int32_t x1 = std::min<int32_t>(band_w, band_x + sprite->width());
+    int32_t y0 = std::max<int32_t>(0, band_y);
+    int32_t y1 = std::min<int32_t>(band_h, band_y + sprite->height());
+    if (x0 >= x1 || y0 >= y1) { return; }
+
+    int32_t w = x1 - x0;
+    auto src = _line_buf;
+    auto dst = &_line_buf[_area_w];
+    uint32_t a = l.alpha + 1;
+    uint32_t ia = 256 - a;
+    bool keyed = l.transp != pixelcopy_t::NON_TRANSP;
+    for (int32_t y = y0; y < y1; ++y)
+    {
+      int32_t sx = x0 - band_x;
+      int32_t sy = y - band_y;
+      sprite->readRectRGB(sx, sy, w, 1, src);
+      _band.readRectRGB(x0, y, w, 1, dst);
+      for (int32_t i = 0; i < w; ++i)
+      {
+        if (keyed && sprite->readPixelValue(sx + i, sy) == l.transp) { continue; }
+        dst[i].r = (src[i].r * a + dst[i].r * ia) >> 8;
+        dst[i].g = (src[i].g * a + dst[i].g * ia) >> 8;
+        dst[i].b = (src[i].b * a + dst[i].b * ia) >> 8;
+      }
+      _band.pushImage(x0, y, w, 1, dst);
+    }
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
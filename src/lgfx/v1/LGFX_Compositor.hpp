@@ -0,0 +1,167 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "LGFX_Sprite.hpp"
+#include "misc/range.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// 複数のスプライトを重ね合わせて表示し、変化した範囲だけを描き直すコンポジタ。
+  /// 合成は数ライン分のバッファで帯状に行うため、画面全体のバッファは不要;
+  /// Composites a stack of sprites (layers) onto a LovyanGFX device and repaints only the
+  /// regions that changed since the last update(): layers that moved, were shown or hidden,
+  /// or were marked with invalidateLayer(). Damaged regions are composited in bands of a few
+  /// lines, so no full screen buffer is needed.
+  ///
+  /// レイヤーは pushSprite と同様に、スプライトの回転は考慮せずに描画する;
+  /// Layers are drawn the way pushSprite draws them; sprite rotation is not taken into account.
+  class LGFX_Compositor
+  {
+  public:
+    /// 1回の update で扱う矩形の最大数。超える分は近い矩形同士を統合する;
+    /// Most damaged rectangles kept per update; beyond that the closest ones are merged.
+    static constexpr size_t max_damage = 8;
+
+    LGFX_Compositor(void) = default;
+    LGFX_Compositor(const LGFX_Compositor&) = delete;
+    LGFX_Compositor& operator=(const LGFX_Compositor&) = delete;
+    ~LGFX_Compositor(void) { release(); }
+
+    /// dst の (x, y, w, h) の範囲を合成先とする。band_lines は1回に合成するライン数;
+    /// Composites into the (x, y, w, h) area of dst, band_lines lines at a time.
+    bool init(LovyanGFX* dst, int32_t x, int32_t y, int32_t w, int32_t h, size_t max_layers = 8, uint_fast16_t band_lines = 16);
+    bool init(LovyanGFX* dst, size_t max_layers = 8, uint_fast16_t band_lines = 16)
+    {
+      return dst && init(dst, 0, 0, dst->width(), dst->height(), max_layers, band_lines);
+    }
+    void release(void);
+
+    /// レイヤーを追加して番号を返す。座標は合成先の範囲の左上が原点。空きが無ければ -1 ;
+    /// Adds a layer and returns its id, or -1 when all max_layers slots are taken.
+    /// Positions are relative to the top left of the composited area; higher z is drawn on top.
+    int addLayer(LGFX_Sprite* sprite, int32_t x = 0, int32_t y = 0, int_fast16_t z = 0);
+    void removeLayer(int id);
+
+    void setLayerPosition(int id, int32_t x, int32_t y);
+    void setLayerZ(int id, int_fast16_t z);
+    void setLayerVisible(int id, bool visible);
+
+    /// 255 で不透明。それ以外は合成先と混合する (行単位の読み書きを伴うため不透明より遅い) ;
+    /// 255 is opaque. Other values blend with what lies below, which goes through a row read
+    /// back and is slower than opaque layers.
+    void setLayerAlpha(int id, uint8_t alpha);
+
+    /// 透過色を設定する。pushSprite の透過色と同じく、スプライトの色深度で比較する。
+    /// 色深度を変更した場合は設定し直すこと;
+    /// Sets the transparent color, compared in the sprite's own color format like the transp
+    /// argument of pushSprite. Set it again after changing the sprite's color depth.
+    template<typename T>
+    void setLayerTransparent(int id, const T& color)
+    {
+      auto l = _get(id);
+      if (l == nullptr) { return; }
+      auto conv = l->sprite->getColorConverter();
+      _set_transparent(id, conv->convert(color) & conv->colormask);
+    }
+    void clearLayerTransparent(int id) { _set_transparent(id, pixelcopy_t::NON_TRANSP); }
+
+    /// スプライトの内容を書き換えた場合に呼び、次の update で描き直させる;
+    /// Call after drawing into the layer's sprite so the next update() repaints it.
+    void invalidateLayer(int id);
+
+    /// 合成先の範囲全体、または一部を次の update で描き直させる;
+    /// Repaints the whole area, or part of it, on the next update().
+    void invalidate(void);
+    void invalidateRect(int32_t x, int32_t y, int32_t w, int32_t h);
+
+    /// どのレイヤーにも覆われない部分の色;
+    /// Color of the parts no layer covers.
+    template<typename T>
+    void setBackgroundColor(const T& color)
+    {
+      _bg_color = lgfx::convert_to_rgb888(color);
+      invalidate();
+    }
+
+    /// 変化した範囲を合成して dst へ送る。戻り値は送った矩形の数;
+    /// Composites the damaged regions and pushes them to dst. Returns the number of rectangles.
+    size_t update(void);
+
+    /// 統合しても損をしない無駄な面積 (画素数) 。大きいほど矩形の数が減る;
+    /// Wasted area in pixels below which two damaged rectangles are merged.
+    void setMergeThreshold(uint32_t pixels) { _merge_threshold = pixels; }
+
+    /// これまでに dst へ送った画素数;
+    /// Pixels pushed to dst so far.
+    uint64_t getPushedPixels(void) const { return _pushed_pixels; }
+
+  protected:
+    struct layer_t
+    {
+      LGFX_Sprite* sprite;
+      int32_t x;
+      int32_t y;
+      uint32_t transp;
+      int_fast16_t z;
+      uint8_t alpha;
+      bool visible;
+      bool dirty;
+      /// 前回の update で描いた範囲 (drawn が false なら無し) ;
+      range_rect_t drawn_rect;
+      bool drawn;
+    };
+
+    LovyanGFX* _dst = nullptr;
+    layer_t* _layers = nullptr;
+    uint8_t* _order = nullptr;
+    uint8_t* _band_buf = nullptr;
+    bgr888_t* _line_buf = nullptr;
+    LGFX_Sprite _band;
+    range_rect_t _damage[max_damage];
+    size_t _damage_count = 0;
+    uint64_t _pushed_pixels = 0;
+    uint32_t _merge_threshold = 1024;
+    uint32_t _bg_color = 0;
+    int32_t _area_x = 0;
+    int32_t _area_y = 0;
+    int32_t _area_w = 0;
+    int32_t _area_h = 0;
+    uint16_t _band_lines = 0;
+    uint8_t _max_layers = 0;
+    uint8_t _layer_count = 0;
+    bool _order_dirty = false;
+
+    layer_t* _get(int id) const { return ((uint32_t)id < _max_layers && _layers[id].sprite) ? &_layers[id] : nullptr; }
+    void _set_transparent(int id, uint32_t raw);
+    bool _layer_rect(const layer_t& l, range_rect_t& rect) const;
+    void _add_damage(range_rect_t rect);
+    void _sort_layers(void);
+    void _composite(const range_rect_t& rect);
+    void _blend_layer(const layer_t& l, int32_t band_x, int32_t band_y, int32_t band_w, int32_t band_h);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
+
+using LGFX_Compositor = lgfx::LGFX_Compositor;
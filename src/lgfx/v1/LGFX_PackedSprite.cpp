@@ -0,0 +1,342 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "LGFX_PackedSprite.hpp"
+
+#include "platforms/common.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  static constexpr uint8_t packed_magic[4] = { 'L', 'P', 'K', '1' };
+
+  /// 転送中の読出し位置。アフィン変換では隣の画素へ移ることが多いため、直前のランから前後へ辿る;
+  struct packed_cursor_t
+  {
+    const uint8_t* runs;
+    const uint8_t* row_index;
+    uint32_t run;     // 現在のランの番号;
+    int32_t row;      // 現在の行 (-1 で未設定) ;
+    int32_t run_x;    // 現在のランの先頭のX座標;
+    int32_t run_end;  // 現在のランの次のX座標;
+  };
+
+  static inline uint_fast8_t packed_locate(packed_cursor_t* c, int32_t x, int32_t y)
+  {
+    auto runs = c->runs;
+    if (y != c->row)
+    {
+      c->row = y;
+      c->run = pgm_read_dword_unaligned(&c->row_index[y << 2]);
+      c->run_x = 0;
+      c->run_end = pgm_read_byte(&runs[c->run << 1]) + 1;
+    }
+    while (x >= c->run_end)
+    {
+      c->run_x = c->run_end;
+      c->run_end += pgm_read_byte(&runs[++c->run << 1]) + 1;
+    }
+    while (x < c->run_x)
+    {
+      c->run_end = c->run_x;
+      c->run_x -= pgm_read_byte(&runs[--c->run << 1]) + 1;
+    }
+    return pgm_read_byte(&runs[(c->run << 1) + 1]);
+  }
+
+  static inline bool is_unit_step(const pixelcopy_t* param)
+  {
+    return param->src_x32_add == (1u << pixelcopy_t::FP_SCALE) && param->src_y32_add == 0;
+  }
+
+  template <typename TDst>
+  static uint32_t copy_packed(void* __restrict dst, uint32_t index, uint32_t last, pixelcopy_t* __restrict param)
+  {
+    auto c = static_cast<packed_cursor_t*>(const_cast<void*>(param->src_data));
+    auto pal = static_cast<const bgr888_t*>(param->palette);
+    auto d = static_cast<TDst*>(dst);
+    auto transp = param->transp;
+    if (is_unit_step(param))
+    { /// 等倍の場合はラン単位で色を変換して塗る;
+      int32_t y = param->src_y32 >> pixelcopy_t::FP_SCALE;
+      int32_t x = param->src_x32 >> pixelcopy_t::FP_SCALE;
+      int32_t x0 = x;
+      do
+      {
+        uint32_t i = packed_locate(c, x, y);
+        if (i == transp) { break; }
+        uint32_t n = std::min<uint32_t>(c->run_end - x, last - index);
+        uint32_t color = color_convert<TDst, bgr888_t>(pal[i].get());
+        x += n;
+        do { d[index++].set(color); } while (--n);
+      } while (index != last);
+      param->src_x32 += (x - x0) << pixelcopy_t::FP_SCALE;
+      return index;
+    }
+    do
+    {
+      uint32_t i = packed_locate(c, param->src_x32 >> pixelcopy_t::FP_SCALE, param->src_y32 >> pixelcopy_t::FP_SCALE);
+      if (i == transp) { break; }
+      d[index].set(color_convert<TDst, bgr888_t>(pal[i].get()));
+      param->src_x32 += param->src_x32_add;
+      param->src_y32 += param->src_y32_add;
+    } while (++index != last);
+    return index;
+  }
+
+  static uint32_t skip_packed(uint32_t index, uint32_t last, pixelcopy_t* param)
+  {
+    auto c = static_cast<packed_cursor_t*>(const_cast<void*>(param->src_data));
+    auto transp = param->transp;
+    if (is_unit_step(param))
+    {
+      int32_t y = param->src_y32 >> pixelcopy_t::FP_SCALE;
+      int32_t x = param->src_x32 >> pixelcopy_t::FP_SCALE;
+      int32_t x0 = x;
+      do
+      {
+        if (packed_locate(c, x, y) != transp) { break; }
+        uint32_t n = std::min<uint32_t>(c->run_end - x, last - index);
+        x += n;
+        index += n;
+      } while (index != last);
+      param->src_x32 += (x - x0) << pixelcopy_t::FP_SCALE;
+      return index;
+    }
+    do
+    {
+      if (packed_locate(c, param->src_x32 >> pixelcopy_t::FP_SCALE, param->src_y32 >> pixelcopy_t::FP_SCALE) != transp) { break; }
+      param->src_x32 += param->src_x32_add;
+      param->src_y32 += param->src_y32_add;
+    } while (++index != last);
+    return index;
+  }
+
+  static auto get_fp_copy_packed(color_depth_t dst_depth) -> uint32_t(*)(void*, uint32_t, uint32_t, pixelcopy_t*)
+  {
+    return (dst_depth == rgb565_2Byte) ? copy_packed<swap565_t>
+         : (dst_depth == rgb332_1Byte) ? copy_packed<rgb332_t >
+         : (dst_depth == rgb888_3Byte) ? copy_packed<bgr888_t >
+         : (dst_depth == rgb666_3Byte) ? copy_packed<bgr666_t >
+         : (dst_depth == grayscale_8bit) ? copy_packed<grayscale_t>
+         : (dst_depth == argb8888_4Byte) ? copy_packed<bgra8888_t>
+         : nullptr;
+  }
+
+//----------------------------------------------------------------------------
+
+  static inline void write_u16(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; }
+  static inline void write_u32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+  static inline uint32_t read_u16(const uint8_t* p) { return pgm_read_byte(&p[0]) | pgm_read_byte(&p[1]) << 8; }
+
+  static inline size_t palette_bytes(size_t count) { return (count * 3 + 3) & ~3u; }
+
+  /// 色をパレットに探し、無ければ追加する。256色を超える場合は -1 ;
+  static int find_or_add(bgr888_t* palette, size_t& count, const bgr888_t& color)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (palette[i].r == color.r && palette[i].g == color.g && palette[i].b == color.b) { return i; }
+    }
+    if (count == LGFX_PackedSprite::max_palette) { return -1; }
+    palette[count] = color;
+    return count++;
+  }
+
+  bool LGFX_PackedSprite::createFromImage(LovyanGFX* src, int32_t x, int32_t y, int32_t w, int32_t h)
+  {
+    release();
+    if (src == nullptr || w < 1 || h < 1 || x < 0 || y < 0 || x + w > src->width() || y + h > src->height()) { return false; }
+
+    ScratchBuffer line((w + 1) * sizeof(bgr888_t));
+    ScratchBuffer pal_buf(max_palette * sizeof(bgr888_t) + 1);
+    if (!line || !pal_buf) { return false; }
+    auto rgb = reinterpret_cast<bgr888_t*>(line.get());
+    auto palette = reinterpret_cast<bgr888_t*>(pal_buf.get());
+    size_t palette_count = 0;
+
+    /// 1回目はパレットとランの数を求め、2回目で書込む;
+    size_t run_count = 0;
+    for (int32_t row = 0; row < h; ++row)
+    {
+      src->readRectRGB(x, y + row, w, 1, rgb);
+      for (int32_t i = 0; i < w;)
+      {
+        int32_t end = std::min(i + 256, w);
+        int32_t j = i + 1;
+        while (j < end && rgb[j].r == rgb[i].r && rgb[j].g == rgb[i].g && rgb[j].b == rgb[i].b) { ++j; }
+        if (find_or_add(palette, palette_count, rgb[i]) < 0) { return false; }
+        ++run_count;
+        i = j;
+      }
+    }
+
+    size_t pal_len = palette_bytes(palette_count);
+    size_t length = header_size + pal_len + (h + 1) * 4 + run_count * 2;
+    auto data = static_cast<uint8_t*>(heap_alloc_psram(length));
+    if (data == nullptr) { data = static_cast<uint8_t*>(heap_alloc(length)); }
+    if (data == nullptr) { return false; }
+
+    memset(data, 0, header_size + pal_len);
+    memcpy(data, packed_magic, 4);
+    write_u16(&data[4], w);
+    write_u16(&data[6], h);
+    write_u16(&data[8], palette_count);
+    write_u32(&data[12], run_count);
+    memcpy(&data[header_size], palette, palette_count * 3);
+    auto row_index = &data[header_size + pal_len];
+    auto runs = &row_index[(h + 1) * 4];
+
+    uint32_t run = 0;
+    for (int32_t row = 0; row < h; ++row)
+    {
+      write_u32(&row_index[row * 4], run);
+      src->readRectRGB(x, y + row, w, 1, rgb);
+      for (int32_t i = 0; i < w;)
+      {
+        int32_t end = std::min(i + 256, w);
+        int32_t j = i + 1;
+        while (j < end && rgb[j].r == rgb[i].r && rgb[j].g == rgb[i].g && rgb[j].b == rgb[i].b) { ++j; }
+        runs[run * 2] = j - i - 1;
+        runs[run * 2 + 1] = find_or_add(palette, palette_count, rgb[i]);
+        ++run;
+        i = j;
+      }
+    }
+    write_u32(&row_index[h * 4], run);
+
+    if (!setBuffer(data, length))
+    {
+      heap_free(data);
+      return false;
+    }
+    _owned = data;
+    return true;
+  }
+
+  bool LGFX_PackedSprite::setBuffer(const void* data, size_t length)
+  {
+    release();
+    auto p = static_cast<const uint8_t*>(data);
+    if (p == nullptr || length < header_size) { return false; }
+    for (size_t i = 0; i < 4; ++i)
+    {
+      if (pgm_read_byte(&p[i]) != packed_magic[i]) { return false; }
+    }
+    uint32_t w = read_u16(&p[4]);
+    uint32_t h = read_u16(&p[6]);
+    uint32_t palette_count = read_u16(&p[8]);
+    uint32_t run_count = read_u16(&p[12]) | read_u16(&p[14]) << 16;
+    size_t pal_len = palette_bytes(palette_count);
+    if (w == 0 || h == 0 || palette_count == 0 || palette_count > max_palette
+     || length < header_size + pal_len + (h + 1) * 4 + run_count * 2)
+    {
+      return false;
+    }
+    _data = p;
+    _length = length;
+    _palette = reinterpret_cast<const bgr888_t*>(&p[header_size]);
+    _row_index = &p[header_size + pal_len];
+    _runs = &_row_index[(h + 1) * 4];
+    _width = w;
+    _height = h;
+    _palette_count = palette_count;
+    _xpivot = w >> 1;
+    _ypivot = h >> 1;
+    return true;
+  }
+
+  void LGFX_PackedSprite::release(void)
+  {
+    if (_owned)
+    {
+      heap_free(_owned);
+      _owned = nullptr;
+    }
+    _data = nullptr;
+    _length = 0;
+    _palette = nullptr;
+    _row_index = nullptr;
+    _runs = nullptr;
+    _width = _height = _palette_count = 0;
+  }
+
+  uint32_t LGFX_PackedSprite::find_color(uint32_t rgb888) const
+  {
+    for (uint32_t i = 0; i < _palette_count; ++i)
+    {
+      auto c = _palette[i];
+      if ((uint32_t)(c.R8() << 16 | c.G8() << 8 | c.B8()) == rgb888) { return i; }
+    }
+    return pixelcopy_t::NON_TRANSP;
+  }
+
+  bool LGFX_PackedSprite::init_pc(pixelcopy_t* pc, packed_cursor_t* cursor, LovyanGFX* dst, uint32_t transp) const
+  {
+    if (_data == nullptr || dst == nullptr || dst->hasPalette()) { return false; }
+    pc->fp_copy = get_fp_copy_packed(dst->getColorDepth());
+    if (pc->fp_copy == nullptr) { return false; }
+    pc->fp_skip = skip_packed;
+    pc->src_data = cursor;
+    pc->palette = _palette;
+    pc->transp = transp;
+    pc->src_depth = palette_8bit;
+    pc->dst_depth = dst->getColorDepth();
+    pc->no_convert = false;
+
+    cursor->runs = _runs;
+    cursor->row_index = _row_index;
+    cursor->run = 0;
+    cursor->row = -1;
+    cursor->run_x = 0;
+    cursor->run_end = 0;
+    return true;
+  }
+
+  void LGFX_PackedSprite::push_sprite(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp)
+  {
+    packed_cursor_t cursor;
+    pixelcopy_t pc;
+    if (!init_pc(&pc, &cursor, dst, transp)) { return; }
+    dst->pushImage(x, y, _width, _height, &pc);
+  }
+
+  void LGFX_PackedSprite::push_rotate_zoom(LovyanGFX* dst, float x, float y, float angle, float zoom_x, float zoom_y, uint32_t transp)
+  {
+    packed_cursor_t cursor;
+    pixelcopy_t pc;
+    if (!init_pc(&pc, &cursor, dst, transp)) { return; }
+    dst->pushImageRotateZoom(x, y, _xpivot, _ypivot, angle, zoom_x, zoom_y, _width, _height, &pc);
+  }
+
+  void LGFX_PackedSprite::push_affine(LovyanGFX* dst, const float matrix[6], uint32_t transp)
+  {
+    packed_cursor_t cursor;
+    pixelcopy_t pc;
+    if (!init_pc(&pc, &cursor, dst, transp)) { return; }
+    dst->pushImageAffine(matrix, _width, _height, &pc);
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
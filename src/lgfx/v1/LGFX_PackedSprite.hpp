@@ -0,0 +1,120 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "LGFXBase.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  struct packed_cursor_t;
+
+  /// パレット (最大256色) と行ごとのランレングスで圧縮した、読出し専用のスプライト。
+  /// 転送時は fp_copy がランを直接転送先へ展開するため、全体を展開するバッファは不要;
+  /// Read-only sprite compressed as a palette of up to 256 colors plus per row run lengths.
+  /// pushSprite / pushRotateZoom / pushAffine decode runs straight into the destination through
+  /// the pixelcopy_t fp_copy hook, so no decompression buffer is needed. Static UI artwork
+  /// typically shrinks several times compared with raw rgb565.
+  ///
+  /// 転送先は 8bit 以上のパレット無しの色深度に限る。それ以外の転送先には何も描画しない;
+  /// Destinations must be 8 bit or deeper and have no palette (rgb332 up to argb8888);
+  /// pushing onto a palette or sub-byte destination draws nothing.
+  ///
+  /// データ形式 (リトルエンディアン) ;
+  /// Data layout, little endian:
+  ///   header     16 bytes : "LPK1", width (u16), height (u16), palette count (u16), 0 (u16), run count (u32)
+  ///   palette    palette count x 3 bytes (r, g, b), padded to a multiple of 4 bytes
+  ///   row index  (height + 1) x u32 : number of the first run of each row
+  ///   runs       run count x 2 bytes : (length - 1, palette index); a run never crosses a row
+  class LGFX_PackedSprite
+  {
+  public:
+    static constexpr size_t header_size = 16;
+    static constexpr size_t max_palette = 256;
+
+    LGFX_PackedSprite(void) = default;
+    LGFX_PackedSprite(const LGFX_PackedSprite&) = delete;
+    LGFX_PackedSprite& operator=(const LGFX_PackedSprite&) = delete;
+    ~LGFX_PackedSprite(void) { release(); }
+
+    /// src の (x, y, w, h) の範囲を読出して圧縮する。色数が 256 を超える場合は false ;
+    /// Reads the (x, y, w, h) area of src and compresses it. Fails when it has more than 256 colors.
+    bool createFromImage(LovyanGFX* src, int32_t x, int32_t y, int32_t w, int32_t h);
+    bool createFromImage(LovyanGFX* src) { return src && createFromImage(src, 0, 0, src->width(), src->height()); }
+
+    /// 圧縮済みのデータ (getBuffer で得たもの) を複製せずに使う。フラッシュ上の配列も指定できる;
+    /// Uses already compressed data, such as a const array in flash written out from getBuffer(),
+    /// without copying it. The data must outlive this object.
+    bool setBuffer(const void* data, size_t length);
+    void release(void);
+
+    const uint8_t* getBuffer(void) const { return _data; }
+    size_t bufferLength(void) const { return _length; }
+    int32_t width(void) const { return _width; }
+    int32_t height(void) const { return _height; }
+    size_t getPaletteCount(void) const { return _palette_count; }
+
+    void setPivot(float x, float y) { _xpivot = x; _ypivot = y; }
+    float getPivotX(void) const { return _xpivot; }
+    float getPivotY(void) const { return _ypivot; }
+
+    /// 透過色は LGFX の他の関数と同様に色の型で指定する。画像に無い色であれば透過しない;
+    /// The transparent color is given as any LGFX color type; a color absent from the image
+    /// simply makes nothing transparent.
+    void pushSprite(LovyanGFX* dst, int32_t x, int32_t y) { push_sprite(dst, x, y, pixelcopy_t::NON_TRANSP); }
+    template<typename T>
+    void pushSprite(LovyanGFX* dst, int32_t x, int32_t y, const T& transp) { push_sprite(dst, x, y, find_color(convert_to_rgb888(transp))); }
+
+    void pushRotateZoom(LovyanGFX* dst, float dst_x, float dst_y, float angle, float zoom_x, float zoom_y) { push_rotate_zoom(dst, dst_x, dst_y, angle, zoom_x, zoom_y, pixelcopy_t::NON_TRANSP); }
+    template<typename T>
+    void pushRotateZoom(LovyanGFX* dst, float dst_x, float dst_y, float angle, float zoom_x, float zoom_y, const T& transp) { push_rotate_zoom(dst, dst_x, dst_y, angle, zoom_x, zoom_y, find_color(convert_to_rgb888(transp))); }
+
+    void pushAffine(LovyanGFX* dst, const float matrix[6]) { push_affine(dst, matrix, pixelcopy_t::NON_TRANSP); }
+    template<typename T>
+    void pushAffine(LovyanGFX* dst, const float matrix[6], const T& transp) { push_affine(dst, matrix, find_color(convert_to_rgb888(transp))); }
+
+  protected:
+    const uint8_t* _data = nullptr;
+    uint8_t* _owned = nullptr;
+    size_t _length = 0;
+    const bgr888_t* _palette = nullptr;
+    const uint8_t* _row_index = nullptr;
+    const uint8_t* _runs = nullptr;
+    float _xpivot = 0;
+    float _ypivot = 0;
+    uint16_t _width = 0;
+    uint16_t _height = 0;
+    uint16_t _palette_count = 0;
+
+    /// パレット番号。無い色なら NON_TRANSP ;
+    uint32_t find_color(uint32_t rgb888) const;
+    bool init_pc(pixelcopy_t* pc, packed_cursor_t* cursor, LovyanGFX* dst, uint32_t transp) const;
+
+    void push_sprite(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp);
+    void push_rotate_zoom(LovyanGFX* dst, float x, float y, float angle, float zoom_x, float zoom_y, uint32_t transp);
+    void push_affine(LovyanGFX* dst, const float matrix[6], uint32_t transp);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
+
+using LGFX_PackedSprite = lgfx::LGFX_PackedSprite;
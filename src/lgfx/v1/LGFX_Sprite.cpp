@@ -50,6 +50,7 @@ namespace lgfx
 
   void Panel_Sprite::deleteSprite(void)
   {
+    setModified();
     _bitwidth = _panel_width = _panel_height = _width = _height = 0;
     setRotation(_rotation);
     _img.release();
@@ -57,6 +58,7 @@ namespace lgfx
 
   void* Panel_Sprite::createSprite(int32_t w, int32_t h, color_conv_t* conv, bool psram)
   {
+    setModified();
     if (w < 1 || h < 1)
     {
       deleteSprite();
@@ -87,6 +89,7 @@ namespace lgfx
 
   color_depth_t Panel_Sprite::setColorDepth(color_depth_t depth)
   {
+    setModified();
     _write_depth = depth;
     _read_depth = depth;
     return depth;
@@ -126,6 +129,7 @@ namespace lgfx
 
   void Panel_Sprite::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
   {
+    setModified();
     uint_fast8_t r = _rotation;
     if (r)
     {
@@ -161,6 +165,7 @@ namespace lgfx
 
   void Panel_Sprite::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
   {
+    setModified();
     uint_fast8_t r = _rotation;
     if (r)
     {
@@ -324,6 +329,7 @@ namespace lgfx
 
   void Panel_Sprite::writePixels(pixelcopy_t* param, uint32_t length, bool use_dma)
   {
+    setModified();
     (void)use_dma;
     uint_fast16_t xs = _xs;
     uint_fast16_t xe = _xe;
@@ -428,6 +434,7 @@ namespace lgfx
 
   void Panel_Sprite::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool)
   {
+    setModified();
     uint_fast8_t r = _rotation;
     if (r == 0 && param->transp == pixelcopy_t::NON_TRANSP && param->no_convert && _img.use_memcpy())
     {
@@ -486,8 +493,24 @@ namespace lgfx
     } while (--h);
   }
 
+  void Panel_Sprite::write_image_memcpy(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, const void* src, uint32_t src_stride, uint32_t bytes)
+  {
+    auto bw = _bitwidth * bytes;
+    auto sw = src_stride * bytes;
+    auto dst = &_img[bw * y + x * bytes];
+    auto s = static_cast<const uint8_t*>(src);
+    w *= bytes;
+    do
+    {
+      memcpy_P(dst, s, w);
+      dst += bw;
+      s   += sw;
+    } while (--h);
+  }
+
   void Panel_Sprite::writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param)
   {
+    setModified();
     uint32_t nextx = 0;
     uint32_t nexty = 1 << pixelcopy_t::FP_SCALE;
     if (_rotation)
@@ -607,6 +630,7 @@ namespace lgfx
 
   void Panel_Sprite::copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y)
   {
+    setModified();
     uint_fast8_t r = _rotation;
     if (r)
     {
@@ -682,6 +706,58 @@ namespace lgfx
 
 //----------------------------------------------------------------------------
 
+  bool LGFX_Sprite::push_sprite_masked(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp)
+  {
+    uint32_t bytes = _write_conv.bits >> 3;
+    if (_img == nullptr || (_write_conv.bits & 7) || bytes < 1 || bytes > 3) { return false; }
+
+    uint32_t w = _panel_sprite._panel_width;
+    uint32_t h = _panel_sprite._panel_height;
+    uint32_t stride = _panel_sprite._bitwidth;
+    uint32_t stamp = _panel_sprite.getModifyCount();
+    if (!_span_mask.isBuilt() || _span_mask.getStamp() != stamp || _span_mask.getTransparent() != transp
+     || _span_mask.getWidth() != w || _span_mask.getHeight() != h)
+    {
+      if (!_span_mask.build(_img, stride, w, h, bytes, transp)) { return false; }
+      _span_mask.setStamp(stamp);
+    }
+
+    /// 転送先のクリップ範囲に掛かる行だけを処理する;
+    int32_t cx, cy, cw, ch;
+    dst->getClipRect(&cx, &cy, &cw, &ch);
+    int32_t ys = std::max<int32_t>(0, cy - y);
+    int32_t ye = std::min<int32_t>(h, cy + ch - y);
+    if (ys >= ye || x >= cx + cw || x + (int32_t)w <= cx) { return true; }
+
+    pixelcopy_t p(_img, dst->getColorDepth(), getColorDepth(), dst->hasPalette(), _palette);
+    bool use_dma = _panel_sprite.getSpriteBuffer()->use_dma();
+    auto img = static_cast<const uint8_t*>(_img);
+    dst->startWrite();
+    for (int32_t sy = ys; sy < ye; ++sy)
+    {
+      if (_span_mask.isOpaqueRow(sy))
+      { /// 全て不透明な行が続く場合はまとめて送る;
+        int32_t ey = sy + 1;
+        while (ey < ye && _span_mask.isOpaqueRow(ey)) { ++ey; }
+        pixelcopy_t pc = p;
+        pc.src_data = &img[sy * stride * bytes];
+        dst->pushImage(x, y + sy, w, ey - sy, &pc, use_dma);
+        sy = ey - 1;
+        continue;
+      }
+      size_t count = _span_mask.getSpanCount(sy);
+      auto spans = _span_mask.getSpans(sy);
+      for (size_t i = 0; i < count; ++i)
+      {
+        pixelcopy_t pc = p;
+        pc.src_data = &img[(sy * stride + spans[i].x) * bytes];
+        dst->pushImage(x + spans[i].x, y + sy, spans[i].length, 1, &pc, use_dma);
+      }
+    }
+    dst->endWrite();
+    return true;
+  }
+
   bool LGFX_Sprite::create_from_bmp_file(DataWrapper* data, const char *path) {
     data->need_transaction = false;
     bool res = false;
@@ -21,6 +21,7 @@ Contributors:
 
 #include "LGFXBase.hpp"
 #include "misc/SpriteBuffer.hpp"
+#include "misc/SpanMask.hpp"
 #include "misc/bitmap.hpp"
 #include "Panel.hpp"
 
@@ -72,6 +73,11 @@ namespace lgfx
     LGFX_INLINE const SpriteBuffer* getSpriteBuffer(void) const { return &_img; }
     LGFX_INLINE uint32_t bufferLength(void) const { return (_bitwidth * _write_bits >> 3) * _panel_height; }
 
+    /// バッファへ書込む度に増える値。書込みで無効になるキャッシュ (SpanMask) の判定に使う;
+    /// Incremented on every write to the buffer, so caches built from it (SpanMask) can tell they are stale.
+    LGFX_INLINE uint32_t getModifyCount(void) const { return _modify_count; }
+    LGFX_INLINE void setModified(void) { ++_modify_count; }
+
 
     color_depth_t setColorDepth(color_depth_t depth) override;
     void setRotation(uint_fast8_t r) override;
@@ -89,7 +95,55 @@ namespace lgfx
 
     uint32_t readPixelValue(uint_fast16_t x, uint_fast16_t y);
 
+    /// 回転なし・RGB形式のスプライトへ、色変換をコンパイル時に確定させたループで書き込む。
+    /// 対象外の場合は何もせず false を返すので、呼出し側で writeImage (pixelcopy_t経由) を使うこと;
+    /// Writes an image with the conversion loop fixed at compile time (no rotation, RGB depths only).
+    /// Returns false without writing anything otherwise; the caller then falls back to writeImage.
+    template <typename TSrc>
+    bool writeImageDirect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, const TSrc* src, uint32_t src_stride)
+    {
+      if (_rotation) { return false; }
+      setModified();
+      switch (_write_depth)
+      {
+      case rgb565_2Byte:   write_image_direct<swap565_t  >(x, y, w, h, src, src_stride); return true;
+      case rgb332_1Byte:   write_image_direct<rgb332_t   >(x, y, w, h, src, src_stride); return true;
+      case rgb888_3Byte:   write_image_direct<bgr888_t   >(x, y, w, h, src, src_stride); return true;
+      case rgb666_3Byte:   write_image_direct<bgr666_t   >(x, y, w, h, src, src_stride); return true;
+      case grayscale_8bit: write_image_direct<grayscale_t>(x, y, w, h, src, src_stride); return true;
+      default: return false;
+      }
+    }
+
   protected:
+    void write_image_memcpy(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, const void* src, uint32_t src_stride, uint32_t bytes);
+
+    template <typename TDst, typename TSrc>
+    void write_image_direct(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, const TSrc* src, uint32_t src_stride)
+    {
+      LGFX_PANEL_STATS_SCOPE(this, writeImage, w * h);
+      if (std::is_same<TDst, TSrc>::value && _img.use_memcpy())
+      {
+        write_image_memcpy(x, y, w, h, src, src_stride, sizeof(TDst));
+        return;
+      }
+      auto dst = &reinterpret_cast<TDst*>(_img.get())[x + y * _bitwidth];
+      auto fn = (w >= 16) ? convert_row_t<TDst, TSrc>::get() : nullptr;
+      do
+      {
+        if (fn) { fn(dst, src, w); }
+        else
+        {
+          for (uint32_t i = 0; i < w; ++i)
+          {
+            dst[i].set(color_convert<TDst, TSrc>(src[i].get()));
+          }
+        }
+        dst += _bitwidth;
+        src += src_stride;
+      } while (--h);
+    }
+
     void _rotate_pixelcopy(uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& w, uint_fast16_t& h, pixelcopy_t* param, uint32_t& nextx, uint32_t& nexty);
 
     SpriteBuffer _img;
@@ -99,6 +153,7 @@ namespace lgfx
     uint_fast16_t _panel_width;   // rotationしていない状態の幅;
     uint_fast16_t _panel_height;  // rotationしていない状態の高さ;
     uint_fast16_t _bitwidth;
+    uint32_t _modify_count = 0;
   };
 
   class LGFX_Sprite : public LovyanGFX
@@ -142,9 +197,25 @@ namespace lgfx
       _clip_b = -1;
 
       _panel_sprite.deleteSprite();
+      _span_mask.release();
       _img = nullptr;
     }
 
+    /// 透過色付きの pushSprite で、行ごとの不透明な区間 (SpanMask) を作成して再利用する。
+    /// スプライトへ描画すると次の転送時に作り直される。1 ~ 3 バイト/画素のスプライトが対象;
+    /// Keyed pushSprite calls keep a per row list of opaque spans (SpanMask) and reuse it while
+    /// the sprite is unchanged, so repeated pushes copy spans instead of testing every pixel.
+    /// Drawing into the sprite rebuilds it on the next push. Applies to 8, 16 and 24 bit sprites.
+    void setSpanMaskCache(bool enabled)
+    {
+      _use_span_mask = enabled;
+      if (!enabled) { _span_mask.release(); }
+    }
+
+    /// getBuffer() のバッファへ直接書込んだ場合に呼び、記録した区間を作り直させる;
+    /// Call after writing to getBuffer() directly so the cached spans are rebuilt.
+    void invalidateSpanMask(void) { _panel_sprite.setModified(); }
+
     void setPsram( bool enabled )
     {
       if (_psram == enabled) return;
@@ -324,12 +395,27 @@ namespace lgfx
     template<typename T>
     LGFX_INLINE void fillSprite (const T& color) { fillScreen(color); }
 
+    using LovyanGFX::pushImage;
+
+    /// RGB形式の画像は行ごとの関数ポインタ呼出しを経由せず、型に応じて展開したループで書き込む。
+    /// パレット付き・回転中のスプライトや未対応の型は従来通り pixelcopy_t を経由する;
+    /// RGB images are written by a loop instantiated for the source type instead of calling
+    /// pixelcopy_t::fp_copy per row. Palette / rotated sprites and other types use pixelcopy_t as before.
+    template<typename T>
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const T* data)
+    {
+      if (!push_image_direct(x, y, w, h, data)) { LovyanGFX::pushImage(x, y, w, h, data); }
+    }
+
     template<typename T>
     LGFX_INLINE void pushSprite(                int32_t x, int32_t y, const T& transp) { push_sprite(_parent, x, y, _write_conv.convert(transp) & _write_conv.colormask); }
     template<typename T>
     LGFX_INLINE void pushSprite(LovyanGFX* dst, int32_t x, int32_t y, const T& transp) { push_sprite(    dst, x, y, _write_conv.convert(transp) & _write_conv.colormask); }
     LGFX_INLINE void pushSprite(                int32_t x, int32_t y) { push_sprite(_parent, x, y); }
     LGFX_INLINE void pushSprite(LovyanGFX* dst, int32_t x, int32_t y) { push_sprite(    dst, x, y); }
+    /// スプライト同士の転送は pushImage と同じく型を確定させたループを使う;
+    /// Sprite to sprite copies use the same statically instantiated loop as pushImage.
+    LGFX_INLINE void pushSprite(LGFX_Sprite* dst, int32_t x, int32_t y) { if (!push_sprite_direct(dst, x, y)) { push_sprite(dst, x, y); } }
 
     template<typename T> void pushRotated(                float angle, const T& transp) { push_rotate_zoom(_parent, _parent->getPivotX(), _parent->getPivotY(), angle, 1.0f, 1.0f, _write_conv.convert(transp) & _write_conv.colormask); }
     template<typename T> void pushRotated(LovyanGFX* dst, float angle, const T& transp) { push_rotate_zoom(dst    , dst    ->getPivotX(), dst    ->getPivotY(), angle, 1.0f, 1.0f, _write_conv.convert(transp) & _write_conv.colormask); }
@@ -389,6 +475,10 @@ namespace lgfx
 
     bool _psram = false;
 
+    bool _use_span_mask = false;
+
+    SpanMask _span_mask;
+
     bool create_palette(void)
     {
       if (_write_conv.bits > 8) return false;
@@ -414,10 +504,60 @@ namespace lgfx
 
     void push_sprite(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp = pixelcopy_t::NON_TRANSP)
     {
+      if (transp != pixelcopy_t::NON_TRANSP && _use_span_mask && push_sprite_masked(dst, x, y, transp)) { return; }
       pixelcopy_t p(_img, dst->getColorDepth(), getColorDepth(), dst->hasPalette(), _palette, transp);
       dst->pushImage(x, y, _panel_sprite._panel_width, _panel_sprite._panel_height, &p, _panel_sprite.getSpriteBuffer()->use_dma()); // DMA disable with use SPIRAM
     }
 
+    /// SpanMask の不透明な区間だけを転送する。対象外の形式であれば false ;
+    bool push_sprite_masked(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp);
+
+    bool push_sprite_direct(LGFX_Sprite* dst, int32_t x, int32_t y)
+    {
+      if (dst == this) { return false; }
+      auto w = _panel_sprite._panel_width;
+      auto h = _panel_sprite._panel_height;
+      switch (getColorDepth())
+      {
+      case rgb565_2Byte:   return dst->push_image_direct(x, y, w, h, static_cast<const swap565_t*  >(_img));
+      case rgb332_1Byte:   return dst->push_image_direct(x, y, w, h, static_cast<const rgb332_t*   >(_img));
+      case rgb888_3Byte:   return dst->push_image_direct(x, y, w, h, static_cast<const bgr888_t*   >(_img));
+      case grayscale_8bit: return dst->push_image_direct(x, y, w, h, static_cast<const grayscale_t*>(_img));
+      default: return false;
+      }
+    }
+
+    /// 未対応の型は false を返し、pixelcopy_t を使う経路に任せる;
+    template<typename T>
+    bool push_image_direct(int32_t, int32_t, int32_t, int32_t, const T*) { return false; }
+
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t*  data) { return push_image_rgb(x, y, w, h, reinterpret_cast<const rgb332_t*>(data)); }
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) { return _swapBytes ? push_image_rgb(x, y, w, h, reinterpret_cast<const rgb565_t*>(data)) : push_image_rgb(x, y, w, h, reinterpret_cast<const swap565_t*>(data)); }
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const void*     data) { return _swapBytes ? push_image_rgb(x, y, w, h, reinterpret_cast<const rgb888_t*>(data)) : push_image_rgb(x, y, w, h, reinterpret_cast<const bgr888_t* >(data)); }
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const rgb332_t*    data) { return push_image_rgb(x, y, w, h, data); }
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const rgb565_t*    data) { return push_image_rgb(x, y, w, h, data); }
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const swap565_t*   data) { return push_image_rgb(x, y, w, h, data); }
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const rgb888_t*    data) { return push_image_rgb(x, y, w, h, data); }
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const bgr888_t*    data) { return push_image_rgb(x, y, w, h, data); }
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const argb8888_t*  data) { return push_image_rgb(x, y, w, h, data); }
+    bool push_image_direct(int32_t x, int32_t y, int32_t w, int32_t h, const grayscale_t* data) { return push_image_rgb(x, y, w, h, data); }
+
+    template<typename TSrc>
+    bool push_image_rgb(int32_t x, int32_t y, int32_t w, int32_t h, const TSrc* data)
+    {
+      if (hasPalette()) { return false; }
+
+      int32_t dx=0, dw=w;
+      if (0 < _clip_l - x) { dx = _clip_l - x; dw -= dx; x = _clip_l; }
+      if (_adjust_width(x, dx, dw, _clip_l, _clip_r - _clip_l + 1)) { return true; }
+
+      int32_t dy=0, dh=h;
+      if (0 < _clip_t - y) { dy = _clip_t - y; dh -= dy; y = _clip_t; }
+      if (_adjust_width(y, dy, dh, _clip_t, _clip_b - _clip_t + 1)) { return true; }
+
+      return _panel_sprite.writeImageDirect(x, y, dw, dh, &data[dx + dy * w], w);
+    }
+
     void push_rotate_zoom(LovyanGFX* dst, float x, float y, float angle, float zoom_x, float zoom_y, uint32_t transp = pixelcopy_t::NON_TRANSP)
     {
       dst->pushImageRotateZoom(x, y, _xpivot, _ypivot, angle, zoom_x, zoom_y, _panel_sprite._panel_width, _panel_sprite._panel_height, _img, transp, getColorDepth(), _palette.img24());
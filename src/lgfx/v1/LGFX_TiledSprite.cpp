@@ -0,0 +1,629 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "LGFX_TiledSprite.hpp"
+
+#include "misc/common_function.hpp"
+#include "platforms/common.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  static inline uint32_t read_raw(const uint8_t* p, uint_fast8_t bytes)
+  {
+    uint32_t v = 0;
+    memcpy(&v, p, bytes);
+    return v;
+  }
+
+  /// 同じ画素の連続を [個数-1 (1バイト)][画素] で表す。dst が nullptr の場合は大きさだけを返す;
+  static size_t rle_encode(const uint8_t* src, size_t pixels, uint_fast8_t bytes, uint8_t* dst)
+  {
+    size_t len = 0;
+    size_t i = 0;
+    while (i < pixels)
+    {
+      uint32_t v = read_raw(&src[i * bytes], bytes);
+      size_t run = 1;
+      while (run < 256 && i + run < pixels && read_raw(&src[(i + run) * bytes], bytes) == v) { ++run; }
+      if (dst)
+      {
+        dst[len] = run - 1;
+        memcpy(&dst[len + 1], &src[i * bytes], bytes);
+      }
+      len += 1 + bytes;
+      i += run;
+    }
+    return len;
+  }
+
+  static void rle_decode(const uint8_t* src, size_t pixels, uint_fast8_t bytes, uint8_t* dst)
+  {
+    while (pixels)
+    {
+      size_t run = std::min<size_t>(src[0] + 1, pixels);
+      memset_multi(dst, read_raw(&src[1], bytes), bytes, run);
+      dst += run * bytes;
+      src += 1 + bytes;
+      pixels -= run;
+    }
+  }
+
+  static bool is_solid(const uint8_t* src, size_t pixels, uint_fast8_t bytes, uint32_t rawcolor)
+  {
+    for (size_t i = 0; i < pixels; ++i)
+    {
+      if (read_raw(&src[i * bytes], bytes) != rawcolor) { return false; }
+    }
+    return true;
+  }
+
+//----------------------------------------------------------------------------
+
+  bool Panel_TiledSprite::createSprite(uint_fast16_t w, uint_fast16_t h, uint_fast16_t tile_w, uint_fast16_t tile_h)
+  {
+    deleteSprite();
+    if (w == 0 || h == 0 || tile_w == 0 || tile_h == 0) { return false; }
+
+    _tile_w = std::min(tile_w, w);
+    _tile_h = std::min(tile_h, h);
+    _cols = (w + _tile_w - 1) / _tile_w;
+    _rows = (h + _tile_h - 1) / _tile_h;
+
+    size_t table_len = _cols * _rows * sizeof(tile_t);
+    _tiles = static_cast<tile_t*>(heap_alloc(table_len));
+    _work = static_cast<uint8_t*>(heap_alloc(_tile_bytes()));
+    _base_line = static_cast<uint8_t*>(heap_alloc((_tile_w + 1) * (_write_bits >> 3)));
+    if (_tiles == nullptr || _work == nullptr || _base_line == nullptr)
+    {
+      deleteSprite();
+      return false;
+    }
+    memset(_tiles, 0, table_len);
+    _width = w;
+    _height = h;
+    setRotation(_rotation);
+    setBaseColor(_base_raw);
+    return true;
+  }
+
+  void Panel_TiledSprite::deleteSprite(void)
+  {
+    if (_tiles)
+    {
+      for (uint32_t i = _cols * _rows; i--;) { _free_tile(i); }
+      heap_free(_tiles);
+      _tiles = nullptr;
+    }
+    if (_work) { heap_free(_work); _work = nullptr; }
+    if (_base_line) { heap_free(_base_line); _base_line = nullptr; }
+    _work_index = UINT32_MAX;
+    _used_bytes = 0;
+    _tile_w = _tile_h = _cols = _rows = 0;
+    _width = _height = 0;
+    setRotation(_rotation);
+  }
+
+  void Panel_TiledSprite::setBaseColor(uint32_t rawcolor)
+  {
+    uint_fast8_t bytes = _write_bits >> 3;
+    _base_raw = rawcolor & (UINT32_MAX >> (32 - (bytes << 3)));
+    if (_base_line) { memset_multi(_base_line, _base_raw, bytes, _tile_w); }
+  }
+
+  color_depth_t Panel_TiledSprite::setColorDepth(color_depth_t depth)
+  {
+    /// タイルの画素はバイト単位で扱うため、パレット形式と 1 bit ~ 4 bit, 32 bit は使えない;
+    if ((depth & color_depth_t::has_palette) || (depth & 7) || (depth & color_depth_t::bit_mask) > 24)
+    {
+      depth = rgb565_2Byte;
+    }
+    _write_depth = depth;
+    _read_depth = depth;
+    return depth;
+  }
+
+  void Panel_TiledSprite::setRotation(uint_fast8_t)
+  {
+    _rotation = 0;
+    _xs = 0;
+    _ys = 0;
+    _xe = _width - 1;
+    _ye = _height - 1;
+  }
+
+  size_t Panel_TiledSprite::getAllocatedTileCount(void) const
+  {
+    size_t count = 0;
+    for (uint32_t i = _cols * _rows; i--;) { count += (_tiles[i].data != nullptr); }
+    return count;
+  }
+
+  size_t Panel_TiledSprite::getCompressedTileCount(void) const
+  {
+    size_t count = 0;
+    for (uint32_t i = _cols * _rows; i--;) { count += (_tiles[i].packed != 0); }
+    return count;
+  }
+
+  void Panel_TiledSprite::_free_tile(uint32_t index)
+  {
+    auto& t = _tiles[index];
+    if (t.data)
+    {
+      _used_bytes -= t.packed ? t.packed : _tile_bytes();
+      heap_free(t.data);
+    }
+    t.data = nullptr;
+    t.packed = 0;
+    if (_work_index == index) { _work_index = UINT32_MAX; }
+  }
+
+  uint8_t* Panel_TiledSprite::_tile_for_write(uint32_t index)
+  {
+    auto& t = _tiles[index];
+    t.touched = true;
+    if (t.data && !t.packed) { return t.data; }
+
+    size_t len = _tile_bytes();
+    auto buf = static_cast<uint8_t*>(_psram ? heap_alloc_psram(len) : nullptr);
+    if (buf == nullptr) { buf = static_cast<uint8_t*>(heap_alloc(len)); }
+    if (buf == nullptr) { return nullptr; }
+
+    uint_fast8_t bytes = _write_bits >> 3;
+    if (t.data == nullptr)
+    {
+      memset_multi(buf, _base_raw, bytes, _tile_pixels());
+    }
+    else
+    {
+      rle_decode(t.data, _tile_pixels(), bytes, buf);
+      _free_tile(index);
+    }
+    t.data = buf;
+    _used_bytes += len;
+    return buf;
+  }
+
+  const uint8_t* Panel_TiledSprite::_tile_for_read(uint32_t index)
+  {
+    auto& t = _tiles[index];
+    if (t.packed == 0) { return t.data; }
+    if (_work_index != index)
+    {
+      rle_decode(t.data, _tile_pixels(), _write_bits >> 3, _work);
+      _work_index = index;
+    }
+    return _work;
+  }
+
+  const uint8_t* Panel_TiledSprite::_read_line(uint32_t index, uint_fast16_t ly)
+  {
+    auto img = _tile_for_read(index);
+    return img ? &img[ly * _tile_w * (_write_bits >> 3)] : _base_line;
+  }
+
+  const uint8_t* Panel_TiledSprite::getTileImage(uint_fast16_t tile_x, uint_fast16_t tile_y)
+  {
+    if (tile_x >= _cols || tile_y >= _rows) { return nullptr; }
+    return _tile_for_read(tile_x + tile_y * _cols);
+  }
+
+  void Panel_TiledSprite::_set_solid(uint32_t index, uint32_t rawcolor)
+  {
+    /// 単色のタイルは圧縮した状態で持つ;
+    uint_fast8_t bytes = _write_bits >> 3;
+    size_t pixels = _tile_pixels();
+    size_t len = ((pixels + 255) >> 8) * (1 + bytes);
+    auto buf = static_cast<uint8_t*>(heap_alloc(len));
+    if (buf == nullptr)
+    {
+      auto img = _tile_for_write(index);
+      if (img) { memset_multi(img, rawcolor, bytes, pixels); }
+      return;
+    }
+    _free_tile(index);
+    for (size_t i = 0; pixels; i += 1 + bytes)
+    {
+      size_t run = std::min<size_t>(pixels, 256);
+      buf[i] = run - 1;
+      memcpy(&buf[i + 1], &rawcolor, bytes);
+      pixels -= run;
+    }
+    auto& t = _tiles[index];
+    t.data = buf;
+    t.packed = len;
+    _used_bytes += len;
+  }
+
+  size_t Panel_TiledSprite::compressIdleTiles(void)
+  {
+    size_t count = 0;
+    uint_fast8_t bytes = _write_bits >> 3;
+    size_t pixels = _tile_pixels();
+    size_t raw_len = _tile_bytes();
+    for (uint32_t i = 0, n = _cols * _rows; i < n; ++i)
+    {
+      auto& t = _tiles[i];
+      if (t.data == nullptr || t.packed) { continue; }
+      if (t.touched)
+      {
+        t.touched = false;
+        continue;
+      }
+      if (is_solid(t.data, pixels, bytes, _base_raw))
+      {
+        _free_tile(i);
+        ++count;
+        continue;
+      }
+      /// 十分に縮まない場合は非圧縮のままにする;
+      size_t len = rle_encode(t.data, pixels, bytes, nullptr);
+      if (len * 4 > raw_len * 3) { continue; }
+      auto buf = static_cast<uint8_t*>(heap_alloc(len));
+      if (buf == nullptr) { continue; }
+      rle_encode(t.data, pixels, bytes, buf);
+      _free_tile(i);
+      t.data = buf;
+      t.packed = len;
+      _used_bytes += len;
+      ++count;
+    }
+    return count;
+  }
+
+  void Panel_TiledSprite::setWindow(uint_fast16_t xs, uint_fast16_t ys, uint_fast16_t xe, uint_fast16_t ye)
+  {
+    xs = std::max<uint_fast16_t>(0u, std::min<uint_fast16_t>(_width  - 1, xs));
+    xe = std::max<uint_fast16_t>(0u, std::min<uint_fast16_t>(_width  - 1, xe));
+    ys = std::max<uint_fast16_t>(0u, std::min<uint_fast16_t>(_height - 1, ys));
+    ye = std::max<uint_fast16_t>(0u, std::min<uint_fast16_t>(_height - 1, ye));
+    _xpos = xs;
+    _xs = xs;
+    _xe = xe;
+    _ypos = ys;
+    _ys = ys;
+    _ye = ye;
+  }
+
+  void Panel_TiledSprite::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
+  {
+    uint_fast8_t bytes = _write_bits >> 3;
+    uint_fast16_t tx = x / _tile_w;
+    uint_fast16_t ty = y / _tile_h;
+    uint32_t index = tx + ty * _cols;
+    if (_tiles[index].data == nullptr && (rawcolor & (UINT32_MAX >> (32 - (bytes << 3)))) == _base_raw) { return; }
+    auto img = _tile_for_write(index);
+    if (img == nullptr) { return; }
+    memcpy(&img[((x - tx * _tile_w) + (y - ty * _tile_h) * _tile_w) * bytes], &rawcolor, bytes);
+  }
+
+  void Panel_TiledSprite::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
+  {
+    uint_fast8_t bytes = _write_bits >> 3;
+    rawcolor &= UINT32_MAX >> (32 - (bytes << 3));
+    size_t stride = _tile_w * bytes;
+    uint_fast16_t ty = y / _tile_h;
+    uint_fast16_t ly = y - ty * _tile_h;
+    do
+    {
+      uint_fast16_t lh = std::min<uint_fast16_t>(h, _tile_h - ly);
+      uint_fast16_t th = std::min<uint_fast16_t>(_tile_h, _height - ty * _tile_h);
+      uint_fast16_t tx = x / _tile_w;
+      uint_fast16_t lx = x - tx * _tile_w;
+      uint_fast16_t remain = w;
+      do
+      {
+        uint_fast16_t lw = std::min<uint_fast16_t>(remain, _tile_w - lx);
+        uint_fast16_t tw = std::min<uint_fast16_t>(_tile_w, _width - tx * _tile_w);
+        uint32_t index = tx + ty * _cols;
+        if (lx == 0 && ly == 0 && lw >= tw && lh >= th)
+        { /// タイル全体を塗る場合は確保せずに済ませる;
+          if (rawcolor == _base_raw) { _free_tile(index); }
+          else { _set_solid(index, rawcolor); }
+        }
+        else if (_tiles[index].data != nullptr || rawcolor != _base_raw)
+        {
+          auto img = _tile_for_write(index);
+          if (img)
+          {
+            img += ly * stride + lx * bytes;
+            for (uint_fast16_t i = 0; i < lh; ++i)
+            {
+              memset_multi(img, rawcolor, bytes, lw);
+              img += stride;
+            }
+          }
+        }
+        lx = 0;
+        ++tx;
+        remain -= lw;
+      } while (remain);
+      ly = 0;
+      ++ty;
+      h -= lh;
+    } while (h);
+  }
+
+  void Panel_TiledSprite::writeBlock(uint32_t rawcolor, uint32_t length)
+  {
+    do
+    {
+      uint32_t h = 1;
+      auto w = std::min<uint32_t>(length, _xe + 1 - _xpos);
+      if (length >= (w << 1) && _xpos == _xs)
+      {
+        h = std::min<uint32_t>(length / w, _ye + 1 - _ypos);
+      }
+      writeFillRectPreclipped(_xpos, _ypos, w, h, rawcolor);
+      if ((_xpos += w) <= _xe) return;
+      _xpos = _xs;
+      if (_ye < (_ypos += h)) { _ypos = _ys; }
+      length -= w * h;
+    } while (length);
+  }
+
+  void Panel_TiledSprite::_write_line(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, pixelcopy_t* param)
+  {
+    size_t stride = _tile_w * (_write_bits >> 3);
+    uint_fast16_t ty = y / _tile_h;
+    uint_fast16_t tx = x / _tile_w;
+    uint32_t lx = x - tx * _tile_w;
+    uint32_t index = tx + ty * _cols;
+    size_t offset = (y - ty * _tile_h) * stride;
+    bool transp = param->transp != pixelcopy_t::NON_TRANSP;
+    do
+    {
+      uint32_t end = std::min<uint32_t>(_tile_w, lx + w);
+      w -= end - lx;
+      uint32_t pos = lx;
+      /// 透過色のみの区間ではタイルを確保しない;
+      if (transp) { pos = param->fp_skip(pos, end, param); }
+      if (pos != end)
+      {
+        auto img = _tile_for_write(index);
+        if (img == nullptr) { return; }
+        img += offset;
+        if (transp)
+        {
+          while (end != (pos = param->fp_copy(img, pos, end, param))
+             &&  end != (pos = param->fp_skip(     pos, end, param)));
+        }
+        else
+        {
+          param->fp_copy(img, pos, end, param);
+        }
+      }
+      lx = 0;
+      ++index;
+    } while (w);
+  }
+
+  void Panel_TiledSprite::writePixels(pixelcopy_t* param, uint32_t length, bool)
+  {
+    uint_fast16_t x = _xpos;
+    uint_fast16_t y = _ypos;
+    uint32_t linelength;
+    do
+    {
+      linelength = std::min<uint32_t>(_xe - x + 1, length);
+      _write_line(x, y, linelength, param);
+      if ((x += linelength) > _xe)
+      {
+        x = _xs;
+        y = (y != _ye) ? (y + 1) : _ys;
+      }
+    } while (length -= linelength);
+    _xpos = x;
+    _ypos = y;
+  }
+
+  void Panel_TiledSprite::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool)
+  {
+    uint32_t sx32 = param->src_x32;
+    uint32_t sy32 = param->src_y32;
+    h += y;
+    do
+    {
+      _write_line(x, y, w, param);
+      param->src_x32 = sx32;
+      param->src_y32 = (sy32 += 1 << pixelcopy_t::FP_SCALE);
+    } while (++y != h);
+  }
+
+  void Panel_TiledSprite::writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param)
+  {
+    writeImage(x, y, w, h, param, false);
+  }
+
+  void Panel_TiledSprite::readRect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, void* dst, pixelcopy_t* param)
+  {
+    uint_fast8_t bytes = _write_bits >> 3;
+    auto d = static_cast<uint8_t*>(dst);
+    uint32_t pos = 0;
+    h += y;
+    do
+    {
+      uint_fast16_t ty = y / _tile_h;
+      uint_fast16_t ly = y - ty * _tile_h;
+      uint_fast16_t tx = x / _tile_w;
+      uint_fast16_t lx = x - tx * _tile_w;
+      uint32_t index = tx + ty * _cols;
+      uint_fast16_t remain = w;
+      do
+      {
+        uint_fast16_t lw = std::min<uint_fast16_t>(remain, _tile_w - lx);
+        auto line = _read_line(index, ly);
+        if (param->no_convert)
+        {
+          memcpy(&d[pos * bytes], &line[lx * bytes], lw * bytes);
+        }
+        else
+        {
+          param->src_data = line;
+          param->src_x32 = lx << pixelcopy_t::FP_SCALE;
+          param->src_y32 = 0;
+          param->fp_copy(dst, pos, pos + lw, param);
+        }
+        pos += lw;
+        remain -= lw;
+        lx = 0;
+        ++index;
+      } while (remain);
+    } while (++y != h);
+  }
+
+  void Panel_TiledSprite::copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y)
+  {
+    ScratchBuffer line((w + 1) * (_write_bits >> 3));
+    if (!line) { return; }
+    pixelcopy_t pc_read(nullptr, _write_depth, _read_depth);
+    pixelcopy_t pc_write(line.get(), _write_depth, _write_depth);
+    /// 重なる範囲を壊さないよう、下へ移す場合は下の行から処理する;
+    int_fast16_t add = 1;
+    if (dst_y > src_y)
+    {
+      src_y += h - 1;
+      dst_y += h - 1;
+      add = -1;
+    }
+    do
+    {
+      readRect(src_x, src_y, w, 1, line.get(), &pc_read);
+      pc_write.src_x32 = 0;
+      pc_write.src_y32 = 0;
+      pc_write.src_bitwidth = w;
+      writeImage(dst_x, dst_y, w, 1, &pc_write, false);
+      src_y += add;
+      dst_y += add;
+    } while (--h);
+  }
+
+//----------------------------------------------------------------------------
+
+  bool LGFX_TiledSprite::createSprite(int32_t w, int32_t h, uint_fast16_t tile_w, uint_fast16_t tile_h)
+  {
+    if (w < 1 || h < 1 || w > UINT16_MAX || h > UINT16_MAX) { return false; }
+    bool res = _panel_tiled.createSprite(w, h, tile_w, tile_h);
+    _panel_tiled.setBaseColor(_write_conv.convert(_base_rgb888));
+
+    _sw = width();
+    _clip_r = _sw - 1;
+    _xpivot = _sw >> 1;
+
+    _sh = height();
+    _clip_b = _sh - 1;
+    _ypivot = _sh >> 1;
+
+    _clip_l = _clip_t = _sx = _sy = 0;
+    return res;
+  }
+
+  void LGFX_TiledSprite::deleteSprite(void)
+  {
+    _clip_l = 0;
+    _clip_t = 0;
+    _clip_r = -1;
+    _clip_b = -1;
+    _panel_tiled.deleteSprite();
+  }
+
+  void LGFX_TiledSprite::setColorDepth(color_depth_t depth)
+  {
+    LovyanGFX::setColorDepth(depth);
+    if (!_panel_tiled.isCreated()) { return; }
+    auto w = width();
+    auto h = height();
+    auto tw = _panel_tiled.getTileWidth();
+    auto th = _panel_tiled.getTileHeight();
+    deleteSprite();
+    createSprite(w, h, tw, th);
+  }
+
+  void LGFX_TiledSprite::pushViewport(LovyanGFX* dst, int32_t dst_x, int32_t dst_y, int32_t w, int32_t h, int32_t view_x, int32_t view_y)
+  {
+    if (dst == nullptr || !_panel_tiled.isCreated()) { return; }
+
+    /// 転送先の範囲・キャンバスの範囲・クリップ範囲の重なりにクリップを絞り、
+    /// 掛かるタイルを丸ごと渡して端の切り取りは pushImage のクリップ処理に任せる;
+    int32_t cx, cy, cw, ch;
+    dst->getClipRect(&cx, &cy, &cw, &ch);
+    int32_t ox = dst_x - view_x;
+    int32_t oy = dst_y - view_y;
+    int32_t l = std::max(std::max(cx, dst_x), ox);
+    int32_t t = std::max(std::max(cy, dst_y), oy);
+    int32_t r = std::min(std::min(cx + cw, dst_x + w), ox + (int32_t)width());
+    int32_t b = std::min(std::min(cy + ch, dst_y + h), oy + (int32_t)height());
+    if (l >= r || t >= b) { return; }
+
+    int32_t tw = _panel_tiled.getTileWidth();
+    int32_t th = _panel_tiled.getTileHeight();
+    int32_t tx_end = (r - 1 - ox) / tw;
+    int32_t ty_end = (b - 1 - oy) / th;
+    auto rawcolor = dst->getRawColor();
+    pixelcopy_t p(nullptr, dst->getColorDepth(), getColorDepth(), dst->hasPalette());
+
+    /// 未確保のタイルも確保済みのタイルと同じ変換で表示されるよう、基本色を同じ pixelcopy で転送先の形式にする;
+    uint32_t base_raw = 0;
+    {
+      uint32_t base = _panel_tiled.getBaseColor();
+      uint8_t buf[4] = { 0 };
+      pixelcopy_t pc = p;
+      pc.src_data = &base;
+      pc.fp_copy(buf, 0, 1, &pc);
+      uint_fast8_t dst_bits = dst->getColorDepth() & color_depth_t::bit_mask;
+      /// 1Byte 未満の形式は1Byte分に並べた値を色として使う;
+      if (dst_bits < 8) { base_raw = (buf[0] >> (8 - dst_bits)) * (0xFF / ((1 << dst_bits) - 1)); }
+      else { memcpy(&base_raw, buf, dst_bits >> 3); }
+    }
+
+    dst->setClipRect(l, t, r - l, b - t);
+    dst->startWrite();
+    for (int32_t ty = (t - oy) / th; ty <= ty_end; ++ty)
+    {
+      for (int32_t tx = (l - ox) / tw; tx <= tx_end; ++tx)
+      {
+        int32_t px = ox + tx * tw;
+        int32_t py = oy + ty * th;
+        auto img = _panel_tiled.getTileImage(tx, ty);
+        if (img == nullptr)
+        {
+          dst->setRawColor(base_raw);
+          dst->fillRect(px, py, tw, th);
+        }
+        else
+        {
+          pixelcopy_t pc = p;
+          pc.src_data = img;
+          dst->pushImage(px, py, tw, th, &pc);
+        }
+      }
+    }
+    dst->endWrite();
+    dst->setClipRect(cx, cy, cw, ch);
+    dst->setRawColor(rawcolor);
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
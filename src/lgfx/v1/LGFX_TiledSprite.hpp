@@ -0,0 +1,216 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "LGFXBase.hpp"
+#include "Panel.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+  class LGFX_TiledSprite;
+
+  /// 固定サイズのタイルを並べて画像を保持するパネル。
+  /// タイルは最初に書込まれた時に確保され、それまでは全画素が基本色として扱われる;
+  /// Panel keeping its image as a grid of fixed size tiles. A tile is allocated the first time
+  /// something other than the base color is written to it; until then all its pixels read as
+  /// the base color. Supports 8, 16 and 24 bit color depths without rotation.
+  struct Panel_TiledSprite : public IPanel
+  {
+    friend LGFX_TiledSprite;
+
+    Panel_TiledSprite(void) { _start_count = INT32_MAX; }
+    virtual ~Panel_TiledSprite(void) { deleteSprite(); }
+
+    void beginTransaction(void) override {}
+    void endTransaction(void) override {}
+    void setInvert(bool) override {}
+    void setSleep(bool) override {}
+    void setPowerSave(bool) override {}
+    void writeCommand(uint32_t, uint_fast8_t) override {}
+    void writeData(uint32_t, uint_fast8_t) override {}
+    void initDMA(void) override {}
+    void waitDMA(void) override {}
+    bool dmaBusy(void) override { return false; }
+    void waitDisplay(void) override {}
+    bool displayBusy(void) override { return false; }
+    void display(uint_fast16_t, uint_fast16_t, uint_fast16_t, uint_fast16_t) override {}
+    bool isReadable(void) const override { return true; }
+    bool isBusShared(void) const override { return false; }
+
+    uint32_t readCommand(uint_fast16_t, uint_fast8_t, uint_fast8_t) override { return 0; }
+    uint32_t readData(uint_fast8_t, uint_fast8_t) override { return 0; }
+
+    bool createSprite(uint_fast16_t w, uint_fast16_t h, uint_fast16_t tile_w, uint_fast16_t tile_h);
+    void deleteSprite(void);
+    bool isCreated(void) const { return _tiles != nullptr; }
+    void setPsram(bool enabled) { _psram = enabled; }
+
+    /// 未確保のタイルの色 (書込み先の形式の値) ;
+    /// Raw color, in the write format, that unallocated tiles read as.
+    void setBaseColor(uint32_t rawcolor);
+    uint32_t getBaseColor(void) const { return _base_raw; }
+
+    /// 前回の呼出し以降に書込みの無かったタイルを圧縮し、基本色のみのタイルは解放する。
+    /// 圧縮したタイルは次に書込まれた時に展開される。戻り値は圧縮・解放したタイルの数;
+    /// Compresses the tiles that were not written since the previous call and frees those that
+    /// only hold the base color. A compressed tile is expanded again on its next write.
+    /// Returns the number of tiles compressed or freed.
+    size_t compressIdleTiles(void);
+
+    /// タイルの画像 (tile_w x tile_h 画素) 。未確保のタイルは nullptr 。
+    /// 圧縮されたタイルは作業用バッファへ展開したものを返すため、次の読出しまで有効;
+    /// Image of one tile, tile_w x tile_h pixels; nullptr for an unallocated tile. Compressed
+    /// tiles are expanded into a shared work buffer, valid until the next read.
+    const uint8_t* getTileImage(uint_fast16_t tile_x, uint_fast16_t tile_y);
+
+    uint_fast16_t getTileWidth(void) const { return _tile_w; }
+    uint_fast16_t getTileHeight(void) const { return _tile_h; }
+    uint_fast16_t getTileColumns(void) const { return _cols; }
+    uint_fast16_t getTileRows(void) const { return _rows; }
+    size_t getAllocatedTileCount(void) const;
+    size_t getCompressedTileCount(void) const;
+    /// タイルの画像に使用しているメモリのバイト数;
+    /// Bytes currently held by tile images, compressed or not.
+    size_t getMemoryUsage(void) const { return _used_bytes; }
+
+    color_depth_t setColorDepth(color_depth_t depth) override;
+    void setRotation(uint_fast8_t r) override;
+
+    void setWindow(uint_fast16_t xs, uint_fast16_t ys, uint_fast16_t xe, uint_fast16_t ye) override;
+    void drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) override;
+    void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor) override;
+    void writeBlock(uint32_t rawcolor, uint32_t len) override;
+    void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) override;
+    void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) override;
+    void writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param) override;
+
+    void readRect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, void* dst, pixelcopy_t* param) override;
+    void copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y) override;
+
+  protected:
+    struct tile_t
+    {
+      /// nullptr なら全画素が基本色;
+      uint8_t* data;
+      /// 0 なら非圧縮。それ以外は圧縮データのバイト数;
+      uint32_t packed;
+      /// 前回の compressIdleTiles 以降に書込まれたか;
+      bool touched;
+    };
+
+    tile_t* _tiles = nullptr;
+    uint8_t* _work = nullptr;      // 圧縮されたタイルの読出し用;
+    uint8_t* _base_line = nullptr; // 基本色で埋めた1行分 (未確保のタイルの読出し用) ;
+    size_t _used_bytes = 0;
+    uint32_t _work_index = UINT32_MAX;
+    uint32_t _base_raw = 0;
+    uint_fast16_t _xpos;
+    uint_fast16_t _ypos;
+    uint16_t _tile_w = 0;
+    uint16_t _tile_h = 0;
+    uint16_t _cols = 0;
+    uint16_t _rows = 0;
+    bool _psram = false;
+
+    size_t _tile_pixels(void) const { return _tile_w * _tile_h; }
+    /// 24 bit の画素は4バイト単位で読まれるため、1画素分の余裕を持たせる;
+    size_t _tile_bytes(void) const { return (_tile_pixels() + 1) * (_write_bits >> 3); }
+
+    uint8_t* _tile_for_write(uint32_t index);
+    const uint8_t* _tile_for_read(uint32_t index);
+    const uint8_t* _read_line(uint32_t index, uint_fast16_t ly);
+    void _free_tile(uint32_t index);
+    void _set_solid(uint32_t index, uint32_t rawcolor);
+    void _write_line(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, pixelcopy_t* param);
+  };
+
+//----------------------------------------------------------------------------
+
+  /// 1つの連続したバッファを必要としない、タイル分割されたスプライト。
+  /// 使用中のタイルだけがメモリを消費するため、RAM に収まらない大きさの地図やグラフを扱える;
+  /// Sprite whose storage is a grid of tiles instead of one contiguous buffer, so a canvas can be
+  /// far larger than the largest free heap block. Only tiles holding something other than the
+  /// base color (setBaseColor) use memory; clear() or filling a whole tile with the base color
+  /// frees it, and compressIdleTiles() shrinks tiles that are no longer being drawn to.
+  ///
+  /// 表示は pushViewport で、表示範囲に掛かるタイルだけを転送する;
+  /// pushViewport() shows a window of the canvas, transferring only the tiles it overlaps.
+  class LGFX_TiledSprite : public LovyanGFX
+  {
+  public:
+    LGFX_TiledSprite(void)
+    : LovyanGFX()
+    {
+      _panel = &_panel_tiled;
+      setColorDepth(_write_conv.depth);
+    }
+
+    virtual ~LGFX_TiledSprite(void) { deleteSprite(); }
+
+    /// tile_w x tile_h 画素のタイルで w x h のキャンバスを作成する。この時点ではタイルは確保しない;
+    /// Creates a w x h canvas made of tile_w x tile_h tiles. No tile is allocated yet.
+    bool createSprite(int32_t w, int32_t h, uint_fast16_t tile_w = 64, uint_fast16_t tile_h = 64);
+    void deleteSprite(void);
+
+    /// 8, 16, 24 bit のみ対応。それ以外は 16 bit になる。作成済みの場合は内容を破棄して作り直す;
+    /// Only 8, 16 and 24 bit depths are supported; anything else becomes 16 bit.
+    /// An existing canvas is created again, losing its contents.
+    void setColorDepth(color_depth_t depth);
+    void setColorDepth(int bits) { setColorDepth((color_depth_t)(bits & color_depth_t::bit_mask)); }
+
+    void setPsram(bool enabled) { _panel_tiled.setPsram(enabled); }
+
+    /// 未確保のタイルの色。変更すると未確保のタイルの見た目も変わる;
+    /// Color of unallocated tiles; changing it also changes what those tiles show.
+    template<typename T>
+    void setBaseColor(T color)
+    {
+      LovyanGFX::setBaseColor(color);
+      _panel_tiled.setBaseColor(_write_conv.convert(_base_rgb888));
+    }
+
+    size_t compressIdleTiles(void) { return _panel_tiled.compressIdleTiles(); }
+
+    uint_fast16_t getTileWidth(void) const { return _panel_tiled.getTileWidth(); }
+    uint_fast16_t getTileHeight(void) const { return _panel_tiled.getTileHeight(); }
+    size_t getAllocatedTileCount(void) const { return _panel_tiled.getAllocatedTileCount(); }
+    size_t getCompressedTileCount(void) const { return _panel_tiled.getCompressedTileCount(); }
+    size_t getMemoryUsage(void) const { return _panel_tiled.getMemoryUsage(); }
+
+    /// キャンバスの (view_x, view_y) から w x h の範囲を dst の (dst_x, dst_y) へ転送する;
+    /// Pushes the w x h area of the canvas starting at (view_x, view_y) to (dst_x, dst_y) of dst.
+    void pushViewport(LovyanGFX* dst, int32_t dst_x, int32_t dst_y, int32_t w, int32_t h, int32_t view_x, int32_t view_y);
+    void pushViewport(LovyanGFX* dst, int32_t view_x, int32_t view_y)
+    {
+      pushViewport(dst, 0, 0, dst->width(), dst->height(), view_x, view_y);
+    }
+
+    void pushSprite(LovyanGFX* dst, int32_t x, int32_t y) { pushViewport(dst, x, y, width(), height(), 0, 0); }
+
+  protected:
+    Panel_TiledSprite _panel_tiled;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
+
+using LGFX_TiledSprite = lgfx::LGFX_TiledSprite;
@@ -31,6 +31,7 @@ Contributors:
 #include "misc/enum.hpp"
 #include "misc/colortype.hpp"
 #include "misc/pixelcopy.hpp"
+#include "misc/panel_stats.hpp"
 
 namespace lgfx
 {
@@ -85,8 +86,12 @@ namespace lgfx
     };
     uint8_t _rotation = 0;
     epd_mode_t _epd_mode = (epd_mode_t)0;  // EPDでない場合は0。それ以外の場合はEPD描画モード;
+    dither_mode_t _dither_mode = (dither_mode_t)0;  // ディザリングを行わないパネルでは0;
     bool _invert = false;
     bool _auto_display = false;
+#if defined ( LGFX_PANEL_STATS )
+    panel_stats_t _stats = {};
+#endif
 
   public:
     IPanel(void) = default;
@@ -105,8 +110,15 @@ namespace lgfx
     epd_mode_t getEpdMode(void) const { return _epd_mode; }
     void setEpdMode(epd_mode_t epd_mode) { if (_epd_mode && epd_mode) _epd_mode = epd_mode; }
     bool isEpd(void) const { return _epd_mode; }
+    dither_mode_t getDitherMode(void) const { return _dither_mode; }
+    void setDitherMode(dither_mode_t dither_mode) { if (_dither_mode && dither_mode) _dither_mode = dither_mode; }
     bool getAutoDisplay(void) const { return _auto_display; }
     void setAutoDisplay(bool auto_display) { _auto_display = auto_display; }
+#if defined ( LGFX_PANEL_STATS )
+    panel_stats_t& getStats(void) { return _stats; }
+    const panel_stats_t& getStats(void) const { return _stats; }
+    void resetStats(void) { _stats.reset(); }
+#endif
 
     virtual void beginTransaction(void) = 0;
     virtual void endTransaction(void) = 0;
@@ -0,0 +1,390 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "Allocator.hpp"
+
+#include "../platforms/common.hpp"
+
+#include <string.h>
+
+#if !defined (ARDUINO) && ( defined (__linux__) || defined (__APPLE__) || defined (_WIN32) )
+ // ホストOS上では描画以外のスレッドからもメモリが確保されるため排他制御を行う;
+ #define LGFX_ALLOCATOR_THREAD_SAFE
+ #include <mutex>
+#endif
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  static IAllocator* _allocator = nullptr;
+
+#if defined (LGFX_ALLOCATOR_THREAD_SAFE)
+  static thread_local FrameArena* _scratch_arena = nullptr;
+  static std::mutex _pool_mutex;
+  struct pool_lock_t
+  {
+    pool_lock_t(void) { _pool_mutex.lock(); }
+    ~pool_lock_t(void) { _pool_mutex.unlock(); }
+  };
+#else
+  static FrameArena* _scratch_arena = nullptr;
+  struct pool_lock_t { pool_lock_t(void) {} };
+#endif
+
+  void setAllocator(IAllocator* allocator) { _allocator = allocator; }
+  IAllocator* getAllocator(void) { return _allocator; }
+
+  void setScratchArena(FrameArena* arena) { _scratch_arena = arena; }
+  FrameArena* getScratchArena(void) { return _scratch_arena; }
+
+  static void* platform_alloc(size_t length, AllocationSource source)
+  {
+    switch (source)
+    {
+    case AllocationSource::Dma:   return platform_heap_alloc_dma(length);
+    case AllocationSource::Psram: return platform_heap_alloc_psram(length);
+    default:                      return platform_heap_alloc(length);
+    }
+  }
+
+  static void* dispatch_alloc(size_t length, AllocationSource source)
+  {
+    if (_allocator)
+    {
+      void* res = _allocator->allocate(length, source);
+      if (res) { return res; }
+    }
+    return platform_alloc(length, source);
+  }
+
+  void* heap_alloc(      size_t length) { return dispatch_alloc(length, AllocationSource::Normal); }
+  void* heap_alloc_psram(size_t length) { return dispatch_alloc(length, AllocationSource::Psram); }
+  void* heap_alloc_dma(  size_t length) { return dispatch_alloc(length, AllocationSource::Dma); }
+
+  void heap_free(void* buf)
+  {
+    if (buf == nullptr) { return; }
+    if (_allocator && _allocator->deallocate(buf)) { return; }
+    platform_heap_free(buf);
+  }
+
+//----------------------------------------------------------------------------
+
+  /// ブロックの直前に置くヘッダ。block_align に合わせて 16 バイトとする;
+  struct block_header_t
+  {
+    uint32_t size;       // ヘッダを除くブロックの大きさ;
+    uint32_t prev_size;  // 直前のブロックの大きさ (ヘッダを含む) 。先頭のブロックは 0 ;
+    uint32_t used;
+    uint32_t reserved;
+  };
+  static_assert(sizeof(block_header_t) == PoolAllocator::block_align, "block header must keep blocks aligned");
+
+  /// 空きブロックの本体に置く、空きリストの双方向リンク;
+  struct free_link_t
+  {
+    block_header_t* prev;
+    block_header_t* next;
+  };
+
+  static inline free_link_t* link_of(block_header_t* hdr) { return (free_link_t*)&hdr[1]; }
+  static inline size_t total_size(const block_header_t* hdr) { return sizeof(block_header_t) + hdr->size; }
+  static inline block_header_t* next_block(block_header_t* hdr) { return (block_header_t*)((uint8_t*)hdr + total_size(hdr)); }
+
+  static inline uint_fast8_t msb_index(size_t v)
+  {
+    uint_fast8_t res = 0;
+    while (v >>= 1) { ++res; }
+    return res;
+  }
+
+  // 64 バイト以下がクラス 0 、以降は2の累乗毎に4つのクラスに分ける (いずれも16の倍数) ;
+  size_t PoolAllocator::sizeClassOf(size_t length)
+  {
+    if (length <= 64) { return 0; }
+    size_t t = length - 1;
+    uint_fast8_t msb = msb_index(t);
+    size_t sub = (t >> (msb - 2)) & 3;
+    return (msb - 6) * 4 + sub + 1;
+  }
+
+  size_t PoolAllocator::classSize(size_t size_class)
+  {
+    if (size_class == 0) { return 64; }
+    size_t msb = (size_class - 1) / 4 + 6;
+    size_t sub = (size_class - 1) & 3;
+    return (5 + sub) << (msb - 2);
+  }
+
+  // 空きブロックは、そのクラスの要求を必ず満たせるよう classSize 以上となるクラスのリストへ入れる;
+  static size_t free_class_of(size_t size)
+  {
+    size_t c = PoolAllocator::sizeClassOf(size);
+    if (c >= PoolAllocator::class_count) { return PoolAllocator::class_count - 1; }
+    if (PoolAllocator::classSize(c) > size) { --c; }
+    return c;
+  }
+
+  static void free_list_push(void** lists, block_header_t* hdr)
+  {
+    auto& head = lists[free_class_of(hdr->size)];
+    auto link = link_of(hdr);
+    link->prev = nullptr;
+    link->next = (block_header_t*)head;
+    if (head) { link_of((block_header_t*)head)->prev = hdr; }
+    head = hdr;
+  }
+
+  static void free_list_remove(void** lists, block_header_t* hdr)
+  {
+    auto link = link_of(hdr);
+    if (link->next) { link_of(link->next)->prev = link->prev; }
+    if (link->prev) { link_of(link->prev)->next = link->next; }
+    else { lists[free_class_of(hdr->size)] = link->next; }
+  }
+
+  bool PoolAllocator::init(const config_t& cfg)
+  {
+    release();
+    pool_lock_t lock;
+    size_t bytes[3] = { cfg.normal_bytes, cfg.dma_bytes, cfg.psram_bytes };
+    for (size_t i = 0; i < 3; ++i)
+    {
+      // ブロックの大きさは 32bit で持つため、領域は 4GiB 未満とする;
+      size_t len = (bytes[i] < UINT32_MAX ? bytes[i] : UINT32_MAX) & ~(block_align - 1);
+      if (len == 0) { continue; }
+      auto buf = (uint8_t*)platform_alloc(len + block_align, (AllocationSource)i);
+      if (buf == nullptr)
+      {
+        _release();
+        return false;
+      }
+      auto& r = _region[i];
+      r.raw = buf;
+      r.base = &buf[(block_align - ((uintptr_t)buf & (block_align - 1))) & (block_align - 1)];
+      r.capacity = len;
+      r.stats.capacity = len;
+    }
+    return true;
+  }
+
+  void PoolAllocator::release(void)
+  {
+    pool_lock_t lock;
+    _release();
+  }
+
+  void PoolAllocator::_release(void)
+  {
+    for (auto& r : _region)
+    {
+      if (r.raw) { platform_heap_free(r.raw); }
+      r = region_t();
+    }
+  }
+
+  void* PoolAllocator::allocate(size_t length, AllocationSource source)
+  {
+    if ((size_t)source >= 3) { return nullptr; }
+    pool_lock_t lock;
+    auto& r = _region[source];
+    if (r.base == nullptr) { return nullptr; }
+
+    size_t cls = sizeClassOf(length);
+    if (cls >= class_count) { ++r.stats.fallback_count; return nullptr; }
+    size_t size = classSize(cls);
+
+    block_header_t* hdr = nullptr;
+    // 同じクラス、より大きなクラスの空きブロック、未使用の末尾の順に探す;
+    for (size_t c = cls; c < class_count; ++c)
+    {
+      if (r.free_list[c]) { hdr = (block_header_t*)r.free_list[c]; break; }
+    }
+    if (hdr)
+    {
+      free_list_remove(r.free_list, hdr);
+      r.stats.cached -= total_size(hdr);
+      // 余りが最小のブロックを作れる大きさであれば分割して空きリストへ戻す;
+      if (hdr->size >= size + sizeof(block_header_t) + classSize(0))
+      {
+        auto rest = (block_header_t*)((uint8_t*)&hdr[1] + size);
+        rest->size = hdr->size - size - sizeof(block_header_t);
+        rest->prev_size = sizeof(block_header_t) + size;
+        rest->used = 0;
+        hdr->size = size;
+        auto next = next_block(rest);
+        if ((uint8_t*)next < &r.base[r.top]) { next->prev_size = total_size(rest); }
+        free_list_push(r.free_list, rest);
+        r.stats.cached += total_size(rest);
+      }
+    }
+    else if (r.top + sizeof(block_header_t) + size <= r.capacity)
+    {
+      hdr = (block_header_t*)&r.base[r.top];
+      hdr->size = size;
+      hdr->prev_size = r.tail_prev;
+      r.tail_prev = total_size(hdr);
+      r.top += total_size(hdr);
+    }
+    else
+    {
+      ++r.stats.fallback_count;
+      return nullptr;
+    }
+
+    hdr->used = 1;
+    r.stats.used += total_size(hdr);
+    if (r.stats.peak < r.stats.used) { r.stats.peak = r.stats.used; }
+    ++r.stats.alloc_count;
+    return &hdr[1];
+  }
+
+  bool PoolAllocator::deallocate(void* buf)
+  {
+    pool_lock_t lock;
+    auto r = _find_region(buf);
+    if (r == nullptr) { return false; }
+    auto hdr = &((block_header_t*)buf)[-1];
+    if (!hdr->used) { return true; }
+    hdr->used = 0;
+    r->stats.used -= total_size(hdr);
+    ++r->stats.free_count;
+
+    // 前後の空きブロックと結合する;
+    auto tail = &r->base[r->top];
+    auto next = next_block(hdr);
+    if ((uint8_t*)next < tail && !next->used)
+    {
+      free_list_remove(r->free_list, next);
+      r->stats.cached -= total_size(next);
+      hdr->size += total_size(next);
+    }
+    if (hdr->prev_size)
+    {
+      auto prev = (block_header_t*)((uint8_t*)hdr - hdr->prev_size);
+      if (!prev->used)
+      {
+        free_list_remove(r->free_list, prev);
+        r->stats.cached -= total_size(prev);
+        prev->size += total_size(hdr);
+        hdr = prev;
+      }
+    }
+
+    next = next_block(hdr);
+    if ((uint8_t*)next == tail)
+    { // 末尾のブロックは未使用領域に戻す;
+      r->top = (uint8_t*)hdr - r->base;
+      r->tail_prev = hdr->prev_size;
+      return true;
+    }
+    next->prev_size = total_size(hdr);
+    free_list_push(r->free_list, hdr);
+    r->stats.cached += total_size(hdr);
+    return true;
+  }
+
+  PoolAllocator::region_t* PoolAllocator::_find_region(const void* buf)
+  {
+    auto p = (const uint8_t*)buf;
+    for (auto& r : _region)
+    {
+      if (r.base && p > r.base && p < &r.base[r.capacity]) { return &r; }
+    }
+    return nullptr;
+  }
+
+  PoolAllocator::stats_t PoolAllocator::getStats(AllocationSource source) const
+  {
+    if ((size_t)source >= 3) { return stats_t(); }
+    pool_lock_t lock;
+    auto& r = _region[source];
+    stats_t res = r.stats;
+    size_t tail = r.capacity - r.top;
+    res.largest_free = (tail > sizeof(block_header_t)) ? tail - sizeof(block_header_t) : 0;
+    for (size_t c = class_count; c--; )
+    {
+      if (r.free_list[c])
+      { // 最も大きなクラスのリストには大きさの異なるブロックが入りうる;
+        for (auto hdr = (block_header_t*)r.free_list[c]; hdr; hdr = link_of(hdr)->next)
+        {
+          if (res.largest_free < hdr->size) { res.largest_free = hdr->size; }
+        }
+        break;
+      }
+    }
+    return res;
+  }
+
+//----------------------------------------------------------------------------
+
+  bool FrameArena::init(size_t bytes, AllocationSource source)
+  {
+    release();
+    _raw = (uint8_t*)platform_alloc(bytes + 15, source);
+    if (_raw == nullptr) { return false; }
+    _base = &_raw[-(uintptr_t)_raw & 15];
+    _capacity = bytes;
+    return true;
+  }
+
+  void FrameArena::release(void)
+  {
+    if (_raw) { platform_heap_free(_raw); }
+    _raw = _base = nullptr;
+    _capacity = _top = _peak = 0;
+  }
+
+  void* FrameArena::allocate(size_t length)
+  {
+    size_t start = (_top + 15) & ~(size_t)15;
+    if (_base == nullptr || start + length > _capacity)
+    {
+      ++_fallback_count;
+      return nullptr;
+    }
+    _top = start + length;
+    if (_peak < _top) { _peak = _top; }
+    return &_base[start];
+  }
+
+//----------------------------------------------------------------------------
+
+  ScratchBuffer::ScratchBuffer(size_t length, bool use_heap)
+  {
+    auto arena = _scratch_arena;
+    if (arena)
+    {
+      _mark = arena->mark();
+      _buffer = (uint8_t*)arena->allocate(length);
+      if (_buffer) { _arena = arena; return; }
+    }
+    if (use_heap) { _buffer = (uint8_t*)heap_alloc_dma(length); }
+  }
+
+  ScratchBuffer::~ScratchBuffer(void)
+  {
+    if (_arena) { _arena->rewind(_mark); }
+    else { heap_free(_buffer); }
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
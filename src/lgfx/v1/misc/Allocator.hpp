@@ -0,0 +1,239 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  enum AllocationSource
+  {
+    Normal,
+    Dma,
+    Psram,
+    Preallocated,
+  };
+
+//----------------------------------------------------------------------------
+
+  /// ライブラリが使うメモリの確保・解放を差し替えるためのインタフェース;
+  /// Interface for taking over the memory the library allocates through heap_alloc and friends.
+  /// Install one with setAllocator() at startup, before anything is allocated.
+  struct IAllocator
+  {
+    virtual ~IAllocator(void) = default;
+
+    /// 確保できない場合は nullptr を返す。その場合はプラットフォームのヒープから確保される;
+    /// Returns nullptr when the request cannot be served; the platform heap is used instead.
+    virtual void* allocate(size_t length, AllocationSource source) = 0;
+
+    /// buf がこのアロケータのものでなければ false を返す。その場合はプラットフォームのヒープへ返される;
+    /// Returns false when buf was not allocated here; it is then handed to the platform heap.
+    virtual bool deallocate(void* buf) = 0;
+  };
+
+  /// nullptr でプラットフォームのヒープのみを使う状態に戻す。確保済みのメモリが残っている間は変更しないこと。
+  /// 設定したアロケータはメモリを確保する全てのスレッドから呼ばれるため、スレッドセーフであること;
+  /// nullptr restores plain platform heap allocation. Do not change it while memory from the
+  /// previous allocator is still in use. The allocator is called from every thread that allocates
+  /// (e.g. the Panel_Recorder and Panel_VNC worker threads), so it must be thread safe.
+  void setAllocator(IAllocator* allocator);
+  IAllocator* getAllocator(void);
+
+  void* heap_alloc(      size_t length);
+  void* heap_alloc_psram(size_t length);
+  void* heap_alloc_dma(  size_t length);
+  void heap_free(void* buf);
+
+//----------------------------------------------------------------------------
+
+  /// 用途 (Normal / Dma / Psram) 毎に予め確保した領域から、サイズクラス別の空きリストで割当てるアロケータ。
+  /// 解放したブロックは隣接する空きブロックと結合されるため、大きさの異なる確保と解放を繰り返しても断片化しにくい;
+  /// Pool allocator carving blocks out of one region per AllocationSource, reserved once at init.
+  /// Requests are rounded up to a size class (four classes per power of two). A freed block is
+  /// merged with free neighbours and kept in a free list by size, from which later requests take
+  /// a block of their class or split a larger one, so mixed sizes do not fragment the region the
+  /// way a plain heap does. Blocks are 16 byte aligned and a region is limited to 4 GiB. On host
+  /// OSes every call is serialized with a mutex.
+  class PoolAllocator : public IAllocator
+  {
+  public:
+    struct config_t
+    {
+      /// 各領域の大きさ。0 の領域はプラットフォームのヒープをそのまま使う;
+      /// Size of each region in bytes; requests for a region of size 0 go to the platform heap.
+      size_t normal_bytes = 0;
+      size_t dma_bytes    = 0;
+      size_t psram_bytes  = 0;
+    };
+
+    struct stats_t
+    {
+      size_t capacity = 0;
+      /// 使用中のブロックの合計 (ヘッダを含む) ;
+      /// bytes in live blocks, headers included.
+      size_t used = 0;
+      /// used の最大値;
+      /// high-water mark of used.
+      size_t peak = 0;
+      /// 空きリストに入っているブロックの合計;
+      /// bytes held in the free lists.
+      size_t cached = 0;
+      /// 1回で確保できる最大のブロック;
+      /// largest block a single request can still get.
+      size_t largest_free = 0;
+      uint32_t alloc_count = 0;
+      uint32_t free_count = 0;
+      /// 領域が足りずプラットフォームのヒープへ回した回数;
+      /// requests passed on to the platform heap because the region was exhausted.
+      uint32_t fallback_count = 0;
+
+      /// 空き容量のうち、最大のブロックとして使えない割合 (0.0 ~ 1.0) ;
+      /// share of the free space that is not part of the largest free block, 0.0 .. 1.0.
+      float fragmentation(void) const
+      {
+        size_t free_bytes = capacity - used;
+        return free_bytes ? 1.0f - (float)largest_free / free_bytes : 0.0f;
+      }
+    };
+
+    static constexpr size_t block_align = 16;
+    static constexpr size_t class_count = 77;
+
+    PoolAllocator(void) = default;
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+    ~PoolAllocator(void) { release(); }
+
+    bool init(const config_t& cfg);
+    /// 全ての領域を解放する。この後で領域内のブロックを heap_free に渡してはならない;
+    /// Frees every region; no block from them may be passed to heap_free afterwards.
+    void release(void);
+
+    void* allocate(size_t length, AllocationSource source) override;
+    bool deallocate(void* buf) override;
+
+    stats_t getStats(AllocationSource source) const;
+
+    /// length バイトの要求に使うサイズクラス。class_count 以上は扱えない大きさ;
+    /// Size class serving a request of length bytes; class_count or above means too large.
+    static size_t sizeClassOf(size_t length);
+    /// サイズクラスのブロックの大きさ (ヘッダを除く) ;
+    /// Payload size of the blocks in a size class.
+    static size_t classSize(size_t size_class);
+
+  protected:
+    struct region_t
+    {
+      uint8_t* raw = nullptr;
+      uint8_t* base = nullptr;
+      size_t capacity = 0;
+      size_t top = 0;
+      /// 未使用の末尾の直前にあるブロックの大きさ (ヘッダを含む) ;
+      /// size of the block just below top, header included.
+      size_t tail_prev = 0;
+      void* free_list[class_count] = {};
+      stats_t stats;
+    };
+    region_t _region[3];
+
+    region_t* _find_region(const void* buf);
+    void _release(void);
+  };
+
+//----------------------------------------------------------------------------
+
+  /// 1回の描画処理の間だけ使う作業用バッファを、予め確保した領域から順に切り出すアロケータ。
+  /// mark() で得た位置へ rewind() すると、それ以降に切り出した分をまとめて返す。
+  /// 1つの FrameArena は1つのスレッドからのみ使用すること;
+  /// Bump allocator for scratch buffers that only live for one drawing call. Memory comes from a
+  /// single region reserved at init; rewind() to a position returned by mark() gives back
+  /// everything taken since. Not thread safe: use one FrameArena per drawing thread.
+  class FrameArena
+  {
+  public:
+    FrameArena(void) = default;
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    ~FrameArena(void) { release(); }
+
+    bool init(size_t bytes, AllocationSource source = AllocationSource::Dma);
+    void release(void);
+
+    /// 16バイト境界に揃えて切り出す。足りない場合は nullptr ;
+    /// Takes length bytes, 16 byte aligned; nullptr when the region is too small.
+    void* allocate(size_t length);
+
+    size_t mark(void) const { return _top; }
+    void rewind(size_t mark) { if (mark < _top) { _top = mark; } }
+    void reset(void) { _top = 0; }
+
+    size_t getCapacity(void) const { return _capacity; }
+    size_t getUsed(void) const { return _top; }
+    /// 使用量の最大値。領域の大きさを決める目安になる;
+    /// high-water mark of getUsed(), a guide for sizing the region.
+    size_t getPeak(void) const { return _peak; }
+    uint32_t getFallbackCount(void) const { return _fallback_count; }
+
+  protected:
+    uint8_t* _raw = nullptr;
+    uint8_t* _base = nullptr;
+    size_t _capacity = 0;
+    size_t _top = 0;
+    size_t _peak = 0;
+    uint32_t _fallback_count = 0;
+  };
+
+  /// 描画処理の作業用バッファに使う FrameArena を設定する。nullptr でヒープを使う。
+  /// ホストOS上では呼出したスレッドのみに設定される;
+  /// Sets the FrameArena the drawing functions take their scratch buffers from; nullptr uses the heap.
+  /// On host OSes the setting is per thread and only affects the calling thread.
+  void setScratchArena(FrameArena* arena);
+  FrameArena* getScratchArena(void);
+
+  /// 作業用バッファ。設定された FrameArena から切り出し、無いか足りなければ heap_alloc_dma で確保する。
+  /// use_heap が false の場合はヒープを使わず空のままとなる (呼出し側でスタック等を使う) 。
+  /// 破棄時に返却されるため、入れ子にして使う場合は後に作ったものから破棄されること;
+  /// Scratch buffer taken from the scratch arena, or from heap_alloc_dma when there is none or it
+  /// is full. With use_heap false it stays empty instead, leaving the caller to fall back to the
+  /// stack. It is given back on destruction, so nested buffers must be destroyed in reverse order.
+  class ScratchBuffer
+  {
+  public:
+    ScratchBuffer(size_t length, bool use_heap = true);
+    ~ScratchBuffer(void);
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+    uint8_t* get(void) const { return _buffer; }
+    operator bool(void) const { return _buffer != nullptr; }
+
+  private:
+    uint8_t* _buffer = nullptr;
+    FrameArena* _arena = nullptr;
+    size_t _mark = 0;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -0,0 +1,222 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "EPD_Diff.hpp"
+#include "../platforms/common.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  bool EPD_Diff::init(uint_fast16_t width, uint_fast16_t height, uint_fast8_t bits)
+  {
+    release();
+    if ((bits != 1 && bits != 4) || width == 0 || height == 0) { return false; }
+
+    _width  = width;
+    _height = height;
+    _bits   = bits;
+    _stride = (width * bits + 7) >> 3;
+    _tiles_x = (width  + tile_width  - 1) / tile_width;
+    _tiles_y = (height + tile_height - 1) / tile_height;
+
+    size_t len = _stride * height;
+    _shown = static_cast<uint8_t*>(heap_alloc_psram(len));
+    if (_shown == nullptr) { _shown = static_cast<uint8_t*>(heap_alloc(len)); }
+    _tiles = static_cast<uint8_t*>(heap_alloc(_tiles_x * _tiles_y));
+    if (_shown == nullptr || _tiles == nullptr)
+    {
+      release();
+      return false;
+    }
+    memset(_shown, 0, len);
+    memset(_tiles, 0, _tiles_x * _tiles_y);
+    _valid = false;
+    _changed = false;
+    _partial_count = 0;
+    return true;
+  }
+
+  void EPD_Diff::release(void)
+  {
+    if (_shown) { heap_free(_shown); _shown = nullptr; }
+    if (_tiles) { heap_free(_tiles); _tiles = nullptr; }
+    _valid = false;
+    _changed = false;
+  }
+
+  void EPD_Diff::compareRow(uint_fast16_t y, const uint8_t* row, uint_fast16_t xs, uint_fast16_t xe)
+  {
+    if (_shown == nullptr || y >= _height) { return; }
+    xe = std::min<uint_fast16_t>(xe, _width - 1);
+    if (xs > xe) { return; }
+
+    uint32_t tile_bytes = (tile_width * _bits) >> 3;
+    auto shown = &_shown[y * _stride];
+    auto tiles = &_tiles[(y / tile_height) * _tiles_x];
+    for (uint32_t tx = xs / tile_width; tx <= xe / tile_width; ++tx)
+    {
+      uint32_t b0 = tx * tile_bytes;
+      uint32_t len = std::min(tile_bytes, _stride - b0);
+      if (0 == memcmp(&shown[b0], &row[b0], len)) { continue; }
+
+      uint_fast8_t change = change_t::change_mono;
+      if (_bits == 4)
+      { // 変化した画素のうち、新しい値が白と黒以外のものがあれば中間色の変化;
+        for (uint32_t i = b0; i < b0 + len; ++i)
+        {
+          uint_fast8_t n = row[i];
+          uint_fast8_t d = n ^ shown[i];
+          if (((d & 0xF0) && (uint_fast8_t)((n >> 4  ) - 1) < 14)
+           || ((d & 0x0F) && (uint_fast8_t)((n & 0x0F) - 1) < 14))
+          {
+            change = change_t::change_gray;
+            break;
+          }
+        }
+      }
+      memcpy(&shown[b0], &row[b0], len);
+      if (tiles[tx] < change) { tiles[tx] = change; }
+      _changed = true;
+    }
+  }
+
+  static inline int32_t rect_area(const range_rect_t& r)
+  {
+    return (int32_t)r.width() * r.height();
+  }
+
+  static inline range_rect_t rect_union(const range_rect_t& a, const range_rect_t& b)
+  {
+    range_rect_t res;
+    res.left   = std::min(a.left  , b.left  );
+    res.right  = std::max(a.right , b.right );
+    res.top    = std::min(a.top   , b.top   );
+    res.bottom = std::max(a.bottom, b.bottom);
+    return res;
+  }
+
+  static inline int32_t rect_waste(const range_rect_t& a, const range_rect_t& b)
+  {
+    return rect_area(rect_union(a, b)) - rect_area(a) - rect_area(b);
+  }
+
+  void EPD_Diff::_add_rect(update_t* list, size_t& count, size_t max, const update_t& rect) const
+  {
+    /// 同じ種類の変化で、統合しても損をしない矩形は吸収する;
+    /// absorb rectangles of the same kind that are cheaper to merge than to update separately.
+    update_t r = rect;
+    size_t i = 0;
+    while (i < count)
+    {
+      if (list[i].change == r.change && rect_waste(r.rect, list[i].rect) <= (int32_t)_rect_overhead)
+      {
+        r.rect = rect_union(r.rect, list[i].rect);
+        list[i] = list[--count];
+        i = 0;
+      }
+      else
+      {
+        ++i;
+      }
+    }
+    if (count < max)
+    {
+      list[count++] = r;
+      return;
+    }
+
+    /// 上限に達している場合は、増える面積が最小の組を統合する。波形は遅い方に合わせる;
+    /// the list is full: merge the pair adding the least area, keeping the slower waveform.
+    size_t best_i = 0;
+    size_t best_j = max;
+    int32_t best = INT32_MAX;
+    for (size_t j = 0; j <= max; ++j)
+    {
+      auto& rj = (j == max) ? r : list[j];
+      for (i = 0; i < j; ++i)
+      {
+        int32_t waste = rect_waste(list[i].rect, rj.rect);
+        if (best > waste)
+        {
+          best = waste;
+          best_i = i;
+          best_j = j;
+        }
+      }
+    }
+    auto& rj = (best_j == max) ? r : list[best_j];
+    list[best_i].rect = rect_union(list[best_i].rect, rj.rect);
+    list[best_i].change = std::max(list[best_i].change, rj.change);
+    if (best_j != max) { list[best_j] = r; }
+  }
+
+  size_t EPD_Diff::getUpdates(update_t* list, size_t max, bool& full)
+  {
+    full = false;
+    if ((_valid && !_changed) || max == 0) { return 0; }
+    _changed = false;
+
+    if (!_valid || (_full_interval && _partial_count >= _full_interval))
+    {
+      memset(_tiles, 0, _tiles_x * _tiles_y);
+      _valid = true;
+      _partial_count = 0;
+      full = true;
+      list[0].rect.left   = 0;
+      list[0].rect.right  = _width - 1;
+      list[0].rect.top    = 0;
+      list[0].rect.bottom = _height - 1;
+      list[0].change = change_t::change_gray;
+      return 1;
+    }
+    ++_partial_count;
+
+    /// 各タイル行で同じ種類の変化が続く範囲を矩形にし、順に統合していく;
+    /// every run of equally changed tiles on a tile row becomes a rectangle to merge in.
+    size_t count = 0;
+    auto tiles = _tiles;
+    for (uint32_t ty = 0; ty < _tiles_y; ++ty, tiles += _tiles_x)
+    {
+      uint32_t tx = 0;
+      while (tx < _tiles_x)
+      {
+        uint_fast8_t change = tiles[tx];
+        if (change == change_t::change_none) { ++tx; continue; }
+        uint32_t start = tx;
+        do { tiles[tx] = change_t::change_none; } while (++tx < _tiles_x && tiles[tx] == change);
+
+        update_t u;
+        u.rect.left   = start * tile_width;
+        u.rect.right  = std::min<uint32_t>(_width , tx * tile_width) - 1;
+        u.rect.top    = ty * tile_height;
+        u.rect.bottom = std::min<uint32_t>(_height, (ty + 1) * tile_height) - 1;
+        u.change = (change_t)change;
+        _add_rect(list, count, max, u);
+      }
+    }
+    return count;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
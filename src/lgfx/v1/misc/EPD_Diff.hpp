@@ -0,0 +1,125 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "range.hpp"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// 電子ペーパーに表示中の画像を保持し、新しい画像との差分から更新が必要な矩形と、
+  /// それぞれに使える最も速い波形の種類を求める (epd_auto で使用) ;
+  /// Keeps a copy of the image currently shown on an e-paper panel and turns the difference
+  /// against the next image into a few update rectangles, each tagged with the fastest kind of
+  /// waveform that can draw it. Used by the panels in epd_auto mode.
+  ///
+  /// 画像は 1bpp (MSB側が左) または 4bpp (上位4bitが左) で、座標は回転前のパネル座標;
+  /// Images are 1bpp (leftmost pixel in the MSB) or 4bpp (leftmost pixel in the high nibble),
+  /// in unrotated panel coordinates. Differences are tracked in tiles of tile_width x tile_height.
+  class EPD_Diff
+  {
+  public:
+    static constexpr uint_fast8_t tile_width  = 16;
+    static constexpr uint_fast8_t tile_height = 8;
+
+    enum change_t : uint8_t
+    {
+      change_none = 0,
+      /// 変化した画素が全て白か黒になる。DU 等の2値の高速な波形で描ける;
+      /// every changed pixel ends up black or white: a fast two-level waveform (DU) will do.
+      change_mono = 1,
+      /// 中間色へ変化する画素がある。階調を持つ波形 (GC16 等) が必要;
+      /// some pixel changes to an intermediate level and needs a grayscale waveform (GC16).
+      change_gray = 2,
+    };
+
+    struct update_t
+    {
+      range_rect_t rect;
+      change_t change;
+    };
+
+    EPD_Diff(void) = default;
+    EPD_Diff(const EPD_Diff&) = delete;
+    EPD_Diff& operator=(const EPD_Diff&) = delete;
+    ~EPD_Diff(void) { release(); }
+
+    /// bits は 1 または 4 。表示中の画像は不明として扱い、最初の更新は全画面になる;
+    /// bits is 1 or 4. The shown image starts out unknown, so the first update covers the panel.
+    bool init(uint_fast16_t width, uint_fast16_t height, uint_fast8_t bits);
+    void release(void);
+    bool isInitialized(void) const { return _shown != nullptr; }
+
+    /// 表示中の画像を不明として扱い、次の更新を全画面にする (初期化やスリープ復帰時) ;
+    /// Forgets the shown image; the next update is a full refresh (after init or wake up).
+    void invalidate(void) { _valid = false; }
+
+    /// 表示中の画像が既知か。false の間は compareRow で全ラインを渡すこと;
+    /// false until the next full update; pass every row to compareRow while it is false.
+    bool isValid(void) const { return _valid; }
+
+    /// 残像を消すための全画面更新を、部分更新 count 回毎に行う。0 で無効;
+    /// A full refresh is scheduled after every count partial updates to clear ghosting; 0 disables it.
+    void setFullRefreshInterval(uint16_t count) { _full_interval = count; }
+    uint16_t getFullRefreshInterval(void) const { return _full_interval; }
+
+    /// 別々に更新する場合の1矩形あたりのコストを画素数で表したもの。これより無駄な面積が少なければ統合する;
+    /// Per-update overhead in pixels; rectangles are merged when their union wastes less than this.
+    void setRectOverhead(uint32_t pixels) { _rect_overhead = pixels; }
+
+    /// 1ライン分の新しい画像 (row はライン先頭) の [xs, xe] を表示中の画像と比較し、差分を記録して取り込む。
+    /// 範囲に掛かるタイルは全体を比較するため、row はタイル単位で有効な画素を持つこと;
+    /// Compares the new row y (row points at the start of the row) with the shown image over the
+    /// tiles touched by [xs, xe], records the changed tiles and takes the new pixels over. Whole
+    /// tiles are compared, so row must hold valid pixels for every tile the range touches.
+    void compareRow(uint_fast16_t y, const uint8_t* row, uint_fast16_t xs, uint_fast16_t xe);
+
+    /// 記録した差分を最大 max 個の矩形にまとめる。全画面更新の時期に当たる場合は full を true にして
+    /// パネル全体の矩形を1つ返す。戻り値は矩形の数で、変化が無ければ 0 ;
+    /// Turns the recorded changes into at most max rectangles and clears them. When a full refresh
+    /// is due, full is set and a single rectangle covering the panel is returned. Returns 0 when
+    /// nothing changed.
+    size_t getUpdates(update_t* list, size_t max, bool& full);
+
+  protected:
+    uint8_t* _shown = nullptr;
+    uint8_t* _tiles = nullptr;
+    uint32_t _stride = 0;
+    uint16_t _width = 0;
+    uint16_t _height = 0;
+    uint16_t _tiles_x = 0;
+    uint16_t _tiles_y = 0;
+    uint16_t _full_interval = 32;
+    uint16_t _partial_count = 0;
+    uint32_t _rect_overhead = 1024;
+    uint8_t _bits = 1;
+    bool _valid = false;
+    bool _changed = false;
+
+    void _add_rect(update_t* list, size_t& count, size_t max, const update_t& rect) const;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -0,0 +1,649 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "HUB75_Encoder.hpp"
+#include "DividedFrameBuffer.hpp"
+#include "../platforms/common.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// RGB565 用のガンマ補正。64階調の入力値から 8bit の輝度値を得る。
+  /// (ESP32 の uint_fast8_t は 32bit のため、途中の値が 255 を超えても切り捨てられない) ;
+  static uint32_t gamma_565(uint32_t i)
+  {
+    uint32_t v = ((i * 65) >> 4) + 1;
+    v = (v * v) >> 8;
+    if (v < i) { v = i; }
+    else if (v > 255) { v = 255; }
+    return v;
+  }
+
+  void HUB75_Encoder::makePixelTable(uint32_t* tbl, color_depth_t depth)
+  { // ガンマ補正と同時に、各ビットの間隔を広げる処理も行うようにデータを生成する。
+    if (depth == color_depth_t::rgb565_2Byte)
+    {
+      // RGB565の場合は、単一色に対して使用する64要素のテーブルを作成する。
+      // 利用時にRGB成分をまとめやすくするため、3bit間隔に変換して作成する。
+      for (size_t i = 0; i < 64; ++i)
+      {
+        uint32_t v = gamma_565(i);
+
+        // データの各ビット間の間隔を広げる
+        uint32_t value = 0;
+        for (size_t shift = 0; shift < 8; ++shift)
+        {
+          uint32_t mask = (1 << shift);
+          value |= (v & mask) << (shift * 2);
+        }
+        tbl[i] = value;
+      }
+    }
+    else
+    {
+      // RGB332の場合は、3色まとめて変換できる256要素のテーブルを作成する。
+      // BGRの3ビット+無データ3bitの 6bitが5セット並んだ状態のデータを作成する。
+      for (size_t rgb332 = 0; rgb332 < 256; ++rgb332)
+      {
+        uint_fast16_t r = 1 + (((rgb332 & 0xE0u) * 0b01001u) >> 5);
+        uint_fast16_t g = 1 + (((rgb332 & 0x1Cu) * 0b01001u) >> 2);
+        uint_fast16_t b = 1 + (((rgb332 & 0x03u) * 0b10101u)     );
+        r = (r * r + 31) >> 7;
+        g = (g * g + 31) >> 7;
+        b = (b * b + 31) >> 7;
+        if (r > 31) { r = 31; }
+        if (g > 31) { g = 31; }
+        if (b > 31) { b = 31; }
+
+        uint32_t value = 0;
+        for (size_t shift = 0; shift < 5; ++shift)
+        {
+          uint32_t mask = (1 << shift);
+          value |= (r & mask) << (shift * 5 + 0)
+                |  (g & mask) << (shift * 5 + 1)
+                |  (b & mask) << (shift * 5 + 2);
+        }
+        tbl[rgb332] = value;
+      }
+    }
+  }
+
+  void HUB75_Encoder::makeBrightnessPeriod(uint16_t* period, uint_fast16_t panel_width, uint8_t brightness, color_depth_t depth)
+  {
+    int br = brightness + 1;
+    uint32_t light_len_limit = (panel_width - 7);
+    uint32_t slen = (light_len_limit * br) >> 8;
+
+    uint32_t transfer_period_count = TRANSFER_PERIOD_COUNT_332;
+    uint32_t half_start = 4;
+    if (depth == color_depth_t::rgb565_2Byte)
+    {
+      transfer_period_count = TRANSFER_PERIOD_COUNT_565;
+      half_start = 6;
+    }
+
+    period[transfer_period_count] = panel_width;
+    for (int p = transfer_period_count - 1; p >= 0; --p)
+    {
+      period[p] = slen + 4;
+      if (p < (int)half_start) { slen >>= 1; }
+    }
+  }
+
+  void HUB75_Encoder::drawLine332(work_t* work)
+  {
+    uint8_t* src8_h = (uint8_t*)(work->s32h);
+    uint8_t* src8_l = (uint8_t*)(work->s32l);
+    uint32_t* d32 = work->d32;
+    uint32_t len32 = work->len32;
+    uint32_t xe = work->xe;
+    uint32_t xe_idx = work->xe_idx;
+    auto mixdata = work->mixdata;
+    auto xe_tbl = work->xe_tbl;
+    for (;;)
+    {
+      do
+      {
+        // RGB332の値を基にガンマテーブルを適用する
+        // このテーブルの中身は単にガンマ補正をするだけでなく、
+        // BGR順に1ビットずつ並んだ状態に変換する処理を兼ねている。
+        uint32_t rgb_upper_1 = work->pixel_tbl[*src8_h++];
+        uint32_t rgb_upper_2 = work->pixel_tbl[*src8_h++];
+        uint32_t rgb_lower_1 = work->pixel_tbl[*src8_l++];
+        uint32_t rgb_lower_2 = work->pixel_tbl[*src8_l++];
+
+        // パラレルで同時に送信する6bit分のRGB成分(画面の上半分と下半分)が隣接するように纏める。
+        uint32_t rgb_1 = rgb_upper_1 + (rgb_lower_1 << 3);
+        uint32_t rgb_2 = rgb_upper_2 + (rgb_lower_2 << 3);
+
+        d32[len32 * 0] = mixdata[TRANSFER_PERIOD_COUNT_332];
+
+        int32_t i = 0;
+        uint32_t pixel_2 = rgb_2 & 0x3F;
+        uint32_t pixel_1 = rgb_1 & 0x3F;
+        pixel_2 += mixdata[i];
+        pixel_1 <<= 16;
+        d32[++i * len32] = pixel_1 + pixel_2;
+        do
+        {
+          rgb_2 >>= 6;
+          rgb_1 >>= 6;
+          pixel_2 = rgb_2 & 0x3F;
+          pixel_1 = rgb_1 & 0x3F;
+          pixel_2 += mixdata[i];
+          pixel_1 <<= 16;
+          // 横２列ぶん同時にバッファにセットする
+          d32[++i * len32] = pixel_1 + pixel_2;
+        } while (i < TRANSFER_PERIOD_COUNT_332);
+
+        ++d32;
+      } while (--xe);
+      if (xe_idx == TRANSFER_PERIOD_COUNT_332) break;
+      uint32_t new_xe = xe_tbl[xe_idx] >> 1;
+      uint32_t old_xe;
+      do {
+        old_xe = new_xe;
+        mixdata[++xe_idx] = work->mix_value;
+        new_xe = xe_tbl[xe_idx] >> 1;
+      } while (new_xe <= old_xe);
+      xe = new_xe - old_xe;
+    }
+  }
+
+  void HUB75_Encoder::drawLine565(work_t* work)
+  {
+    uint32_t* d32 = work->d32;
+    uint32_t len32 = work->len32;
+    uint32_t xe = work->xe;
+    uint32_t xe_idx = work->xe_idx;
+    auto pixel_tbl = work->pixel_tbl;
+    auto mixdata = work->mixdata;
+    auto xe_tbl = work->xe_tbl;
+
+    for (;;)
+    {
+      do
+      {
+        // 16bit RGB565を32bit変数に2ピクセル纏めて取り込む。(画面の上半分用)
+        uint32_t rgb565x2_upper = *work->s32h++;
+        // 画面の下半分用のピクセルも同様に2ピクセル纏めて取り込む
+        uint32_t rgb565x2_lower = *work->s32l++;
+
+        // R,G,Bそれぞれの成分に分離する。2x2=4ピクセルまとめて処理することで演算回数を削減する
+        uint32_t r_upper_1 = rgb565x2_upper >> 11;
+        uint32_t r_lower_1 = rgb565x2_lower >> 11;
+        uint32_t g_upper_1 = rgb565x2_upper >> 5;
+        uint32_t g_lower_1 = rgb565x2_lower >> 5;
+        uint32_t b_upper_2 = rgb565x2_upper & 0x1F001F;
+        uint32_t b_lower_2 = rgb565x2_lower & 0x1F001F;
+        uint32_t r_upper_2 = r_upper_1 & 0x1F001F;
+        uint32_t r_lower_2 = r_lower_1 & 0x1F001F;
+        uint32_t g_upper_2 = g_upper_1 & 0x3F003F;
+        uint32_t g_lower_2 = g_lower_1 & 0x3F003F;
+
+        r_upper_1 = r_upper_2 & 0x1F;
+        r_lower_1 = r_lower_2 & 0x1F;
+        r_upper_2 >>= 16;
+        r_lower_2 >>= 16;
+        g_upper_1 = g_upper_2 & 0x3F;
+        g_lower_1 = g_lower_2 & 0x3F;
+        g_upper_2 >>= 16;
+        g_lower_2 >>= 16;
+        uint32_t b_upper_1 = b_upper_2 & 0x1F;
+        uint32_t b_lower_1 = b_lower_2 & 0x1F;
+        b_upper_2 >>= 16;
+        b_lower_2 >>= 16;
+
+        // RGBそれぞれ64階調値を元にガンマテーブルを適用する
+        // このテーブルの中身は単にガンマ補正をするだけでなく、
+        // 各ビットを3bit間隔に変換する処理を兼ねている。
+        // 具体的には  0bABCDEFGH  ->  0bA__B__C__D__E__F__G__H__ のようになる
+        r_upper_1 = pixel_tbl[r_upper_1 << 1];
+        r_lower_1 = pixel_tbl[r_lower_1 << 1];
+        r_upper_2 = pixel_tbl[r_upper_2 << 1];
+        r_lower_2 = pixel_tbl[r_lower_2 << 1];
+        g_upper_1 = pixel_tbl[g_upper_1];
+        g_lower_1 = pixel_tbl[g_lower_1];
+        g_upper_2 = pixel_tbl[g_upper_2];
+        g_lower_2 = pixel_tbl[g_lower_2];
+        b_upper_1 = pixel_tbl[b_upper_1 << 1];
+        b_lower_1 = pixel_tbl[b_lower_1 << 1];
+        b_upper_2 = pixel_tbl[b_upper_2 << 1];
+        b_lower_2 = pixel_tbl[b_lower_2 << 1];
+
+        // テーブルから取り込んだ値は3bit間隔となっているので、
+        // R,G,Bそれぞれが互いを避けるようにビットシフトすることでまとめることができる。
+        g_upper_1 += b_upper_1 << 1;
+        g_lower_1 += b_lower_1 << 1;
+        g_upper_2 += b_upper_2 << 1;
+        g_lower_2 += b_lower_2 << 1;
+        uint32_t rgb_upper_1 = r_upper_1 + (g_upper_1 << 1);
+        uint32_t rgb_lower_1 = r_lower_1 + (g_lower_1 << 1);
+        uint32_t rgb_upper_2 = r_upper_2 + (g_upper_2 << 1);
+        uint32_t rgb_lower_2 = r_lower_2 + (g_lower_2 << 1);
+
+        // 上記の変数の中身は BGRBGRBGRBGR… の順にビットが並んだ状態となる
+        // これを、各色の0,2,4,6ビットと1,3,5,7ビットの成分に分離する
+        uint32_t rgb_upper_1_even = rgb_upper_1 & 0b00111000111000111000111000111000;
+        uint32_t rgb_upper_1_odd  = rgb_upper_1 & 0b11000111000111000111000111000111;
+        uint32_t rgb_lower_1_even = rgb_lower_1 & 0b00111000111000111000111000111000;
+        uint32_t rgb_lower_1_odd  = rgb_lower_1 & 0b11000111000111000111000111000111;
+        uint32_t rgb_upper_2_even = rgb_upper_2 & 0b00111000111000111000111000111000;
+        uint32_t rgb_upper_2_odd  = rgb_upper_2 & 0b11000111000111000111000111000111;
+        uint32_t rgb_lower_2_even = rgb_lower_2 & 0b00111000111000111000111000111000;
+        uint32_t rgb_lower_2_odd  = rgb_lower_2 & 0b11000111000111000111000111000111;
+
+        // パラレルで同時に送信する6bit分のRGB成分(画面の上半分と下半分)が隣接するように纏める。
+        uint32_t rgb_even_1 = (rgb_lower_1_even    ) + (rgb_upper_1_even >> 3);
+        uint32_t rgb_odd_1  = (rgb_lower_1_odd << 3) + (rgb_upper_1_odd      );
+        uint32_t rgb_even_2 = (rgb_lower_2_even    ) + (rgb_upper_2_even >> 3);
+        uint32_t rgb_odd_2  = (rgb_lower_2_odd << 3) + (rgb_upper_2_odd      );
+
+        d32[0] = mixdata[TRANSFER_PERIOD_COUNT_565];
+
+        uint32_t i = 0;
+        do
+        {
+          uint32_t odd_2 = rgb_odd_2 & 0x3F;
+          uint32_t odd_1 = rgb_odd_1 & 0x3F;
+          uint32_t even_2 = rgb_even_2 & 0x3F;
+          uint32_t even_1 = rgb_even_1 & 0x3F;
+          rgb_odd_2 >>= 6;
+          rgb_odd_1 >>= 6;
+          odd_2 += mixdata[i] + (odd_1 << 16);
+          // 奇数番ビット成分を横２列ぶん同時にバッファにセットする
+          d32[++i * len32] = odd_2;
+          even_2 += mixdata[i] + (even_1 << 16);
+          rgb_even_2 >>= 6;
+          rgb_even_1 >>= 6;
+          // 偶数番ビット成分を横２列ぶん同時にバッファにセットする
+          d32[++i * len32] = even_2;
+        } while (i < TRANSFER_PERIOD_COUNT_565);
+        ++d32;
+      } while (--xe);
+      if (xe_idx == TRANSFER_PERIOD_COUNT_565) break;
+      uint32_t new_xe = xe_tbl[xe_idx] >> 1;
+      uint32_t old_xe;
+      do {
+        old_xe = new_xe;
+        mixdata[++xe_idx] = work->mix_value;
+        new_xe = xe_tbl[xe_idx] >> 1;
+      } while (new_xe <= old_xe);
+      xe = new_xe - old_xe;
+    }
+  }
+
+//----------------------------------------------------------------------------
+
+  bool HUB75_Encoder::init(const config_t& config)
+  {
+    release();
+    _cfg = config;
+    if (_cfg.depth != color_depth_t::rgb332_1Byte && _cfg.depth != color_depth_t::rgb565_2Byte) { return false; }
+    if (_cfg.panel_width < 8 || (_cfg.panel_width & 1) || _cfg.panel_height < 4 || (_cfg.panel_height & 1)) { return false; }
+
+    _pixel_tbl = (uint32_t*)heap_alloc(getPixelTableLength(_cfg.depth) * sizeof(uint32_t));
+    _line_buf = (uint32_t*)heap_alloc(_cfg.panel_width * 2 * sizeof(uint32_t));
+    if (_pixel_tbl == nullptr || _line_buf == nullptr)
+    {
+      release();
+      return false;
+    }
+    makePixelTable(_pixel_tbl, _cfg.depth);
+
+    setBrightness(_cfg.brightness);
+    return true;
+  }
+
+  void HUB75_Encoder::release(void)
+  {
+    if (_pixel_tbl) { heap_free(_pixel_tbl); _pixel_tbl = nullptr; }
+    if (_line_buf ) { heap_free(_line_buf ); _line_buf  = nullptr; }
+  }
+
+  void HUB75_Encoder::setBrightness(uint8_t brightness)
+  {
+    _cfg.brightness = brightness;
+    makeBrightnessPeriod(_brightness_period, _cfg.panel_width, brightness, _cfg.depth);
+  }
+
+  void HUB75_Encoder::encodeLine(uint32_t* dst, uint_fast16_t y, const void* upper, const void* lower, bool fast)
+  {
+    uint32_t transfer_period_count = getTransferPeriodCount(_cfg.depth);
+
+    uint32_t yy = 0;
+    uint32_t yy_oe = mask_oe | mask_pin_b_lat; // PIN B Discharge
+    if (!_cfg.address_shiftreg)
+    {
+      yy = y << 8 | y << 24;
+      yy_oe = yy | mask_oe;
+    }
+    uint32_t mixdata[TRANSFER_PERIOD_COUNT_565 + 1];
+    mixdata[0] = yy_oe;
+    for (size_t i = 1; i <= transfer_period_count; ++i)
+    {
+      mixdata[i] = yy;
+    }
+
+    if (fast)
+    {
+      _encode_pixels_fast(dst, upper, lower, mixdata);
+    }
+    else
+    {
+      work_t work;
+      work.d32 = dst;
+      work.s32h = (uint32_t*)upper;
+      work.s32l = (uint32_t*)lower;
+      work.pixel_tbl = _pixel_tbl;
+      work.mixdata = mixdata;
+      work.xe_tbl = _brightness_period;
+      work.len32 = _cfg.panel_width >> 1;
+      work.xe = _brightness_period[0] >> 1;
+      work.xe_idx = 0;
+      work.mix_value = yy_oe;
+      if (_cfg.depth == color_depth_t::rgb565_2Byte)
+      {
+        drawLine565(&work);
+      }
+      else
+      {
+        drawLine332(&work);
+      }
+    }
+    _finish_line(dst, y);
+  }
+
+  static void write_plane(uint32_t* __restrict d, const uint32_t* __restrict p1, const uint32_t* __restrict p2, uint32_t shift, uint32_t begin, uint32_t end, uint32_t mix)
+  {
+    for (uint32_t k = begin; k < end; ++k)
+    {
+      d[k] = (((p1[k] >> shift) & 0x3F) << 16) + ((p2[k] >> shift) & 0x3F) + mix;
+    }
+  }
+
+  /// 画素毎に輝度ビットを 6bit 間隔で並べ (上半分の RGB を下位 3bit 、下半分を上位 3bit) 、偶数列と奇数列に分けて保持した後、
+  /// ビットプレーン毎に連続した領域へ書出す。内側のループは分岐が無く 32bit 演算のみのためベクトル化できる;
+  void HUB75_Encoder::_encode_pixels_fast(uint32_t* dst, const void* upper, const void* lower, const uint32_t* mixdata)
+  {
+    const uint32_t len32 = _cfg.panel_width >> 1;
+    const uint32_t transfer_period_count = getTransferPeriodCount(_cfg.depth);
+
+    // [0] 偶数列(ペアの1ピクセル目) , [1] 奇数列 。RGB565 は輝度の偶数番ビット用 [0][1] と奇数番ビット用 [2][3] を使う
+    uint32_t* planes[4] = { _line_buf, &_line_buf[len32], &_line_buf[len32 * 2], &_line_buf[len32 * 3] };
+
+    if (_cfg.depth == color_depth_t::rgb565_2Byte)
+    {
+      // drawLine565 と同様に 3bit 間隔のテーブルで RGB を纏め、輝度の偶数番ビットと奇数番ビットに分離する
+      static constexpr const uint32_t mask = 0b000111000111000111000111;
+      auto tbl = _pixel_tbl;
+      auto up = (const uint16_t*)upper;
+      auto lo = (const uint16_t*)lower;
+      for (uint32_t x = 0; x < len32 * 2; ++x)
+      {
+        uint32_t u = tbl[(up[x] >> 10) & 0x3E] | tbl[(up[x] >> 5) & 0x3F] << 1 | tbl[(up[x] << 1) & 0x3E] << 2;
+        uint32_t l = tbl[(lo[x] >> 10) & 0x3E] | tbl[(lo[x] >> 5) & 0x3F] << 1 | tbl[(lo[x] << 1) & 0x3E] << 2;
+        uint32_t even = (u & mask) | (l & mask) << 3;
+        uint32_t odd  = ((u >> 3) & mask) | (l & (mask << 3));
+        planes[    (x & 1)][x >> 1] = even;
+        planes[2 + (x & 1)][x >> 1] = odd;
+      }
+    }
+    else
+    {
+      auto tbl = _pixel_tbl;
+      auto up = (const uint8_t*)upper;
+      auto lo = (const uint8_t*)lower;
+      for (uint32_t x = 0; x < len32 * 2; ++x)
+      {
+        planes[x & 1][x >> 1] = tbl[up[x]] | tbl[lo[x]] << 3;
+      }
+    }
+
+    // 各期間の制御ビットは、列が境界を越えると mixdata[0] の値 (OE付き) に切り替わる (drawLine332/565 と同じ規則)
+    uint32_t border[TRANSFER_PERIOD_COUNT_565 + 1];
+    border[0] = 0;
+    for (uint32_t i = 1; i <= transfer_period_count; ++i)
+    {
+      border[i] = std::min<uint32_t>(len32, std::max<uint32_t>(border[i - 1], _brightness_period[i - 1] >> 1));
+    }
+    const uint32_t mix_on = mixdata[0];
+
+    // データ無し点灯期間
+    for (uint32_t k = 0; k < border[transfer_period_count]; ++k) { dst[k] = mixdata[transfer_period_count]; }
+    for (uint32_t k = border[transfer_period_count]; k < len32; ++k) { dst[k] = mix_on; }
+
+    for (uint32_t i = 0; i < transfer_period_count; ++i)
+    {
+      auto d = &dst[(i + 1) * len32];
+      uint32_t sel = 0;
+      uint32_t shift = i * 6;
+      if (_cfg.depth == color_depth_t::rgb565_2Byte)
+      {
+        sel = (i & 1) << 1;
+        shift = (i >> 1) * 6;
+      }
+      const uint32_t* p1 = planes[sel];
+      const uint32_t* p2 = planes[sel + 1];
+      write_plane(d, p1, p2, shift, 0, border[i], mixdata[i]);
+      write_plane(d, p1, p2, shift, border[i], len32, mix_on);
+    }
+  }
+
+  void HUB75_Encoder::_finish_line(uint32_t* dst, uint_fast16_t y)
+  {
+    const uint32_t len32 = _cfg.panel_width >> 1;
+    const uint32_t panel_height = _cfg.panel_height;
+    const uint32_t transfer_period_count = getTransferPeriodCount(_cfg.depth);
+    const uint16_t* xe_tbl = _brightness_period;
+
+    { // SHIFTREG_ABCのY座標情報をセット;
+      // Bus_HUB75 は DMA バッファを巡回して使い、以前のY座標ビットを消去するため、定常状態では他の位置は消去済みとなる;
+      auto d32 = &dst[len32 * (transfer_period_count + 1)];
+      for (uint32_t i = 0; i < panel_height; ++i)
+      {
+        d32[i] = mask_pin_a_clk | mask_oe;
+      }
+      uint32_t poi = (~y) & ((panel_height >> 1) - 1);
+      d32[poi                      ] = mask_pin_a_clk | mask_oe | mask_pin_c_dat;
+      d32[poi + (panel_height >> 1)] = mask_pin_a_clk | mask_oe | mask_pin_c_dat;
+      // 末尾にラッチを追加;
+      d32[panel_height - 1] |= mask_pin_b_lat | mask_lat | mask_lat << 16;
+    }
+
+    // 無データ,点灯のみの期間の先頭の点灯防止処理
+    dst[0] |= mask_oe;
+    dst[1] |= (xe_tbl[transfer_period_count - 1] & 1) ? (mask_oe & ~0xFFFF) : mask_oe;
+
+    // データのラッチ及びラッチ直後の点灯防止処理
+    // (Bus_HUB75 と異なり負の添字を使わない。64bit環境では len32 * i - 1 が符号無しのまま拡張されるため)
+    for (uint32_t i = 0; i < transfer_period_count; ++i)
+    {
+      auto d32 = &dst[len32 * (i + 2)];
+      d32[-1] |= mask_lat;
+      d32[ 0] |= mask_oe;
+      d32[ 1] |= (xe_tbl[i] & 1) ? (mask_oe & ~0xFFFF) : mask_oe;
+    }
+  }
+
+  void HUB75_Encoder::encodeFrame(uint32_t* dst, const DividedFrameBuffer* frame_buffer, bool fast)
+  {
+    uint_fast16_t half = _cfg.panel_height >> 1;
+    size_t line_length = getLineLength();
+    for (uint_fast16_t y = 0; y < half; ++y)
+    {
+      encodeLine(&dst[y * line_length], y, frame_buffer->getLineBuffer(y), frame_buffer->getLineBuffer(y + half), fast);
+    }
+  }
+
+//----------------------------------------------------------------------------
+
+  bool HUB75_PanelLayout::init(uint_fast8_t panel_count, uint_fast16_t single_width, uint_fast16_t single_height, uint_fast16_t total_width, uint_fast16_t total_height)
+  {
+    if (_panel_position != nullptr) { return true; }
+    if (panel_count < 1) { return false; }
+
+    _panel_position = (panel_position_t*)heap_alloc(panel_count * sizeof(panel_position_t));
+    if (_panel_position == nullptr) { return false; }
+    _panel_count = panel_count;
+    _single_width = single_width;
+    _single_height = single_height;
+    memset(_panel_position, 0, panel_count * sizeof(panel_position_t));
+    memset(_x_hitcheck_mask, 0, sizeof(_x_hitcheck_mask));
+    memset(_y_hitcheck_mask, 0, sizeof(_y_hitcheck_mask));
+
+    uint32_t s = 0;
+    uint32_t tmp = total_width - 1;
+    while (tmp >>= 1) { ++s; }
+    _x_hitcheck_shift = (s > 2) ? (s - 2) : 0;
+
+    s = 0;
+    tmp = total_height - 1;
+    while (tmp >>= 1) { ++s; }
+    _y_hitcheck_shift = (s > 2) ? (s - 2) : 0;
+    return true;
+  }
+
+  void HUB75_PanelLayout::release(void)
+  {
+    if (_panel_position)
+    {
+      heap_free(_panel_position);
+      _panel_position = nullptr;
+    }
+    _panel_count = 0;
+  }
+
+  bool HUB75_PanelLayout::setPanelPosition(uint_fast8_t index, uint_fast16_t x, uint_fast16_t y, uint_fast8_t rotation)
+  {
+    if (_panel_position == nullptr) { return false; }
+    if (index < _panel_count)
+    {
+      _panel_position[index].x = x;
+      _panel_position[index].y = y;
+      _panel_position[index].rotation = rotation;
+
+      static constexpr const size_t x_size = sizeof(_x_hitcheck_mask) / sizeof(_x_hitcheck_mask[0]);
+      static constexpr const size_t y_size = sizeof(_y_hitcheck_mask) / sizeof(_y_hitcheck_mask[0]);
+
+      uint32_t mask_index = 1 << index;
+
+      auto w = _single_width;
+      auto h = _single_height;
+      if (rotation & 1)
+      {
+        std::swap(w, h);
+      }
+      for (size_t i = 0; i < x_size; ++i)
+      {
+        _x_hitcheck_mask[i] &= ~mask_index;
+      }
+      uint_fast16_t xe = (x + w - 1) >> _x_hitcheck_shift;
+      if (xe > x_size - 1) { xe = x_size - 1; }
+      x >>= _x_hitcheck_shift;
+      while (x <= xe)
+      {
+        _x_hitcheck_mask[x] |= mask_index;
+        ++x;
+      }
+
+      for (size_t i = 0; i < y_size; ++i)
+      {
+        _y_hitcheck_mask[i] &= ~mask_index;
+      }
+      uint_fast16_t ye = (y + h - 1) >> _y_hitcheck_shift;
+      if (ye > y_size - 1) { ye = y_size - 1; }
+      y >>= _y_hitcheck_shift;
+      while (y <= ye)
+      {
+        _y_hitcheck_mask[y] |= mask_index;
+        ++y;
+      }
+    }
+    return true;
+  }
+
+  bool HUB75_PanelLayout::toPhysical(uint_fast8_t panel_index, uint_fast16_t x, uint_fast16_t y, uint_fast16_t& ix, uint_fast16_t& iy) const
+  {
+    auto single_width = _single_width;
+    auto single_height = _single_height;
+    uint_fast8_t r = _panel_position[panel_index].rotation;
+    ix = x - _panel_position[panel_index].x;
+    iy = y - _panel_position[panel_index].y;
+    if (r & 1)
+    {
+      std::swap(ix, iy);
+    }
+    if (ix >= single_width) { return false; }
+    if (iy >= single_height) { return false; }
+    if (r)
+    {
+      r = 1 << r;
+      if (0b11001100 & r) { ix = single_width  - ix - 1; }
+      if (0b10010110 & r) { iy = single_height - iy - 1; }
+    }
+    ix += panel_index * single_width;
+    return true;
+  }
+
+  bool HUB75_PanelLayout::clipSpan(uint_fast8_t panel_index, uint_fast16_t y, uint_fast16_t& x, uint_fast16_t& w, uint_fast16_t& ix, uint_fast16_t& iy, int_fast8_t& dx, int_fast8_t& dy) const
+  {
+    auto single_width = _single_width;
+    auto single_height = _single_height;
+    auto& pos = _panel_position[panel_index];
+    uint_fast8_t r = pos.rotation;
+    uint_fast16_t pw = single_width;
+    uint_fast16_t ph = single_height;
+    if (r & 1)
+    {
+      std::swap(pw, ph);
+    }
+    if (y < pos.y || y >= pos.y + ph) { return false; }
+    uint_fast16_t xs = std::max<uint_fast16_t>(x, pos.x);
+    uint_fast16_t xe = std::min<uint_fast16_t>(x + w, pos.x + pw);
+    if (xs >= xe) { return false; }
+    x = xs;
+    w = xe - xs;
+
+    ix = x - pos.x;
+    iy = y - pos.y;
+    dx = 1;
+    dy = 0;
+    if (r & 1)
+    {
+      std::swap(ix, iy);
+      std::swap(dx, dy);
+    }
+    if (r)
+    {
+      r = 1 << r;
+      if (0b11001100 & r) { ix = single_width  - ix - 1; dx = -dx; }
+      if (0b10010110 & r) { iy = single_height - iy - 1; dy = -dy; }
+    }
+    ix += panel_index * single_width;
+    return true;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -0,0 +1,220 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "enum.hpp"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  class DividedFrameBuffer;
+
+  /// HUB75 パネル用に、フレームバッファの内容を BCM (Binary Code Modulation) のビットプレーン列へ変換する。
+  /// Bus_HUB75 の DMA バッファと同じ形式を生成し、デバイスに依存しないため PC 上で検証・計測できる;
+  /// Converts frame buffer lines into the binary-code-modulation bit planes sent to HUB75 panels,
+  /// in exactly the DMA line format used by Bus_HUB75. Nothing here touches the hardware, so the
+  /// gamma table, brightness periods and bit-plane packing can be tested and profiled on a PC.
+  ///
+  /// 1ライン分の出力 (uint32_t 単位、1要素に横2ピクセル分の 16bit データ) :
+  ///  [0]                 : データ無し点灯期間
+  ///  [1] ~ [N]           : 輝度ビット 0 ~ N-1 のデータ転送期間 (N = getTransferPeriodCount)
+  ///  [N+1] (panel_height): SHIFTREG_ABC のアドレス期間
+  /// Layout of one encoded line, in uint32_t units of two 16-bit samples (the first pixel of a
+  /// pair in the upper half): one lit-only period, N bit-plane periods of panel_width / 2 words
+  /// each, then panel_height words of shift-register address data.
+  class HUB75_Encoder
+  {
+  public:
+    static constexpr int32_t LINECHANGE_PERIOD_COUNT = 1;
+    static constexpr int32_t TRANSFER_PERIOD_COUNT_332 = 5;
+    static constexpr int32_t TRANSFER_PERIOD_COUNT_565 = 8;
+    static constexpr int32_t EXTEND_PERIOD_COUNT_332 = 2;
+    static constexpr int32_t EXTEND_PERIOD_COUNT_565 = 5;
+    static constexpr int32_t TOTAL_PERIOD_COUNT_332 = TRANSFER_PERIOD_COUNT_332 + EXTEND_PERIOD_COUNT_332 + LINECHANGE_PERIOD_COUNT;
+    static constexpr int32_t TOTAL_PERIOD_COUNT_565 = TRANSFER_PERIOD_COUNT_565 + EXTEND_PERIOD_COUNT_565 + LINECHANGE_PERIOD_COUNT;
+    static constexpr uint32_t mask_lat        = 0x00000040;
+    static constexpr uint32_t mask_oe         = 0x00800080;
+    static constexpr uint32_t mask_addr       = 0x1F001F00;
+    static constexpr uint32_t mask_pin_a_clk  = 0x00000100;
+    static constexpr uint32_t mask_pin_b_lat  = 0x02000200;
+    static constexpr uint32_t mask_pin_c_dat  = 0x04000400;
+
+    /// 1ライン分のデータ生成に使う作業領域。Bus_HUB75 のアセンブラ版と配置を共有している;
+    /// Work area for one line. The field offsets are shared with Bus_HUB75's Xtensa assembly.
+    struct work_t
+    {
+      uint32_t* d32;            //  0
+      uint32_t* s32h;           //  4
+      uint32_t* s32l;           //  8
+      uint32_t* pixel_tbl;      // 12
+      uint32_t* mixdata;        // 16
+      uint16_t* xe_tbl;         // 20
+      uint32_t len32;           // 24
+      uint32_t xe_idx;          // 28
+      uint32_t xe;              // 32
+      uint32_t mask3bit;        // 36
+      uint32_t mix_value;       // 40
+      uint32_t* _retaddr;       // 44 A0保管用
+    };
+
+    /// 輝度ビットの転送期間の数 (RGB332 は 5 、RGB565 は 8) ;
+    /// number of bit-plane periods per line: 5 for RGB332, 8 for RGB565.
+    static uint32_t getTransferPeriodCount(color_depth_t depth)
+    {
+      return (depth == color_depth_t::rgb565_2Byte) ? TRANSFER_PERIOD_COUNT_565 : TRANSFER_PERIOD_COUNT_332;
+    }
+
+    /// ガンマ補正テーブルの要素数 (RGB332 は 256 、RGB565 は 64) ;
+    /// entries in the gamma table: 256 for RGB332, 64 for RGB565.
+    static size_t getPixelTableLength(color_depth_t depth)
+    {
+      return (depth == color_depth_t::rgb565_2Byte) ? 64 : 256;
+    }
+
+    /// ガンマ補正とビット間隔の拡張を兼ねたテーブルを生成する;
+    /// Builds the gamma table that also spreads the bits for packing (see Bus_HUB75).
+    static void makePixelTable(uint32_t* tbl, color_depth_t depth);
+
+    /// 明るさに応じた各輝度ビットの点灯期間 (getTransferPeriodCount + 1 要素) を生成する;
+    /// Builds the lit length of every bit-plane period for a brightness (getTransferPeriodCount + 1 entries).
+    static void makeBrightnessPeriod(uint16_t* period, uint_fast16_t panel_width, uint8_t brightness, color_depth_t depth);
+
+    /// 1ライン分のビットプレーンを生成する (Bus_HUB75 のアセンブラ版と同じ結果になる) ;
+    /// Packs one line into bit planes, producing the same output as Bus_HUB75's assembly versions.
+    static void drawLine332(work_t* work);
+    static void drawLine565(work_t* work);
+
+//----------------------------------------------------------------------------
+
+    struct config_t
+    {
+      /// 連結したパネル全体の幅;
+      /// width of the whole chain.
+      uint16_t panel_width = 64;
+      uint16_t panel_height = 32;
+
+      /// rgb332_1Byte または rgb565_2Byte ;
+      color_depth_t depth = color_depth_t::rgb565_2Byte;
+
+      /// Bus_HUB75::config_t::address_mode が address_shiftreg の場合に true ;
+      /// true when Bus_HUB75::config_t::address_mode is address_shiftreg.
+      bool address_shiftreg = false;
+
+      uint8_t brightness = 128;
+    };
+
+    HUB75_Encoder(void) = default;
+    HUB75_Encoder(const HUB75_Encoder&) = delete;
+    HUB75_Encoder& operator=(const HUB75_Encoder&) = delete;
+    ~HUB75_Encoder(void) { release(); }
+
+    bool init(const config_t& config);
+    void release(void);
+
+    const config_t& config(void) const { return _cfg; }
+
+    void setBrightness(uint8_t brightness);
+
+    /// 1ライン分の出力の長さ (uint32_t 単位) ;
+    /// length of one encoded line in uint32_t units.
+    size_t getLineLength(void) const { return (_cfg.panel_width >> 1) * (getTransferPeriodCount(_cfg.depth) + 1) + _cfg.panel_height; }
+
+    /// ライン y (0 ~ panel_height/2-1) を生成する。upper は y ライン目、lower は y + panel_height/2 ライン目の画素。
+    /// fast が true の場合はビットプレーン毎に連続して書込む版を使う (結果は同じ) ;
+    /// Encodes line y from the pixels of rows y (upper) and y + panel_height / 2 (lower).
+    /// With fast, the planes are built one after another with contiguous stores instead of
+    /// the strided per-pixel stores of drawLine332/565; the output is identical.
+    void encodeLine(uint32_t* dst, uint_fast16_t y, const void* upper, const void* lower, bool fast = true);
+
+    /// 全ライン (panel_height / 2 本) を dst に連続して生成する;
+    /// Encodes all panel_height / 2 lines into dst, getLineLength() words apart.
+    void encodeFrame(uint32_t* dst, const DividedFrameBuffer* frame_buffer, bool fast = true);
+
+  protected:
+    config_t _cfg;
+    uint32_t* _pixel_tbl = nullptr;
+    uint32_t* _line_buf = nullptr;
+    uint16_t _brightness_period[TRANSFER_PERIOD_COUNT_565 + 1];
+
+    void _encode_pixels_fast(uint32_t* dst, const void* upper, const void* lower, const uint32_t* mixdata);
+    void _finish_line(uint32_t* dst, uint_fast16_t y);
+  };
+
+//----------------------------------------------------------------------------
+
+  /// 複数の HUB75 パネルを並べた仮想画面の座標から、各パネルの物理座標を求める;
+  /// Maps coordinates of a virtual screen made of several HUB75 panels to each panel's
+  /// position in the chained frame buffer (used by Panel_HUB75_Multi).
+  class HUB75_PanelLayout
+  {
+  public:
+    HUB75_PanelLayout(void) = default;
+    HUB75_PanelLayout(const HUB75_PanelLayout&) = delete;
+    HUB75_PanelLayout& operator=(const HUB75_PanelLayout&) = delete;
+    ~HUB75_PanelLayout(void) { release(); }
+
+    /// パネル枚数と1枚の大きさ、仮想画面の大きさを指定して初期化する (初期化済みの場合は何もしない) ;
+    /// Allocates the panel table; does nothing when already initialized.
+    bool init(uint_fast8_t panel_count, uint_fast16_t single_width, uint_fast16_t single_height, uint_fast16_t total_width, uint_fast16_t total_height);
+    void release(void);
+    bool isInitialized(void) const { return _panel_position != nullptr; }
+
+    bool setPanelPosition(uint_fast8_t index, uint_fast16_t x, uint_fast16_t y, uint_fast8_t rotation = 0);
+
+    /// 座標 (x, y) を含む可能性のあるパネルのビットマスク;
+    /// bit mask of the panels that may contain (x, y).
+    uint32_t getHitMask(uint_fast16_t x, uint_fast16_t y) const { return _x_hitcheck_mask[x >> _x_hitcheck_shift] & _y_hitcheck_mask[y >> _y_hitcheck_shift]; }
+    uint32_t getRowHitMask(uint_fast16_t y) const { return _y_hitcheck_mask[y >> _y_hitcheck_shift]; }
+
+    /// 仮想座標を panel_index のパネルの物理座標 (連結したフレームバッファ上の座標) へ変換する。範囲外なら false ;
+    /// Converts to the frame buffer coordinate of panel_index; false when outside that panel.
+    bool toPhysical(uint_fast8_t panel_index, uint_fast16_t x, uint_fast16_t y, uint_fast16_t& ix, uint_fast16_t& iy) const;
+
+    /// 仮想座標の範囲 [x, x+w) と panel_index のパネルとの重なりを求め、物理座標の開始位置と1ピクセル毎の移動量を返す;
+    /// Clips [x, x+w) on row y to panel_index and returns the physical start and per-pixel step.
+    bool clipSpan(uint_fast8_t panel_index, uint_fast16_t y, uint_fast16_t& x, uint_fast16_t& w, uint_fast16_t& ix, uint_fast16_t& iy, int_fast8_t& dx, int_fast8_t& dy) const;
+
+  protected:
+    struct panel_position_t
+    {
+      uint16_t x;
+      uint16_t y;
+      uint8_t rotation;
+    };
+
+// 座標の上位3ビットを使用し、座標範囲に該当するパネルを判定するためのテーブル
+    uint32_t _x_hitcheck_mask[8];
+    uint32_t _y_hitcheck_mask[8];
+    uint8_t _x_hitcheck_shift = 0;
+    uint8_t _y_hitcheck_shift = 0;
+
+    panel_position_t* _panel_position = nullptr;
+    uint8_t _panel_count = 0;
+    uint16_t _single_width = 0;
+    uint16_t _single_height = 0;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
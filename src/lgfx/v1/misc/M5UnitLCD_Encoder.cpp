@@ -0,0 +1,274 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "M5UnitLCD_Encoder.hpp"
+#include "pixelcopy_simd.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+#if defined ( LGFX_PIXELCOPY_SIMD_X86 )
+ #include <emmintrin.h>
+ #if defined ( _MSC_VER )
+  #include <intrin.h>
+ #endif
+#elif defined ( LGFX_PIXELCOPY_SIMD_NEON )
+ #include <arm_neon.h>
+#endif
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+#if defined ( LGFX_PIXELCOPY_SIMD_X86 ) || defined ( LGFX_PIXELCOPY_SIMD_NEON )
+ #define LGFX_UNITLCD_SIMD
+
+  /// a[i] == b[i] となるバイトの位置にビットが立つ 16bit のマスク;
+  static inline uint32_t equal_mask16(const uint8_t* a, const uint8_t* b)
+  {
+ #if defined ( LGFX_PIXELCOPY_SIMD_X86 )
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)a), _mm_loadu_si128((const __m128i*)b)));
+ #else
+    static constexpr uint8_t weight[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t t = vandq_u8(vceqq_u8(vld1q_u8(a), vld1q_u8(b)), vld1q_u8(weight));
+    uint8x8_t p = vpadd_u8(vget_low_u8(t), vget_high_u8(t));
+    p = vpadd_u8(p, p);
+    p = vpadd_u8(p, p);
+    return vget_lane_u16(vreinterpret_u16_u8(p), 0);
+ #endif
+  }
+
+  /// 最下位の立っているビットの位置 (m は 0 以外) ;
+  static inline uint32_t lowest_bit(uint32_t m)
+  {
+ #if defined ( _MSC_VER )
+    unsigned long idx;
+    _BitScanForward(&idx, m);
+    return idx;
+ #else
+    return __builtin_ctz(m);
+ #endif
+  }
+#endif
+
+  /// a から始まる画素と次の画素が同じか;
+  static inline bool same_as_next(const uint8_t* a, size_t bytes)
+  {
+    switch (bytes)
+    {
+    case 1: return a[0] == a[1];
+    case 2: return a[0] == a[2] && a[1] == a[3];
+    case 3: return a[0] == a[3] && a[1] == a[4] && a[2] == a[5];
+    default: return 0 == memcmp(a, &a[bytes], bytes);
+    }
+  }
+
+  /// 次の画素と同じ値を持つ最初の画素の位置。無ければ pixels ;
+  static size_t next_pair(const uint8_t* src, size_t pixels, size_t bytes)
+  {
+    if (pixels < 2) { return pixels; }
+    size_t p = 0;
+#if defined ( LGFX_UNITLCD_SIMD )
+    // 各バイトを1画素後のバイトと比較し、画素の全バイトが一致する位置を探す;
+    static constexpr uint16_t pixel_head[5] = { 0, 0xFFFF, 0x5555, 0x1249, 0x1111 };
+    if (bytes <= 4)
+    {
+      size_t step = 16 - (16 % bytes);
+      size_t limit = (pixels - 1) * bytes;
+      size_t k = 0;
+      for (; k + 16 <= limit; k += step)
+      {
+        uint32_t m = equal_mask16(&src[k], &src[k + bytes]);
+        for (size_t s = 1; s < bytes; ++s) { m &= m >> 1; }
+        m &= pixel_head[bytes];
+        if (m) { return (k + lowest_bit(m)) / bytes; }
+      }
+      p = k / bytes;
+    }
+#endif
+    for (; p + 1 < pixels; ++p)
+    {
+      if (same_as_next(&src[p * bytes], bytes)) { return p; }
+    }
+    return pixels;
+  }
+
+  size_t M5UnitLCD_Encoder::runLength(const uint8_t* src, size_t pixels, size_t bytes)
+  {
+    if (pixels < 2) { return pixels; }
+    // 1画素前の同じ位置のバイトと異なる最初のバイトが、連続の終わり;
+    size_t total = pixels * bytes;
+    size_t k = bytes;
+#if defined ( LGFX_UNITLCD_SIMD )
+    for (; k + 16 <= total; k += 16)
+    {
+      uint32_t m = equal_mask16(&src[k], &src[k - bytes]);
+      if (m != 0xFFFF) { return (k + lowest_bit(~m)) / bytes; }
+    }
+#else
+    for (; k + 4 <= total; k += 4)
+    {
+      uint32_t a, b;
+      memcpy(&a, &src[k], 4);
+      memcpy(&b, &src[k - bytes], 4);
+      if (a != b) { break; }
+    }
+#endif
+    for (; k < total; ++k)
+    {
+      if (src[k] != src[k - bytes]) { break; }
+    }
+    return k / bytes;
+  }
+
+  /// 符号化の本体。Store が false の場合は長さだけを数える。
+  /// 同じ領域内で符号化できるよう、元データを読んでから書込む順序にしている;
+  template <bool Store>
+  static size_t rle_parse(uint8_t* dst, const uint8_t* src, size_t pixels, size_t bytes)
+  {
+    size_t out = 0;
+    size_t i = 0;
+    while (i < pixels)
+    {
+      auto s = &src[i * bytes];
+      size_t run = M5UnitLCD_Encoder::runLength(s, pixels - i, bytes);
+      if (run >= 2)
+      {
+        do
+        {
+          size_t len = std::min<size_t>(run, 255);
+          if (Store)
+          {
+            memmove(&dst[out + 1], s, bytes);
+            dst[out] = len;
+          }
+          out += 1 + bytes;
+          run -= len;
+          i += len;
+        } while (run);
+        continue;
+      }
+
+      // 絶対モードは、中断しても長くならない連続が現れるまで続ける。
+      // 短い連続が並ぶ場合はまとめて評価し、絶対モードを再開する2バイトと比べる;
+      size_t e = i + 1;
+      while (e < pixels)
+      {
+        e += next_pair(&src[e * bytes], pixels - e, bytes);
+        if (e >= pixels) { break; }
+        size_t gain = 0;
+        size_t f = e;
+        do
+        {
+          size_t r = M5UnitLCD_Encoder::runLength(&src[f * bytes], pixels - f, bytes);
+          if (r < 2) { break; }
+          gain += (r - 1) * bytes - 1;
+          f += r;
+        } while (f < pixels && gain < 2);
+        if (gain >= 2 || (f == pixels && gain)) { break; }
+        e = f;
+      }
+
+      size_t n = e - i;
+      if (n < 3)
+      { // 絶対モードは3画素以上のため、1画素ずつ連続データとして送る;
+        do
+        {
+          if (Store)
+          {
+            memmove(&dst[out + 1], &src[i * bytes], bytes);
+            dst[out] = 1;
+          }
+          out += 1 + bytes;
+          ++i;
+        } while (--n);
+        continue;
+      }
+      do
+      {
+        size_t len = n;
+        if (len > 255) { len = (n - 255 < 3) ? n - 3 : 255; }
+        if (Store)
+        {
+          memmove(&dst[out + 2], &src[i * bytes], len * bytes);
+          dst[out    ] = 0;
+          dst[out + 1] = len;
+        }
+        out += 2 + len * bytes;
+        i += len;
+        n -= len;
+      } while (n);
+    }
+    return out;
+  }
+
+  size_t M5UnitLCD_Encoder::estimateRLE(const uint8_t* src, size_t pixels, size_t bytes)
+  {
+    return rle_parse<false>(nullptr, src, pixels, bytes);
+  }
+
+  size_t M5UnitLCD_Encoder::encodeRLE(uint8_t* dst, const uint8_t* src, size_t pixels, size_t bytes)
+  {
+    return rle_parse<true>(dst, src, pixels, bytes);
+  }
+
+  size_t M5UnitLCD_Encoder::decodeRLE(uint8_t* dst, const uint8_t* src, size_t len, size_t bytes, size_t max_pixels)
+  {
+    size_t res = 0;
+    size_t idx = 0;
+    while (idx < len && res < max_pixels)
+    {
+      size_t n = src[idx++];
+      if (n == 0)
+      {
+        if (idx >= len) { break; }
+        size_t count = src[idx++];
+        n = std::min<size_t>(count, max_pixels - res);
+        n = std::min<size_t>(n, (len - idx) / bytes);
+        memcpy(&dst[res * bytes], &src[idx], n * bytes);
+        idx += count * bytes;
+      }
+      else
+      {
+        if (idx + bytes > len) { break; }
+        n = std::min<size_t>(n, max_pixels - res);
+        for (size_t i = 0; i < n; ++i)
+        {
+          memcpy(&dst[(res + i) * bytes], &src[idx], bytes);
+        }
+        idx += bytes;
+      }
+      res += n;
+    }
+    return res;
+  }
+
+  M5UnitLCD_Encoder::method_t M5UnitLCD_Encoder::select(const uint8_t* src, size_t pixels, size_t bytes, method_t current, size_t* rle_len)
+  {
+    size_t rle = estimateRLE(src, pixels, bytes);
+    if (rle_len) { *rle_len = rle; }
+    size_t raw = pixels * bytes;
+    if      (current == method_t::method_raw) { rle += command_switch_cost; }
+    else if (current == method_t::method_rle) { raw += command_switch_cost; }
+    return (raw < rle) ? method_t::method_raw : method_t::method_rle;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -0,0 +1,88 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// M5UnitLCD へ送る画素データの圧縮。CMD_WRITE_RLE の形式で符号化し、
+  /// 送信量の見積りから生データ (CMD_WRITE_RAW) と RLE のどちらで送るかを選ぶ;
+  /// Pixel stream encoder for Panel_M5UnitLCD. It produces the CMD_WRITE_RLE format and, from a
+  /// one pass size estimate, decides whether a span goes out raw (CMD_WRITE_RAW) or RLE encoded.
+  /// Nothing here touches the bus, so the encoder can be tested and profiled on a PC.
+  ///
+  /// RLE の形式 (bytes は1画素のバイト数 1 ~ 4) :
+  ///  [n] [画素]            : 同じ画素が n 個 (1 ~ 255) 続く
+  ///  [0] [n] [画素 x n]    : n 個 (3 ~ 255) の画素をそのまま並べる (絶対モード)
+  /// RLE records: a count of 1 .. 255 followed by one pixel repeated that many times, or a zero,
+  /// a count of 3 .. 255 and that many literal pixels.
+  class M5UnitLCD_Encoder
+  {
+  public:
+    enum method_t : uint8_t
+    {
+      /// 送信中のコマンドが無い (どちらを選んでも切替のコストは掛からない) ;
+      /// no pixel write in progress, so neither method pays for a command switch.
+      method_none,
+      method_raw,
+      method_rle,
+    };
+
+    /// 送信コマンドを切替える際の余分なコスト (I2C の STOP / START とアドレス、コマンドのバイト数相当) ;
+    /// Extra cost, in bytes, of switching between CMD_WRITE_RAW and CMD_WRITE_RLE: the I2C
+    /// stop / start, the address byte and the command byte.
+    static constexpr size_t command_switch_cost = 4;
+
+    /// 同じ画素の連続数 (src の先頭から、最大 pixels) ;
+    /// Number of pixels equal to the first one, at most pixels.
+    static size_t runLength(const uint8_t* src, size_t pixels, size_t bytes);
+
+    /// src を RLE で符号化した場合のバイト数。符号化と同じ処理で長さだけを数える;
+    /// Size of the RLE encoding of src, counted by the same parse encodeRLE uses.
+    static size_t estimateRLE(const uint8_t* src, size_t pixels, size_t bytes);
+
+    /// 符号化で生データより増える分の上限;
+    /// Upper bound of how much the RLE output can exceed pixels * bytes at any point.
+    static size_t encodeMargin(size_t pixels) { return (pixels >> 6) + 8; }
+
+    /// src を RLE で dst に符号化し、書込んだバイト数を返す。
+    /// dst が src より encodeMargin(pixels) 以上前にあれば、同じバッファ内で重なっていてもよい;
+    /// Encodes src into dst and returns the bytes written. dst may overlap src when it starts at
+    /// least encodeMargin(pixels) bytes before it, so the panel can encode in place in its DMA buffer.
+    static size_t encodeRLE(uint8_t* dst, const uint8_t* src, size_t pixels, size_t bytes);
+
+    /// RLE を復号して画素数を返す (ユニット側の処理と同じ。検証用) ;
+    /// Decodes RLE data as the unit does and returns the pixel count; used for verification.
+    static size_t decodeRLE(uint8_t* dst, const uint8_t* src, size_t len, size_t bytes, size_t max_pixels);
+
+    /// 送信量が少なくなる方式を選ぶ。current は直前に使った方式で、切替える場合は command_switch_cost を加算する。
+    /// 同じ長さであれば RLE を選ぶ。rle_len には RLE で送る場合の長さが入る;
+    /// Picks the method that puts fewer bytes on the bus, charging command_switch_cost to a
+    /// change away from current; ties go to RLE. rle_len receives the estimated RLE size.
+    static method_t select(const uint8_t* src, size_t pixels, size_t bytes, method_t current, size_t* rle_len = nullptr);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -0,0 +1,119 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "SpanMask.hpp"
+#include "../platforms/common.hpp"
+
+#include <string.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// 画素の値を pixelcopy_t の比較と同じ形で読む;
+  template <uint_fast8_t Bytes>
+  static inline uint32_t load_raw(const uint8_t* p)
+  {
+    switch (Bytes)
+    {
+    case 1: return p[0];
+    case 2: { uint16_t v; memcpy(&v, p, 2); return v; }
+    default: return p[0] | p[1] << 8 | p[2] << 16;
+    }
+  }
+
+  /// 1行の不透明な区間を求める。spans が nullptr の場合は数だけを返す;
+  template <uint_fast8_t Bytes>
+  static size_t scan_row(const uint8_t* row, uint32_t width, uint32_t transp, SpanMask::span_t* spans)
+  {
+    size_t count = 0;
+    uint32_t x = 0;
+    while (x < width)
+    {
+      while (load_raw<Bytes>(&row[x * Bytes]) == transp)
+      {
+        if (++x == width) { return count; }
+      }
+      uint32_t start = x;
+      while (++x < width && load_raw<Bytes>(&row[x * Bytes]) != transp);
+      if (spans)
+      {
+        spans[count].x = start;
+        spans[count].length = x - start;
+      }
+      ++count;
+    }
+    return count;
+  }
+
+  template <uint_fast8_t Bytes>
+  static size_t scan_image(const uint8_t* img, uint32_t stride, uint32_t width, uint32_t height, uint32_t transp, uint32_t* row_index, SpanMask::span_t* spans)
+  {
+    size_t total = 0;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+      if (row_index) { row_index[y] = total; }
+      total += scan_row<Bytes>(&img[y * stride * Bytes], width, transp, spans ? &spans[total] : nullptr);
+    }
+    if (row_index) { row_index[height] = total; }
+    return total;
+  }
+
+  static size_t scan(const uint8_t* img, uint32_t stride, uint32_t width, uint32_t height, uint_fast8_t bytes, uint32_t transp, uint32_t* row_index, SpanMask::span_t* spans)
+  {
+    switch (bytes)
+    {
+    case 1:  return scan_image<1>(img, stride, width, height, transp, row_index, spans);
+    case 2:  return scan_image<2>(img, stride, width, height, transp, row_index, spans);
+    default: return scan_image<3>(img, stride, width, height, transp, row_index, spans);
+    }
+  }
+
+  bool SpanMask::build(const void* img, uint32_t stride, uint32_t width, uint32_t height, uint_fast8_t bytes, uint32_t transp)
+  {
+    release();
+    if (img == nullptr || bytes < 1 || bytes > 3 || width == 0 || height == 0 || width > UINT16_MAX || height > UINT16_MAX) { return false; }
+
+    auto src = static_cast<const uint8_t*>(img);
+    /// 区間の数を数えてから、必要な分だけ確保して書込む;
+    size_t total = scan(src, stride, width, height, bytes, transp, nullptr, nullptr);
+    _row_index = static_cast<uint32_t*>(heap_alloc((height + 1) * sizeof(uint32_t)));
+    _spans = static_cast<span_t*>(heap_alloc((total ? total : 1) * sizeof(span_t)));
+    if (_row_index == nullptr || _spans == nullptr)
+    {
+      release();
+      return false;
+    }
+    scan(src, stride, width, height, bytes, transp, _row_index, _spans);
+    _transp = transp;
+    _width = width;
+    _height = height;
+    return true;
+  }
+
+  void SpanMask::release(void)
+  {
+    if (_row_index) { heap_free(_row_index); _row_index = nullptr; }
+    if (_spans) { heap_free(_spans); _spans = nullptr; }
+    _width = _height = 0;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
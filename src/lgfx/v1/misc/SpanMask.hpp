@@ -0,0 +1,81 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// 透過色を持つ画像の、行ごとの不透明な区間の一覧。
+  /// 一度作成すれば、転送時に画素ごとに透過色と比較する必要が無くなる;
+  /// Per row list of the opaque spans of an image with a transparent color. Once built, a keyed
+  /// push only copies the spans: no per pixel comparison, and nothing at all for rows that are
+  /// entirely transparent. Images of 1 to 3 bytes per pixel are supported.
+  class SpanMask
+  {
+  public:
+    struct span_t
+    {
+      uint16_t x;
+      uint16_t length;
+    };
+
+    SpanMask(void) = default;
+    SpanMask(const SpanMask&) = delete;
+    SpanMask& operator=(const SpanMask&) = delete;
+    ~SpanMask(void) { release(); }
+
+    /// img は stride 画素毎に1行。transp は画像と同じ形式の値 (pixelcopy_t::transp と同じ) ;
+    /// img holds rows of stride pixels of bytes each; transp is a raw value in the image's own
+    /// format, as in pixelcopy_t::transp. Returns false for unsupported formats or out of memory.
+    bool build(const void* img, uint32_t stride, uint32_t width, uint32_t height, uint_fast8_t bytes, uint32_t transp);
+    void release(void);
+
+    bool isBuilt(void) const { return _row_index != nullptr; }
+    uint32_t getTransparent(void) const { return _transp; }
+    uint32_t getWidth(void) const { return _width; }
+    uint32_t getHeight(void) const { return _height; }
+
+    /// 作成元の画像の更新回数。利用側で保持し、画像が変化していないかの判定に使う;
+    /// Caller supplied stamp of the image the mask was built from, used to detect later writes.
+    uint32_t getStamp(void) const { return _stamp; }
+    void setStamp(uint32_t stamp) { _stamp = stamp; }
+
+    size_t getSpanCount(uint32_t y) const { return _row_index[y + 1] - _row_index[y]; }
+    const span_t* getSpans(uint32_t y) const { return &_spans[_row_index[y]]; }
+    /// 行全体が不透明か;
+    /// true when row y has no transparent pixel.
+    bool isOpaqueRow(uint32_t y) const { return getSpanCount(y) == 1 && _spans[_row_index[y]].length == _width; }
+
+  protected:
+    uint32_t* _row_index = nullptr;
+    span_t* _spans = nullptr;
+    uint32_t _transp = 0;
+    uint32_t _stamp = 0;
+    uint16_t _width = 0;
+    uint16_t _height = 0;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
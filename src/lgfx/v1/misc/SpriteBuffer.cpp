@@ -29,7 +29,7 @@ namespace lgfx
  {
 //----------------------------------------------------------------------------
 
-  SpriteBuffer::SpriteBuffer(size_t length, AllocationSource source) : _buffer(nullptr), _length(0), _source(source)
+  SpriteBuffer::SpriteBuffer(size_t length, AllocationSource source) : _buffer(nullptr), _length(0), _capacity(0), _source(source)
   {
     if (length)
     {
@@ -38,12 +38,13 @@ namespace lgfx
     }
   }
 
-  SpriteBuffer::SpriteBuffer(const SpriteBuffer& rhs) : _buffer(nullptr)
+  SpriteBuffer::SpriteBuffer(const SpriteBuffer& rhs) : _buffer(nullptr), _length(0), _capacity(0)
   {
     if ( rhs._source == AllocationSource::Preallocated )
     {
       this->_buffer = rhs._buffer;
       this->_length = rhs._length;
+      this->_capacity = rhs._capacity;
       this->_source = rhs._source;
     }
     else
@@ -56,11 +57,12 @@ namespace lgfx
     }
   }
 
-  SpriteBuffer::SpriteBuffer(SpriteBuffer&& rhs) : _buffer(nullptr)
+  SpriteBuffer::SpriteBuffer(SpriteBuffer&& rhs) : _buffer(nullptr), _length(0), _capacity(0)
   {
     if ( rhs._source == AllocationSource::Preallocated ) {
       this->_buffer = rhs._buffer;
       this->_length = rhs._length;
+      this->_capacity = rhs._capacity;
       this->_source = rhs._source;
     }
     else {
@@ -77,6 +79,7 @@ namespace lgfx
     if ( rhs._source == AllocationSource::Preallocated ) {
       this->_buffer = rhs._buffer;
       this->_length = rhs._length;
+      this->_capacity = rhs._capacity;
       this->_source = rhs._source;
     }
     else {
@@ -93,6 +96,7 @@ namespace lgfx
     if( rhs._source == AllocationSource::Preallocated ) {
       this->_buffer = rhs._buffer;
       this->_length = rhs._length;
+      this->_capacity = rhs._capacity;
       this->_source = rhs._source;
     }
     else {
@@ -111,10 +115,17 @@ namespace lgfx
     _source = AllocationSource::Preallocated;
     _buffer = reinterpret_cast<uint8_t*>(buffer);
     _length = 0;
+    _capacity = 0;
   }
 
   void SpriteBuffer::reset(size_t length, AllocationSource source)
   {
+    if (_buffer != nullptr && _source == source && source != AllocationSource::Preallocated
+     && length <= _capacity && length >= (_capacity >> 1))
+    {
+      _length = length;
+      return;
+    }
     this->release();
     void* buffer = nullptr;
     _source = source;
@@ -139,11 +150,13 @@ namespace lgfx
     _buffer = reinterpret_cast<uint8_t*>(buffer);
     if ( _buffer != nullptr ) {
       _length = length;
+      _capacity = length;
     }
   }
 
   void SpriteBuffer::release(void) {
     _length = 0;
+    _capacity = 0;
     if ( _buffer != nullptr ) {
       if (_source != AllocationSource::Preallocated)
       {
@@ -17,6 +17,8 @@ Contributors:
 /----------------------------------------------------------------------------*/
 #pragma once
 
+#include "Allocator.hpp"
+
 #include <stdint.h>
 #include <stddef.h>
 
@@ -28,27 +30,20 @@ namespace lgfx
 
   struct bgr888_t;
 
-  enum AllocationSource
-  {
-    Normal,
-    Dma,
-    Psram,
-    Preallocated,
-  };
-
   class SpriteBuffer
   {
   private:
     uint8_t* _buffer;
     size_t _length;
+    size_t _capacity;
     AllocationSource _source;
 
   public:
-    SpriteBuffer(void) : _buffer(nullptr), _length(0), _source(Dma) {}
+    SpriteBuffer(void) : _buffer(nullptr), _length(0), _capacity(0), _source(Dma) {}
 
     SpriteBuffer(size_t length, AllocationSource source = AllocationSource::Dma);
 
-    SpriteBuffer(uint8_t* buffer, size_t length) : _buffer(buffer), _length(length), _source(AllocationSource::Preallocated)
+    SpriteBuffer(uint8_t* buffer, size_t length) : _buffer(buffer), _length(length), _capacity(length), _source(AllocationSource::Preallocated)
     {
     }
 
@@ -71,6 +66,9 @@ namespace lgfx
 
     void reset(void* buffer);
 
+    /// 同じ確保元で、確保済みの領域に収まり半分以上を使う場合は、解放せずにそのまま使う;
+    /// Keeps the current allocation when it comes from the same source and length fits in it
+    /// while using at least half of it, so resizing a sprite does not go back to the heap.
     void reset(size_t length, AllocationSource source);
 
     void release(void);
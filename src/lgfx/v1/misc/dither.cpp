@@ -0,0 +1,301 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "dither.hpp"
+#include "pixelcopy_simd.hpp"
+#include "../platforms/common.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+#if defined ( LGFX_PIXELCOPY_SIMD_X86 )
+ #include <emmintrin.h>
+#elif defined ( LGFX_PIXELCOPY_SIMD_NEON )
+ #include <arm_neon.h>
+#endif
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// 閾値テーブル。値 T は 0 ~ 255 で、階調値は ((gray * (levels-1)) の 1/256 単位の値 + T) >> 8 ;
+  /// Threshold maps. A level is (gray scaled to (levels - 1) * 256 + T) >> 8.
+  static constexpr uint8_t bayer4[16] =
+  {   8, 136,  40, 168,
+    200,  72, 232, 104,
+     56, 184,  24, 152,
+    248, 120, 216,  88,
+  };
+
+  static constexpr uint8_t bayer8[64] =
+  {   2, 130,  34, 162,  10, 138,  42, 170,
+    194,  66, 226,  98, 202,  74, 234, 106,
+     50, 178,  18, 146,  58, 186,  26, 154,
+    242, 114, 210,  82, 250, 122, 218,  90,
+     14, 142,  46, 174,   6, 134,  38, 166,
+    206,  78, 238, 110, 198,  70, 230, 102,
+     62, 190,  30, 158,  54, 182,  22, 150,
+    254, 126, 222,  94, 246, 118, 214,  86,
+  };
+
+  /// void-and-cluster 法で生成した 16x16 のブルーノイズ;
+  /// 16x16 blue noise made with the void-and-cluster method.
+  static constexpr uint8_t blue_noise16[256] =
+  { 108, 244,   5,  86, 156, 250,   9,  92, 238, 165,  21,  85, 233,  44,  69, 218,
+     52, 188, 138, 210,  63, 111, 178, 151,  29, 104, 224, 182,   1, 157, 198, 131,
+    230,  79,  34, 172,  16, 223,  38,  66, 207, 130,  58, 145, 110, 247,  90,  26,
+    163, 102, 251, 119, 203,  95, 133, 245,  87, 186,  14, 208,  67,  37, 140, 179,
+     59,  19, 150,  45,  77, 162, 197,   4, 169,  48, 234,  94, 168, 221,  12, 206,
+    239, 129, 212, 181, 236,  23,  56, 103, 217, 147, 114,  27, 195, 124,  75, 112,
+    191,  89,   2,  65, 106, 144, 252, 127,  32,  74, 242, 135,  53, 255, 159,  43,
+     31, 171, 137, 229,  36, 192,  84, 184, 158, 200,  18, 173,  88,   6, 101, 225,
+    117, 246,  80, 164, 122, 220,   8,  49, 231,  99,  60, 222, 154, 215, 183,  68,
+    209,  10,  50, 201,  22,  97, 149,  72, 121,  13, 193, 113,  39, 128,  24, 141,
+    174, 105, 148, 235,  64, 175, 243, 205, 166, 249, 143,  70, 237,  82, 199,  55,
+    219,  33,  83, 189, 115,  42, 134,  25,  54,  91,  35, 185,   3, 152, 248,  93,
+    123, 160, 253, 132,   0, 226,  81, 107, 190, 216, 126, 227, 167, 109,  47,  15,
+    228,  57,  20,  71, 214, 161, 180, 240,   7, 155,  78,  17,  62, 211, 139, 187,
+     96, 177, 202, 146, 100,  28,  61, 142,  41, 116, 254, 176,  98,  30, 241,  76,
+    153,  40, 118, 232,  46, 194, 125, 213,  73, 196,  51, 136, 204, 120, 170,  11,
+  };
+
+  /// 8bit の輝度を (levels-1) * 256 を最大とする値に変換する。255 は必ず最大の階調になる;
+  /// Scales gray to 0 .. (levels - 1) * 256, so that 255 always reaches the top level.
+  static inline uint32_t scale_gray(uint32_t gray, uint32_t mul)
+  {
+    uint32_t x = gray * mul;
+    return x + ((x + 255) >> 8);
+  }
+
+  static void get_threshold_map(dither_mode_t mode, const uint8_t*& tbl, uint32_t& shift)
+  {
+    switch (mode)
+    {
+    case dither_mode_t::dither_bayer4:     tbl = bayer4;       shift = 2; break;
+    case dither_mode_t::dither_blue_noise: tbl = blue_noise16; shift = 4; break;
+    default:                               tbl = bayer8;       shift = 3; break;
+    }
+  }
+
+  /// dst[i] = (scale_gray(gray[i]) + thr[i]) >> 8 。dst と thr は同じ領域でもよい;
+  /// dst may alias thr.
+  static void quantize_row(uint8_t* dst, const uint8_t* gray, const uint8_t* thr, uint32_t length, uint32_t mul)
+  {
+    uint32_t i = 0;
+#if defined ( LGFX_PIXELCOPY_SIMD_X86 )
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m = _mm_set1_epi16(mul);
+    const __m128i c255 = _mm_set1_epi16(255);
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i g = _mm_loadu_si128((const __m128i*)&gray[i]);
+      __m128i t = _mm_loadu_si128((const __m128i*)&thr[i]);
+      __m128i xl = _mm_mullo_epi16(_mm_unpacklo_epi8(g, zero), m);
+      __m128i xh = _mm_mullo_epi16(_mm_unpackhi_epi8(g, zero), m);
+      xl = _mm_add_epi16(xl, _mm_srli_epi16(_mm_add_epi16(xl, c255), 8));
+      xh = _mm_add_epi16(xh, _mm_srli_epi16(_mm_add_epi16(xh, c255), 8));
+      xl = _mm_srli_epi16(_mm_add_epi16(xl, _mm_unpacklo_epi8(t, zero)), 8);
+      xh = _mm_srli_epi16(_mm_add_epi16(xh, _mm_unpackhi_epi8(t, zero)), 8);
+      _mm_storeu_si128((__m128i*)&dst[i], _mm_packus_epi16(xl, xh));
+    }
+#elif defined ( LGFX_PIXELCOPY_SIMD_NEON )
+    const uint8x8_t m = vdup_n_u8(mul);
+    const uint16x8_t c255 = vdupq_n_u16(255);
+    for (; i + 8 <= length; i += 8)
+    {
+      uint16x8_t x = vmull_u8(vld1_u8(&gray[i]), m);
+      x = vaddq_u16(x, vshrq_n_u16(vaddq_u16(x, c255), 8));
+      x = vaddq_u16(x, vmovl_u8(vld1_u8(&thr[i])));
+      vst1_u8(&dst[i], vshrn_n_u16(x, 8));
+    }
+#endif
+    for (; i < length; ++i)
+    {
+      dst[i] = (scale_gray(gray[i], mul) + thr[i]) >> 8;
+    }
+  }
+
+//----------------------------------------------------------------------------
+
+  void Ditherer::release(void)
+  {
+    for (auto& e : _err)
+    {
+      if (e) { heap_free(e); e = nullptr; }
+    }
+    _err_capacity = 0;
+    _err_column_end = 0;
+  }
+
+  void Ditherer::setLevels(uint_fast8_t levels)
+  {
+    levels = std::min<uint_fast8_t>(16, std::max<uint_fast8_t>(2, levels));
+    if (_levels != levels)
+    {
+      _levels = levels;
+      resetError();
+    }
+  }
+
+  void Ditherer::resetError(void)
+  {
+    _err_column_end = 0;
+    if (_err_capacity == 0) { return; }
+    for (auto e : _err)
+    {
+      memset(e, 0, (_err_capacity + 4) * sizeof(int16_t));
+    }
+  }
+
+  bool Ditherer::_reserve_error(uint32_t columns)
+  {
+    if (columns <= _err_capacity) { return true; }
+    uint32_t capacity = (std::max(columns, _err_capacity * 2) + 63) & ~63u;
+    int16_t* rows[3];
+    for (size_t i = 0; i < 3; ++i)
+    {
+      rows[i] = (int16_t*)heap_alloc((capacity + 4) * sizeof(int16_t));
+      if (rows[i] == nullptr)
+      {
+        while (i--) { heap_free(rows[i]); }
+        return false;
+      }
+      memset(rows[i], 0, (capacity + 4) * sizeof(int16_t));
+      if (_err[i])
+      {
+        memcpy(rows[i], _err[i], (_err_capacity + 4) * sizeof(int16_t));
+        heap_free(_err[i]);
+      }
+      _err[i] = rows[i];
+    }
+    _err_capacity = capacity;
+    return true;
+  }
+
+  void Ditherer::_next_error_row(void)
+  {
+    auto e = _err[0];
+    _err[0] = _err[1];
+    _err[1] = _err[2];
+    _err[2] = e;
+    memset(e, 0, (_err_capacity + 4) * sizeof(int16_t));
+  }
+
+  void Ditherer::_threshold_row(dither_mode_t mode, uint8_t* dst, uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, int_fast8_t dx, int_fast8_t dy) const
+  {
+    const uint8_t* tbl;
+    uint32_t shift;
+    get_threshold_map(mode, tbl, shift);
+    uint32_t mask = (1u << shift) - 1;
+    uint32_t px = x + _offset_x;
+    uint32_t py = y + _offset_y;
+    if (dx == 1 && dy == 0)
+    { // パターン1周期分を作った後は倍々に複製する;
+      auto row = &tbl[(py & mask) << shift];
+      uint32_t i = 0;
+      for (; i < w && i <= mask; ++i)
+      {
+        dst[i] = row[(px + i) & mask];
+      }
+      while (i < w)
+      {
+        uint32_t len = std::min<uint32_t>(i, w - i);
+        memcpy(&dst[i], dst, len);
+        i += len;
+      }
+      return;
+    }
+    for (uint32_t i = 0; i < w; ++i)
+    {
+      dst[i] = tbl[(py & mask) << shift | (px & mask)];
+      px += dx;
+      py += dy;
+    }
+  }
+
+  uint_fast8_t Ditherer::pixel(dither_mode_t mode, uint_fast16_t x, uint_fast16_t y, uint_fast8_t gray) const
+  {
+    const uint8_t* tbl;
+    uint32_t shift;
+    get_threshold_map(mode, tbl, shift);
+    uint32_t mask = (1u << shift) - 1;
+    uint32_t t = tbl[((y + _offset_y) & mask) << shift | ((x + _offset_x) & mask)];
+    return (scale_gray(gray, _levels - 1) + t) >> 8;
+  }
+
+  void Ditherer::fillRow(dither_mode_t mode, uint8_t* dst, uint_fast8_t gray, uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, int_fast8_t dx, int_fast8_t dy) const
+  {
+    _threshold_row(mode, dst, x, y, w, dx, dy);
+    uint32_t v = scale_gray(gray, _levels - 1);
+    for (uint32_t i = 0; i < w; ++i)
+    {
+      dst[i] = (v + dst[i]) >> 8;
+    }
+  }
+
+  void Ditherer::imageRow(dither_mode_t mode, uint8_t* dst, const uint8_t* gray, uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, int_fast8_t dx, int_fast8_t dy, uint_fast16_t column)
+  {
+    uint32_t mul = _levels - 1;
+    bool diffusion = (mode == dither_mode_t::dither_floyd_steinberg || mode == dither_mode_t::dither_atkinson);
+    if (!diffusion || !_reserve_error(column + w))
+    {
+      _threshold_row(mode, dst, x, y, w, dx, dy);
+      quantize_row(dst, gray, dst, w, mul);
+      return;
+    }
+
+    if (column < _err_column_end) { _next_error_row(); }
+    _err_column_end = column + w;
+
+    // 誤差の各行は先頭に2要素の余白がある;
+    int16_t* e0 = &_err[0][column + 2];
+    int16_t* e1 = &_err[1][column + 2];
+    int16_t* e2 = &_err[2][column + 2];
+    const int32_t max_level = mul;
+    bool atkinson = (mode == dither_mode_t::dither_atkinson);
+
+    for (int32_t i = 0; i < (int32_t)w; ++i)
+    {
+      int32_t e = (int32_t)scale_gray(gray[i], mul) + e0[i];
+      int32_t q = std::min(max_level, std::max<int32_t>(0, (e + 128) >> 8));
+      int32_t r = e - (q << 8);
+      dst[i] = q;
+      if (atkinson)
+      { // 誤差の 6/8 を周囲へ配分する;
+        int32_t s = r / 8;
+        e0[i + 1] += s;
+        e0[i + 2] += s;
+        e1[i - 1] += s;
+        e1[i    ] += s;
+        e1[i + 1] += s;
+        e2[i    ] += s;
+      }
+      else
+      { // Floyd-Steinberg: 右 7/16 , 左下 3/16 , 下 5/16 , 右下 1/16 ;
+        e0[i + 1] += r * 7 / 16;
+        e1[i - 1] += r * 3 / 16;
+        e1[i    ] += r * 5 / 16;
+        e1[i + 1] += r     / 16;
+      }
+    }
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
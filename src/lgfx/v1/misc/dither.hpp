@@ -0,0 +1,96 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "enum.hpp"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// 8bit グレースケールを 2 ~ 16 階調へ減色する。1ライン単位で処理し、閾値パターンによる方式は
+  /// SIMD (SSE2 / NEON) で、誤差拡散は行を跨いだ誤差を保持して処理する;
+  /// Reduces 8-bit grayscale to 2 .. 16 levels a row at a time. Ordered modes quantize whole
+  /// rows with SSE2 / NEON where available; the error diffusion modes carry their error buffers
+  /// from one row to the next until resetError().
+  ///
+  /// 座標は閾値パターンの位置を決めるためのもので、(dx, dy) は行の1画素毎の移動量。
+  /// 回転したパネルでもパネル上の位置で模様が揃うよう、回転前のパネル座標を渡す;
+  /// Coordinates only select the threshold pattern phase; (dx, dy) is the step per pixel along
+  /// the row. Panels pass unrotated panel coordinates so the pattern lines up across rotations.
+  class Ditherer
+  {
+  public:
+    Ditherer(void) = default;
+    Ditherer(const Ditherer&) = delete;
+    Ditherer& operator=(const Ditherer&) = delete;
+    ~Ditherer(void) { release(); }
+
+    /// 誤差拡散用のバッファを解放する;
+    /// Frees the error diffusion buffers.
+    void release(void);
+
+    /// 出力の階調数 (2 ~ 16) 。変更した場合は蓄積した誤差を破棄する;
+    /// Number of output levels, 2 .. 16. Changing it discards the accumulated error.
+    void setLevels(uint_fast8_t levels);
+    uint_fast8_t getLevels(void) const { return _levels; }
+
+    /// 閾値パターンの開始位置をずらす;
+    /// Shifts the threshold pattern.
+    void setOffset(uint_fast8_t x, uint_fast8_t y) { _offset_x = x; _offset_y = y; }
+
+    /// 誤差拡散の蓄積を破棄する。画像や描画範囲の開始時に呼ぶ;
+    /// Discards the accumulated error; call it when a new image or window starts.
+    void resetError(void);
+
+    /// 1画素分の階調値 (0 ~ levels-1) ;
+    /// Level of a single pixel, 0 .. levels - 1.
+    uint_fast8_t pixel(dither_mode_t mode, uint_fast16_t x, uint_fast16_t y, uint_fast8_t gray) const;
+
+    /// 単色の1ライン分の階調値。閾値パターンのみを使う;
+    /// Levels for a row of one gray value, using the threshold pattern only.
+    void fillRow(dither_mode_t mode, uint8_t* dst, uint_fast8_t gray, uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, int_fast8_t dx = 1, int_fast8_t dy = 0) const;
+
+    /// 画像の1ライン分の階調値。column は誤差バッファ上の位置で、前回の呼出しの終端より手前の場合は次の行として扱う;
+    /// Levels for a row of an image. column is the position in the error buffers; a call whose
+    /// column lies before the end of the previous call starts a new row.
+    void imageRow(dither_mode_t mode, uint8_t* dst, const uint8_t* gray, uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, int_fast8_t dx = 1, int_fast8_t dy = 0, uint_fast16_t column = 0);
+
+  protected:
+    /// 誤差の各行 (現在の行、次の行、その次の行) 。左右に2要素ずつの余白を持つ;
+    /// error rows (current, next, the one after), each with two spare entries on both sides.
+    int16_t* _err[3] = { nullptr, nullptr, nullptr };
+    uint32_t _err_capacity = 0;
+    uint32_t _err_column_end = 0;
+    uint8_t _levels = 2;
+    uint8_t _offset_x = 0;
+    uint8_t _offset_y = 0;
+
+    void _threshold_row(dither_mode_t mode, uint8_t* dst, uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, int_fast8_t dx, int_fast8_t dy) const;
+    bool _reserve_error(uint32_t columns);
+    void _next_error_row(void);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -47,10 +47,30 @@ namespace lgfx
       epd_text    = 2,
       epd_fast    = 3,
       epd_fastest = 4,
+      /// 前回の表示との差分から更新範囲と波形を自動で選択する;
+      /// refresh only what changed, choosing the waveform per area.
+      epd_auto    = 5,
     };
   }
   using namespace epd_mode;
 
+  /// 単色・グレースケールのパネルで中間色を表現する方式。誤差拡散は画像の描画にのみ使用され、
+  /// 塗り潰しや1画素の描画では dither_bayer8 の閾値を使う;
+  /// How monochrome and grayscale panels render intermediate tones. The error diffusion modes
+  /// apply to image rows only; fills and single pixels use the dither_bayer8 pattern instead.
+  namespace dither_mode
+  {
+    enum dither_mode_t
+    {
+      dither_bayer4          = 1,
+      dither_bayer8          = 2,
+      dither_blue_noise      = 3,
+      dither_floyd_steinberg = 4,
+      dither_atkinson        = 5,
+    };
+  }
+  using namespace dither_mode;
+
 //----------------------------------------------------------------------------
 
   namespace colors  // Colour enumeration
@@ -250,3 +270,4 @@ using namespace lgfx::textdatum;
 using namespace lgfx::datum;
 using namespace lgfx::attribute;
 using namespace lgfx::epd_mode;
+using namespace lgfx::dither_mode;
@@ -0,0 +1,100 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+/// LGFX_PANEL_STATS を定義してビルドすると、パネルのエントリポイント毎の呼出し回数・ピクセル数・処理時間を計測する。
+/// 構造体のレイアウトが変わるため、ライブラリ全体を同じ定義でビルドすること;
+/// Define LGFX_PANEL_STATS to count calls / pixels / time per panel entry point.
+/// This changes the IPanel layout, so the whole library must be built with the same setting.
+
+#if defined ( LGFX_PANEL_STATS )
+
+#include <stdint.h>
+#include <string.h>
+
+#if __has_include(<chrono>)
+#include <chrono>
+#endif
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  struct panel_stats_t
+  {
+    struct entry_t
+    {
+      uint32_t calls;
+      uint64_t pixels;
+      uint64_t time_ns;  /// 累積処理時間 (ナノ秒) ; cumulative time spent in the call (nanoseconds)
+    };
+
+    entry_t setWindow;
+    entry_t writeBlock;
+    entry_t drawPixelPreclipped;
+    entry_t writeFillRectPreclipped;
+    entry_t writeImage;
+    entry_t writeImageARGB;
+    entry_t writePixels;
+    entry_t copyRect;
+    entry_t readRect;
+    entry_t display;
+
+    void reset(void) { memset(this, 0, sizeof(panel_stats_t)); }
+
+    static inline uint64_t now_ns(void)
+    {
+#if __has_include(<chrono>)
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+      return 0;
+#endif
+    }
+  };
+
+  /// スコープを抜けるまでの時間を entry に加算する;
+  /// Adds the time until the end of the scope to the entry.
+  struct panel_stats_scope_t
+  {
+    panel_stats_scope_t(panel_stats_t::entry_t& entry, uint64_t pixels) : _entry(entry), _start(panel_stats_t::now_ns())
+    {
+      ++entry.calls;
+      entry.pixels += pixels;
+    }
+    ~panel_stats_scope_t(void) { _entry.time_ns += panel_stats_t::now_ns() - _start; }
+
+  private:
+    panel_stats_t::entry_t& _entry;
+    uint64_t _start;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
+
+ #define LGFX_PANEL_STATS_CONCAT_IMPL(a, b) a##b
+ #define LGFX_PANEL_STATS_CONCAT(a, b) LGFX_PANEL_STATS_CONCAT_IMPL(a, b)
+ #define LGFX_PANEL_STATS_SCOPE(panel, entry, pixels) lgfx::panel_stats_scope_t LGFX_PANEL_STATS_CONCAT(lgfx_panel_stats_scope_, __LINE__) { (panel)->getStats().entry, (uint64_t)(pixels) }
+
+#else
+
+ #define LGFX_PANEL_STATS_SCOPE(panel, entry, pixels)
+
+#endif
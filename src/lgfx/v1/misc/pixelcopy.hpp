@@ -20,6 +20,7 @@ Contributors:
 #include <string.h>
 
 #include "colortype.hpp"
+#include "pixelcopy_simd.hpp"
 
 namespace lgfx
 {
@@ -167,6 +168,12 @@ namespace lgfx
       }
       else
       {
+        auto fn = convert_row_t<TDst, TSrc>::get();
+        if (fn != nullptr && (last - index) >= 16)
+        {
+          fn(&d[index], &s[index], last - index);
+          return last;
+        }
         do {
           d[index].set(color_convert<TDst, TSrc>(s[index].get()));
         } while (++index != last);
@@ -202,6 +209,16 @@ namespace lgfx
       auto src_y32_add = param->src_y32_add;
       auto src_x32 = param->src_x32;
       auto src_y32 = param->src_y32;
+      if (src_x32_add == (1u << FP_SCALE) && src_y32_add == 0 && param->transp == NON_TRANSP && (last - index) >= 16)
+      { // 等倍・横方向の転送は行単位の変換カーネルを使う;
+        auto fn = convert_row_t<TDst, TSrc>::get();
+        if (fn != nullptr)
+        {
+          fn(&d[index], &s[(src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_bitwidth], last - index);
+          param->src_x32 = src_x32 + ((last - index) << FP_SCALE);
+          return last;
+        }
+      }
       do {
         uint32_t i = (src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_bitwidth;
         uint32_t raw = s[i].get();
@@ -357,6 +374,63 @@ namespace lgfx
       return last;
     }
 
+    /// (x,y)-(src_xe,src_ye) の範囲の画素を面積比で加算する。
+    /// Checked が false の場合、呼出し側で範囲全体が画像内にあることを保証すること;
+    template <typename TSrc, bool Checked>
+    static inline void accumulate_rgb_antialias(uint32_t* __restrict argb, const TSrc* color, int32_t x, int32_t y, int32_t src_width, int32_t src_height, const pixelcopy_t* __restrict param)
+    {
+      int32_t xe = param->src_xe;
+      int32_t ye = param->src_ye;
+      uint32_t transp = param->transp;
+      uint32_t rate_y = 256u - (param->src_y_lo >> 8);
+      uint32_t rate_x = 256u - (param->src_x_lo >> 8);
+      if (!Checked && xe == x + 1 && ye == y + 1 && transp == NON_TRANSP && !std::is_same<TSrc, argb8888_t>::value)
+      { // 等倍付近の回転で最も多い 2x2 の参照は分岐せずに加算する;
+        uint32_t rate_xe = (param->src_xe_lo >> 8) + 1;
+        uint32_t rate_ye = (param->src_ye_lo >> 8) + 1;
+        uint32_t r00 = rate_x  * rate_y;
+        uint32_t r01 = rate_xe * rate_y;
+        uint32_t r10 = rate_x  * rate_ye;
+        uint32_t r11 = rate_xe * rate_ye;
+        auto c1 = &color[src_width];
+        uint32_t total = r00 + r01 + r10 + r11;
+        argb[4] += total;
+        argb[3] += total;
+        argb[2] += color[0].R8() * r00 + color[1].R8() * r01 + c1[0].R8() * r10 + c1[1].R8() * r11;
+        argb[1] += color[0].G8() * r00 + color[1].G8() * r01 + c1[0].G8() * r10 + c1[1].G8() * r11;
+        argb[0] += color[0].B8() * r00 + color[1].B8() * r01 + c1[0].B8() * r10 + c1[1].B8() * r11;
+        return;
+      }
+      for (;;)
+      {
+        uint32_t rate = rate_x * rate_y;
+        argb[4] += rate;
+        if ((!Checked || (static_cast<uint32_t>(y) < static_cast<uint32_t>(src_height)
+                       && static_cast<uint32_t>(x) < static_cast<uint32_t>(src_width)))
+         && !(*color == transp))
+        {
+          if (std::is_same<TSrc, argb8888_t>::value) { rate *= color->A8(); }
+          argb[3] += rate;
+          argb[2] += color->R8() * rate;
+          argb[1] += color->G8() * rate;
+          argb[0] += color->B8() * rate;
+        }
+        if (x != xe)
+        {
+          ++color;
+          rate_x = (++x == xe) ? (param->src_xe_lo >> 8) + 1 : 256u;
+        }
+        else
+        {
+          if (++y > ye) break;
+          rate_y = (y == ye) ? (param->src_ye_lo >> 8) + 1 : 256u;
+          x = param->src_x;
+          color += x + src_width - xe;
+          rate_x = 256u - (param->src_x_lo >> 8);
+        }
+      }
+    }
+
     template <typename TSrc>
     static uint32_t copy_rgb_antialias(void* __restrict dst, uint32_t index, uint32_t last, pixelcopy_t* __restrict param)
     {
@@ -396,37 +470,16 @@ namespace lgfx
         else
         {
           uint32_t argb[5] = {0};
+          if (static_cast<uint32_t>(x) < static_cast<uint32_t>(src_width)
+           && static_cast<uint32_t>(y) < static_cast<uint32_t>(src_height)
+           && static_cast<uint32_t>(param->src_xe) < static_cast<uint32_t>(src_width)
+           && static_cast<uint32_t>(param->src_ye) < static_cast<uint32_t>(src_height))
+          { // 参照範囲が全て画像内にある場合は範囲チェックを省く;
+            accumulate_rgb_antialias<TSrc, false>(argb, color, x, y, src_width, src_height, param);
+          }
+          else
           {
-            uint32_t rate_y = 256u - (param->src_y_lo >> 8);
-            uint32_t rate_x = 256u - (param->src_x_lo >> 8);
-            for (;;)
-            {
-              uint32_t rate = rate_x * rate_y;
-              argb[4] += rate;
-              if (static_cast<uint32_t>(y) < static_cast<uint32_t>(src_height)
-               && static_cast<uint32_t>(x) < static_cast<uint32_t>(src_width)
-               && !(*color == param->transp))
-              {
-                if (std::is_same<TSrc, argb8888_t>::value) { rate *= color->A8(); }
-                argb[3] += rate;
-                argb[2] += color->R8() * rate;
-                argb[1] += color->G8() * rate;
-                argb[0] += color->B8() * rate;
-              }
-              if (x != param->src_xe)
-              {
-                ++color;
-                rate_x = (++x == param->src_xe) ? (param->src_xe_lo >> 8) + 1 : 256u;
-              }
-              else
-              {
-                if (++y > param->src_ye) break;
-                rate_y = (y == param->src_ye) ? (param->src_ye_lo >> 8) + 1 : 256u;
-                x = param->src_x;
-                color += x + src_width - param->src_xe;
-                rate_x = 256u - (param->src_x_lo >> 8);
-              }
-            }
+            accumulate_rgb_antialias<TSrc, true>(argb, color, x, y, src_width, src_height, param);
           }
           uint32_t a = argb[3];
           if (!a)
@@ -435,7 +488,8 @@ namespace lgfx
           }
           else
           {
-            d[index].set( (std::is_same<TSrc, argb8888_t>::value ? a : (a * 255)) / argb[4]
+            uint32_t opaque = std::is_same<TSrc, argb8888_t>::value ? argb[4] * 255 : argb[4];
+            d[index].set( (a == opaque) ? 255 : (std::is_same<TSrc, argb8888_t>::value ? a : (a * 255)) / argb[4]
                         , argb[2] / a
                         , argb[1] / a
                         , argb[0] / a
@@ -455,6 +509,16 @@ namespace lgfx
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
       auto s = static_cast<const argb8888_t*>(param->src_data);
+      if (src_x32_add == (1u << FP_SCALE) && src_y32_add == 0 && (last - index) >= 8)
+      { // 横方向に連続する場合は行単位のブレンドカーネルを使う;
+        auto fn = blend_row_t<TDst>::get();
+        if (fn != nullptr)
+        {
+          fn(&d[index], &s[param->src_x + param->src_y * param->src_bitwidth], last - index);
+          param->src_x32 += (last - index) << FP_SCALE;
+          return last;
+        }
+      }
       for (;;) {
         uint32_t i = param->src_x + param->src_y * param->src_bitwidth;
         uint_fast16_t a = s[i].a;
@@ -0,0 +1,868 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "pixelcopy_simd.hpp"
+
+#include <string.h>
+
+#if defined ( LGFX_PIXELCOPY_SIMD_X86 )
+ #include <immintrin.h>
+ #if defined ( _MSC_VER )
+  #include <intrin.h>
+  #define LGFX_TARGET_AVX2
+ #else
+  #define LGFX_TARGET_AVX2 __attribute__ ((target ("avx2")))
+ #endif
+#elif defined ( LGFX_PIXELCOPY_SIMD_NEON )
+ #include <arm_neon.h>
+#endif
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+#if defined ( LGFX_PIXELCOPY_SIMD_X86 ) || defined ( LGFX_PIXELCOPY_SIMD_NEON )
+
+  /// ベクタで処理しきれなかった端数を color_convert で変換する;
+  /// Converts the remainder that did not fill a vector with color_convert.
+  template <typename TDst, typename TSrc>
+  static void convert_tail(void* __restrict dst, const void* __restrict src, uint32_t index, uint32_t length)
+  {
+    auto d = static_cast<TDst*>(dst);
+    auto s = static_cast<const TSrc*>(src);
+    for (; index < length; ++index)
+    {
+      d[index].set(color_convert<TDst, TSrc>(s[index].get()));
+    }
+  }
+
+  template <typename TDst>
+  static void blend_tail(void* __restrict dst, const void* __restrict src, uint32_t index, uint32_t length)
+  {
+    auto d = static_cast<TDst*>(dst);
+    auto s = static_cast<const argb8888_t*>(src);
+    for (; index < length; ++index)
+    {
+      uint_fast16_t a = s[index].a;
+      if (a == 0) { continue; }
+      if (a == 255)
+      {
+        d[index].set(s[index].r, s[index].g, s[index].b);
+        continue;
+      }
+      uint_fast16_t inv = 256 - a;
+      ++a;
+      d[index].set( (d[index].R8() * inv + s[index].R8() * a) >> 8
+                  , (d[index].G8() * inv + s[index].G8() * a) >> 8
+                  , (d[index].B8() * inv + s[index].B8() * a) >> 8
+                  );
+    }
+  }
+
+  static void blend_bgra8888_tail(void* __restrict dst, const void* __restrict src, uint32_t index, uint32_t length)
+  {
+    auto d = static_cast<bgra8888_t*>(dst);
+    auto s = static_cast<const bgra8888_t*>(src);
+    for (; index < length; ++index)
+    {
+      uint_fast8_t a = s[index].a;
+      if (a == 0) { continue; }
+      if (a == 255)
+      {
+        d[index].set(s[index].get());
+        continue;
+      }
+      uint_fast8_t inv = 255 - a;
+      d[index].set( (s[index].r * a + d[index].r * inv + 255) >> 8
+                  , (s[index].g * a + d[index].g * inv + 255) >> 8
+                  , (s[index].b * a + d[index].b * inv + 255) >> 8
+                  );
+    }
+  }
+
+#endif
+
+#if defined ( LGFX_PIXELCOPY_SIMD_X86 )
+
+//----------------------------------------------------------------------------
+// SSE2
+
+  /// 4 つの dword (0x??BBGGRR) を先頭 12 byte に詰める。残り 4 byte は 0 になる;
+  /// Packs four 0x??BBGGRR dwords into the low 12 bytes, the upper 4 bytes become zero.
+  static inline __m128i pack_rgb24_sse2(__m128i v)
+  {
+    __m128i lo = _mm_and_si128(v, _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF));
+    __m128i hi = _mm_and_si128(_mm_srli_epi64(v, 8), _mm_set_epi32(0x0000FFFF, (int)0xFF000000, 0x0000FFFF, (int)0xFF000000));
+    v = _mm_or_si128(lo, hi);
+    return _mm_or_si128(_mm_move_epi64(v), _mm_slli_si128(_mm_srli_si128(v, 8), 6));
+  }
+
+  /// 12 byte の RGB24 を 4 つの dword に展開する (16 byte 読み込む);
+  /// Expands 12 bytes of RGB24 into four dwords; reads 16 bytes.
+  static inline __m128i load_rgb24_sse2(const uint8_t* p)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i t0 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+    __m128i t1 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+    return _mm_unpacklo_epi64(t0, t1);
+  }
+
+  static void bgr888_from_swap565_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint16_t*>(src);
+    const __m128i m07 = _mm_set1_epi16(0x07);
+    const __m128i m1C = _mm_set1_epi16(0x1C);
+    const __m128i mF8 = _mm_set1_epi16(0xF8);
+    uint32_t i = 0;
+    for (; i + 10 <= length; i += 8)
+    {
+      __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i]));
+      __m128i c7 = _mm_and_si128(c, m07);
+      __m128i r = _mm_or_si128(_mm_and_si128(c, mF8), _mm_and_si128(_mm_srli_epi16(c, 5), m07));
+      __m128i g = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(c7, 5), _mm_and_si128(_mm_srli_epi16(c, 11), m1C)), _mm_srli_epi16(c7, 1));
+      __m128i b = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(c, 5), mF8), _mm_and_si128(_mm_srli_epi16(c, 10), m07));
+      __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i * 3     ]), pack_rgb24_sse2(_mm_unpacklo_epi16(rg, b)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i * 3 + 12]), pack_rgb24_sse2(_mm_unpackhi_epi16(rg, b)));
+    }
+    convert_tail<bgr888_t, swap565_t>(dst, src, i, length);
+  }
+
+  static inline __m128i swap565_from_bgr888_dword_sse2(__m128i c)
+  {
+    __m128i r = _mm_or_si128(_mm_and_si128(c, _mm_set1_epi32(0xF8))
+                           , _mm_and_si128(_mm_srli_epi32(c, 13), _mm_set1_epi32(0x07)));
+    __m128i b = _mm_or_si128(_mm_and_si128(_mm_slli_epi32(c,  3), _mm_set1_epi32(0xE000))
+                           , _mm_and_si128(_mm_srli_epi32(c, 11), _mm_set1_epi32(0x1F00)));
+    r = _mm_or_si128(r, b);
+    return _mm_srai_epi32(_mm_slli_epi32(r, 16), 16); // packs_epi32 の飽和を避けるため符号拡張しておく;
+  }
+
+  static void swap565_from_bgr888_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint16_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 10 <= length; i += 8)
+    {
+      __m128i a = swap565_from_bgr888_dword_sse2(load_rgb24_sse2(&s[i * 3     ]));
+      __m128i b = swap565_from_bgr888_dword_sse2(load_rgb24_sse2(&s[i * 3 + 12]));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i]), _mm_packs_epi32(a, b));
+    }
+    convert_tail<swap565_t, bgr888_t>(dst, src, i, length);
+  }
+
+  static inline __m128i swap565_from_rgb332_word_sse2(__m128i c)
+  {
+    __m128i b = _mm_and_si128(c, _mm_set1_epi16(0x03));
+    b = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(b, 3), _mm_slli_epi16(b, 1)), _mm_srli_epi16(b, 1));
+    __m128i lo = _mm_or_si128(_mm_or_si128(_mm_and_si128(c, _mm_set1_epi16(0xE0))
+                                         , _mm_and_si128(_mm_srli_epi16(c, 3), _mm_set1_epi16(0x18)))
+                                         , _mm_and_si128(_mm_srli_epi16(c, 2), _mm_set1_epi16(0x07)));
+    __m128i hi = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(c, 11), _mm_set1_epi16((short)0xE000)), _mm_slli_epi16(b, 8));
+    return _mm_or_si128(lo, hi);
+  }
+
+  static void swap565_from_rgb332_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint16_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i]));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i    ]), swap565_from_rgb332_word_sse2(_mm_unpacklo_epi8(v, zero)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i + 8]), swap565_from_rgb332_word_sse2(_mm_unpackhi_epi8(v, zero)));
+    }
+    convert_tail<swap565_t, rgb332_t>(dst, src, i, length);
+  }
+
+  static inline __m128i swap565_from_grayscale_word_sse2(__m128i c)
+  {
+    __m128i lo = _mm_or_si128(_mm_and_si128(c, _mm_set1_epi16(0xF8)), _mm_srli_epi16(c, 5));
+    __m128i hi = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(c, 11), _mm_set1_epi16((short)0xE000))
+                            , _mm_and_si128(_mm_slli_epi16(c,  5), _mm_set1_epi16(0x1F00)));
+    return _mm_or_si128(lo, hi);
+  }
+
+  static void swap565_from_grayscale_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint16_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i]));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i    ]), swap565_from_grayscale_word_sse2(_mm_unpacklo_epi8(v, zero)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i + 8]), swap565_from_grayscale_word_sse2(_mm_unpackhi_epi8(v, zero)));
+    }
+    convert_tail<swap565_t, grayscale_t>(dst, src, i, length);
+  }
+
+  static void rgb332_from_grayscale_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i]));
+      // 16bit 単位のシフトで隣の byte から入ってくるビットはマスクで落とす;
+      v = _mm_or_si128(_mm_or_si128(_mm_and_si128(v, _mm_set1_epi8((char)0xE0))
+                                  , _mm_and_si128(_mm_srli_epi16(v, 3), _mm_set1_epi8(0x1C)))
+                                  , _mm_and_si128(_mm_srli_epi16(v, 6), _mm_set1_epi8(0x03)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i]), v);
+    }
+    convert_tail<rgb332_t, grayscale_t>(dst, src, i, length);
+  }
+
+  template <typename TDst, int Shift>
+  static void rgb24_from_grayscale_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 18 <= length; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i]));
+      if (Shift) { v = _mm_and_si128(_mm_srli_epi16(v, Shift), _mm_set1_epi8(0xFF >> Shift)); }
+      __m128i cc = _mm_unpacklo_epi8(v, v);
+      __m128i cz = _mm_unpacklo_epi8(v, zero);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i * 3     ]), pack_rgb24_sse2(_mm_unpacklo_epi16(cc, cz)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i * 3 + 12]), pack_rgb24_sse2(_mm_unpackhi_epi16(cc, cz)));
+      cc = _mm_unpackhi_epi8(v, v);
+      cz = _mm_unpackhi_epi8(v, zero);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i * 3 + 24]), pack_rgb24_sse2(_mm_unpacklo_epi16(cc, cz)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i * 3 + 36]), pack_rgb24_sse2(_mm_unpackhi_epi16(cc, cz)));
+    }
+    convert_tail<TDst, grayscale_t>(dst, src, i, length);
+  }
+
+  static void argb8888_from_grayscale_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint32_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m128i ff = _mm_set1_epi8((char)0xFF);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i]));
+      __m128i cc = _mm_unpacklo_epi8(v, v);
+      __m128i ca = _mm_unpacklo_epi8(v, ff);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i     ]), _mm_unpacklo_epi16(cc, ca));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i +  4]), _mm_unpackhi_epi16(cc, ca));
+      cc = _mm_unpackhi_epi8(v, v);
+      ca = _mm_unpackhi_epi8(v, ff);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i +  8]), _mm_unpacklo_epi16(cc, ca));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i + 12]), _mm_unpackhi_epi16(cc, ca));
+    }
+    convert_tail<argb8888_t, grayscale_t>(dst, src, i, length);
+  }
+
+  /// 12 byte だけ書き込む。ブレンドでは直後の画素をまだ読んでいないため上書きできない;
+  /// Stores exactly 12 bytes; the blend kernels must not clobber the next, still unread, pixels.
+  static inline void store_rgb24_sse2(uint8_t* p, __m128i v)
+  {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), v);
+    uint32_t w = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+    memcpy(&p[8], &w, 4);
+  }
+
+  /// argb8888 の 8 画素をチャンネル毎の 16bit レーンに分ける;
+  /// Splits 8 argb8888 pixels into 16bit lanes per channel.
+  static inline void split_argb8888_sse2(const uint8_t* p, __m128i& a, __m128i& r, __m128i& g, __m128i& b)
+  {
+    __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&p[16]));
+    const __m128i mFF = _mm_set1_epi32(0xFF);
+    a = _mm_packs_epi32(_mm_srli_epi32(v0, 24), _mm_srli_epi32(v1, 24));
+    r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(v0, 16), mFF), _mm_and_si128(_mm_srli_epi32(v1, 16), mFF));
+    g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(v0,  8), mFF), _mm_and_si128(_mm_srli_epi32(v1,  8), mFF));
+    b = _mm_packs_epi32(_mm_and_si128(v0, mFF), _mm_and_si128(v1, mFF));
+  }
+
+  /// (d * (256 - a) + s * (a + 1)) >> 8 。inv + a1 = 257 なので 16bit に収まる;
+  /// (d * (256 - a) + s * (a + 1)) >> 8, fits in 16 bits because inv + a1 = 257.
+  static inline __m128i blend_channel_sse2(__m128i d, __m128i s, __m128i inv, __m128i a1)
+  {
+    return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(d, inv), _mm_mullo_epi16(s, a1)), 8);
+  }
+
+  static void swap565_blend_argb8888_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint16_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m07 = _mm_set1_epi16(0x07);
+    const __m128i m1C = _mm_set1_epi16(0x1C);
+    const __m128i mF8 = _mm_set1_epi16(0xF8);
+    const __m128i m255 = _mm_set1_epi16(255);
+    uint32_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+      __m128i a, r, g, b;
+      split_argb8888_sse2(&s[i * 4], a, r, g, b);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, zero)) == 0xFFFF) { continue; }
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, m255)) != 0xFFFF)
+      {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&d[i]));
+        __m128i c7 = _mm_and_si128(c, m07);
+        __m128i dr = _mm_or_si128(_mm_and_si128(c, mF8), _mm_and_si128(_mm_srli_epi16(c, 5), m07));
+        __m128i dg = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(c7, 5), _mm_and_si128(_mm_srli_epi16(c, 11), m1C)), _mm_srli_epi16(c7, 1));
+        __m128i db = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(c, 5), mF8), _mm_and_si128(_mm_srli_epi16(c, 10), m07));
+        __m128i inv = _mm_sub_epi16(_mm_set1_epi16(256), a);
+        __m128i a1 = _mm_add_epi16(a, _mm_set1_epi16(1));
+        r = blend_channel_sse2(dr, r, inv, a1);
+        g = blend_channel_sse2(dg, g, inv, a1);
+        b = blend_channel_sse2(db, b, inv, a1);
+      }
+      __m128i lo = _mm_or_si128(_mm_and_si128(r, mF8), _mm_srli_epi16(g, 5));
+      __m128i hi = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(g, 11), _mm_set1_epi16((short)0xE000))
+                              , _mm_and_si128(_mm_slli_epi16(b,  5), _mm_set1_epi16(0x1F00)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i]), _mm_or_si128(lo, hi));
+    }
+    blend_tail<swap565_t>(dst, src, i, length);
+  }
+
+  static void bgr888_blend_argb8888_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m255 = _mm_set1_epi16(255);
+    const __m128i mFF = _mm_set1_epi32(0xFF);
+    uint32_t i = 0;
+    for (; i + 10 <= length; i += 8)
+    {
+      __m128i a, r, g, b;
+      split_argb8888_sse2(&s[i * 4], a, r, g, b);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, zero)) == 0xFFFF) { continue; }
+      auto p = &d[i * 3];
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, m255)) != 0xFFFF)
+      {
+        __m128i d0 = load_rgb24_sse2(p);
+        __m128i d1 = load_rgb24_sse2(&p[12]);
+        __m128i dr = _mm_packs_epi32(_mm_and_si128(d0, mFF), _mm_and_si128(d1, mFF));
+        __m128i dg = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(d0,  8), mFF), _mm_and_si128(_mm_srli_epi32(d1,  8), mFF));
+        __m128i db = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(d0, 16), mFF), _mm_and_si128(_mm_srli_epi32(d1, 16), mFF));
+        __m128i inv = _mm_sub_epi16(_mm_set1_epi16(256), a);
+        __m128i a1 = _mm_add_epi16(a, _mm_set1_epi16(1));
+        r = blend_channel_sse2(dr, r, inv, a1);
+        g = blend_channel_sse2(dg, g, inv, a1);
+        b = blend_channel_sse2(db, b, inv, a1);
+      }
+      __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+      store_rgb24_sse2( p     , pack_rgb24_sse2(_mm_unpacklo_epi16(rg, b)));
+      store_rgb24_sse2(&p[12], pack_rgb24_sse2(_mm_unpackhi_epi16(rg, b)));
+    }
+    blend_tail<bgr888_t>(dst, src, i, length);
+  }
+
+  /// bgra8888 (メモリ上 a,r,g,b) の 4 画素をブレンドする。a == 0 の画素は dst をそのまま残す;
+  /// Blends 4 bgra8888 pixels (a,r,g,b in memory); pixels with a == 0 keep dst as is.
+  static inline __m128i blend_bgra8888_sse2(__m128i d, __m128i s)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m255 = _mm_set1_epi16(255);
+    __m128i sl = _mm_unpacklo_epi8(s, zero);
+    __m128i sh = _mm_unpackhi_epi8(s, zero);
+    __m128i al = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sl, 0), 0);
+    __m128i ah = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sh, 0), 0);
+    __m128i rl = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sl, al), _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(m255, al))), m255);
+    __m128i rh = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sh, ah), _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(m255, ah))), m255);
+    __m128i res = _mm_or_si128(_mm_packus_epi16(_mm_srli_epi16(rl, 8), _mm_srli_epi16(rh, 8)), _mm_set1_epi32(0xFF));
+    __m128i keep = _mm_cmpeq_epi32(_mm_and_si128(s, _mm_set1_epi32(0xFF)), zero);
+    return _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, res));
+  }
+
+  static void bgra8888_blend_bgra8888_sse2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mFF = _mm_set1_epi32(0xFF);
+    uint32_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+      __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i * 4     ]));
+      __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i * 4 + 16]));
+      __m128i a0 = _mm_and_si128(s0, mFF);
+      __m128i a1 = _mm_and_si128(s1, mFF);
+      if (_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi32(a0, zero), _mm_cmpeq_epi32(a1, zero))) == 0xFFFF) { continue; }
+      if (_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi32(a0, mFF), _mm_cmpeq_epi32(a1, mFF))) != 0xFFFF)
+      {
+        s0 = blend_bgra8888_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&d[i * 4     ])), s0);
+        s1 = blend_bgra8888_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&d[i * 4 + 16])), s1);
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i * 4     ]), s0);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&d[i * 4 + 16]), s1);
+    }
+    blend_bgra8888_tail(dst, src, i, length);
+  }
+
+//----------------------------------------------------------------------------
+// AVX2
+
+  LGFX_TARGET_AVX2
+  static void bgr888_from_swap565_avx2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint16_t*>(src);
+    const __m256i m07 = _mm256_set1_epi16(0x07);
+    const __m256i m1C = _mm256_set1_epi16(0x1C);
+    const __m256i mF8 = _mm256_set1_epi16(0xF8);
+    const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
+                                        , 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    uint32_t i = 0;
+    for (; i + 18 <= length; i += 16)
+    {
+      __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s[i]));
+      __m256i c7 = _mm256_and_si256(c, m07);
+      __m256i r = _mm256_or_si256(_mm256_and_si256(c, mF8), _mm256_and_si256(_mm256_srli_epi16(c, 5), m07));
+      __m256i g = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(c7, 5), _mm256_and_si256(_mm256_srli_epi16(c, 11), m1C)), _mm256_srli_epi16(c7, 1));
+      __m256i b = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(c, 5), mF8), _mm256_and_si256(_mm256_srli_epi16(c, 10), m07));
+      __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+      // unpack はレーン内で動作するので、lo = 0-3,8-11 / hi = 4-7,12-15 番目の画素になる;
+      __m256i lo = _mm256_shuffle_epi8(_mm256_unpacklo_epi16(rg, b), pack);
+      __m256i hi = _mm256_shuffle_epi8(_mm256_unpackhi_epi16(rg, b), pack);
+      auto p = &d[i * 3];
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&p[ 0]), _mm256_castsi256_si128(lo));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&p[12]), _mm256_castsi256_si128(hi));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&p[24]), _mm256_extracti128_si256(lo, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&p[36]), _mm256_extracti128_si256(hi, 1));
+    }
+    convert_tail<bgr888_t, swap565_t>(dst, src, i, length);
+  }
+
+  LGFX_TARGET_AVX2
+  static inline __m256i load_rgb24_avx2(const uint8_t* p, __m256i expand)
+  {
+    __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+                                                             , _mm_loadu_si128(reinterpret_cast<const __m128i*>(&p[12])), 1);
+    return _mm256_shuffle_epi8(v, expand);
+  }
+
+  LGFX_TARGET_AVX2
+  static inline __m256i swap565_from_bgr888_dword_avx2(__m256i c)
+  {
+    __m256i r = _mm256_or_si256(_mm256_and_si256(c, _mm256_set1_epi32(0xF8))
+                              , _mm256_and_si256(_mm256_srli_epi32(c, 13), _mm256_set1_epi32(0x07)));
+    __m256i b = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi32(c,  3), _mm256_set1_epi32(0xE000))
+                              , _mm256_and_si256(_mm256_srli_epi32(c, 11), _mm256_set1_epi32(0x1F00)));
+    return _mm256_or_si256(r, b);
+  }
+
+  LGFX_TARGET_AVX2
+  static void swap565_from_bgr888_avx2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint16_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m256i expand = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+                                          , 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    uint32_t i = 0;
+    for (; i + 18 <= length; i += 16)
+    {
+      auto p = &s[i * 3];
+      __m256i a = swap565_from_bgr888_dword_avx2(load_rgb24_avx2(&p[ 0], expand));
+      __m256i b = swap565_from_bgr888_dword_avx2(load_rgb24_avx2(&p[24], expand));
+      // packus もレーン内で動作するので 64bit 単位で並べ替える;
+      __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[i]), v);
+    }
+    convert_tail<swap565_t, bgr888_t>(dst, src, i, length);
+  }
+
+  LGFX_TARGET_AVX2
+  static void swap565_from_rgb332_avx2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint16_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m256i m03 = _mm256_set1_epi16(0x03);
+    const __m256i m07 = _mm256_set1_epi16(0x07);
+    const __m256i m18 = _mm256_set1_epi16(0x18);
+    const __m256i mE0 = _mm256_set1_epi16(0xE0);
+    const __m256i mE000 = _mm256_set1_epi16((short)0xE000);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i])));
+      __m256i b = _mm256_and_si256(c, m03);
+      b = _mm256_add_epi16(_mm256_add_epi16(_mm256_slli_epi16(b, 3), _mm256_slli_epi16(b, 1)), _mm256_srli_epi16(b, 1));
+      __m256i lo = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(c, mE0)
+                                                 , _mm256_and_si256(_mm256_srli_epi16(c, 3), m18))
+                                                 , _mm256_and_si256(_mm256_srli_epi16(c, 2), m07));
+      __m256i hi = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(c, 11), mE000), _mm256_slli_epi16(b, 8));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[i]), _mm256_or_si256(lo, hi));
+    }
+    convert_tail<swap565_t, rgb332_t>(dst, src, i, length);
+  }
+
+  LGFX_TARGET_AVX2
+  static void swap565_from_grayscale_avx2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint16_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    const __m256i mF8 = _mm256_set1_epi16(0xF8);
+    const __m256i m1F00 = _mm256_set1_epi16(0x1F00);
+    const __m256i mE000 = _mm256_set1_epi16((short)0xE000);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i])));
+      __m256i lo = _mm256_or_si256(_mm256_and_si256(c, mF8), _mm256_srli_epi16(c, 5));
+      __m256i hi = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(c, 11), mE000)
+                                 , _mm256_and_si256(_mm256_slli_epi16(c,  5), m1F00));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[i]), _mm256_or_si256(lo, hi));
+    }
+    convert_tail<swap565_t, grayscale_t>(dst, src, i, length);
+  }
+
+  template <typename TDst, int Shift>
+  LGFX_TARGET_AVX2
+  static void rgb24_from_grayscale_avx2(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    // 出力の k byte 目は入力の k/3 画素目;
+    const __m256i idx01 = _mm256_setr_epi8( 0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5
+                                          , 5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9,10,10);
+    const __m128i idx2  = _mm_setr_epi8   (10,11,11,11,12,12,12,13,13,13,14,14,14,15,15,15);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[i]));
+      if (Shift) { v = _mm_and_si128(_mm_srli_epi16(v, Shift), _mm_set1_epi8(0xFF >> Shift)); }
+      auto p = &d[i * 3];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(v), idx01));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&p[32]), _mm_shuffle_epi8(v, idx2));
+    }
+    convert_tail<TDst, grayscale_t>(dst, src, i, length);
+  }
+
+//----------------------------------------------------------------------------
+
+  static bool cpu_has_avx2(void)
+  {
+#if defined ( _MSC_VER )
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) { return false; }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) && (info[2] & (1 << 28));
+    if (!osxsave || (_xgetbv(0) & 6) != 6) { return false; }
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+  }
+
+  static convert_row_table_t make_convert_row_table(void)
+  {
+    convert_row_table_t t;
+    t.isa = "sse2";
+    t.bgr888_from_swap565     = bgr888_from_swap565_sse2;
+    t.swap565_from_bgr888     = swap565_from_bgr888_sse2;
+    t.swap565_from_rgb332     = swap565_from_rgb332_sse2;
+    t.swap565_from_grayscale  = swap565_from_grayscale_sse2;
+    t.rgb332_from_grayscale   = rgb332_from_grayscale_sse2;
+    t.bgr888_from_grayscale   = rgb24_from_grayscale_sse2<bgr888_t, 0>;
+    t.bgr666_from_grayscale   = rgb24_from_grayscale_sse2<bgr666_t, 2>;
+    t.argb8888_from_grayscale = argb8888_from_grayscale_sse2;
+    t.swap565_blend_argb8888  = swap565_blend_argb8888_sse2;
+    t.bgr888_blend_argb8888   = bgr888_blend_argb8888_sse2;
+    t.bgra8888_blend_bgra8888 = bgra8888_blend_bgra8888_sse2;
+    if (cpu_has_avx2())
+    {
+      t.isa = "avx2";
+      t.bgr888_from_swap565    = bgr888_from_swap565_avx2;
+      t.swap565_from_bgr888    = swap565_from_bgr888_avx2;
+      t.swap565_from_rgb332    = swap565_from_rgb332_avx2;
+      t.swap565_from_grayscale = swap565_from_grayscale_avx2;
+      t.bgr888_from_grayscale  = rgb24_from_grayscale_avx2<bgr888_t, 0>;
+      t.bgr666_from_grayscale  = rgb24_from_grayscale_avx2<bgr666_t, 2>;
+    }
+    return t;
+  }
+
+#elif defined ( LGFX_PIXELCOPY_SIMD_NEON )
+
+//----------------------------------------------------------------------------
+// NEON
+
+  static void bgr888_from_swap565_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      // lo = RRRRRGGG , hi = GGGBBBBB
+      uint8x16x2_t c = vld2q_u8(&s[i * 2]);
+      uint8x16_t lo = c.val[0];
+      uint8x16_t hi = c.val[1];
+      uint8x16_t l7 = vandq_u8(lo, vdupq_n_u8(0x07));
+      uint8x16x3_t rgb;
+      rgb.val[0] = vorrq_u8(vandq_u8(lo, vdupq_n_u8(0xF8)), vshrq_n_u8(lo, 5));
+      rgb.val[1] = vorrq_u8(vorrq_u8(vshlq_n_u8(l7, 5), vandq_u8(vshrq_n_u8(hi, 3), vdupq_n_u8(0x1C))), vshrq_n_u8(l7, 1));
+      rgb.val[2] = vorrq_u8(vshlq_n_u8(hi, 3), vandq_u8(vshrq_n_u8(hi, 2), vdupq_n_u8(0x07)));
+      vst3q_u8(&d[i * 3], rgb);
+    }
+    convert_tail<bgr888_t, swap565_t>(dst, src, i, length);
+  }
+
+  static void swap565_from_bgr888_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      uint8x16x3_t rgb = vld3q_u8(&s[i * 3]);
+      uint8x16x2_t c;
+      c.val[0] = vorrq_u8(vandq_u8(rgb.val[0], vdupq_n_u8(0xF8)), vshrq_n_u8(rgb.val[1], 5));
+      c.val[1] = vorrq_u8(vandq_u8(vshlq_n_u8(rgb.val[1], 3), vdupq_n_u8(0xE0)), vshrq_n_u8(rgb.val[2], 3));
+      vst2q_u8(&d[i * 2], c);
+    }
+    convert_tail<swap565_t, bgr888_t>(dst, src, i, length);
+  }
+
+  static void swap565_from_rgb332_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      uint8x16_t v = vld1q_u8(&s[i]);
+      uint8x16_t b = vandq_u8(v, vdupq_n_u8(0x03));
+      b = vaddq_u8(vaddq_u8(vshlq_n_u8(b, 3), vshlq_n_u8(b, 1)), vshrq_n_u8(b, 1));
+      uint8x16x2_t c;
+      c.val[0] = vorrq_u8(vorrq_u8(vandq_u8(v, vdupq_n_u8(0xE0))
+                                 , vandq_u8(vshrq_n_u8(v, 3), vdupq_n_u8(0x18)))
+                                 , vandq_u8(vshrq_n_u8(v, 2), vdupq_n_u8(0x07)));
+      c.val[1] = vorrq_u8(vandq_u8(vshlq_n_u8(v, 3), vdupq_n_u8(0xE0)), b);
+      vst2q_u8(&d[i * 2], c);
+    }
+    convert_tail<swap565_t, rgb332_t>(dst, src, i, length);
+  }
+
+  static void swap565_from_grayscale_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      uint8x16_t v = vld1q_u8(&s[i]);
+      uint8x16x2_t c;
+      c.val[0] = vorrq_u8(vandq_u8(v, vdupq_n_u8(0xF8)), vshrq_n_u8(v, 5));
+      c.val[1] = vorrq_u8(vandq_u8(vshlq_n_u8(v, 3), vdupq_n_u8(0xE0)), vshrq_n_u8(v, 3));
+      vst2q_u8(&d[i * 2], c);
+    }
+    convert_tail<swap565_t, grayscale_t>(dst, src, i, length);
+  }
+
+  static void rgb332_from_grayscale_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      uint8x16_t v = vld1q_u8(&s[i]);
+      v = vorrq_u8(vorrq_u8(vandq_u8(v, vdupq_n_u8(0xE0))
+                          , vandq_u8(vshrq_n_u8(v, 3), vdupq_n_u8(0x1C)))
+                          , vshrq_n_u8(v, 6));
+      vst1q_u8(&d[i], v);
+    }
+    convert_tail<rgb332_t, grayscale_t>(dst, src, i, length);
+  }
+
+  template <typename TDst, int Shift>
+  static void rgb24_from_grayscale_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      uint8x16_t v = vld1q_u8(&s[i]);
+      if (Shift) { v = vshrq_n_u8(v, Shift ? Shift : 1); }
+      uint8x16x3_t rgb = { { v, v, v } };
+      vst3q_u8(&d[i * 3], rgb);
+    }
+    convert_tail<TDst, grayscale_t>(dst, src, i, length);
+  }
+
+  static void argb8888_from_grayscale_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      uint8x16_t v = vld1q_u8(&s[i]);
+      uint8x16x4_t bgra = { { v, v, v, vdupq_n_u8(0xFF) } };
+      vst4q_u8(&d[i * 4], bgra);
+    }
+    convert_tail<argb8888_t, grayscale_t>(dst, src, i, length);
+  }
+
+  static inline uint8x8_t blend_channel_neon(uint8x8_t d, uint8x8_t s, uint16x8_t inv, uint16x8_t a1)
+  {
+    return vshrn_n_u16(vaddq_u16(vmulq_u16(vmovl_u8(d), inv), vmulq_u16(vmovl_u8(s), a1)), 8);
+  }
+
+  static inline uint64_t alpha_bits_neon(uint8x8_t a)
+  {
+    return vget_lane_u64(vreinterpret_u64_u8(a), 0);
+  }
+
+  static void swap565_blend_argb8888_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+      uint8x8x4_t sv = vld4_u8(&s[i * 4]);  // b, g, r, a
+      uint64_t am = alpha_bits_neon(sv.val[3]);
+      if (am == 0) { continue; }
+      uint8x8_t r = sv.val[2];
+      uint8x8_t g = sv.val[1];
+      uint8x8_t b = sv.val[0];
+      if (am != ~0ull)
+      {
+        uint8x8x2_t c = vld2_u8(&d[i * 2]);
+        uint8x8_t lo = c.val[0];
+        uint8x8_t hi = c.val[1];
+        uint8x8_t l7 = vand_u8(lo, vdup_n_u8(0x07));
+        uint8x8_t dr = vorr_u8(vand_u8(lo, vdup_n_u8(0xF8)), vshr_n_u8(lo, 5));
+        uint8x8_t dg = vorr_u8(vorr_u8(vshl_n_u8(l7, 5), vand_u8(vshr_n_u8(hi, 3), vdup_n_u8(0x1C))), vshr_n_u8(l7, 1));
+        uint8x8_t db = vorr_u8(vshl_n_u8(hi, 3), vand_u8(vshr_n_u8(hi, 2), vdup_n_u8(0x07)));
+        uint16x8_t a16 = vmovl_u8(sv.val[3]);
+        uint16x8_t inv = vsubq_u16(vdupq_n_u16(256), a16);
+        uint16x8_t a1 = vaddq_u16(a16, vdupq_n_u16(1));
+        r = blend_channel_neon(dr, r, inv, a1);
+        g = blend_channel_neon(dg, g, inv, a1);
+        b = blend_channel_neon(db, b, inv, a1);
+      }
+      uint8x8x2_t o;
+      o.val[0] = vorr_u8(vand_u8(r, vdup_n_u8(0xF8)), vshr_n_u8(g, 5));
+      o.val[1] = vorr_u8(vand_u8(vshl_n_u8(g, 3), vdup_n_u8(0xE0)), vshr_n_u8(b, 3));
+      vst2_u8(&d[i * 2], o);
+    }
+    blend_tail<swap565_t>(dst, src, i, length);
+  }
+
+  static void bgr888_blend_argb8888_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+      uint8x8x4_t sv = vld4_u8(&s[i * 4]);  // b, g, r, a
+      uint64_t am = alpha_bits_neon(sv.val[3]);
+      if (am == 0) { continue; }
+      uint8x8x3_t o = { { sv.val[2], sv.val[1], sv.val[0] } };
+      if (am != ~0ull)
+      {
+        uint8x8x3_t dv = vld3_u8(&d[i * 3]);
+        uint16x8_t a16 = vmovl_u8(sv.val[3]);
+        uint16x8_t inv = vsubq_u16(vdupq_n_u16(256), a16);
+        uint16x8_t a1 = vaddq_u16(a16, vdupq_n_u16(1));
+        o.val[0] = blend_channel_neon(dv.val[0], o.val[0], inv, a1);
+        o.val[1] = blend_channel_neon(dv.val[1], o.val[1], inv, a1);
+        o.val[2] = blend_channel_neon(dv.val[2], o.val[2], inv, a1);
+      }
+      vst3_u8(&d[i * 3], o);
+    }
+    blend_tail<bgr888_t>(dst, src, i, length);
+  }
+
+  static void bgra8888_blend_bgra8888_neon(void* __restrict dst, const void* __restrict src, uint32_t length)
+  {
+    auto d = static_cast<uint8_t*>(dst);
+    auto s = static_cast<const uint8_t*>(src);
+    uint32_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+      uint8x8x4_t sv = vld4_u8(&s[i * 4]);  // a, r, g, b
+      uint64_t am = alpha_bits_neon(sv.val[0]);
+      if (am == 0) { continue; }
+      if (am != ~0ull)
+      {
+        uint8x8x4_t dv = vld4_u8(&d[i * 4]);
+        uint8x8_t a = sv.val[0];
+        uint8x8_t inv = vsub_u8(vdup_n_u8(255), a);
+        uint16x8_t round = vdupq_n_u16(255);
+        for (int c = 1; c < 4; ++c)
+        {
+          sv.val[c] = vshrn_n_u16(vaddq_u16(vaddq_u16(vmull_u8(sv.val[c], a), vmull_u8(dv.val[c], inv)), round), 8);
+        }
+        sv.val[0] = vbsl_u8(vceq_u8(a, vdup_n_u8(0)), dv.val[0], vdup_n_u8(255));
+      }
+      vst4_u8(&d[i * 4], sv);
+    }
+    blend_bgra8888_tail(dst, src, i, length);
+  }
+
+  static convert_row_table_t make_convert_row_table(void)
+  {
+    convert_row_table_t t;
+    t.isa = "neon";
+    t.swap565_blend_argb8888  = swap565_blend_argb8888_neon;
+    t.bgr888_blend_argb8888   = bgr888_blend_argb8888_neon;
+    t.bgra8888_blend_bgra8888 = bgra8888_blend_bgra8888_neon;
+    t.bgr888_from_swap565     = bgr888_from_swap565_neon;
+    t.swap565_from_bgr888     = swap565_from_bgr888_neon;
+    t.swap565_from_rgb332     = swap565_from_rgb332_neon;
+    t.swap565_from_grayscale  = swap565_from_grayscale_neon;
+    t.rgb332_from_grayscale   = rgb332_from_grayscale_neon;
+    t.bgr888_from_grayscale   = rgb24_from_grayscale_neon<bgr888_t, 0>;
+    t.bgr666_from_grayscale   = rgb24_from_grayscale_neon<bgr666_t, 2>;
+    t.argb8888_from_grayscale = argb8888_from_grayscale_neon;
+    return t;
+  }
+
+#else
+
+  static convert_row_table_t make_convert_row_table(void)
+  {
+    return convert_row_table_t();
+  }
+
+#endif
+
+  const convert_row_table_t& get_convert_row_table(void)
+  {
+    static const convert_row_table_t table = make_convert_row_table();
+    return table;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
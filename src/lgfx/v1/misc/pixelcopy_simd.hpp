@@ -0,0 +1,100 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "colortype.hpp"
+
+/// x86 (SSE2/AVX2) / ARM (NEON) 向けの1ライン単位の色変換カーネル。
+/// pixelcopy_t::copy_rgb_fast / copy_rgb_affine から呼ばれる。結果は color_convert と同一;
+/// Row conversion kernels for x86 (SSE2/AVX2) and ARM (NEON), used by pixelcopy_t.
+/// The output is bit-exact with color_convert. Define LGFX_PIXELCOPY_NO_SIMD to disable them.
+
+#if !defined ( LGFX_PIXELCOPY_NO_SIMD )
+ #if defined ( __SSE2__ ) || defined ( _M_X64 ) || ( defined ( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+  #define LGFX_PIXELCOPY_SIMD_X86
+ #elif defined ( __ARM_NEON ) || defined ( __ARM_NEON__ )
+  #define LGFX_PIXELCOPY_SIMD_NEON
+ #endif
+#endif
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// 変換前に dst と src が重なっていないこと;
+  /// dst and src must not overlap.
+  typedef void (*convert_row_fn_t)(void* __restrict dst, const void* __restrict src, uint32_t length);
+
+  struct convert_row_table_t
+  {
+    convert_row_fn_t bgr888_from_swap565   = nullptr;
+    convert_row_fn_t swap565_from_bgr888   = nullptr;
+    convert_row_fn_t swap565_from_rgb332   = nullptr;
+    convert_row_fn_t swap565_from_grayscale = nullptr;
+    convert_row_fn_t rgb332_from_grayscale  = nullptr;
+    convert_row_fn_t bgr888_from_grayscale  = nullptr;
+    convert_row_fn_t bgr666_from_grayscale  = nullptr;
+    convert_row_fn_t argb8888_from_grayscale = nullptr;
+
+    /// argb8888 の src を dst にアルファブレンドする (pixelcopy_t::blend_rgb_fast と同じ計算) ;
+    /// Alpha-blends an argb8888 src onto dst, same arithmetic as pixelcopy_t::blend_rgb_fast.
+    convert_row_fn_t swap565_blend_argb8888 = nullptr;
+    convert_row_fn_t bgr888_blend_argb8888  = nullptr;
+
+    /// PNG/QOI デコーダ用。bgra8888 同士で (s*a + d*(255-a) + 255) >> 8 のブレンドを行う;
+    /// For the PNG/QOI decoders: bgra8888 onto bgra8888 as (s*a + d*(255-a) + 255) >> 8.
+    convert_row_fn_t bgra8888_blend_bgra8888 = nullptr;
+
+    /// 選択された命令セット ("avx2" / "sse2" / "neon" / "none") ;
+    /// instruction set selected at runtime ("avx2" / "sse2" / "neon" / "none").
+    const char* isa = "none";
+  };
+
+  /// 初回呼出し時に CPU の機能を調べて変換テーブルを決定する;
+  /// The table is chosen from the CPU features on first use.
+  const convert_row_table_t& get_convert_row_table(void);
+
+  /// 対応するカーネルが無い組合せでは nullptr を返す;
+  /// Returns nullptr when there is no kernel for the pair.
+  template <typename TDst, typename TSrc>
+  struct convert_row_t { static constexpr convert_row_fn_t get(void) { return nullptr; } };
+
+  template <typename TDst>
+  struct blend_row_t { static constexpr convert_row_fn_t get(void) { return nullptr; } };
+
+#if defined ( LGFX_PIXELCOPY_SIMD_X86 ) || defined ( LGFX_PIXELCOPY_SIMD_NEON )
+
+  template <> struct blend_row_t<swap565_t> { static convert_row_fn_t get(void) { return get_convert_row_table().swap565_blend_argb8888; } };
+  template <> struct blend_row_t<bgr888_t > { static convert_row_fn_t get(void) { return get_convert_row_table().bgr888_blend_argb8888;  } };
+
+  template <> struct convert_row_t<bgr888_t  , swap565_t  > { static convert_row_fn_t get(void) { return get_convert_row_table().bgr888_from_swap565;    } };
+  template <> struct convert_row_t<swap565_t , bgr888_t   > { static convert_row_fn_t get(void) { return get_convert_row_table().swap565_from_bgr888;    } };
+  template <> struct convert_row_t<swap565_t , rgb332_t   > { static convert_row_fn_t get(void) { return get_convert_row_table().swap565_from_rgb332;    } };
+  template <> struct convert_row_t<swap565_t , grayscale_t> { static convert_row_fn_t get(void) { return get_convert_row_table().swap565_from_grayscale; } };
+  template <> struct convert_row_t<rgb332_t  , grayscale_t> { static convert_row_fn_t get(void) { return get_convert_row_table().rgb332_from_grayscale;  } };
+  template <> struct convert_row_t<bgr888_t  , grayscale_t> { static convert_row_fn_t get(void) { return get_convert_row_table().bgr888_from_grayscale;  } };
+  template <> struct convert_row_t<bgr666_t  , grayscale_t> { static convert_row_fn_t get(void) { return get_convert_row_table().bgr666_from_grayscale;  } };
+  template <> struct convert_row_t<argb8888_t, grayscale_t> { static convert_row_fn_t get(void) { return get_convert_row_table().argb8888_from_grayscale; } };
+
+#endif
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -115,15 +115,65 @@ namespace lgfx
   void Panel_FlexibleFrameBuffer::_fill_rect_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
   {
     h += y;
+    do
+    {
+      _fill_span_inner(x, y, w, rawcolor);
+    } while (++y < h);
+  }
+
+  void Panel_FlexibleFrameBuffer::_fill_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint32_t rawcolor)
+  {
     uint_fast16_t ie = x + w;
     do
     {
-      auto i = x;
-      do
+      _draw_pixel_inner(x, y, rawcolor);
+    } while (++x != ie);
+  }
+
+  void Panel_FlexibleFrameBuffer::_write_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* src)
+  {
+    size_t bytes = _write_bits >> 3;
+    uint_fast16_t ie = x + w;
+    do
+    {
+      uint32_t raw = *src++;
+      for (size_t by = 1; by < bytes; ++by)
       {
-        _draw_pixel_inner(i, y, rawcolor);
-      } while (++i != ie);
-    } while (++y < h);
+        raw += (*src++) << (by * 8);
+      }
+      _draw_pixel_inner(x, y, raw);
+    } while (++x != ie);
+  }
+
+  void Panel_FlexibleFrameBuffer::_read_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint8_t* dst)
+  {
+    size_t bytes = _read_bits >> 3;
+    uint_fast16_t ie = x + w;
+    do
+    {
+      uint32_t raw = _read_pixel_inner(x, y);
+      *dst++ = raw;
+      for (size_t by = 1; by < bytes; ++by)
+      {
+        *dst++ = raw >>= 8;
+      }
+    } while (++x != ie);
+  }
+
+  void Panel_FlexibleFrameBuffer::_reverse_span(uint8_t* buf, uint_fast16_t w, uint_fast8_t bytes)
+  {
+    if (w < 2) { return; }
+    uint8_t* l = buf;
+    uint8_t* r = buf + (w - 1) * bytes;
+    do
+    {
+      for (size_t by = 0; by < bytes; ++by)
+      {
+        std::swap(l[by], r[by]);
+      }
+      l += bytes;
+      r -= bytes;
+    } while (l < r);
   }
 
   void Panel_FlexibleFrameBuffer::writeBlock(uint32_t rawcolor, uint32_t length)
@@ -213,6 +263,12 @@ namespace lgfx
     size_t len = w * bytes;
     auto pixelbuf = (uint8_t*)alloca((len + 7) & ~3);
 
+    /// 縦横を入れ替えない回転では、行をまとめて変換して _write_span_inner へ渡す;
+    uint_fast8_t r = _rotation;
+    bool use_span = !(r & 1);
+    bool flip_x = r & 2;
+    bool flip_y = (1u << r) & 0b10010110;
+
     h += y;
     do
     {
@@ -224,15 +280,30 @@ namespace lgfx
         if (pos != pos2)
         {
           uint8_t* buf = &pixelbuf[pos * bytes];
-          do
+          if (use_span)
           {
-            raw = *buf++;
-            for (size_t by = 1; by < bytes; ++by)
+            uint_fast16_t px = x + pos;
+            uint_fast16_t py = flip_y ? _height - (y + 1) : y;
+            if (flip_x)
             {
-              raw += (*buf++) << (by * 8);
+              _reverse_span(buf, pos2 - pos, bytes);
+              px = _width - (x + pos2);
             }
-            drawPixelPreclipped(x + pos, y, raw);
-          } while (++pos != pos2);
+            _write_span_inner(px, py, pos2 - pos, buf);
+            pos = pos2;
+          }
+          else
+          {
+            do
+            {
+              raw = *buf++;
+              for (size_t by = 1; by < bytes; ++by)
+              {
+                raw += (*buf++) << (by * 8);
+              }
+              drawPixelPreclipped(x + pos, y, raw);
+            } while (++pos != pos2);
+          }
         }
         if (pos != w)
         {
@@ -311,20 +382,32 @@ namespace lgfx
 
     size_t pos = 0;
 
+    uint_fast8_t r = _rotation;
+    bool flip_x = r & 2;
+    bool flip_y = (1u << r) & 0b10010110;
+
     h += y;
     do
     {
-      uint8_t* buf = pixelbuf;
-      uint32_t i = 0;
-      do
+      if (!(r & 1))
       {
-        uint32_t raw = readPixelPreclipped(x + i, y);
-        *buf++ = raw;
-        for (size_t by = 1; by < bytes; ++by)
+        _read_span_inner(flip_x ? _width - (x + w) : x, flip_y ? _height - (y + 1) : y, w, pixelbuf);
+        if (flip_x) { _reverse_span(pixelbuf, w, bytes); }
+      }
+      else
+      {
+        uint8_t* buf = pixelbuf;
+        uint32_t i = 0;
+        do
         {
-          *buf++ = raw >>= 8;
-        }
-      } while (++i != w);
+          uint32_t raw = readPixelPreclipped(x + i, y);
+          *buf++ = raw;
+          for (size_t by = 1; by < bytes; ++by)
+          {
+            *buf++ = raw >>= 8;
+          }
+        } while (++i != w);
+      }
 
       param->src_y32 = 0;
       param->src_x32 = 0;
@@ -27,6 +27,8 @@ namespace lgfx
 
 // 1ピクセル単位で描画を行うフレームバッファ
 // 動作は重いが、派生クラスで _draw_pixel_inner / _read_pixel_inner を overrideするだけで使用できる。
+// 横方向の連続した範囲は _fill_span_inner / _write_span_inner / _read_span_inner を経由するため、
+// 派生クラスでこれらを overrideすると塗り潰しや画像転送を行単位で処理できる。
 
   struct Panel_FlexibleFrameBuffer : public Panel_Device
   {
@@ -71,6 +73,16 @@ namespace lgfx
     virtual void _draw_pixel_inner(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) {}
     virtual void _fill_rect_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor);
 
+    /// パネル座標系の横方向 w ピクセルの範囲を処理する。既定では1ピクセル単位の関数を呼び出す;
+    /// Horizontal spans of w pixels in panel coordinates. The defaults fall back to the per-pixel calls.
+    /// Pixel data is in the write format (_write_bits per pixel, same byte order as rawcolor).
+    virtual void _fill_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint32_t rawcolor);
+    virtual void _write_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* src);
+    virtual void _read_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint8_t* dst);
+
+    /// ピクセル列の並びを反転する (左右反転の回転で使用) ;
+    static void _reverse_span(uint8_t* buf, uint_fast16_t w, uint_fast8_t bytes);
+
   };
 
 //----------------------------------------------------------------------------
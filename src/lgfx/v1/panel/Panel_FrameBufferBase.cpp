@@ -96,7 +96,29 @@ namespace lgfx
     _ye = ye;
   }
 
+  void Panel_FrameBufferBase::_update_modified_rect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
+  {
+    uint_fast8_t r = _internal_rotation;
+    if (r)
+    {
+      if ((1u << r) & 0b10010110) { y = _height - (y + h); }
+      if (r & 2)                  { x = _width  - (x + w); }
+      if (r & 1) { std::swap(x, y);  std::swap(w, h); }
+    }
+    _mark_modified(x, y, w, h);
+  }
+
   void Panel_FrameBufferBase::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
+  {
+    _draw_pixel(x, y, rawcolor);
+    /// drawPixel は startWrite / endWrite を経由せずに呼ばれるため、ここで反映する;
+    if (_auto_display && !getStartCount())
+    {
+      display(0, 0, 0, 0);
+    }
+  }
+
+  void Panel_FrameBufferBase::_draw_pixel(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
   {
     uint_fast8_t r = _internal_rotation;
     if (r)
@@ -105,6 +127,7 @@ namespace lgfx
       if (r & 2)                  { x = _width  - (x + 1); }
       if (r & 1) { std::swap(x, y); }
     }
+    _mark_modified(x, y, 1, 1);
     if (_write_bits >= 8)
     {
       size_t bytes = _write_bits >> 3;
@@ -123,6 +146,7 @@ namespace lgfx
       if (r & 2)                  { x = _width  - (x + w); }
       if (r & 1) { std::swap(x, y);  std::swap(w, h); }
     }
+    _mark_modified(x, y, w, h);
     h += y;
     if (_write_bits >= 8)
     {
@@ -192,6 +216,8 @@ namespace lgfx
   void Panel_FrameBufferBase::writePixels(pixelcopy_t* param, uint32_t length, bool use_dma)
   {
     (void)use_dma;
+    /// 書込み位置はウィンドウ内を巡回するため、ウィンドウ全体を変更範囲にする;
+    _update_modified_rect(_xs, _ys, _xe - _xs + 1, _ye - _ys + 1);
     uint_fast16_t xs = _xs;
     uint_fast16_t xe = _xe;
     uint_fast16_t ys = _ys;
@@ -270,6 +296,7 @@ namespace lgfx
 
   void Panel_FrameBufferBase::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool)
   {
+    _update_modified_rect(x, y, w, h);
     uint_fast8_t r = _internal_rotation;
     if (r == 0 && param->transp == pixelcopy_t::NON_TRANSP && param->no_convert)
     {
@@ -313,6 +340,7 @@ namespace lgfx
 
   void Panel_FrameBufferBase::writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param)
   {
+    _update_modified_rect(x, y, w, h);
     uint32_t nextx = 0;
     uint32_t nexty = 1 << pixelcopy_t::FP_SCALE;
     if (_internal_rotation)
@@ -398,6 +426,16 @@ namespace lgfx
   }
 
   void Panel_FrameBufferBase::copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y)
+  {
+    _copy_rect(dst_x, dst_y, w, h, src_x, src_y);
+    /// copyRect は startWrite / endWrite を経由せずに呼ばれるため、ここで反映する;
+    if (_auto_display && !getStartCount())
+    {
+      display(0, 0, 0, 0);
+    }
+  }
+
+  void Panel_FrameBufferBase::_copy_rect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y)
   {
     uint_fast8_t r = _internal_rotation;
     if (r)
@@ -406,6 +444,7 @@ namespace lgfx
       if (r & 2)                  { src_x = _width  - (src_x + w); dst_x = _width  - (dst_x + w); }
       if (r & 1) { std::swap(src_x, src_y);  std::swap(dst_x, dst_y);  std::swap(w, h); }
     }
+    _mark_modified(dst_x, dst_y, w, h);
     size_t bytes = _write_bits >> 3;
     size_t len = w * bytes;
     int32_t add = 1;
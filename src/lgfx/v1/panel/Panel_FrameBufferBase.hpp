@@ -18,6 +18,9 @@ Contributors:
 #pragma once
 
 #include "Panel_Device.hpp"
+#include "../misc/range.hpp"
+
+#include <algorithm>
 
 namespace lgfx
 {
@@ -28,6 +31,7 @@ namespace lgfx
   struct Panel_FrameBufferBase : public Panel_Device
   {
   public:
+    Panel_FrameBufferBase(void) { _clear_modified_rect(); }
 
     bool init(bool use_reset) override;
     void beginTransaction(void) override {}
@@ -65,8 +69,49 @@ namespace lgfx
     uint8_t** _lines_buffer = nullptr;
     uint16_t _xpos, _ypos;
 
+    /// 前回の反映以降に書込まれた範囲 (回転前のパネル座標系) 。書込み関数が広げ、
+    /// バッファを別の場所へ転送する派生クラスが display() で参照・消去する;
+    /// Area written since it was last cleared, in unrotated panel coordinates. Every write entry
+    /// point grows it; panels that present the buffer elsewhere read and clear it in display().
+    range_rect_t _range_mod;
+
     void _rotate_pixelcopy(uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& w, uint_fast16_t& h, pixelcopy_t* param, uint32_t& nextx, uint32_t& nexty);
 
+    /// 変更範囲が空の状態で書込みが始まる時 (フレームの最初の書込み) に呼ばれる;
+    /// Called when a write arrives while nothing is marked modified, i.e. on the first write of a frame.
+    virtual void _begin_modified(void) {}
+
+    /// 回転後の座標で変更範囲を広げる;
+    void _mark_modified(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
+    {
+      if (_range_mod.empty()) { _begin_modified(); }
+      _range_mod.left   = std::min<int_fast16_t>(_range_mod.left  , x        );
+      _range_mod.right  = std::max<int_fast16_t>(_range_mod.right , x + w - 1);
+      _range_mod.top    = std::min<int_fast16_t>(_range_mod.top   , y        );
+      _range_mod.bottom = std::max<int_fast16_t>(_range_mod.bottom, y + h - 1);
+    }
+    /// 回転前の (描画関数から見た) 座標で変更範囲を広げる;
+    void _update_modified_rect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h);
+    void _clear_modified_rect(void)
+    {
+      _range_mod.top    = INT16_MAX;
+      _range_mod.left   = INT16_MAX;
+      _range_mod.right  = 0;
+      _range_mod.bottom = 0;
+    }
+    void _modified_all(void)
+    {
+      _range_mod.left   = 0;
+      _range_mod.top    = 0;
+      _range_mod.right  = _cfg.panel_width  - 1;
+      _range_mod.bottom = _cfg.panel_height - 1;
+    }
+
+    /// drawPixelPreclipped の本体 (変更範囲の記録を含み、display() は呼ばない) ;
+    void _draw_pixel(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor);
+    /// copyRect の本体 (変更範囲の記録を含み、display() は呼ばない) ;
+    void _copy_rect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y);
+
   };
 
 //----------------------------------------------------------------------------
@@ -31,8 +31,6 @@ namespace lgfx
  {
 //----------------------------------------------------------------------------
 
-  static constexpr uint8_t Bayer[16] = { 8, 200, 40, 232, 72, 136, 104, 168, 56, 248, 24, 216, 120, 184, 88, 152 };
-
   Panel_GDEW0154M09::Panel_GDEW0154M09(void)
   {
     _cfg.dummy_read_bits = 0;
@@ -74,6 +72,7 @@ namespace lgfx
     setInvert(_invert);
 
     setRotation(_rotation);
+    _diff.invalidate();
 
     _range_old.top = 0;
     _range_old.left = 0;
@@ -81,7 +80,7 @@ namespace lgfx
     _range_old.bottom = _height - 1;
     _exec_transfer(0x13, _range_old);
     _close_transfer();
-    _range_mod = _range_old;
+    _add_dirty_rect(_range_old.left, _range_old.top, _range_old.right, _range_old.bottom);
 
     endWrite();
 
@@ -102,30 +101,31 @@ namespace lgfx
   {
     if (0 < w && 0 < h)
     {
-      _range_mod.left   = std::min<int16_t>(_range_mod.left  , x        );
-      _range_mod.right  = std::max<int16_t>(_range_mod.right , x + w - 1);
-      _range_mod.top    = std::min<int16_t>(_range_mod.top   , y        );
-      _range_mod.bottom = std::max<int16_t>(_range_mod.bottom, y + h - 1);
+      _add_dirty_rect(x, y, x + w - 1, y + h - 1);
     }
     if (_range_mod.empty()) { return; }
+    range_rect_t range = _range_mod;
+    bool quality = getEpdMode() == epd_mode_t::epd_quality;
+    if (getEpdMode() == epd_mode_t::epd_auto && !_diff_range(range, quality))
+    { /// 表示内容に変化が無ければ更新しない;
+      _clear_dirty_rects();
+      return;
+    }
     _close_transfer();
-    _range_old = _range_mod;
+    _range_old = range;
     while (millis() - _send_msec < _refresh_msec) delay(1);
-    if (getEpdMode() == epd_mode_t::epd_quality)
+    if (quality)
     {
-      _exec_transfer(0x13, _range_mod, true);
+      _exec_transfer(0x13, range, true);
       _wait_busy();
       _bus->writeCommand(0x12, 8);
       auto send_msec = millis();
       delay(300);
       while (millis() - send_msec < _refresh_msec) delay(1);
-      _exec_transfer(0x10, _range_mod, true);
+      _exec_transfer(0x10, range, true);
     }
-    _exec_transfer(0x13, _range_mod);
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+    _exec_transfer(0x13, range);
+    _clear_dirty_rects();
 
     _wait_busy();
     _bus->writeCommand(0x12, 8);
@@ -181,105 +181,6 @@ namespace lgfx
     endWrite();
   }
 
-  void Panel_GDEW0154M09::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
-  {
-    uint_fast16_t xs = x, xe = x + w - 1;
-    uint_fast16_t ys = y, ye = y + h - 1;
-    _xs = xs;
-    _ys = ys;
-    _xe = xe;
-    _ye = ye;
-    _update_transferred_rect(xs, ys, xe, ye);
-
-    swap565_t color;
-    color.raw = rawcolor;
-    uint32_t value = (color.R8() + (color.G8() << 1) + color.B8()) >> 2;
-
-    y = ys;
-    do
-    {
-      x = xs;
-      uint32_t idx = ((_cfg.panel_width + 7) & ~7) * y + x;
-      auto btbl = &Bayer[(y & 3) << 2];
-      do
-      {
-        bool flg = 256 <= value + btbl[x & 3];
-        if (flg) _buf[idx >> 3] |=   0x80 >> (idx & 7);
-        else     _buf[idx >> 3] &= ~(0x80 >> (idx & 7));
-        ++idx;
-      } while (++x <= xe);
-    } while (++y <= ye);
-  }
-
-  void Panel_GDEW0154M09::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma)
-  {
-    uint_fast16_t xs = x, xe = x + w - 1;
-    uint_fast16_t ys = y, ye = y + h - 1;
-    _update_transferred_rect(xs, ys, xe, ye);
-
-    auto readbuf = (swap565_t*)alloca(w * sizeof(swap565_t));
-    auto sx = param->src_x32;
-    h += y;
-    do
-    {
-      uint32_t prev_pos = 0, new_pos = 0;
-      do
-      {
-        new_pos = param->fp_copy(readbuf, prev_pos, w, param);
-        if (new_pos != prev_pos)
-        {
-          do
-          {
-            auto color = readbuf[prev_pos];
-            _draw_pixel(x + prev_pos, y, (color.R8() + (color.G8() << 1) + color.B8()) >> 2);
-          } while (new_pos != ++prev_pos);
-        }
-      } while (w != new_pos && w != (prev_pos = param->fp_skip(new_pos, w, param)));
-      param->src_x32 = sx;
-      param->src_y++;
-    } while (++y < h);
-  }
-
-  void Panel_GDEW0154M09::writePixels(pixelcopy_t* param, uint32_t length, bool use_dma)
-  {
-    {
-      uint_fast16_t xs = _xs;
-      uint_fast16_t xe = _xe;
-      uint_fast16_t ys = _ys;
-      uint_fast16_t ye = _ye;
-      _update_transferred_rect(xs, ys, xe, ye);
-    }
-    uint_fast16_t xs   = _xs  ;
-    uint_fast16_t ys   = _ys  ;
-    uint_fast16_t xe   = _xe  ;
-    uint_fast16_t ye   = _ye  ;
-    uint_fast16_t xpos = _xpos;
-    uint_fast16_t ypos = _ypos;
-
-    static constexpr uint32_t buflen = 16;
-    swap565_t colors[buflen];
-    int bufpos = buflen;
-    do
-    {
-      if (bufpos == buflen) {
-        param->fp_copy(colors, 0, std::min(length, buflen), param);
-        bufpos = 0;
-      }
-      auto color = colors[bufpos++];
-      _draw_pixel(xpos, ypos, (color.R8() + (color.G8() << 1) + color.B8()) >> 2);
-      if (++xpos > xe)
-      {
-        xpos = xs;
-        if (++ypos > ye)
-        {
-          ypos = ys;
-        }
-      }
-    } while (--length);
-    _xpos = xpos;
-    _ypos = ypos;
-  }
-
   void Panel_GDEW0154M09::readRect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, void* dst, pixelcopy_t* param)
   {
     auto readbuf = (swap565_t*)alloca(w * sizeof(swap565_t));
@@ -312,13 +213,21 @@ namespace lgfx
     return true;
   }
 
-  void Panel_GDEW0154M09::_draw_pixel(uint_fast16_t x, uint_fast16_t y, uint32_t value)
+  void Panel_GDEW0154M09::_write_level(uint_fast16_t x, uint_fast16_t y, uint_fast8_t level)
   {
-    _rotate_pos(x, y);
     uint32_t idx = ((_cfg.panel_width + 7) & ~7) * y + x;
-    bool flg = 256 <= value + Bayer[(x & 3) | (y & 3) << 2];
-    if (flg) _buf[idx >> 3] |=   0x80 >> (idx & 7);
-    else     _buf[idx >> 3] &= ~(0x80 >> (idx & 7));
+    if (level) _buf[idx >> 3] |=   0x80 >> (idx & 7);
+    else       _buf[idx >> 3] &= ~(0x80 >> (idx & 7));
+  }
+
+  void Panel_GDEW0154M09::_write_levels(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* levels)
+  {
+    uint32_t idx = ((_cfg.panel_width + 7) & ~7) * y + x;
+    for (uint32_t i = 0; i < w; ++i, ++idx)
+    {
+      if (levels[i]) _buf[idx >> 3] |=   0x80 >> (idx & 7);
+      else           _buf[idx >> 3] &= ~(0x80 >> (idx & 7));
+    }
   }
 
   bool Panel_GDEW0154M09::_read_pixel(uint_fast16_t x, uint_fast16_t y)
@@ -391,6 +300,39 @@ namespace lgfx
     _bus->wait();
   }
 
+  /// 変更範囲を前回表示した内容と比較し、実際に変化した範囲へ絞る。
+  /// 全画面更新の時期であれば full を true にする。変化が無ければ false ;
+  bool Panel_GDEW0154M09::_diff_range(range_rect_t& range, bool& full)
+  {
+    if (!_diff.isInitialized() && !_diff.init(_cfg.panel_width, _cfg.panel_height, 1))
+    { // 差分用のメモリを確保できない場合は毎回高画質で更新する;
+      full = true;
+      return true;
+    }
+    int32_t xs = range.left;
+    int32_t xe = range.right;
+    int32_t ys = range.top;
+    int32_t ye = range.bottom;
+    if (!_diff.isValid())
+    {
+      xs = 0;
+      ys = 0;
+      xe = _cfg.panel_width - 1;
+      ye = _cfg.panel_height - 1;
+    }
+    uint32_t stride = ((_cfg.panel_width + 7) & ~7) >> 3;
+    for (int32_t y = ys; y <= ye; ++y)
+    {
+      _diff.compareRow(y, &_buf[y * stride], xs, xe);
+    }
+    /// リフレッシュ時間は範囲に依らないため、変化した範囲全体を1回で更新する;
+    /// a refresh takes the same time whatever its size, so update one bounding rectangle.
+    EPD_Diff::update_t update;
+    if (0 == _diff.getUpdates(&update, 1, full)) { return false; }
+    range = update.rect;
+    return true;
+  }
+
   void Panel_GDEW0154M09::_update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye)
   {
     _rotate_pos(xs, ys, xe, ye);
@@ -402,10 +344,7 @@ namespace lgfx
     {
       _close_transfer();
     }
-    _range_mod.top    = std::min<int32_t>(ys, _range_mod.top);
-    _range_mod.left   = std::min<int32_t>(x1, _range_mod.left);
-    _range_mod.right  = std::max<int32_t>(x2, _range_mod.right);
-    _range_mod.bottom = std::max<int32_t>(ye, _range_mod.bottom);
+    _add_dirty_rect(x1, ys, x2, ye);
   }
 
 //----------------------------------------------------------------------------
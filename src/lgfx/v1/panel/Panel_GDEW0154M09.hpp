@@ -19,6 +19,7 @@ Contributors:
 
 #include "Panel_HasBuffer.hpp"
 #include "../misc/range.hpp"
+#include "../misc/EPD_Diff.hpp"
 
 namespace lgfx
 {
@@ -42,30 +43,33 @@ namespace lgfx
     bool displayBusy(void) override;
     void display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h) override;
 
-    void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor) override;
-    void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) override;
-    void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) override;
-
     uint32_t readCommand(uint_fast16_t, uint_fast8_t, uint_fast8_t) override { return 0; }
     uint32_t readData(uint_fast8_t, uint_fast8_t) override { return 0; }
 
     void readRect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, void* dst, pixelcopy_t* param) override;
 
+    /// epd_auto の場合に、残像を消すための全画面更新を部分更新 count 回毎に行う;
+    /// In epd_auto mode, flash the whole panel after every count partial updates.
+    void setFullRefreshInterval(uint16_t count) { _diff.setFullRefreshInterval(count); }
+
   private:
 
     static constexpr unsigned long _refresh_msec = 320;
 
     range_rect_t _range_old;
     unsigned long _send_msec = 0;
+    EPD_Diff _diff;
 
     size_t _get_buffer_length(void) const override;
 
     bool _wait_busy(uint32_t timeout = 1000);
-    void _draw_pixel(uint_fast16_t x, uint_fast16_t y, uint32_t value);
     bool _read_pixel(uint_fast16_t x, uint_fast16_t y);
-    void _update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye);
+    void _write_level(uint_fast16_t x, uint_fast16_t y, uint_fast8_t level) override;
+    void _write_levels(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* levels) override;
+    void _update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye) override;
     void _exec_transfer(uint32_t cmd, const range_rect_t& range, bool invert = false);
     void _close_transfer(void);
+    bool _diff_range(range_rect_t& range, bool& full);
 
     const uint8_t* getInitCommands(uint8_t listno) const override
     {
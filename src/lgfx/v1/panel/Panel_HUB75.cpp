@@ -31,16 +31,6 @@ namespace lgfx
     _frame_buffer.release();
   }
 
-  Panel_HUB75_Multi::~Panel_HUB75_Multi(void)
-  {
-    if (_panel_position)
-    {
-      heap_free(_panel_position);
-      _panel_position = nullptr;
-    }
-    _panel_position_count = 0;
-  }
-
   bool Panel_HUB75::init(bool use_reset)
   {
     return _init_impl(_cfg.panel_width, _cfg.panel_height);
@@ -175,147 +165,234 @@ namespace lgfx
     }
   }
 
-  void Panel_HUB75_Multi::_draw_pixel_inner(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
+  void Panel_HUB75::_fill_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint32_t rawcolor)
   {
-    uint32_t indexmask = _x_hitcheck_mask[x >> _x_hitcheck_shift] & _y_hitcheck_mask[y >> _y_hitcheck_shift];
-    if (!indexmask) { return; }
+    if (convertCoordinate)
+    {
+      do { Panel_HUB75::_draw_pixel_inner(x++, y, rawcolor); } while (--w);
+      return;
+    }
+    auto buf = _frame_buffer.getLineBuffer(y);
+    switch (_write_bits >> 3)
+    {
+      default:
+        memset(&buf[x], rawcolor, w);
+        break;
 
-    auto single_width = _config_detail.single_width;
-    auto single_height = _config_detail.single_height;
-    for (uint_fast8_t panel_index = 0; indexmask; ++panel_index, indexmask >>= 1)
+      case 2:
+      { // swap565ではなく rgb565で扱う
+        uint16_t color = rawcolor << 8 | ((rawcolor >> 8) & 0xFF);
+        auto b16 = &((uint16_t*)buf)[x];
+        do { *b16++ = color; } while (--w);
+      }
+        break;
+
+      case 3:
+      {
+        auto b24 = &((lgfx::bgr888_t*)buf)[x];
+        do { *b24++ = rawcolor; } while (--w);
+      }
+        break;
+    }
+  }
+
+  void Panel_HUB75::_write_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* src)
+  {
+    size_t bytes = _write_bits >> 3;
+    if (convertCoordinate)
     {
-      if (indexmask & 1)
+      do
       {
-        auto r = _panel_position[panel_index].rotation;
-        uint_fast16_t ix = x - _panel_position[panel_index].x;
-        uint_fast16_t iy = y - _panel_position[panel_index].y;
-        if (r & 1)
+        uint32_t raw = *src++;
+        for (size_t by = 1; by < bytes; ++by)
         {
-          std::swap(ix, iy);
+          raw += (*src++) << (by * 8);
         }
-        if (ix >= single_width) { continue; }
-        if (iy >= single_height) { continue; }
-        if (r)
-        {
-          r = 1 << r;
-          if (0b11001100 & r) { ix = single_width  - ix - 1; }
-          if (0b10010110 & r) { iy = single_height - iy - 1; }
-        }
-
-        Panel_HUB75::_draw_pixel_inner(ix + panel_index * single_width, iy, rawcolor);
-      }
+        Panel_HUB75::_draw_pixel_inner(x++, y, raw);
+      } while (--w);
+      return;
+    }
+    auto buf = _frame_buffer.getLineBuffer(y);
+    if (bytes == 2)
+    { // swap565ではなく rgb565で扱う
+      auto b16 = &((uint16_t*)buf)[x];
+      do
+      {
+        *b16++ = src[0] << 8 | src[1];
+        src += 2;
+      } while (--w);
+    }
+    else
+    {
+      memcpy(&buf[x * bytes], src, w * bytes);
     }
   }
 
-  uint32_t Panel_HUB75_Multi::_read_pixel_inner(uint_fast16_t x, uint_fast16_t y)
+  void Panel_HUB75::_read_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint8_t* dst)
   {
-    uint32_t indexmask = _x_hitcheck_mask[x >> _x_hitcheck_shift] & _y_hitcheck_mask[y >> _y_hitcheck_shift];
-    if (!indexmask) { return 0; }
+    size_t bytes = _read_bits >> 3;
+    if (convertCoordinate)
     {
-      auto single_width = _config_detail.single_width;
-      auto single_height = _config_detail.single_height;
-      for (uint_fast8_t panel_index = 0; indexmask; ++panel_index, indexmask >>= 1)
+      do
       {
-        if (indexmask & 1)
+        uint32_t raw = Panel_HUB75::_read_pixel_inner(x++, y);
+        *dst++ = raw;
+        for (size_t by = 1; by < bytes; ++by)
         {
-          uint_fast8_t r = _panel_position[panel_index].rotation;
-          uint_fast16_t ix = x - _panel_position[panel_index].x;
-          uint_fast16_t iy = y - _panel_position[panel_index].y;
-          if (r & 1)
-          {
-            std::swap(ix, iy);
-          }
-          if (ix >= single_width) { continue; }
-          if (iy >= single_height) { continue; }
-          if (r)
-          {
-            r = 1 << r;
-            if (0b11001100 & r) { ix = single_width  - ix - 1; }
-            if (0b10010110 & r) { iy = single_height - iy - 1; }
-          }
-          return Panel_HUB75::_read_pixel_inner(ix + panel_index * single_width, iy);
+          *dst++ = raw >>= 8;
         }
-      }
+      } while (--w);
+      return;
+    }
+    auto buf = _frame_buffer.getLineBuffer(y);
+    if (bytes == 2)
+    {
+      auto b16 = &((uint16_t*)buf)[x];
+      do
+      {
+        uint_fast16_t tmp = *b16++;
+        dst[0] = tmp >> 8;
+        dst[1] = tmp;
+        dst += 2;
+      } while (--w);
+    }
+    else
+    {
+      memcpy(dst, &buf[x * bytes], w * bytes);
     }
-    return 0;
   }
 
-  bool Panel_HUB75_Multi::_init_hitcheck(void)
+  void Panel_HUB75_Multi::_fill_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint32_t rawcolor)
   {
-    if (_panel_position == nullptr)
+    uint32_t indexmask = _layout.getRowHitMask(y);
+    for (uint_fast8_t panel_index = 0; indexmask; ++panel_index, indexmask >>= 1)
     {
-      auto panel_count = _config_detail.panel_count;
-      if (panel_count < 1)
+      if (!(indexmask & 1)) { continue; }
+      uint_fast16_t sx = x, sw = w, ix, iy;
+      int_fast8_t dx, dy;
+      if (!_layout.clipSpan(panel_index, y, sx, sw, ix, iy, dx, dy)) { continue; }
+      if (dy == 0)
       {
-        return false;
+        Panel_HUB75::_fill_span_inner(dx > 0 ? ix : ix + 1 - sw, iy, sw, rawcolor);
+      }
+      else
+      {
+        do { Panel_HUB75::_draw_pixel_inner(ix, iy, rawcolor); iy += dy; } while (--sw);
       }
-      _panel_position_count = panel_count;
-      _panel_position = (panel_position_t*)heap_alloc_dma(panel_count * sizeof(panel_position_t));
-      memset(_panel_position, 0, panel_count * sizeof(panel_position_t));
-      memset(_x_hitcheck_mask, 0, sizeof(_x_hitcheck_mask));
-      memset(_y_hitcheck_mask, 0, sizeof(_y_hitcheck_mask));
-
-      uint32_t s = 0;
-      uint32_t tmp = _cfg.panel_width - 1;
-      while (tmp >>= 1) { ++s; }
-      _x_hitcheck_shift = (s > 2) ? (s - 2) : 0;
-
-      s = 0;
-      tmp = _cfg.panel_height - 1;
-      while (tmp >>= 1) { ++s; }
-      _y_hitcheck_shift = (s > 2) ? (s - 2) : 0;
     }
-    return _panel_position != nullptr;
   }
 
-  bool Panel_HUB75_Multi::setPanelPosition(uint_fast8_t index, uint_fast16_t x, uint_fast16_t y, uint_fast8_t rotation)
+  void Panel_HUB75_Multi::_write_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* src)
   {
-    if (!_init_hitcheck()) { return false; }
-    auto panel_count = _config_detail.panel_count;
-    if (index < panel_count)
+    size_t bytes = _write_bits >> 3;
+    uint8_t* tmp = nullptr;
+    uint32_t indexmask = _layout.getRowHitMask(y);
+    for (uint_fast8_t panel_index = 0; indexmask; ++panel_index, indexmask >>= 1)
     {
-      _panel_position[index].x = x;
-      _panel_position[index].y = y;
-      _panel_position[index].rotation = rotation;
-
-      static constexpr const size_t x_size = sizeof(_x_hitcheck_mask) / sizeof(_x_hitcheck_mask[0]);
-      static constexpr const size_t y_size = sizeof(_y_hitcheck_mask) / sizeof(_y_hitcheck_mask[0]);
-
-      uint32_t mask_index = 1 << index;
-
-      auto w = _config_detail.single_width;
-      auto h = _config_detail.single_height;
-      if (rotation & 1)
+      if (!(indexmask & 1)) { continue; }
+      uint_fast16_t sx = x, sw = w, ix, iy;
+      int_fast8_t dx, dy;
+      if (!_layout.clipSpan(panel_index, y, sx, sw, ix, iy, dx, dy)) { continue; }
+      auto s = &src[(sx - x) * bytes];
+      if (dy == 0)
       {
-        std::swap(w, h);
+        if (dx < 0)
+        { // パネルが左右反転している場合は逆順に並べ替えて書込む
+          if (tmp == nullptr) { tmp = (uint8_t*)alloca(w * bytes); }
+          memcpy(tmp, s, sw * bytes);
+          _reverse_span(tmp, sw, bytes);
+          s = tmp;
+          ix = ix + 1 - sw;
+        }
+        Panel_HUB75::_write_span_inner(ix, iy, sw, s);
       }
-      for (size_t i = 0; i < x_size; ++i)
+      else
       {
-        _x_hitcheck_mask[i] &= ~mask_index;
+        do
+        {
+          uint32_t raw = *s++;
+          for (size_t by = 1; by < bytes; ++by)
+          {
+            raw += (*s++) << (by * 8);
+          }
+          Panel_HUB75::_draw_pixel_inner(ix, iy, raw);
+          iy += dy;
+        } while (--sw);
       }
-      uint_fast16_t xe = (x + w - 1) >> _x_hitcheck_shift;
-      if (xe > x_size - 1) { xe = x_size - 1; }
-      x >>= _x_hitcheck_shift;
-      while (x <= xe)
+    }
+  }
+
+  void Panel_HUB75_Multi::_read_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint8_t* dst)
+  {
+    size_t bytes = _read_bits >> 3;
+    memset(dst, 0, w * bytes);
+    uint32_t indexmask = _layout.getRowHitMask(y);
+    if (!indexmask) { return; }
+    // パネルが重なっている場合は番号の小さいパネルを優先するため、逆順に読み出す
+    for (int_fast8_t panel_index = 31 - __builtin_clz(indexmask); panel_index >= 0; --panel_index)
+    {
+      if (!(indexmask & (1u << panel_index))) { continue; }
+      uint_fast16_t sx = x, sw = w, ix, iy;
+      int_fast8_t dx, dy;
+      if (!_layout.clipSpan(panel_index, y, sx, sw, ix, iy, dx, dy)) { continue; }
+      auto d = &dst[(sx - x) * bytes];
+      if (dy == 0)
       {
-        _x_hitcheck_mask[x] |= mask_index;
-        ++x;
+        Panel_HUB75::_read_span_inner(dx > 0 ? ix : ix + 1 - sw, iy, sw, d);
+        if (dx < 0) { _reverse_span(d, sw, bytes); }
       }
+      else
+      {
+        do
+        {
+          uint32_t raw = Panel_HUB75::_read_pixel_inner(ix, iy);
+          *d++ = raw;
+          for (size_t by = 1; by < bytes; ++by)
+          {
+            *d++ = raw >>= 8;
+          }
+          iy += dy;
+        } while (--sw);
+      }
+    }
+  }
 
-      for (size_t i = 0; i < y_size; ++i)
+  void Panel_HUB75_Multi::_draw_pixel_inner(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
+  {
+    uint32_t indexmask = _layout.getHitMask(x, y);
+    for (uint_fast8_t panel_index = 0; indexmask; ++panel_index, indexmask >>= 1)
+    {
+      uint_fast16_t ix, iy;
+      if ((indexmask & 1) && _layout.toPhysical(panel_index, x, y, ix, iy))
       {
-        _y_hitcheck_mask[i] &= ~mask_index;
+        Panel_HUB75::_draw_pixel_inner(ix, iy, rawcolor);
       }
-      uint_fast16_t ye = (y + h - 1) >> _y_hitcheck_shift;
-      if (ye > y_size - 1) { ye = y_size - 1; }
-      y >>= _y_hitcheck_shift;
-      while (y <= ye)
+    }
+  }
+
+  uint32_t Panel_HUB75_Multi::_read_pixel_inner(uint_fast16_t x, uint_fast16_t y)
+  {
+    uint32_t indexmask = _layout.getHitMask(x, y);
+    for (uint_fast8_t panel_index = 0; indexmask; ++panel_index, indexmask >>= 1)
+    {
+      uint_fast16_t ix, iy;
+      if ((indexmask & 1) && _layout.toPhysical(panel_index, x, y, ix, iy))
       {
-        _y_hitcheck_mask[y] |= mask_index;
-        ++y;
+        return Panel_HUB75::_read_pixel_inner(ix, iy);
       }
     }
-    return true;
+    return 0;
+  }
+
+  bool Panel_HUB75_Multi::_init_hitcheck(void)
+  {
+    return _layout.init(_config_detail.panel_count, _config_detail.single_width, _config_detail.single_height, _cfg.panel_width, _cfg.panel_height);
+  }
+
+  bool Panel_HUB75_Multi::setPanelPosition(uint_fast8_t index, uint_fast16_t x, uint_fast16_t y, uint_fast8_t rotation)
+  {
+    if (!_init_hitcheck()) { return false; }
+    return _layout.setPanelPosition(index, x, y, rotation);
   }
 
 //----------------------------------------------------------------------------
@@ -20,6 +20,7 @@ Contributors:
 #include "Panel_FlexibleFrameBuffer.hpp"
 
 #include "../misc/DividedFrameBuffer.hpp"
+#include "../misc/HUB75_Encoder.hpp"
 
 namespace lgfx
 {
@@ -58,6 +59,11 @@ namespace lgfx
 
     uint32_t _read_pixel_inner(uint_fast16_t x, uint_fast16_t y) override;
     void _draw_pixel_inner(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) override;
+
+    // 行バッファへ直接書込む。convertCoordinate が設定されている場合は1ピクセル単位で処理する
+    void _fill_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint32_t rawcolor) override;
+    void _write_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* src) override;
+    void _read_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint8_t* dst) override;
   };
 
 
@@ -67,8 +73,6 @@ namespace lgfx
   {
   public:
 
-    virtual ~Panel_HUB75_Multi(void);
-
     bool init(bool use_reset) override;
 
     struct config_detail_t
@@ -90,30 +94,19 @@ namespace lgfx
     bool setPanelPosition(uint_fast8_t index, uint_fast16_t x, uint_fast16_t y, uint_fast8_t rotation = 0);
 
   protected:
-    struct panel_position_t
-    {
-      uint16_t x;
-      uint16_t y;
-      uint8_t rotation;
-    };
-
     config_detail_t _config_detail;
 
-// 座標の上位3ビットを使用し、座標範囲に該当するパネルを判定するためのテーブル
-    uint32_t _x_hitcheck_mask[8];
-    uint32_t _y_hitcheck_mask[8];
-    uint8_t _x_hitcheck_shift = 0;
-    uint8_t _y_hitcheck_shift = 0;
-
-    panel_position_t* _panel_position = nullptr;
-    size_t  _panel_position_count = 0;
-
-    uint16_t _single_width;
-    uint16_t _single_height;
+    // 仮想座標から各パネルの物理座標への変換 (PC上でも検証できるよう HUB75_Encoder.hpp に分離)
+    HUB75_PanelLayout _layout;
 
     bool _init_hitcheck(void);
     uint32_t _read_pixel_inner(uint_fast16_t x, uint_fast16_t y) override;
     void _draw_pixel_inner(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) override;
+
+    // 範囲を各パネルとの重なり毎に分割し、パネル内で横一列になる場合は行単位で処理する
+    void _fill_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint32_t rawcolor) override;
+    void _write_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* src) override;
+    void _read_span_inner(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint8_t* dst) override;
   };
 
 //----------------------------------------------------------------------------
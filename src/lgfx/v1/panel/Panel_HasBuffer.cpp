@@ -18,8 +18,13 @@ Contributors:
 #include "Panel_HasBuffer.hpp"
 
 #include "../platforms/common.hpp"
+#include "../misc/pixelcopy.hpp"
+#include "../misc/colortype.hpp"
 #include "../Bus.hpp"
 
+#include <string.h>
+#include <algorithm>
+
 namespace lgfx
 {
  inline namespace v1
@@ -34,14 +39,12 @@ namespace lgfx
   Panel_HasBuffer::Panel_HasBuffer(void) : Panel_Device()
   {
     _auto_display = true;
+    _dither_mode = dither_mode_t::dither_bayer4;
   }
 
   bool Panel_HasBuffer::init(bool use_reset)
   {
-    _range_mod.top = INT16_MAX;
-    _range_mod.left = INT16_MAX;
-    _range_mod.right = 0;
-    _range_mod.bottom = 0;
+    _clear_dirty_rects();
 
     auto len = _get_buffer_length();
     if (_buf) heap_free(_buf);
@@ -85,6 +88,7 @@ namespace lgfx
     _ys = ys;
     _xe = xe;
     _ye = ye;
+    _dither.resetError();
   }
 
   void Panel_HasBuffer::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
@@ -132,6 +136,196 @@ namespace lgfx
     _ypos = ypos;
   }
 
+  void Panel_HasBuffer::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
+  {
+    uint_fast16_t xs = x, xe = x + w - 1;
+    uint_fast16_t ys = y, ye = y + h - 1;
+    _xs = xs;
+    _ys = ys;
+    _xe = xe;
+    _ye = ye;
+    _update_transferred_rect(xs, ys, xe, ye);
+
+    uint8_t gray;
+    _gray_row(&gray, &rawcolor, 1);
+
+    // 塗り潰しはパネル座標で行うため回転の影響を受けない;
+    w = xe - xs + 1;
+    auto levels = (uint8_t*)alloca(w);
+    y = ys;
+    do
+    {
+      _dither.fillRow(_dither_mode, levels, gray, xs, y, w);
+      _write_levels(xs, y, w, levels);
+    } while (++y <= ye);
+  }
+
+  void Panel_HasBuffer::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma)
+  {
+    uint_fast16_t xs = x, xe = x + w - 1;
+    uint_fast16_t ys = y, ye = y + h - 1;
+    _update_transferred_rect(xs, ys, xe, ye);
+
+    size_t bytes = _write_bits >> 3;
+    auto readbuf = (uint8_t*)alloca(w * bytes);
+    auto gray    = (uint8_t*)alloca(w);
+    auto levels  = (uint8_t*)alloca(w);
+    auto drawn   = (uint8_t*)alloca(w);
+    /// 透過色で読み飛ばされた画素も輝度変換の対象になるため、未初期化のまま読まないよう一度だけ消去する;
+    /// skipped (transparent) pixels are still converted, so never leave them uninitialized.
+    memset(readbuf, 0, w * bytes);
+
+    int_fast8_t dx, dy;
+    _get_row_step(dx, dy);
+    _dither.resetError();
+
+    auto sx = param->src_x32;
+    h += y;
+    do
+    {
+      uint32_t prev_pos = 0, new_pos = 0;
+      memset(drawn, 0, w);
+      do
+      {
+        new_pos = param->fp_copy(readbuf, prev_pos, w, param);
+        memset(&drawn[prev_pos], 1, new_pos - prev_pos);
+      } while (w != new_pos && w != (prev_pos = param->fp_skip(new_pos, w, param)));
+      param->src_x32 = sx;
+      param->src_y++;
+
+      _gray_row(gray, readbuf, w);
+      uint_fast16_t px = x, py = y;
+      _rotate_pos(px, py);
+      _dither.imageRow(_dither_mode, levels, gray, px, py, w, dx, dy);
+
+      /// 描画された区間のみを書込む;
+      /// store only the runs that were drawn.
+      for (uint32_t i = 0; i < w; ++i)
+      {
+        if (!drawn[i]) { continue; }
+        uint32_t j = i;
+        while (++j < w && drawn[j]);
+        _write_row(x + i, y, j - i, &levels[i]);
+        i = j;
+      }
+    } while (++y < h);
+  }
+
+  void Panel_HasBuffer::writePixels(pixelcopy_t* param, uint32_t length, bool use_dma)
+  {
+    {
+      uint_fast16_t xs = _xs;
+      uint_fast16_t xe = _xe;
+      uint_fast16_t ys = _ys;
+      uint_fast16_t ye = _ye;
+      _update_transferred_rect(xs, ys, xe, ye);
+    }
+    uint_fast16_t xs   = _xs  ;
+    uint_fast16_t ys   = _ys  ;
+    uint_fast16_t xe   = _xe  ;
+    uint_fast16_t ye   = _ye  ;
+    uint_fast16_t xpos = _xpos;
+    uint_fast16_t ypos = _ypos;
+
+    uint32_t buflen = std::min<uint32_t>(length, xe - xs + 1);
+    auto readbuf = (uint8_t*)alloca(buflen * (_write_bits >> 3));
+    auto gray    = (uint8_t*)alloca(buflen);
+    auto levels  = (uint8_t*)alloca(buflen);
+
+    int_fast8_t dx, dy;
+    _get_row_step(dx, dy);
+    do
+    {
+      uint32_t len = std::min<uint32_t>(length, std::min<uint32_t>(buflen, xe + 1 - xpos));
+      param->fp_copy(readbuf, 0, len, param);
+      _gray_row(gray, readbuf, len);
+      uint_fast16_t px = xpos, py = ypos;
+      _rotate_pos(px, py);
+      /// 誤差拡散は描画範囲の左端からの位置で行を継続する;
+      /// error diffusion continues a row by its position from the window's left edge.
+      _dither.imageRow(_dither_mode, levels, gray, px, py, len, dx, dy, xpos - xs);
+      _write_row(xpos, ypos, len, levels);
+      xpos += len;
+      if (xpos > xe)
+      {
+        xpos = xs;
+        if (++ypos > ye)
+        {
+          ypos = ys;
+        }
+      }
+      length -= len;
+    } while (length);
+    _xpos = xpos;
+    _ypos = ypos;
+  }
+
+  void Panel_HasBuffer::_update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye)
+  {
+    _rotate_pos(xs, ys, xe, ye);
+    _add_dirty_rect(xs, ys, xe, ye);
+  }
+
+  void Panel_HasBuffer::_gray_row(uint8_t* dst, const void* src, uint32_t length)
+  {
+    if (_write_bits == 16)
+    {
+      auto s = (const swap565_t*)src;
+      for (uint32_t i = 0; i < length; ++i)
+      {
+        dst[i] = (s[i].R8() + (s[i].G8() << 1) + s[i].B8()) >> 2;
+      }
+    }
+    else
+    {
+      auto s = (const bgr888_t*)src;
+      for (uint32_t i = 0; i < length; ++i)
+      {
+        dst[i] = (s[i].R8() + (s[i].G8() << 1) + s[i].B8()) >> 2;
+      }
+    }
+  }
+
+  void Panel_HasBuffer::_write_levels(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* levels)
+  {
+    for (uint32_t i = 0; i < w; ++i)
+    {
+      _write_level(x + i, y, levels[i]);
+    }
+  }
+
+  void Panel_HasBuffer::_write_row(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint8_t* levels)
+  {
+    int_fast8_t dx, dy;
+    _get_row_step(dx, dy);
+    _rotate_pos(x, y);
+    if (dy == 0)
+    {
+      if (dx < 0)
+      {
+        std::reverse(levels, levels + w);
+        x -= w - 1;
+      }
+      _write_levels(x, y, w, levels);
+      return;
+    }
+    for (uint32_t i = 0; i < w; ++i)
+    {
+      _write_level(x, y, levels[i]);
+      y += dy;
+    }
+  }
+
+  void Panel_HasBuffer::_get_row_step(int_fast8_t &dx, int_fast8_t &dy) const
+  {
+    uint_fast8_t r = _internal_rotation;
+    dx = (r & 1) ? 0 : 1;
+    dy = (r & 1) ? 1 : 0;
+    uint_fast8_t rb = 1 << r;
+    if (rb & 0b11000110) { dx = -dx; } // case 1:2:6:7:
+    if (rb & 0b10011100) { dy = -dy; } // case 2:3:4:7:
+  }
+
   void Panel_HasBuffer::_rotate_pos(uint_fast16_t &x, uint_fast16_t &y)
   {
     uint_fast8_t r = _internal_rotation;
@@ -166,6 +360,104 @@ namespace lgfx
     }
   }
 
+  static inline int32_t dirty_rect_area(const range_rect_t& r)
+  {
+    return (int32_t)r.width() * r.height();
+  }
+
+  static inline range_rect_t dirty_rect_union(const range_rect_t& a, const range_rect_t& b)
+  {
+    range_rect_t res;
+    res.left   = std::min(a.left  , b.left  );
+    res.right  = std::max(a.right , b.right );
+    res.top    = std::min(a.top   , b.top   );
+    res.bottom = std::max(a.bottom, b.bottom);
+    return res;
+  }
+
+  /// 統合によって増える(転送不要な)面積。重なっている場合は負になる;
+  /// area that merging would add; negative when the rectangles overlap.
+  static inline int32_t dirty_rect_waste(const range_rect_t& a, const range_rect_t& b)
+  {
+    return dirty_rect_area(dirty_rect_union(a, b)) - dirty_rect_area(a) - dirty_rect_area(b);
+  }
+
+  void Panel_HasBuffer::_add_dirty_rect(int_fast16_t xs, int_fast16_t ys, int_fast16_t xe, int_fast16_t ye)
+  {
+    _range_mod.left   = std::min(xs, _range_mod.left  );
+    _range_mod.right  = std::max(xe, _range_mod.right );
+    _range_mod.top    = std::min(ys, _range_mod.top   );
+    _range_mod.bottom = std::max(ye, _range_mod.bottom);
+
+    range_rect_t rect;
+    rect.left   = xs;
+    rect.right  = xe;
+    rect.top    = ys;
+    rect.bottom = ye;
+
+    /// 統合しても損をしない矩形は吸収する。統合で大きくなった矩形が他と重なることがあるため繰り返す;
+    /// absorb every rectangle that is cheaper to merge than to send separately;
+    /// repeat, since the grown rectangle may now overlap others.
+    size_t i = 0;
+    while (i < _dirty_count)
+    {
+      if (dirty_rect_waste(rect, _dirty_rects[i]) <= (int32_t)_dirty_rect_overhead)
+      {
+        rect = dirty_rect_union(rect, _dirty_rects[i]);
+        _dirty_rects[i] = _dirty_rects[--_dirty_count];
+        i = 0;
+      }
+      else
+      {
+        ++i;
+      }
+    }
+
+    if (_dirty_count < dirty_rect_max)
+    {
+      _dirty_rects[_dirty_count++] = rect;
+      return;
+    }
+
+    /// 上限に達している場合は、新しい矩形を含めて増える面積が最小の組を統合する;
+    /// the list is full: merge the pair (the new rectangle included) whose union adds the least area.
+    size_t best_i = 0;
+    size_t best_j = dirty_rect_max;
+    int32_t best = INT32_MAX;
+    for (size_t j = 0; j <= dirty_rect_max; ++j)
+    {
+      auto& rj = (j == dirty_rect_max) ? rect : _dirty_rects[j];
+      for (i = 0; i < j; ++i)
+      {
+        int32_t waste = dirty_rect_waste(_dirty_rects[i], rj);
+        if (best > waste)
+        {
+          best = waste;
+          best_i = i;
+          best_j = j;
+        }
+      }
+    }
+    if (best_j != dirty_rect_max)
+    {
+      _dirty_rects[best_i] = dirty_rect_union(_dirty_rects[best_i], _dirty_rects[best_j]);
+      _dirty_rects[best_j] = rect;
+    }
+    else
+    {
+      _dirty_rects[best_i] = dirty_rect_union(_dirty_rects[best_i], rect);
+    }
+  }
+
+  void Panel_HasBuffer::_clear_dirty_rects(void)
+  {
+    _range_mod.top    = INT16_MAX;
+    _range_mod.left   = INT16_MAX;
+    _range_mod.right  = 0;
+    _range_mod.bottom = 0;
+    _dirty_count = 0;
+  }
+
 //----------------------------------------------------------------------------
  }
 }
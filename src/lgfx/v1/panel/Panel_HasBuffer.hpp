@@ -19,6 +19,7 @@ Contributors:
 
 #include "Panel_Device.hpp"
 #include "../misc/range.hpp"
+#include "../misc/dither.hpp"
 
 namespace lgfx
 {
@@ -44,9 +45,37 @@ namespace lgfx
     void drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) override;
     void writeBlock(uint32_t rawcolor, uint32_t length) override;
 
+    /// 描画はディザリング (setDitherMode) を経て _write_level / _write_levels で階調値として書込まれる;
+    /// Drawing goes through the ditherer (see setDitherMode) and reaches the buffer as levels
+    /// through _write_level / _write_levels.
+    void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor) override;
+    void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) override;
+    void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) override;
+
+    /// display() まで保持する変更範囲の最大数。超えた場合は統合後の面積の増加が最も少ない組をまとめる;
+    /// Maximum number of dirty rectangles kept until display().
+    /// When it is exceeded, the pair whose union adds the least area is merged.
+    static constexpr size_t dirty_rect_max = 4;
+
+    /// display() 待ちの変更範囲を取得する。座標は回転前のパネルの座標系;
+    /// Dirty rectangles waiting for display(), in unrotated panel coordinates.
+    size_t getDirtyRectCount(void) const { return _dirty_count; }
+    const range_rect_t& getDirtyRect(size_t index) const { return _dirty_rects[index]; }
+
   protected:
     uint8_t* _buf = nullptr;
+    Ditherer _dither;
+
+    /// 全ての変更範囲を包含する矩形;
+    /// bounding box of every dirty rectangle.
     range_rect_t _range_mod;
+    range_rect_t _dirty_rects[dirty_rect_max];
+    uint8_t _dirty_count = 0;
+
+    /// 別々に転送する場合の1矩形あたりのコストをピクセル数で表したもの。これより無駄な面積が少なければ統合する;
+    /// Per-transfer overhead expressed in pixels; two rectangles are merged when their union wastes less than this.
+    uint32_t _dirty_rect_overhead = 64;
+
     int32_t _xpos = 0;
     int32_t _ypos = 0;
     bool _in_transaction = false;
@@ -54,6 +83,30 @@ namespace lgfx
     virtual size_t _get_buffer_length(void) const = 0;
     void _rotate_pos(uint_fast16_t &x, uint_fast16_t &y);
     void _rotate_pos(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye);
+
+    void _add_dirty_rect(int_fast16_t xs, int_fast16_t ys, int_fast16_t xe, int_fast16_t ye);
+    void _clear_dirty_rects(void);
+
+    /// 描画範囲をパネル座標へ変換し、変更範囲に加える;
+    /// Rotates a drawing range to panel coordinates and marks it dirty.
+    virtual void _update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye);
+
+    /// _write_depth 形式の色データを 8bit の輝度へ変換する;
+    /// Converts colors in the _write_depth format to 8-bit gray.
+    virtual void _gray_row(uint8_t* dst, const void* src, uint32_t length);
+
+    /// パネル座標へ階調値 (0 ~ _dither.getLevels()-1) を書込む;
+    /// Stores levels (0 .. _dither.getLevels() - 1) at panel coordinates.
+    virtual void _write_level(uint_fast16_t x, uint_fast16_t y, uint_fast8_t level) = 0;
+    virtual void _write_levels(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* levels);
+
+    /// 回転後の座標で横1ライン分の階調値を書込む。levels の内容は書換えられることがある;
+    /// Stores a row given in rotated coordinates; levels may be modified.
+    void _write_row(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint8_t* levels);
+
+    /// 回転後の座標で右へ1画素進んだ時のパネル座標の移動量;
+    /// Panel coordinate step for one pixel to the right in rotated coordinates.
+    void _get_row_step(int_fast8_t &dx, int_fast8_t &dy) const;
   };
 
 //----------------------------------------------------------------------------
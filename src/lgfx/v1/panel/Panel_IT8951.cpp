@@ -21,6 +21,8 @@ Contributors:
 #include "../misc/pixelcopy.hpp"
 #include "../misc/colortype.hpp"
 
+#include <string.h>
+
 #if __has_include (<esp_log.h>)
  #include <esp_log.h>
 #endif
@@ -38,7 +40,13 @@ namespace lgfx
  {
 //----------------------------------------------------------------------------
 
-  static constexpr int8_t Bayer[16] = {-30, 2, -22, 10, 18, -14, 26, -6, -18, 14, -26, 6, 30, -2, 22, -10};
+  static void to_gray_row(uint8_t* dst, const bgr888_t* src, uint32_t length)
+  {
+    for (uint32_t i = 0; i < length; ++i)
+    {
+      dst[i] = (src[i].R8() + (src[i].G8() << 1) + src[i].B8()) >> 2;
+    }
+  }
 
 //Built in I80 Command Code
   static constexpr uint32_t IT8951_TCON_SYS_RUN         = 0x0001;
@@ -111,6 +119,7 @@ IT8951 Registers defines
     _cfg.panel_width  = _cfg.memory_width  = 2048;
     _cfg.panel_height = _cfg.memory_height = 2048;
     _epd_mode = epd_mode_t::epd_quality;
+    _dither_mode = dither_mode_t::dither_bayer4;
     _auto_display = true;
   }
 
@@ -175,6 +184,7 @@ IT8951 Registers defines
 
       setInvert(_invert);
       setRotation(_rotation);
+      _diff.invalidate();
 
       _write_command(IT8951_TCON_SYS_RUN);
       _write_reg(IT8951_I80CPCR, 0x0001); //enable pack write
@@ -445,6 +455,79 @@ IT8951 Registers defines
     return _write_args(IT8951_I80_CMD_DPY_BUF_AREA, params, 7);
   }
 
+  /// 画像メモリから変更範囲を読出して前回の表示内容と比較し、変化した範囲だけを更新する。
+  /// 白黒のみの変化は DU 、中間色を含む変化と定期的な全画面更新は GC16 を使う;
+  /// Reads the modified area back from the image memory, compares it with what is shown and
+  /// refreshes only the changed rectangles: DU where every change is to black or white, GC16 for
+  /// gray changes and for the periodic full refresh.
+  bool Panel_IT8951::_display_auto(void)
+  {
+    if (!_diff.isInitialized() && !_diff.init(_cfg.panel_width, _cfg.panel_height, 4))
+    {
+      return false;
+    }
+    int32_t l = _range_new.left;
+    int32_t r = _range_new.right;
+    int32_t t = _range_new.top;
+    int32_t b = _range_new.bottom;
+    if (!_diff.isValid())
+    {
+      l = 0;
+      t = 0;
+      r = _cfg.panel_width - 1;
+      b = _cfg.panel_height - 1;
+    }
+    // 比較はタイル単位のため、タイル境界に揃えて読出す;
+    l &= ~(EPD_Diff::tile_width - 1);
+    r = std::min<int32_t>(_cfg.panel_width - 1, r | (EPD_Diff::tile_width - 1));
+    uint32_t bufsize = (r - l + 1 + 31) & ~31;
+    // 読出し長は行の右端を越えないようにする;
+    uint32_t len = std::min<uint32_t>(bufsize, _cfg.panel_width - l);
+    auto readbuf = static_cast<uint8_t*>(heap_alloc(bufsize + ((_cfg.panel_width + 1) >> 1)));
+    if (readbuf == nullptr) { return false; }
+    auto row = &readbuf[bufsize];
+
+    // 変更範囲は先に空にしておき、処理中に display() が再度呼ばれても何もしないようにする。
+    // display() は endWrite の中からも呼ばれるため startWrite/endWrite は使わず、
+    // トランザクションが開始されていない場合のみここで開始する;
+    _range_new.top = INT16_MAX;
+    _range_new.left = INT16_MAX;
+    _range_new.right = 0;
+    _range_new.bottom = 0;
+    bool in_transaction = _in_transaction;
+    if (!in_transaction) { beginTransaction(); }
+    for (int32_t y = t; y <= b; ++y)
+    {
+      _read_raw_line(l, y, (len + 1) >> 1, reinterpret_cast<uint16_t*>(readbuf));
+      // 画像メモリは1画素1バイトで上位4bitが階調値;
+      for (int32_t x = l; x <= r; x += 2)
+      {
+        row[x >> 1] = (readbuf[x - l] & 0xF0) | (readbuf[x - l + 1] >> 4);
+      }
+      _diff.compareRow(y, row, l, r);
+    }
+    heap_free(readbuf);
+
+    EPD_Diff::update_t list[4];
+    bool full;
+    size_t count = _diff.getUpdates(list, 4, full);
+    for (size_t i = 0; i < count; ++i)
+    {
+      _range_new = list[i].rect;
+      _update_raw_area((full || list[i].change == EPD_Diff::change_gray) ? UPDATE_MODE_GC16 : UPDATE_MODE_DU);
+      if (i == 0) { _range_old = list[i].rect; }
+      else
+      {
+        _range_old.left   = std::min(_range_old.left  , list[i].rect.left  );
+        _range_old.right  = std::max(_range_old.right , list[i].rect.right );
+        _range_old.top    = std::min(_range_old.top   , list[i].rect.top   );
+        _range_old.bottom = std::max(_range_old.bottom, list[i].rect.bottom);
+      }
+    }
+    if (!in_transaction) { endTransaction(); }
+    return true;
+  }
+
   void Panel_IT8951::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
   {
     if (0 < w && 0 < h)
@@ -457,6 +540,15 @@ IT8951 Registers defines
     }
     if (_range_new.empty()) return;
 
+    if (_epd_mode == epd_mode_t::epd_auto && _display_auto())
+    {
+      _range_new.top = INT16_MAX;
+      _range_new.left = INT16_MAX;
+      _range_new.right = 0;
+      _range_new.bottom = 0;
+      return;
+    }
+
     _range_old = _range_new;
     epd_update_mode_t mode;
     switch (_epd_mode)
@@ -524,6 +616,7 @@ IT8951 Registers defines
     _ys = ys;
     _xe = xe;
     _ye = ye;
+    _dither.resetError();
   }
 
   void Panel_IT8951::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
@@ -533,51 +626,88 @@ IT8951 Registers defines
     endWrite();
   }
 
+  /// 階調値を 4bit ずつ詰めて送信順に並べる。x は先頭画素の座標で、fast の場合は 0 と 15 の2値;
+  /// Packs levels four to a word in transfer order; x is the first pixel's coordinate.
+  uint32_t Panel_IT8951::_pack_levels(uint16_t* dst, const uint8_t* levels, uint_fast16_t x, uint32_t length, bool fast) const
+  {
+    uint_fast16_t mul = fast ? 15 : 1;
+    uint_fast16_t invert = _invert ? 0xFFFF : 0;
+    int32_t shift = (3 - (x & 3)) << 2;
+    uint_fast16_t buf = 0;
+    uint32_t idx = 0;
+    for (uint32_t i = 0; i < length; ++i)
+    {
+      buf |= (levels[i] * mul) << shift;
+      shift -= 4;
+      if (shift < 0)
+      {
+        dst[idx++] = getSwap16(buf ^ invert);
+        buf = 0;
+        shift = 12;
+      }
+    }
+    if (shift != 12)
+    {
+      dst[idx++] = getSwap16(buf ^ invert);
+    }
+    return idx;
+  }
+
   void Panel_IT8951::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
   {
     if (_it8951_rotation & 4)
     {
       y = height() - y - h;
     }
-    _set_area(x, y, w, h);
+    bool fast = _epd_mode == epd_mode_t::epd_fast || _epd_mode == epd_mode_t::epd_fastest;
+    _dither.setLevels(fast ? 2 : 16);
+
+    // 4画素単位に揃えた位置から1ライン分の階調値を作る;
+    uint32_t xs = x & ~3;
+    uint32_t wid = (((x + w + 3) >> 2) - (x >> 2));
+    auto levels = static_cast<uint8_t*>(heap_alloc(wid * 6));
+    if (levels == nullptr) return;
+    auto words = reinterpret_cast<uint16_t*>(&levels[wid * 4]);
+
     bgr888_t color = rawcolor;
-    int32_t sum = color.R8() + (color.G8() << 1) + color.B8();
+    uint8_t gray;
+    to_gray_row(&gray, &color, 1);
+
+    _set_area(x, y, w, h);
     _wait_busy();
     _bus->writeData(0, 16);
-    bool fast = _epd_mode == epd_mode_t::epd_fast || _epd_mode == epd_mode_t::epd_fastest;
-    uint32_t wid = (((x + w + 3) >> 2) - (x >> 2));
     do
     {
-      auto btbl = &Bayer[(y & 3) << 2];
+      _dither.fillRow(_dither_mode, levels, gray, xs, y, wid << 2);
+      _pack_levels(words, levels, xs, wid << 2, fast);
       ++y;
-      uint32_t value;
-      if (fast)
-      {
-        value = (sum + btbl[2]*16 < 512 ? 0 : 0xF000)
-              | (sum + btbl[3]*16 < 512 ? 0 : 0x0F00)
-              | (sum + btbl[0]*16 < 512 ? 0 : 0x00F0)
-              | (sum + btbl[1]*16 < 512 ? 0 : 0x000F);
+      uint32_t i = 0;
+      while (++i < wid && words[i] == words[0]);
+      if (i == wid)
+      { // 全て同じ値の場合 (単色や4画素周期の模様) は繰返し送信する;
+        _bus->writeDataRepeat(words[0], 16, wid);
       }
       else
       {
-        value = std::min<int32_t>(15, (std::max<int32_t>(0, sum + btbl[2])) >> 6) << 12
-              | std::min<int32_t>(15, (std::max<int32_t>(0, sum + btbl[3])) >> 6) <<  8
-              | std::min<int32_t>(15, (std::max<int32_t>(0, sum + btbl[0])) >> 6) <<  4
-              | std::min<int32_t>(15, (std::max<int32_t>(0, sum + btbl[1])) >> 6) ;
+        _bus->writeBytes(reinterpret_cast<uint8_t*>(words), wid << 1, true, false);
       }
-      if (_invert) value = ~value;
-      _bus->writeDataRepeat(value, 16, wid);
     } while (--h);
     _write_command(IT8951_TCON_LD_IMG_END);
+    heap_free(levels);
   }
 
   void Panel_IT8951::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma)
   {
-    uint16_t* writebuf = static_cast<uint16_t*>(heap_alloc(w * sizeof(bgr888_t) + 4));
-    bgr888_t* readbuf = reinterpret_cast<lgfx::bgr888_t*>(&writebuf[2]);
-
+    // 先頭の1ワードはプリアンブル。4画素境界を跨ぐ分の1ワードを加える;
+    uint32_t words = ((w + 6) >> 2) + 1;
+    uint16_t* writebuf = static_cast<uint16_t*>(heap_alloc(words * sizeof(uint16_t) + w * (sizeof(bgr888_t) + 3)));
     if (writebuf == nullptr) return;
+    bgr888_t* readbuf = reinterpret_cast<lgfx::bgr888_t*>(&writebuf[words]);
+    auto gray   = reinterpret_cast<uint8_t*>(&readbuf[w]);
+    auto levels = &gray[w];
+    auto drawn  = &levels[w];
     writebuf[0] = 0;
+    memset(&writebuf[words], 0, w * sizeof(bgr888_t));
 
     int32_t add_y = 1;
     bool flg_setarea = false;
@@ -588,6 +718,8 @@ IT8951 Registers defines
       add_y = -1;
     }
     bool fast = _epd_mode == epd_mode_t::epd_fast || _epd_mode == epd_mode_t::epd_fastest;
+    _dither.setLevels(fast ? 2 : 16);
+    _dither.resetError();
     auto sx = param->src_x32;
 
     bool fastdraw = (param->transp == pixelcopy_t::NON_TRANSP);
@@ -602,55 +734,37 @@ IT8951 Registers defines
     do
     {
       uint32_t prev_pos = 0, new_pos = 0;
+      memset(drawn, 0, w);
       do
       {
         new_pos = param->fp_copy(readbuf, prev_pos, w, param);
-        if (new_pos != prev_pos)
+        memset(&drawn[prev_pos], 1, new_pos - prev_pos);
+      } while (w != new_pos && w != (prev_pos = param->fp_skip(new_pos, w, param)));
+      param->src_x32 = sx;
+      param->src_y += add_y;
+
+      to_gray_row(gray, readbuf, w);
+      _dither.imageRow(_dither_mode, levels, gray, x, y, w);
+
+      for (uint32_t i = 0; i < w; ++i)
+      {
+        if (!drawn[i]) { continue; }
+        uint32_t j = i;
+        while (++j < w && drawn[j]);
+        if (!fastdraw)
         {
-          if (!fastdraw)
+          if (flg_setarea)
           {
-            if (flg_setarea)
-            {
-              _write_command(IT8951_TCON_LD_IMG_END);
-            }
-            flg_setarea = true;
-            _set_area(x + prev_pos, y, new_pos - prev_pos, 1);
-            //_wait_busy();
-            //_bus->writeData(0, 16);
+            _write_command(IT8951_TCON_LD_IMG_END);
           }
-          uint32_t writepos = 1;
-          int32_t shift = (3 - ((x + prev_pos) & 3)) << 2;
-          auto btbl = &Bayer[(y & 3) << 2];
-          do
-          {
-            uint_fast16_t buf = 0;
-            do
-            {
-              auto color = readbuf[prev_pos];
-              int32_t pixel = color.R8() + (color.G8() << 1) + color.B8();
-              if (fast)
-              {
-                pixel = (pixel + btbl[(x + prev_pos) & 3] * 16 < 512) ? 0 : 15;
-              }
-              else
-              {
-                pixel = std::min<int32_t>(15, std::max<int32_t>(0, pixel + btbl[(x + prev_pos) & 3]) >> 6);
-              }
-              buf |= pixel << shift;
-              shift -= 4;
-            } while (new_pos != ++ prev_pos && shift >= 0);
-            if (_invert) buf = ~buf;
-            writebuf[writepos] = getSwap16(buf);
-            writepos++;
-            shift = 12;
-            //_bus->writeData(getSwap16(buf), 16);
-          } while (new_pos != prev_pos);
-          _wait_busy();
-          _bus->writeBytes((uint8_t*)writebuf, writepos << 1, true, false);
+          flg_setarea = true;
+          _set_area(x + i, y, j - i, 1);
         }
-      } while (w != new_pos && w != (prev_pos = param->fp_skip(new_pos, w, param)));
-      param->src_x32 = sx;
-      param->src_y += add_y;
+        uint32_t len = _pack_levels(&writebuf[1], &levels[i], x + i, j - i, fast);
+        _wait_busy();
+        _bus->writeBytes((uint8_t*)writebuf, (len + 1) << 1, true, false);
+        i = j;
+      }
       ++y;
     } while (--h);
     heap_free(writebuf);
@@ -693,48 +807,30 @@ IT8951 Registers defines
     uint32_t w;
 
     uint32_t maxw = std::min(length, xe - xs + 1);
-    bgr888_t* readbuf = static_cast<bgr888_t*>(heap_alloc(maxw * sizeof(bgr888_t)));
-    if (readbuf == nullptr) return;
+    uint32_t words = (maxw + 6) >> 2;
+    uint16_t* writebuf = static_cast<uint16_t*>(heap_alloc(words * sizeof(uint16_t) + maxw * (sizeof(bgr888_t) + 2)));
+    if (writebuf == nullptr) return;
+    bgr888_t* readbuf = reinterpret_cast<lgfx::bgr888_t*>(&writebuf[words]);
+    auto gray   = reinterpret_cast<uint8_t*>(&readbuf[maxw]);
+    auto levels = &gray[maxw];
+
+    bool fast = _epd_mode == epd_mode_t::epd_fast || _epd_mode == epd_mode_t::epd_fastest;
+    _dither.setLevels(fast ? 2 : 16);
     do
     {
       w = std::min(length, xe - xs + 1);
       auto y = _it8951_rotation & 4 ? height() - ypos - 1 : ypos;
-      int32_t prev_pos = 0, new_pos = 0;
-      //do
-      {
-        new_pos = param->fp_copy(readbuf, prev_pos, w, param);
-        //if (new_pos != prev_pos)
-        {
-          _set_area(xpos + prev_pos, y, new_pos - prev_pos, 1);
-          _wait_busy();
-          _bus->writeData(0, 16);
-          uint32_t shift = (3 - ((xpos + prev_pos) & 3)) << 2;
-          uint16_t buf = 0;
-          auto btbl = &Bayer[(y & 3) << 2];
-          do
-          {
-            auto color = readbuf[prev_pos];
-            uint16_t pixel = std::min(15, std::max(0, (color.R8() + (color.G8() << 1) + color.B8() + btbl[(xpos + prev_pos) & 3])) >> 6);
-            buf |= pixel << shift;
-            if (shift)
-            {
-              shift -= 4;
-            }
-            else
-            {
-              _bus->writeData(getSwap16(buf), 16);
-              buf = 0;
-              shift = 12;
-            }
-          } while (new_pos != ++prev_pos);
-          if (shift != 12)
-          {
-            if (_invert) buf = ~buf;
-            _bus->writeData(getSwap16(buf), 16);
-          }
-          _write_command(IT8951_TCON_LD_IMG_END);
-        }
-      }// while (w != new_pos && w != (prev_pos = param->fp_skip(new_pos, w, param)));
+      param->fp_copy(readbuf, 0, w, param);
+      to_gray_row(gray, readbuf, w);
+      _dither.imageRow(_dither_mode, levels, gray, xpos, y, w, 1, 0, xpos - xs);
+
+      _set_area(xpos, y, w, 1);
+      _wait_busy();
+      _bus->writeData(0, 16);
+      uint32_t len = _pack_levels(writebuf, levels, xpos, w, fast);
+      _bus->writeBytes((uint8_t*)writebuf, len << 1, true, false);
+      _write_command(IT8951_TCON_LD_IMG_END);
+
       xpos += w;
       if (xpos > xe)
       {
@@ -748,7 +844,7 @@ IT8951 Registers defines
     _xpos = xpos;
     _ypos = ypos;
 
-    heap_free(readbuf);
+    heap_free(writebuf);
   }
 
   bool Panel_IT8951::_read_raw_line(int32_t raw_x, int32_t raw_y, int32_t len, uint16_t* __restrict buf)
@@ -19,6 +19,8 @@ Contributors:
 
 #include "Panel_Device.hpp"
 #include "../misc/range.hpp"
+#include "../misc/dither.hpp"
+#include "../misc/EPD_Diff.hpp"
 
 namespace lgfx
 {
@@ -62,6 +64,10 @@ namespace lgfx
     uint16_t getVCOM(void);
     void setVCOM(uint16_t vcom);
 
+    /// epd_auto の場合に、残像を消すための全画面更新 (GC16) を部分更新 count 回毎に行う;
+    /// In epd_auto mode, refresh the whole panel with GC16 after every count partial updates.
+    void setFullRefreshInterval(uint16_t count) { _diff.setFullRefreshInterval(count); }
+
   private:
 
     enum epd_update_mode_t
@@ -79,6 +85,8 @@ namespace lgfx
 
     range_rect_t _range_new;
     range_rect_t _range_old;
+    Ditherer _dither;
+    EPD_Diff _diff;
 
     uint16_t _xpos = 0;
     uint16_t _ypos = 0;
@@ -97,7 +105,9 @@ namespace lgfx
     bool _set_target_memory_addr( uint32_t tar_addr);
     bool _set_area( uint32_t x, uint32_t y, uint32_t w, uint32_t h);
     bool _update_raw_area( epd_update_mode_t mode);
+    bool _display_auto( void );
     bool _read_raw_line( int32_t raw_x, int32_t raw_y, int32_t len, uint16_t* buf);
+    uint32_t _pack_levels( uint16_t* dst, const uint8_t* levels, uint_fast16_t x, uint32_t length, bool fast) const;
 
     fastread_dir_t get_fastread_dir(void) const override { return _it8951_rotation & 1 ? fastread_vertical : fastread_horizontal; }
   };
@@ -51,10 +51,7 @@ namespace lgfx
 
     if (!connected) { return false; }
 
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+    _clear_dirty_rects();
 
     setInvert(_invert);
     setRotation(_rotation);
@@ -88,10 +85,7 @@ namespace lgfx
   {
     if (0 < w && 0 < h)
     {
-      _range_mod.left   = std::min<int_fast16_t>(_range_mod.left  , x        );
-      _range_mod.right  = std::max<int_fast16_t>(_range_mod.right , x + w - 1);
-      _range_mod.top    = std::min<int_fast16_t>(_range_mod.top   , y        );
-      _range_mod.bottom = std::max<int_fast16_t>(_range_mod.bottom, y + h - 1);
+      _add_dirty_rect(x, y, x + w - 1, y + h - 1);
     }
     if (_range_mod.empty()) { return; }
 
@@ -100,10 +94,7 @@ namespace lgfx
     uint_fast8_t ys = _range_mod.top    >> 3;
     uint_fast8_t ye = _range_mod.bottom >> 3;
 
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+    _clear_dirty_rects();
 
     y = ys;
     waitBusy();
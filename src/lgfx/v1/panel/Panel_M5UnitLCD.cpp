@@ -20,6 +20,7 @@ Contributors:
 #include "../platforms/common.hpp"
 #include "../misc/pixelcopy.hpp"
 #include "../misc/colortype.hpp"
+#include "../misc/M5UnitLCD_Encoder.hpp"
 
 namespace lgfx
 {
@@ -354,182 +355,46 @@ namespace lgfx
   }
 
 
-  static uint8_t* store_encoded(uint8_t* dst, const uint8_t* src, size_t data_num, size_t bytes)
+  /// dmabuf の margin バイト目から置かれた length 画素を、生データと RLE のうち送信量の少ない方で送る。
+  /// RLE は dmabuf の先頭から同じバッファ内で符号化する;
+  void Panel_M5UnitLCD::_write_span(uint8_t* dmabuf, uint32_t margin, uint32_t length, uint_fast8_t bytes)
   {
-    *dst++ = data_num;
-    memmove(dst, src, bytes);
-    dst += bytes;
-    return dst;
-  }
-
-  static uint8_t* store_absolute(uint8_t* dst, const uint8_t* src, size_t src_size, size_t bytes)
-  {
-    if (src_size >= 3)  // 絶対モード;
+    auto src = &dmabuf[margin];
+    auto current = M5UnitLCD_Encoder::method_t::method_none;
+    switch (_last_cmd & ~7)
     {
-      *dst++ = 0x00;
-      *dst++ = src_size;
-      memmove(dst, src, src_size * bytes);
-      dst += src_size * bytes;
+    case CMD_WRITE_RAW: current = M5UnitLCD_Encoder::method_t::method_raw; break;
+    case CMD_WRITE_RLE: current = M5UnitLCD_Encoder::method_t::method_rle; break;
+    default: break;
     }
-    else  // RLEモード;
-    {
-      for (size_t i = 0; i < src_size; i++)
-      {
-        dst = store_encoded(dst, src + i * bytes, 1, bytes);
-      }
+    bool raw = M5UnitLCD_Encoder::method_t::method_raw == M5UnitLCD_Encoder::select(src, length, bytes, current);
+    uint8_t cmd = (raw ? CMD_WRITE_RAW : CMD_WRITE_RLE) | bytes;
+    size_t idx = _check_repeat(cmd) ? 0 : 1;
+    if (raw)
+    { // コマンドは画素データの直前に置く;
+      src -= idx;
+      src[0] = cmd;
+      _bus->writeBytes(src, idx + length * bytes, false, true);
     }
-    return dst;
-  }
-/*
-  static size_t rleDecode(const uint8_t* src, size_t len, size_t bytes)
-  {
-    size_t res = 0;
-    size_t idx = 0;
-    while (idx < len)
+    else
     {
-      if (src[idx++] == 0)
-      {
-        size_t abs_len = src[idx++];
-        idx += abs_len * bytes;
-        res += abs_len;
-        continue;
-      }
-      res += src[idx-1];
-      idx += bytes;
+      dmabuf[0] = cmd;
+      size_t writelen = idx + M5UnitLCD_Encoder::encodeRLE(&dmabuf[idx], src, length, bytes);
+      _bus->writeBytes(dmabuf, writelen, false, true);
     }
-    return res;
   }
-*/
-  static size_t rleEncode(uint8_t* dest, const uint8_t* src, size_t bytelen, size_t bytes)
-  {
-/*
-Serial.printf("bytelen:%d bytes:%d\r\n", bytelen, bytes);
-for (int i = 0; i < bytelen; ++i) { Serial.printf("%02x ",src[i]); } Serial.println();
-//*/
-    static constexpr size_t maxbyte = 255;
-
-    uint8_t* pdest = dest;
-    const uint8_t* pabs = src;
-    const uint8_t* prev = src;
- 
-    int_fast16_t cont = 1;
-    int_fast16_t abso = 0;
 
-    for (size_t i = bytes; i < bytelen; i += bytes)
-    {
-      size_t byteidx = 0;
-      while (src[i + byteidx] == src[i + byteidx - bytes] && ++byteidx != bytes);
-
-      if (byteidx == bytes)
-      {
-        cont++;
-        if (abso >= 1)
-        {
-          pdest = store_absolute(pdest, pabs, abso, bytes);
-        }
-        else if (cont == maxbyte)
-        {
-          pdest = store_encoded(pdest, prev, maxbyte, bytes);
-          cont = 1;
-          prev = src + i;
-        }
-        abso = -1;
-      }
-      else
-      {
-        abso++;
-        if (cont >= 2)
-        {
-          pdest = store_encoded(pdest, prev, cont, bytes);
-        }
-        else if (abso == maxbyte)
-        {
-          pdest = store_absolute(pdest, pabs, maxbyte, bytes);
-          abso = 0;
-        }
-        cont = 1;
-        if (abso == 0) { pabs = src + i; }
-        prev = src + i;
-      }
-    }
-     if (abso >= 0)
-    {
-      pdest = store_absolute(pdest, pabs, abso + 1, bytes);
-    }
-    else if (cont >= 2)
-    {
-      pdest = store_encoded(pdest, prev, cont, bytes);
-    }
-/*
-size_t res = pdest - dest;
-if (bytelen != rleDecode(dest, res, bytes)*bytes) {
-  Serial.printf("res:%d\r\n", res);
-  for (int i = 0; i < res; ++i) { Serial.printf("%02x ",dest[i]); } Serial.println();
-}
-//*/
-    return pdest - dest;
-  }
-//*
   void Panel_M5UnitLCD::writePixels(pixelcopy_t* param, uint32_t length, bool use_dma)
   {
     (void)use_dma;
     auto bytes = _write_bits >> 3;
-    uint32_t wb = length * bytes;
-    auto dmabuf = _bus->getDMABuffer(wb + (wb >> 7) + 128);
-    dmabuf[0] = CMD_WRITE_RLE | bytes;
-    size_t idx = _check_repeat(dmabuf[0]) ? 0 : 1;
-
-    auto buf = &dmabuf[(wb >> 7) + 128];
-    param->fp_copy(buf, 0, length, param);
-    size_t writelen = idx + rleEncode(&dmabuf[idx], buf, length * bytes, bytes);
-    _bus->writeBytes(dmabuf, writelen, false, true);
-    _raw_color = ~0u;
-  }
-/*/
-  void Panel_M5UnitLCD::writePixels(pixelcopy_t* param, uint32_t length)
-  {
-    auto bytes = _write_bits >> 3;
-    uint32_t wb = length * bytes;
-    auto dmabuf = _bus->getDMABuffer(wb + (wb >> 7) + 1);
-    dmabuf[0] = CMD_WRITE_RAW | _write_bits >> 3;
-    size_t idx = _check_repeat(dmabuf[0]) ? 0 : 1;
-
-    auto buf = &dmabuf[idx];
-    param->fp_copy(buf, 0, length, param);
-    size_t writelen = idx + wb;
-    _bus->writeBytes(dmabuf, writelen, false, true);
-    _raw_color = ~0u;
-  }
-//*/
-/*
-  void Panel_M5UnitLCD::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma)
-  {
-    uint32_t sx32 = param->src_x32;
-    auto bytes = _write_bits >> 3;
-    uint32_t y_add = 1;
-    bool transp = (param->transp != pixelcopy_t::NON_TRANSP);
-    if (!transp) { _set_window(x, y, x+w-1, y+h-1); }
-    uint32_t wb = w * bytes;
-    do
-    {
-      uint32_t i = 0;
-      while (w != (i = param->fp_skip(i, w, param)))
-      {
-        auto dmabuf = _bus->getDMABuffer(wb + 1);
-        dmabuf[0] = CMD_WRITE_RAW | ((_write_bits >> 3) & 3);
-        auto buf = &dmabuf[1];
-        int32_t len = param->fp_copy(buf, 0, w - i, param);
-        if (transp) { _set_window(x + i, y, x + i + len - 1, y); }
-        _bus->writeBytes(dmabuf, 1 + wb, false, true);
-        if (w == (i += len)) break;
-      }
-      param->src_x32 = sx32;
-      param->src_y++;
-      y += y_add;
-    } while (--h);
+    uint32_t margin = M5UnitLCD_Encoder::encodeMargin(length) + 1;
+    auto dmabuf = _bus->getDMABuffer(length * bytes + margin);
+    param->fp_copy(&dmabuf[margin], 0, length, param);
+    _write_span(dmabuf, margin, length, bytes);
     _raw_color = ~0u;
   }
-/*/
+
   void Panel_M5UnitLCD::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma)
   {
     (void)use_dma;
@@ -539,13 +404,13 @@ if (bytelen != rleDecode(dest, res, bytes)*bytes) {
     uint32_t sx32 = param->src_x32;
     auto bytes = _write_bits >> 3;
     uint32_t y_add = 1;
-    uint32_t cmd = CMD_WRITE_RLE | bytes;
     bool transp = (param->transp != pixelcopy_t::NON_TRANSP);
     if (!transp)
     {
       _set_window(x, y, x+w-1, y+h-1);
     }
     uint32_t wb = w * bytes;
+    uint32_t margin = M5UnitLCD_Encoder::encodeMargin(w) + 1;
     do
     {
       uint32_t i = 0;
@@ -555,21 +420,13 @@ if (bytelen != rleDecode(dest, res, bytes)*bytes) {
         _buff_free_count = (_buff_free_count > sub)
                          ? (_buff_free_count - sub)
                          : 0;
-        auto dmabuf = _bus->getDMABuffer(wb + (wb >> 7) + 128);
-        dmabuf[0] = cmd;
-        auto buf = &dmabuf[(wb >> 7) + 128];
-        int32_t len = param->fp_copy(buf, 0, w - i, param);
+        auto dmabuf = _bus->getDMABuffer(wb + margin);
+        int32_t len = param->fp_copy(&dmabuf[margin], 0, w - i, param);
         if (transp)
         {
           _set_window(x + i, y, x + i + len - 1, y);
         }
-        if (!_check_repeat(cmd))
-        {
-          _bus->writeCommand(cmd, 8);
-        }
-        size_t idx = 0;
-        size_t writelen = rleEncode(&dmabuf[idx], buf, len * bytes, bytes);
-        _bus->writeBytes(dmabuf, writelen, false, true);
+        _write_span(dmabuf, margin, len, bytes);
         if (w == (i += len)) break;
       }
       param->src_x32 = sx32;
@@ -143,6 +143,7 @@ namespace lgfx
     void _set_window(uint_fast16_t xs, uint_fast16_t ys, uint_fast16_t xe, uint_fast16_t ye);
     void _fill_rect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint_fast8_t bytes);
     bool _check_repeat(uint32_t cmd = 0, uint_fast8_t limit = 64);
+    void _write_span(uint8_t* dmabuf, uint32_t margin, uint32_t length, uint_fast8_t bytes);
 
   };
 
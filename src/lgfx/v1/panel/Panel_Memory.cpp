@@ -0,0 +1,119 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "Panel_Memory.hpp"
+#include "../platforms/common.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  Panel_Memory::Panel_Memory(void) : Panel_FrameBufferBase()
+  {
+    _cfg.readable = true;
+    _cfg.bus_shared = false;
+  }
+
+  Panel_Memory::~Panel_Memory(void)
+  {
+    deinitFrameBuffer();
+  }
+
+  bool Panel_Memory::init(bool use_reset)
+  {
+    if (!initFrameBuffer(_cfg.panel_width, _cfg.panel_height))
+    {
+      return false;
+    }
+    return Panel_FrameBufferBase::init(use_reset);
+  }
+
+  color_depth_t Panel_Memory::setColorDepth(color_depth_t depth)
+  {
+    auto bits = depth & color_depth_t::bit_mask;
+    if (bits >= 16) {
+      depth = (bits > 16)
+            ? rgb888_3Byte
+            : rgb565_2Byte;
+    } else {
+      depth = (depth == color_depth_t::grayscale_8bit)
+            ? grayscale_8bit
+            : rgb332_1Byte;
+    }
+    _write_depth = depth;
+    _read_depth = depth;
+    updateLineArray();
+
+    return depth;
+  }
+
+  bool Panel_Memory::initFrameBuffer(uint_fast16_t w, uint_fast16_t h)
+  {
+    deinitFrameBuffer();
+    if (w == 0 || h == 0) { return false; }
+
+    uint8_t** lineArray = (uint8_t**)heap_alloc_dma(h * sizeof(uint8_t*));
+    if (nullptr == lineArray) { return false; }
+
+    /// 色深度の変更でラインを再配置できるよう、最大の3Byte/pixelで確保しておく;
+    /// Allocate for the largest depth (3Byte/pixel) so the lines can be re-laid out on setColorDepth.
+    w = (w + 3) & ~3u;
+    _frame_buffer = (uint8_t*)heap_alloc_dma(w * 3 * h);
+    if (nullptr == _frame_buffer)
+    {
+      heap_free(lineArray);
+      return false;
+    }
+    memset(_frame_buffer, 0, w * 3 * h);
+    _lines_buffer = lineArray;
+    updateLineArray();
+    return true;
+  }
+
+  void Panel_Memory::deinitFrameBuffer(void)
+  {
+    if (_lines_buffer)
+    {
+      heap_free(_lines_buffer);
+      _lines_buffer = nullptr;
+    }
+    if (_frame_buffer)
+    {
+      heap_free(_frame_buffer);
+      _frame_buffer = nullptr;
+    }
+    _line_stride = 0;
+  }
+
+  void Panel_Memory::updateLineArray(void)
+  {
+    if (_lines_buffer == nullptr) { return; }
+    size_t w = (_cfg.panel_width + 3) & ~3u;
+    _line_stride = w * _write_bits >> 3;
+    auto fb = _frame_buffer;
+    for (size_t y = 0; y < _cfg.panel_height; ++y)
+    {
+      _lines_buffer[y] = fb;
+      fb += _line_stride;
+    }
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
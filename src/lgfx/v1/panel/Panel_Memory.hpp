@@ -0,0 +1,58 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "Panel_FrameBufferBase.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// ヒープ上のフレームバッファにのみ描画するヘッドレスパネル;
+  /// Headless panel that renders into a plain heap frame buffer (no bus, no window).
+  struct Panel_Memory : public Panel_FrameBufferBase
+  {
+  public:
+    Panel_Memory(void);
+    virtual ~Panel_Memory(void);
+
+    bool init(bool use_reset) override;
+
+    color_depth_t setColorDepth(color_depth_t depth) override;
+
+    /// フレームバッファの先頭ポインタ。ラインは getLineStride バイト間隔で連続している;
+    /// Top of the frame buffer. Lines are contiguous, getLineStride() bytes apart.
+    uint8_t* getFrameBuffer(void) const { return _frame_buffer; }
+    uint8_t* getLineBuffer(uint_fast16_t y) const { return (_lines_buffer && y < _cfg.panel_height) ? _lines_buffer[y] : nullptr; }
+    size_t getLineStride(void) const { return _line_stride; }
+    size_t getFrameBufferLength(void) const { return _line_stride * _cfg.panel_height; }
+
+  protected:
+    uint8_t* _frame_buffer = nullptr;
+    size_t _line_stride = 0;
+
+    bool initFrameBuffer(uint_fast16_t w, uint_fast16_t h);
+    void deinitFrameBuffer(void);
+    void updateLineArray(void);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -38,10 +38,6 @@ namespace lgfx
     void setSleep(bool flg) override;
     void setPowerSave(bool) override {}
 
-    void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor) override;
-    void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) override;
-    void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) override;
-
     uint32_t readCommand(uint_fast16_t, uint_fast8_t, uint_fast8_t) override { return 0; }
     uint32_t readData(uint_fast8_t, uint_fast8_t) override { return 0; }
 
@@ -61,12 +57,11 @@ namespace lgfx
     static constexpr uint8_t CMD_SETPRECHARGE        = 0xD9;
     static constexpr uint8_t CMD_SETVCOMDETECT       = 0xDB;
 
-    uint8_t _bayer_offset = 0;
-
     size_t _get_buffer_length(void) const override;
     bool _read_pixel(uint_fast16_t x, uint_fast16_t y);
-    void _draw_pixel(uint_fast16_t x, uint_fast16_t y, uint32_t value);
-    virtual void _update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye);
+    void _gray_row(uint8_t* dst, const void* src, uint32_t length) override;
+    void _write_level(uint_fast16_t x, uint_fast16_t y, uint_fast8_t level) override;
+    void _write_levels(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* levels) override;
 
   };
 
@@ -33,8 +33,6 @@ namespace lgfx
  {
 //----------------------------------------------------------------------------
 
-  static constexpr int8_t Bayer[16] = {-30, 2, -22, 10, 18, -14, 26, -6, -18, 14, -26, 6, 30, -2, 22, -10};
-
   color_depth_t Panel_SSD1327::setColorDepth(color_depth_t depth)
   {
     _write_depth = color_depth_t::rgb888_3Byte;
@@ -97,105 +95,6 @@ namespace lgfx
     endWrite();
   }
 
-  void Panel_SSD1327::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
-  {
-    uint_fast16_t xs = x, xe = x + w - 1;
-    uint_fast16_t ys = y, ye = y + h - 1;
-    _xs = xs;
-    _ys = ys;
-    _xe = xe;
-    _ye = ye;
-    _update_transferred_rect(xs, ys, xe, ye);
-
-    bgr888_t color { rawcolor };
-    int32_t sum = (color.R8() + (color.G8() << 1) + color.B8());
-
-    y = ys;
-    do
-    {
-      x = xs;
-      auto btbl = &Bayer[(y & 3) << 2];
-      auto buf = &_buf[y * ((_cfg.panel_width + 1) >> 1)];
-      do
-      {
-        size_t idx = x >> 1;
-        uint_fast8_t shift = (x & 1) ? 0 : 4;
-        uint_fast8_t value = (std::min<int32_t>(15, std::max<int32_t>(0, sum + btbl[x & 3]) >> 6) & 0x0F) << shift;
-        buf[idx] = (buf[idx] & (0xF0 >> shift)) | value;
-      } while (++x <= xe);
-    } while (++y <= ye);
-//  display(0,0,0,0);
-  }
-
-  void Panel_SSD1327::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma)
-  {
-    uint_fast16_t xs = x, xe = x + w - 1;
-    uint_fast16_t ys = y, ye = y + h - 1;
-    _update_transferred_rect(xs, ys, xe, ye);
-
-    auto readbuf = (bgr888_t*)alloca(w * sizeof(bgr888_t));
-    auto sx = param->src_x32;
-    h += y;
-    do
-    {
-      uint32_t prev_pos = 0, new_pos = 0;
-      do
-      {
-        new_pos = param->fp_copy(readbuf, prev_pos, w, param);
-        if (new_pos != prev_pos)
-        {
-          do
-          {
-            auto color = readbuf[prev_pos];
-            _draw_pixel(x + prev_pos, y, (color.R8() + (color.G8() << 1) + color.B8()));
-          } while (new_pos != ++prev_pos);
-        }
-      } while (w != new_pos && w != (prev_pos = param->fp_skip(new_pos, w, param)));
-      param->src_x32 = sx;
-      param->src_y++;
-    } while (++y < h);
-  }
-
-  void Panel_SSD1327::writePixels(pixelcopy_t* param, uint32_t length, bool use_dma)
-  {
-    {
-      uint_fast16_t xs = _xs;
-      uint_fast16_t xe = _xe;
-      uint_fast16_t ys = _ys;
-      uint_fast16_t ye = _ye;
-      _update_transferred_rect(xs, ys, xe, ye);
-    }
-    uint_fast16_t xs   = _xs  ;
-    uint_fast16_t ys   = _ys  ;
-    uint_fast16_t xe   = _xe  ;
-    uint_fast16_t ye   = _ye  ;
-    uint_fast16_t xpos = _xpos;
-    uint_fast16_t ypos = _ypos;
-
-    static constexpr uint32_t buflen = 16;
-    bgr888_t colors[buflen];
-    int bufpos = buflen;
-    do
-    {
-      if (bufpos == buflen) {
-        param->fp_copy(colors, 0, std::min(length, buflen), param);
-        bufpos = 0;
-      }
-      auto color = colors[bufpos++];
-      _draw_pixel(xpos, ypos, (color.R8() + (color.G8() << 1) + color.B8()));
-      if (++xpos > xe)
-      {
-        xpos = xs;
-        if (++ypos > ye)
-        {
-          ypos = ys;
-        }
-      }
-    } while (--length);
-    _xpos = xpos;
-    _ypos = ypos;
-  }
-
   void Panel_SSD1327::readRect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, void* dst, pixelcopy_t* param)
   {
     auto readbuf = (bgr888_t*)alloca(w * sizeof(bgr888_t));
@@ -214,15 +113,22 @@ namespace lgfx
     } while (++y < h);
   }
 
-  void Panel_SSD1327::_draw_pixel(uint_fast16_t x, uint_fast16_t y, uint32_t sum)
+  void Panel_SSD1327::_write_level(uint_fast16_t x, uint_fast16_t y, uint_fast8_t level)
   {
-    _rotate_pos(x, y);
-
-    auto btbl = &Bayer[(y & 3) << 2];
     size_t idx = (x >> 1) + (y * ((_cfg.panel_width + 1) >> 1));
     uint_fast8_t shift = (x & 1) ? 0 : 4;
-    uint_fast8_t value = (std::min<int32_t>(15, std::max<int32_t>(0, sum + btbl[x & 3]) >> 6) & 0x0F) << shift;
-    _buf[idx] = (_buf[idx] & (0xF0 >> shift)) | value;
+    _buf[idx] = (_buf[idx] & (0xF0 >> shift)) | level << shift;
+  }
+
+  void Panel_SSD1327::_write_levels(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* levels)
+  {
+    auto buf = &_buf[y * ((_cfg.panel_width + 1) >> 1)];
+    for (uint32_t i = 0; i < w; ++i, ++x)
+    {
+      size_t idx = x >> 1;
+      uint_fast8_t shift = (x & 1) ? 0 : 4;
+      buf[idx] = (buf[idx] & (0xF0 >> shift)) | levels[i] << shift;
+    }
   }
 
   uint8_t Panel_SSD1327::_read_pixel(uint_fast16_t x, uint_fast16_t y)
@@ -235,15 +141,6 @@ namespace lgfx
          ;
   }
 
-  void Panel_SSD1327::_update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye)
-  {
-    _rotate_pos(xs, ys, xe, ye);
-    _range_mod.left   = std::min<int32_t>(xs, _range_mod.left);
-    _range_mod.right  = std::max<int32_t>(xe, _range_mod.right);
-    _range_mod.top    = std::min<int32_t>(ys, _range_mod.top);
-    _range_mod.bottom = std::max<int32_t>(ye, _range_mod.bottom);
-  }
-
   void Panel_SSD1327::setBrightness(uint8_t brightness)
   {
     startWrite();
@@ -262,36 +159,33 @@ namespace lgfx
   {
     if (0 < w && 0 < h)
     {
-      _range_mod.left   = std::min<int16_t>(_range_mod.left  , x        );
-      _range_mod.right  = std::max<int16_t>(_range_mod.right , x + w - 1);
-      _range_mod.top    = std::min<int16_t>(_range_mod.top   , y        );
-      _range_mod.bottom = std::max<int16_t>(_range_mod.bottom, y + h - 1);
+      _add_dirty_rect(x, y, x + w - 1, y + h - 1);
     }
 
     if (_range_mod.empty()) { return; }
 
-    uint_fast8_t xs = _range_mod.left  >> 1;
-    uint_fast8_t xe = _range_mod.right >> 1;
-    uint_fast8_t ofs = _cfg.offset_x >> 1;
+    for (size_t i = 0; i < _dirty_count; ++i)
+    {
+      uint_fast8_t xs = _dirty_rects[i].left  >> 1;
+      uint_fast8_t xe = _dirty_rects[i].right >> 1;
+      uint_fast8_t ofs = _cfg.offset_x >> 1;
 
-    _bus->writeCommand(CMD_CASET | (xs + ofs) << 8 | (xe + ofs) << 16, 24);
+      _bus->writeCommand(CMD_CASET | (xs + ofs) << 8 | (xe + ofs) << 16, 24);
 
-    uint_fast8_t ys = _range_mod.top    + _cfg.offset_y;
-    uint_fast8_t ye = _range_mod.bottom + _cfg.offset_y;
-    ofs = _cfg.offset_y;
-    _bus->writeCommand(CMD_RASET | (ys + ofs) << 8 | (ye + ofs) << 16, 24);
+      uint_fast8_t ys = _dirty_rects[i].top    + _cfg.offset_y;
+      uint_fast8_t ye = _dirty_rects[i].bottom + _cfg.offset_y;
+      ofs = _cfg.offset_y;
+      _bus->writeCommand(CMD_RASET | (ys + ofs) << 8 | (ye + ofs) << 16, 24);
 
-    w = xe - xs + 1;
-    do
-    {
-      auto buf = &_buf[xs + ys * ((_cfg.panel_width + 1) >> 1 )]; 
-      _bus->writeBytes(buf, w, true, true);
-    } while (++ys <= ye);
-
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+      w = xe - xs + 1;
+      do
+      {
+        auto buf = &_buf[xs + ys * ((_cfg.panel_width + 1) >> 1 )]; 
+        _bus->writeBytes(buf, w, true, true);
+      } while (++ys <= ye);
+    }
+
+    _clear_dirty_rects();
   }
 
 
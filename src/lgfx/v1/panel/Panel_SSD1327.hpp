@@ -33,6 +33,7 @@ namespace lgfx
     {
       _cfg.memory_width  = _cfg.panel_width  = 128;
       _cfg.memory_height = _cfg.panel_height = 128;
+      _dither.setLevels(16);
     }
 
     bool init(bool use_reset) override;
@@ -48,10 +49,6 @@ namespace lgfx
 
     void display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h) override;
 
-    void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor) override;
-    void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) override;
-    void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) override;
-
     uint32_t readCommand(uint_fast16_t, uint_fast8_t, uint_fast8_t) override { return 0; }
     uint32_t readData(uint_fast8_t, uint_fast8_t) override { return 0; }
 
@@ -103,8 +100,8 @@ namespace lgfx
 
     size_t _get_buffer_length(void) const override;
     uint8_t _read_pixel(uint_fast16_t x, uint_fast16_t y);
-    void _draw_pixel(uint_fast16_t x, uint_fast16_t y, uint32_t value);
-    void _update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye);
+    void _write_level(uint_fast16_t x, uint_fast16_t y, uint_fast8_t level) override;
+    void _write_levels(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, const uint8_t* levels) override;
 
   };
 
@@ -49,6 +49,10 @@ Contributors:
 
 #include "arduino_default/common.hpp"
 
+#elif defined (LGFX_LINUX_FB)
+
+#include "framebuffer/common.hpp"
+
 #elif __has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>)
 
 #include "sdl/common.hpp"
@@ -88,6 +88,13 @@ Contributors:
 
 #include "arduino_default/Bus_SPI.hpp"
 
+#elif defined (LGFX_LINUX_FB)
+
+#include "framebuffer/Panel_fb.hpp"
+#include "framebuffer/Panel_shm.hpp"
+#include "framebuffer/Panel_Recorder.hpp"
+#include "framebuffer/Panel_VNC.hpp"
+
 #elif __has_include(<SDL2/SDL.h>) || __has_include(<SDL.h>)
 
 #include "sdl/Bus_I2C.hpp"
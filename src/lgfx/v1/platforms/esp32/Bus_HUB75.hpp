@@ -38,6 +38,7 @@ Contributors:
 #include "../common.hpp"
 #include "../../Bus.hpp"
 #include "../../misc/DividedFrameBuffer.hpp"
+#include "../../misc/HUB75_Encoder.hpp"
 
 namespace lgfx
 {
@@ -151,19 +152,19 @@ namespace lgfx
 
   private:
 
-    static constexpr int32_t LINECHANGE_PERIOD_COUNT = 1;
-    static constexpr int32_t TRANSFER_PERIOD_COUNT_332 = 5;
-    static constexpr int32_t TRANSFER_PERIOD_COUNT_565 = 8;
-    static constexpr int32_t EXTEND_PERIOD_COUNT_332 = 2;
-    static constexpr int32_t EXTEND_PERIOD_COUNT_565 = 5;
-    static constexpr const int32_t TOTAL_PERIOD_COUNT_332 = TRANSFER_PERIOD_COUNT_332 + EXTEND_PERIOD_COUNT_332 + LINECHANGE_PERIOD_COUNT;
-    static constexpr const int32_t TOTAL_PERIOD_COUNT_565 = TRANSFER_PERIOD_COUNT_565 + EXTEND_PERIOD_COUNT_565 + LINECHANGE_PERIOD_COUNT;
-    static constexpr const uint32_t _mask_lat    = 0x00000040;
-    static constexpr const uint32_t _mask_oe     = 0x00800080;
-    static constexpr const uint32_t _mask_addr   = 0x1F001F00;
-    static constexpr const uint32_t _mask_pin_a_clk = 0x00000100;
-    static constexpr const uint32_t _mask_pin_b_lat = 0x02000200;
-    static constexpr const uint32_t _mask_pin_c_dat = 0x04000400;
+    static constexpr int32_t LINECHANGE_PERIOD_COUNT = HUB75_Encoder::LINECHANGE_PERIOD_COUNT;
+    static constexpr int32_t TRANSFER_PERIOD_COUNT_332 = HUB75_Encoder::TRANSFER_PERIOD_COUNT_332;
+    static constexpr int32_t TRANSFER_PERIOD_COUNT_565 = HUB75_Encoder::TRANSFER_PERIOD_COUNT_565;
+    static constexpr int32_t EXTEND_PERIOD_COUNT_332 = HUB75_Encoder::EXTEND_PERIOD_COUNT_332;
+    static constexpr int32_t EXTEND_PERIOD_COUNT_565 = HUB75_Encoder::EXTEND_PERIOD_COUNT_565;
+    static constexpr const int32_t TOTAL_PERIOD_COUNT_332 = HUB75_Encoder::TOTAL_PERIOD_COUNT_332;
+    static constexpr const int32_t TOTAL_PERIOD_COUNT_565 = HUB75_Encoder::TOTAL_PERIOD_COUNT_565;
+    static constexpr const uint32_t _mask_lat    = HUB75_Encoder::mask_lat;
+    static constexpr const uint32_t _mask_oe     = HUB75_Encoder::mask_oe;
+    static constexpr const uint32_t _mask_addr   = HUB75_Encoder::mask_addr;
+    static constexpr const uint32_t _mask_pin_a_clk = HUB75_Encoder::mask_pin_a_clk;
+    static constexpr const uint32_t _mask_pin_b_lat = HUB75_Encoder::mask_pin_b_lat;
+    static constexpr const uint32_t _mask_pin_c_dat = HUB75_Encoder::mask_pin_c_dat;
     static constexpr const uint8_t _dma_desc_set = 3;
 
     static void i2s_intr_handler_hub75(void *arg);
@@ -17,6 +17,7 @@ Contributors:
 /----------------------------------------------------------------------------*/
 #pragma once
 
+#include "../../misc/Allocator.hpp"
 #include "../../misc/DataWrapper.hpp"
 #include "../../misc/enum.hpp"
 #include "../../../utility/result.hpp"
@@ -81,10 +82,10 @@ namespace lgfx
     }
   }
 
-  static inline void* heap_alloc(      size_t length) { return heap_caps_malloc(length, MALLOC_CAP_8BIT);  }
-  static inline void* heap_alloc_dma(  size_t length) { return heap_caps_malloc((length + 3) & ~3, MALLOC_CAP_DMA);  }
-  static inline void* heap_alloc_psram(size_t length) { return heap_caps_malloc((length + 3) & ~3, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);  }
-  static inline void heap_free(void* buf) { heap_caps_free(buf); }
+  static inline void* platform_heap_alloc(      size_t length) { return heap_caps_malloc(length, MALLOC_CAP_8BIT);  }
+  static inline void* platform_heap_alloc_dma(  size_t length) { return heap_caps_malloc((length + 3) & ~3, MALLOC_CAP_DMA);  }
+  static inline void* platform_heap_alloc_psram(size_t length) { return heap_caps_malloc((length + 3) & ~3, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);  }
+  static inline void platform_heap_free(void* buf) { heap_caps_free(buf); }
 
   /// 引数のポインタが組込RAMか判定する  true=内部RAM / false=外部RAMやROM等;
 #if defined ( CONFIG_IDF_TARGET_ESP32S3 )
@@ -17,6 +17,7 @@ Contributors:
 /----------------------------------------------------------------------------*/
 #pragma once
 
+#include "../../misc/Allocator.hpp"
 #include "../../misc/DataWrapper.hpp"
 #include "../../misc/enum.hpp"
 #include "../../../utility/result.hpp"
@@ -64,10 +65,10 @@ namespace lgfx
     ets_delay_us(us);
   }
 
-  static inline void* heap_alloc(      size_t length) { return malloc(length); }
-  static inline void* heap_alloc_psram(size_t length) { return malloc(length); }
-  static inline void* heap_alloc_dma(  size_t length) { return malloc(length); } // aligned_alloc(16, length);
-  static inline void heap_free(void* buf) { free(buf); }
+  static inline void* platform_heap_alloc(      size_t length) { return malloc(length); }
+  static inline void* platform_heap_alloc_psram(size_t length) { return malloc(length); }
+  static inline void* platform_heap_alloc_dma(  size_t length) { return malloc(length); } // aligned_alloc(16, length);
+  static inline void platform_heap_free(void* buf) { free(buf); }
 
   static inline void gpio_hi(int_fast8_t pin) { if (pin & 16) { if (pin == 16) *(volatile uint32_t*)(0x60000768) |=  1; } else { *(volatile uint32_t*)(0x60000304) = 1 << (pin & 15); } }
   static inline void gpio_lo(int_fast8_t pin) { if (pin & 16) { if (pin == 16) *(volatile uint32_t*)(0x60000768) &= ~1; } else { *(volatile uint32_t*)(0x60000308) = 1 << (pin & 15); } }
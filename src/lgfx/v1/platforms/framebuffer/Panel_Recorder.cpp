@@ -0,0 +1,404 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#if defined ( LGFX_LINUX_FB )
+
+#include "Panel_Recorder.hpp"
+#include "../../LGFXBase.hpp"
+#include "../../misc/pixelcopy.hpp"
+#include "../common.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  static constexpr char record_magic[8] = { 'L', 'G', 'F', 'X', 'R', 'E', 'C', '1' };
+  static constexpr size_t record_file_header_size = 16;
+  static constexpr size_t record_frame_header_size = 20;
+
+  static void put_le(uint8_t* dst, uint64_t value, size_t bytes)
+  {
+    for (size_t i = 0; i < bytes; ++i) { dst[i] = value >> (i << 3); }
+  }
+
+  static uint64_t get_le(const uint8_t* src, size_t bytes)
+  {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) { value |= (uint64_t)src[i] << (i << 3); }
+    return value;
+  }
+
+  static uint64_t now_us(void)
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /// 記録された形式の1ラインを bgr888_t (R,G,B) に変換する;
+  static void convert_line_rgb(bgr888_t* dst, const uint8_t* src, uint32_t len, uint16_t depth)
+  {
+    pixelcopy_t pc;
+    pc.src_data = src;
+    pc.src_x32 = 0;
+    switch (depth)
+    {
+    case rgb565_2Byte:   pixelcopy_t::copy_rgb_fast<bgr888_t, swap565_t  >(dst, 0, len, &pc); break;
+    case rgb332_1Byte:   pixelcopy_t::copy_rgb_fast<bgr888_t, rgb332_t   >(dst, 0, len, &pc); break;
+    case grayscale_8bit: pixelcopy_t::copy_rgb_fast<bgr888_t, grayscale_t>(dst, 0, len, &pc); break;
+    default:             memcpy(dst, src, len * sizeof(bgr888_t)); break;
+    }
+  }
+
+//----------------------------------------------------------------------------
+
+  struct Panel_Recorder::writer_t
+  {
+    struct frame_t
+    {
+      uint64_t timestamp_us;
+      uint16_t depth;
+      uint16_t x, y, w, h;
+      std::vector<uint8_t> data;
+    };
+
+    FILE* fp = nullptr;
+    record_format_t format = format_lgfx_delta;
+    size_t queue_depth = 8;
+    uint16_t width = 0;
+    uint16_t height = 0;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    /// キューに空きができたことを close() に知らせる;
+    std::condition_variable space;
+    std::deque<frame_t> queue;
+    /// 使い終わったフレームのバッファを再利用する;
+    std::vector<std::vector<uint8_t>> pool;
+    bool quit = false;
+    std::thread thread;
+
+    /// Y4M 用の変換バッファ;
+    std::vector<bgr888_t> rgb_line;
+    std::vector<uint8_t> yuv;
+
+    void run(void)
+    {
+      std::deque<frame_t> batch;
+      for (;;)
+      {
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          cv.wait(lock, [this] { return quit || !queue.empty(); });
+          if (queue.empty()) { break; }
+          /// 溜まっているフレームをまとめて取り出し、ロックを外して書き込む;
+          batch.swap(queue);
+        }
+        space.notify_all();
+        for (auto& frame : batch)
+        {
+          if (format == format_y4m) { write_y4m(frame); }
+          else                      { write_delta(frame); }
+        }
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          for (auto& frame : batch) { pool.push_back(std::move(frame.data)); }
+        }
+        batch.clear();
+      }
+      fflush(fp);
+    }
+
+    void write_delta(const frame_t& frame)
+    {
+      uint8_t hdr[record_frame_header_size];
+      put_le(&hdr[ 0], frame.timestamp_us, 8);
+      put_le(&hdr[ 8], frame.depth, 2);
+      put_le(&hdr[10], frame.x, 2);
+      put_le(&hdr[12], frame.y, 2);
+      put_le(&hdr[14], frame.w, 2);
+      put_le(&hdr[16], frame.h, 2);
+      put_le(&hdr[18], 0, 2);
+      fwrite(hdr, 1, sizeof(hdr), fp);
+      fwrite(frame.data.data(), 1, frame.data.size(), fp);
+    }
+
+    /// BT.601 (リミテッドレンジ) の 4:4:4 で書き出す;
+    void write_y4m(const frame_t& frame)
+    {
+      size_t w = frame.w;
+      size_t h = frame.h;
+      size_t plane = w * h;
+      size_t stride = w * (frame.depth & color_depth_t::bit_mask) >> 3;
+      rgb_line.resize(w + 1);
+      yuv.resize(plane * 3);
+      auto py = yuv.data();
+      auto pu = py + plane;
+      auto pv = pu + plane;
+      for (size_t y = 0; y < h; ++y)
+      {
+        convert_line_rgb(rgb_line.data(), &frame.data[y * stride], w, frame.depth);
+        for (size_t x = 0; x < w; ++x)
+        {
+          int r = rgb_line[x].r;
+          int g = rgb_line[x].g;
+          int b = rgb_line[x].b;
+          *py++ = (( 66 * r + 129 * g +  25 * b + 128) >> 8) +  16;
+          *pu++ = ((-38 * r -  74 * g + 112 * b + 128) >> 8) + 128;
+          *pv++ = ((112 * r -  94 * g -  18 * b + 128) >> 8) + 128;
+        }
+      }
+      fprintf(fp, "FRAME Xts=%llu\n", (unsigned long long)frame.timestamp_us);
+      fwrite(yuv.data(), 1, yuv.size(), fp);
+    }
+  };
+
+//----------------------------------------------------------------------------
+
+  Panel_Recorder::Panel_Recorder(void) : Panel_Memory()
+  {
+  }
+
+  Panel_Recorder::~Panel_Recorder(void)
+  {
+    close();
+  }
+
+  bool Panel_Recorder::init(bool use_reset)
+  {
+    close();
+    if (!Panel_Memory::init(use_reset))
+    {
+      return false;
+    }
+
+    FILE* fp = fopen(_config_detail.path, "wb");
+    if (fp == nullptr)
+    {
+      perror("Error: cannot open the recording file");
+      return false;
+    }
+
+    auto writer = new writer_t();
+    writer->fp = fp;
+    writer->format = _config_detail.format;
+    writer->queue_depth = std::max<size_t>(1, _config_detail.queue_depth);
+    writer->width  = _cfg.panel_width;
+    writer->height = _cfg.panel_height;
+    /// 書込みスレッド側でまとめて書き出すため、大きめのバッファを使う;
+    setvbuf(fp, nullptr, _IOFBF, 1 << 20);
+
+    if (writer->format == format_y4m)
+    {
+      fprintf(fp, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", writer->width, writer->height, std::max<uint_fast8_t>(1, _config_detail.y4m_fps));
+    }
+    else
+    {
+      uint8_t hdr[record_file_header_size];
+      memcpy(hdr, record_magic, sizeof(record_magic));
+      put_le(&hdr[ 8], writer->width, 2);
+      put_le(&hdr[10], writer->height, 2);
+      put_le(&hdr[12], 0, 4);
+      fwrite(hdr, 1, sizeof(hdr), fp);
+    }
+    writer->thread = std::thread(&writer_t::run, writer);
+    _writer = writer;
+
+    _start_us = now_us();
+    _recorded_frames = 0;
+    _merged_frames = 0;
+
+    /// 最初のフレームは画面全体を記録する;
+    _modified_all();
+    return true;
+  }
+
+  void Panel_Recorder::close(void)
+  {
+    auto writer = _writer;
+    if (writer == nullptr) { return; }
+    /// キューが一杯で統合待ちになっている変更範囲も、空きを待って記録する;
+    if (!_range_mod.empty())
+    {
+      _record_frame(true);
+    }
+    _writer = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(writer->mtx);
+      writer->quit = true;
+    }
+    writer->cv.notify_one();
+    writer->thread.join();
+    fclose(writer->fp);
+    delete writer;
+  }
+
+  color_depth_t Panel_Recorder::setColorDepth(color_depth_t depth)
+  {
+    depth = Panel_Memory::setColorDepth(depth);
+    /// ラインの配置が変わるため、全体を更新対象にする;
+    _modified_all();
+    return depth;
+  }
+
+  void Panel_Recorder::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
+  {
+    if (_writer == nullptr) { return; }
+    if (0 < w && 0 < h)
+    {
+      _update_modified_rect(x, y, w, h);
+    }
+    if (_range_mod.empty()) { return; }
+
+    _record_frame(false);
+  }
+
+  void Panel_Recorder::_record_frame(bool wait)
+  {
+    auto writer = _writer;
+    range_rect_t range = _range_mod;
+    if (writer->format == format_y4m)
+    {
+      range.left   = 0;
+      range.top    = 0;
+      range.right  = _cfg.panel_width  - 1;
+      range.bottom = _cfg.panel_height - 1;
+    }
+
+    writer_t::frame_t frame;
+    {
+      std::unique_lock<std::mutex> lock(writer->mtx);
+      if (wait)
+      {
+        writer->space.wait(lock, [writer] { return writer->queue.size() < writer->queue_depth; });
+      }
+      else if (writer->queue.size() >= writer->queue_depth)
+      {
+        /// キューが一杯の場合は変更範囲を残したまま戻り、次のフレームに含めて記録する;
+        ++_merged_frames;
+        return;
+      }
+      if (!writer->pool.empty())
+      {
+        frame.data = std::move(writer->pool.back());
+        writer->pool.pop_back();
+      }
+    }
+
+    size_t bytes = _write_bits >> 3;
+    size_t len = range.width() * bytes;
+    frame.timestamp_us = now_us() - _start_us;
+    frame.depth = _write_depth;
+    frame.x = range.left;
+    frame.y = range.top;
+    frame.w = range.width();
+    frame.h = range.height();
+    frame.data.resize(len * frame.h);
+    auto dst = frame.data.data();
+    for (int_fast16_t yy = range.top; yy <= range.bottom; ++yy)
+    {
+      memcpy(dst, &_lines_buffer[yy][range.left * bytes], len);
+      dst += len;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(writer->mtx);
+      writer->queue.push_back(std::move(frame));
+    }
+    writer->cv.notify_one();
+    ++_recorded_frames;
+
+    _clear_modified_rect();
+  }
+
+//----------------------------------------------------------------------------
+
+  bool FrameRecordReader::open(const char* path)
+  {
+    close();
+    _fp = fopen(path, "rb");
+    if (_fp == nullptr) { return false; }
+
+    uint8_t hdr[record_file_header_size];
+    if (fread(hdr, 1, sizeof(hdr), _fp) != sizeof(hdr)
+     || memcmp(hdr, record_magic, sizeof(record_magic)))
+    {
+      close();
+      return false;
+    }
+    _width  = get_le(&hdr[ 8], 2);
+    _height = get_le(&hdr[10], 2);
+    _frame_index = 0;
+    _timestamp_us = 0;
+    return true;
+  }
+
+  void FrameRecordReader::close(void)
+  {
+    if (_fp != nullptr)
+    {
+      fclose(_fp);
+      _fp = nullptr;
+    }
+  }
+
+  bool FrameRecordReader::readFrame(LGFXBase* dst)
+  {
+    if (_fp == nullptr) { return false; }
+
+    uint8_t hdr[record_frame_header_size];
+    if (fread(hdr, 1, sizeof(hdr), _fp) != sizeof(hdr)) { return false; }
+
+    auto depth = (color_depth_t)get_le(&hdr[8], 2);
+    uint_fast16_t x = get_le(&hdr[10], 2);
+    uint_fast16_t y = get_le(&hdr[12], 2);
+    uint_fast16_t w = get_le(&hdr[14], 2);
+    uint_fast16_t h = get_le(&hdr[16], 2);
+    size_t bits = depth & color_depth_t::bit_mask;
+    if (bits != 8 && bits != 16 && bits != 24) { return false; }
+
+    size_t len = (w * h * bits) >> 3;
+    /// bgr888_t::get は4バイト読むため余裕を持たせる;
+    _buf.resize(len + 4);
+    if (fread(_buf.data(), 1, len, _fp) != len) { return false; }
+
+    _timestamp_us = get_le(&hdr[0], 8);
+    _dirty.left   = x;
+    _dirty.top    = y;
+    _dirty.right  = x + w - 1;
+    _dirty.bottom = y + h - 1;
+    ++_frame_index;
+
+    if (dst != nullptr && w && h)
+    {
+      pixelcopy_t p(_buf.data(), dst->getColorDepth(), depth, dst->hasPalette());
+      dst->pushImage(x, y, w, h, &p);
+    }
+    return true;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
+
+#endif
@@ -0,0 +1,150 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "../../panel/Panel_Memory.hpp"
+#include "../../misc/range.hpp"
+
+#include <stdio.h>
+#include <vector>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  class LGFXBase;
+
+  /// 記録ファイルの形式 (format_lgfx_delta) :
+  ///  ファイルヘッダ 16Byte : "LGFXREC1" , u16 width , u16 height , u32 reserved
+  ///  フレーム毎 20Byte     : u64 timestamp_us , u16 depth , u16 x , u16 y , u16 w , u16 h , u16 reserved
+  ///                           続いて変更範囲の画素 (w * h 画素、本ライブラリの書込み形式) 。値はリトルエンディアン;
+  /// Recording file layout (format_lgfx_delta), little-endian:
+  ///  file header, 16 bytes : "LGFXREC1", u16 width, u16 height, u32 reserved
+  ///  per frame, 20 bytes   : u64 timestamp_us, u16 depth, u16 x, u16 y, u16 w, u16 h, u16 reserved,
+  ///                          followed by the w * h pixels of the dirty rect in the library's write format.
+
+  /// display() 毎にフレームをファイルへ記録するパネル。書込みはバックグラウンドのスレッドで行い、
+  /// キューが一杯の場合はフレームを次のフレームへ統合して描画側を待たせない;
+  /// Panel that appends a frame to a file on every display(). Files are written by a background
+  /// thread through a bounded queue; when the queue is full the frame is folded into the next one
+  /// instead of stalling the renderer. Use setAutoDisplay(true) to record at every endWrite.
+  struct Panel_Recorder : public Panel_Memory
+  {
+  public:
+    enum record_format_t
+    {
+      /// 変更範囲とタイムスタンプを持つ独自形式 (FrameRecordReader で再生できる) ;
+      /// dirty-rect deltas with timestamps, replayable with FrameRecordReader.
+      format_lgfx_delta,
+      /// YUV4MPEG2 (C444) の全画面フレーム。タイムスタンプは "FRAME Xts=..." に入る;
+      /// full YUV4MPEG2 C444 frames for external tools; timestamps go in "FRAME Xts=<us>".
+      format_y4m,
+    };
+
+    struct config_detail_t
+    {
+      const char* path = "lgfx_record.bin";
+      record_format_t format = format_lgfx_delta;
+
+      /// 書込みスレッドに渡すまでに保持できるフレーム数;
+      /// frames that may wait for the writer thread.
+      uint8_t queue_depth = 8;
+
+      /// format_y4m のヘッダに記載するフレームレート;
+      /// frame rate written in the Y4M header.
+      uint8_t y4m_fps = 30;
+    };
+
+    Panel_Recorder(void);
+    virtual ~Panel_Recorder(void);
+
+    bool init(bool use_reset) override;
+
+    color_depth_t setColorDepth(color_depth_t depth) override;
+
+    void display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h) override;
+
+
+    const config_detail_t& config_detail(void) const { return _config_detail; }
+    void config_detail(const config_detail_t& config_detail) { _config_detail = config_detail; }
+
+    /// キューに残ったフレームを書き出してファイルを閉じる;
+    /// Writes out the queued frames and closes the file.
+    void close(void);
+
+    /// 記録したフレーム数と、キューが一杯で次のフレームに統合したフレーム数;
+    /// frames recorded, and frames folded into a later one because the queue was full.
+    uint32_t getRecordedFrames(void) const { return _recorded_frames; }
+    uint32_t getMergedFrames(void) const { return _merged_frames; }
+
+  protected:
+    struct writer_t;
+
+    config_detail_t _config_detail;
+    writer_t* _writer = nullptr;
+
+    uint64_t _start_us = 0;
+    uint32_t _recorded_frames = 0;
+    uint32_t _merged_frames = 0;
+
+    /// 変更範囲をフレームとしてキューに入れる。wait が false でキューが一杯の場合は次のフレームへ統合する;
+    void _record_frame(bool wait);
+  };
+
+//----------------------------------------------------------------------------
+
+  /// Panel_Recorder (format_lgfx_delta) の記録を読み出し、LGFX_Sprite 等へ再生する;
+  /// Replays a Panel_Recorder file (format_lgfx_delta) into an LGFX_Sprite or any other target.
+  class FrameRecordReader
+  {
+  public:
+    ~FrameRecordReader(void) { close(); }
+
+    bool open(const char* path);
+    void close(void);
+
+    uint_fast16_t width(void) const { return _width; }
+    uint_fast16_t height(void) const { return _height; }
+
+    /// 次のフレームの変更範囲を dst に描画する。座標は回転前のパネル座標系なので、dst は回転 0 で
+    /// width() x height() 以上の大きさにしておく。ファイルの終端では false を返す;
+    /// Draws the next frame's dirty rect onto dst. Coordinates are unrotated panel coordinates, so dst
+    /// should be unrotated and at least width() x height(). Returns false at the end of the file.
+    bool readFrame(LGFXBase* dst);
+
+    /// 直前に読んだフレームの情報;
+    /// details of the frame read last.
+    uint64_t getTimestamp(void) const { return _timestamp_us; }
+    uint32_t getFrameIndex(void) const { return _frame_index; }
+    const range_rect_t& getDirtyRect(void) const { return _dirty; }
+
+  protected:
+    FILE* _fp = nullptr;
+    std::vector<uint8_t> _buf;
+    range_rect_t _dirty;
+    uint64_t _timestamp_us = 0;
+    uint32_t _frame_index = 0;
+    uint16_t _width = 0;
+    uint16_t _height = 0;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
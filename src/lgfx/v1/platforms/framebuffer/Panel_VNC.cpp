@@ -0,0 +1,889 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#if defined ( LGFX_LINUX_FB )
+
+#include "Panel_VNC.hpp"
+#include "../../misc/pixelcopy.hpp"
+#include "../common.hpp"
+#include "../../../utility/miniz.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// RFB のメッセージ番号とエンコーディング;
+  enum rfb_message_t
+  { rfb_set_pixel_format  = 0
+  , rfb_set_encodings     = 2
+  , rfb_update_request    = 3
+  , rfb_key_event         = 4
+  , rfb_pointer_event     = 5
+  , rfb_client_cut_text   = 6
+  };
+
+  enum rfb_encoding_t
+  { rfb_enc_raw     = 0
+  , rfb_enc_rre     = 2
+  , rfb_enc_hextile = 5
+  , rfb_enc_zrle    = 16
+  };
+
+  static constexpr size_t rfb_max_rects = 16;
+
+  static void put16(std::vector<uint8_t>& v, uint_fast16_t value) { v.push_back(value >> 8); v.push_back(value); }
+  static void put32(std::vector<uint8_t>& v, uint32_t value) { put16(v, value >> 16); put16(v, value); }
+  static uint_fast16_t get16(const uint8_t* p) { return p[0] << 8 | p[1]; }
+  static uint32_t get32(const uint8_t* p) { return (uint32_t)get16(p) << 16 | get16(&p[2]); }
+
+  /// 接する、または重なる矩形は統合し、数が多すぎる場合は全体を1つにまとめる;
+  static void add_rect(std::vector<range_rect_t>& list, const range_rect_t& rect)
+  {
+    range_rect_t r = rect;
+    for (size_t i = 0; i < list.size(); )
+    {
+      auto& o = list[i];
+      if (o.left <= r.right + 1 && r.left <= o.right + 1 && o.top <= r.bottom + 1 && r.top <= o.bottom + 1)
+      {
+        r.left   = std::min(r.left  , o.left  );
+        r.top    = std::min(r.top   , o.top   );
+        r.right  = std::max(r.right , o.right );
+        r.bottom = std::max(r.bottom, o.bottom);
+        list.erase(list.begin() + i);
+        i = 0;
+        continue;
+      }
+      ++i;
+    }
+    list.push_back(r);
+    if (list.size() > rfb_max_rects)
+    {
+      for (auto& o : list)
+      {
+        r.left   = std::min(r.left  , o.left  );
+        r.top    = std::min(r.top   , o.top   );
+        r.right  = std::max(r.right , o.right );
+        r.bottom = std::max(r.bottom, o.bottom);
+      }
+      list.clear();
+      list.push_back(r);
+    }
+  }
+
+//----------------------------------------------------------------------------
+
+  struct Panel_VNC::server_t
+  {
+    /// 描画スレッドと共有する状態 (mtx で保護) ;
+    std::mutex mtx;
+    std::vector<bgr888_t> shadow;
+    std::vector<range_rect_t> dirty;
+    touch_point_t touch;
+    uint16_t width = 0;
+    uint16_t height = 0;
+
+    std::atomic<bool> quit { false };
+    std::atomic<bool> connected { false };
+    std::thread thread;
+    std::string name;
+    int listen_fd = -1;
+    int client_fd = -1;
+    int wake_fd[2] = { -1, -1 };
+
+    /// 接続毎の状態 (サーバスレッドのみが使用) ;
+    struct pixel_format_t
+    {
+      uint8_t bpp;
+      uint8_t depth;
+      bool big_endian;
+      bool true_colour;
+      uint16_t max[3];
+      uint8_t shift[3];
+    } pf;
+    uint32_t lut[3][256];
+    uint_fast8_t cpixel_bytes = 4;
+    uint_fast8_t cpixel_offset = 0;
+    int32_t encoding = rfb_enc_raw;
+    bool update_requested = false;
+    range_rect_t request;
+    std::vector<range_rect_t> pending;
+    /// send_update で要求範囲外に残った部分;
+    std::vector<range_rect_t> remain;
+    tdefl_compressor* zrle = nullptr;
+
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> zin;
+    std::vector<uint8_t> zout;
+    std::vector<bgr888_t> pixels;
+    std::vector<uint32_t> values;
+
+    ~server_t(void)
+    {
+      if (zrle) { free(zrle); }
+    }
+
+    bool start(const config_detail_t& cfg)
+    {
+      name = cfg.name ? cfg.name : "";
+      if (pipe(wake_fd)) { return false; }
+      fcntl(wake_fd[0], F_SETFL, O_NONBLOCK);
+      fcntl(wake_fd[1], F_SETFL, O_NONBLOCK);
+
+      if (cfg.unix_path != nullptr)
+      {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, cfg.unix_path, sizeof(addr.sun_path) - 1);
+        unlink(cfg.unix_path);
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)))
+        {
+          perror("Error: cannot bind the VNC socket");
+          return false;
+        }
+      }
+      else
+      {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(cfg.port);
+        addr.sin_addr.s_addr = htonl(cfg.bind_any ? INADDR_ANY : INADDR_LOOPBACK);
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        if (listen_fd >= 0) { setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)); }
+        if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)))
+        {
+          perror("Error: cannot bind the VNC port");
+          return false;
+        }
+      }
+      if (listen(listen_fd, 1))
+      {
+        perror("Error: listen");
+        return false;
+      }
+      thread = std::thread(&server_t::run, this);
+      return true;
+    }
+
+    void stop(void)
+    {
+      quit = true;
+      wake();
+      if (thread.joinable()) { thread.join(); }
+      if (listen_fd >= 0) { ::close(listen_fd); listen_fd = -1; }
+      if (wake_fd[0] >= 0) { ::close(wake_fd[0]); ::close(wake_fd[1]); wake_fd[0] = wake_fd[1] = -1; }
+    }
+
+    void wake(void)
+    {
+      if (wake_fd[1] >= 0)
+      {
+        uint8_t b = 0;
+        (void)!write(wake_fd[1], &b, 1);
+      }
+    }
+
+    void drain_wake(void)
+    {
+      uint8_t buf[64];
+      while (read(wake_fd[0], buf, sizeof(buf)) > 0) {}
+    }
+
+    bool read_all(void* buf, size_t len)
+    {
+      auto p = (uint8_t*)buf;
+      while (len)
+      {
+        auto res = recv(client_fd, p, len, 0);
+        if (res <= 0) { return false; }
+        p += res;
+        len -= res;
+      }
+      return true;
+    }
+
+    bool send_all(const void* buf, size_t len)
+    {
+      auto p = (const uint8_t*)buf;
+      while (len)
+      {
+        auto res = send(client_fd, p, len, MSG_NOSIGNAL);
+        if (res <= 0) { return false; }
+        p += res;
+        len -= res;
+      }
+      return true;
+    }
+
+    void run(void)
+    {
+      while (!quit)
+      {
+        struct pollfd fds[2] = { { listen_fd, POLLIN, 0 }, { wake_fd[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) <= 0) { continue; }
+        if (fds[1].revents) { drain_wake(); }
+        if (!(fds[0].revents & POLLIN)) { continue; }
+
+        client_fd = accept(listen_fd, nullptr, nullptr);
+        if (client_fd < 0) { continue; }
+        int one = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        struct timeval tv = { 5, 0 };
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        if (handshake())
+        {
+          connected = true;
+          serve();
+          connected = false;
+        }
+        ::close(client_fd);
+        client_fd = -1;
+        std::lock_guard<std::mutex> lock(mtx);
+        touch.size = 0;
+      }
+    }
+
+    bool handshake(void)
+    {
+      static constexpr char version[] = "RFB 003.008\n";
+      char client_version[12];
+      if (!send_all(version, 12) || !read_all(client_version, 12)) { return false; }
+      int minor = (client_version[8] - '0') * 100 + (client_version[9] - '0') * 10 + (client_version[10] - '0');
+
+      if (minor < 7)
+      {
+        std::vector<uint8_t> v;
+        put32(v, 1); // security type None
+        if (!send_all(v.data(), v.size())) { return false; }
+      }
+      else
+      {
+        static constexpr uint8_t types[] = { 1, 1 }; // count, None
+        uint8_t selected;
+        if (!send_all(types, 2) || !read_all(&selected, 1) || selected != 1) { return false; }
+        if (minor >= 8)
+        {
+          static constexpr uint8_t ok[] = { 0, 0, 0, 0 };
+          if (!send_all(ok, 4)) { return false; }
+        }
+      }
+      uint8_t shared;
+      if (!read_all(&shared, 1)) { return false; }
+
+      /// 既定の形式は 32bpp リトルエンディアンの xRGB;
+      pf.bpp = 32;
+      pf.depth = 24;
+      pf.big_endian = false;
+      pf.true_colour = true;
+      pf.max[0] = pf.max[1] = pf.max[2] = 255;
+      pf.shift[0] = 16;
+      pf.shift[1] = 8;
+      pf.shift[2] = 0;
+      update_pixel_format();
+      encoding = rfb_enc_raw;
+      update_requested = false;
+      pending.clear();
+
+      if (zrle == nullptr)
+      {
+        zrle = (tdefl_compressor*)malloc(sizeof(tdefl_compressor));
+        if (zrle == nullptr) { return false; }
+      }
+      /// ZRLE の zlib ストリームは接続毎に1本;
+      tdefl_init(zrle, put_zout, this, TDEFL_WRITE_ZLIB_HEADER | TDEFL_GREEDY_PARSING_FLAG | 32);
+
+      out.clear();
+      put16(out, width);
+      put16(out, height);
+      out.push_back(pf.bpp);
+      out.push_back(pf.depth);
+      out.push_back(pf.big_endian);
+      out.push_back(pf.true_colour);
+      put16(out, pf.max[0]);
+      put16(out, pf.max[1]);
+      put16(out, pf.max[2]);
+      out.push_back(pf.shift[0]);
+      out.push_back(pf.shift[1]);
+      out.push_back(pf.shift[2]);
+      out.insert(out.end(), 3, 0);
+      put32(out, name.size());
+      out.insert(out.end(), name.begin(), name.end());
+      return send_all(out.data(), out.size());
+    }
+
+    static mz_bool put_zout(const void* buf, int len, void* user)
+    {
+      auto me = (server_t*)user;
+      auto p = (const uint8_t*)buf;
+      me->zout.insert(me->zout.end(), p, p + len);
+      return MZ_TRUE;
+    }
+
+    void update_pixel_format(void)
+    {
+      for (size_t c = 0; c < 3; ++c)
+      {
+        uint32_t max = pf.max[c];
+        for (uint32_t v = 0; v < 256; ++v)
+        {
+          lut[c][v] = ((v * max + 127) / 255) << pf.shift[c];
+        }
+      }
+      /// ZRLE の CPIXEL : 32bpp で色が上位または下位3バイトに収まる場合は3バイトで送る;
+      cpixel_bytes = pf.bpp >> 3;
+      cpixel_offset = 0;
+      if (pf.bpp == 32 && pf.depth <= 24 && pf.true_colour)
+      {
+        uint32_t mask = (uint32_t)pf.max[0] << pf.shift[0] | (uint32_t)pf.max[1] << pf.shift[1] | (uint32_t)pf.max[2] << pf.shift[2];
+        bool low  = (mask & 0xFF000000u) == 0;
+        bool high = (mask & 0x000000FFu) == 0;
+        if (low || high)
+        {
+          cpixel_bytes = 3;
+          /// 送信バイト列中での3バイトの開始位置;
+          cpixel_offset = (low != pf.big_endian) ? 0 : 1;
+        }
+      }
+    }
+
+    void serve(void)
+    {
+      while (!quit)
+      {
+        bool ready = update_requested && has_update();
+        if (ready)
+        {
+          if (!send_update()) { return; }
+          continue;
+        }
+        struct pollfd fds[2] = { { client_fd, POLLIN, 0 }, { wake_fd[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) <= 0) { continue; }
+        if (fds[1].revents) { drain_wake(); }
+        if (fds[0].revents & (POLLERR | POLLHUP)) { return; }
+        if ((fds[0].revents & POLLIN) && !process_message()) { return; }
+      }
+    }
+
+    void keep(int_fast16_t l, int_fast16_t t, int_fast16_t r, int_fast16_t b)
+    {
+      range_rect_t rect;
+      rect.left   = l;
+      rect.top    = t;
+      rect.right  = r;
+      rect.bottom = b;
+      remain.push_back(rect);
+    }
+
+    /// 要求範囲に掛かる変更があるか。要求範囲外の変更は次の要求まで保留する;
+    bool has_update(void)
+    {
+      for (auto& r : pending)
+      {
+        if (r.intersectsWith(request)) { return true; }
+      }
+      std::lock_guard<std::mutex> lock(mtx);
+      for (auto& r : dirty)
+      {
+        if (r.intersectsWith(request)) { return true; }
+      }
+      return false;
+    }
+
+    bool process_message(void)
+    {
+      uint8_t type;
+      uint8_t buf[20];
+      if (!read_all(&type, 1)) { return false; }
+      switch (type)
+      {
+      case rfb_set_pixel_format:
+        if (!read_all(buf, 19)) { return false; }
+        if (buf[3] == 8 || buf[3] == 16 || buf[3] == 32)
+        {
+          /// カラーマップ形式には対応しないため、true-colour として扱う;
+          pf.bpp = buf[3];
+          pf.depth = buf[4];
+          pf.big_endian = buf[5];
+          pf.true_colour = true;
+          pf.max[0] = get16(&buf[7]);
+          pf.max[1] = get16(&buf[9]);
+          pf.max[2] = get16(&buf[11]);
+          pf.shift[0] = buf[13];
+          pf.shift[1] = buf[14];
+          pf.shift[2] = buf[15];
+          update_pixel_format();
+        }
+        return true;
+
+      case rfb_set_encodings:
+        {
+          if (!read_all(buf, 3)) { return false; }
+          size_t count = get16(&buf[1]);
+          /// クライアントの優先順で、対応しているものを選ぶ;
+          encoding = rfb_enc_raw;
+          bool found = false;
+          for (size_t i = 0; i < count; ++i)
+          {
+            if (!read_all(buf, 4)) { return false; }
+            int32_t enc = get32(buf);
+            if (!found && (enc == rfb_enc_raw || enc == rfb_enc_rre || enc == rfb_enc_hextile || enc == rfb_enc_zrle))
+            {
+              encoding = enc;
+              found = true;
+            }
+          }
+        }
+        return true;
+
+      case rfb_update_request:
+        {
+          if (!read_all(buf, 9)) { return false; }
+          range_rect_t r;
+          r.left   = get16(&buf[1]);
+          r.top    = get16(&buf[3]);
+          r.right  = std::min<int_fast16_t>(width , r.left + get16(&buf[5])) - 1;
+          r.bottom = std::min<int_fast16_t>(height, r.top  + get16(&buf[7])) - 1;
+          request = r;
+          update_requested = true;
+          if (!buf[0] && !r.empty())
+          {
+            add_rect(pending, r);
+          }
+        }
+        return true;
+
+      case rfb_key_event:
+        return read_all(buf, 7);
+
+      case rfb_pointer_event:
+        {
+          if (!read_all(buf, 5)) { return false; }
+          std::lock_guard<std::mutex> lock(mtx);
+          touch.x = get16(&buf[1]);
+          touch.y = get16(&buf[3]);
+          touch.size = (buf[0] & 1) ? 1 : 0;
+          touch.id = 0;
+        }
+        return true;
+
+      case rfb_client_cut_text:
+        {
+          if (!read_all(buf, 7)) { return false; }
+          size_t len = get32(&buf[3]);
+          while (len)
+          {
+            size_t l = std::min<size_t>(len, sizeof(buf));
+            if (!read_all(buf, l)) { return false; }
+            len -= l;
+          }
+        }
+        return true;
+
+      default:
+        return false;
+      }
+    }
+
+    /// 変更範囲を取り出し、要求範囲内の画素をロック中に複写してからエンコードする。
+    /// 要求範囲の外側の部分は pending に残し、後の要求で送る;
+    bool send_update(void)
+    {
+      std::vector<range_rect_t> rects;
+      size_t total = 0;
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto& r : dirty) { add_rect(pending, r); }
+        dirty.clear();
+        remain.clear();
+        auto& q = request;
+        for (auto& r : pending)
+        {
+          range_rect_t i;
+          i.left   = std::max(r.left  , q.left  );
+          i.top    = std::max(r.top   , q.top   );
+          i.right  = std::min(r.right , q.right );
+          i.bottom = std::min(r.bottom, q.bottom);
+          if (i.empty())
+          {
+            remain.push_back(r);
+            continue;
+          }
+          rects.push_back(i);
+          total += i.width() * i.height();
+          /// 残りは重ならない最大4つの矩形 (上・下の帯と、左・右の部分) ;
+          if (r.top    < i.top   ) { keep(r.left     , r.top       , r.right    , i.top - 1); }
+          if (i.bottom < r.bottom) { keep(r.left     , i.bottom + 1, r.right    , r.bottom ); }
+          if (r.left   < i.left  ) { keep(r.left     , i.top       , i.left - 1 , i.bottom ); }
+          if (i.right  < r.right ) { keep(i.right + 1, i.top       , r.right    , i.bottom ); }
+        }
+        pending.clear();
+        if (remain.size() <= rfb_max_rects)
+        {
+          pending.swap(remain);
+        }
+        else
+        {
+          for (auto& r : remain) { add_rect(pending, r); }
+        }
+        if (rects.empty()) { return true; }
+        pixels.resize(total);
+        auto dst = pixels.data();
+        for (auto& r : rects)
+        {
+          for (int_fast16_t y = r.top; y <= r.bottom; ++y)
+          {
+            memcpy(dst, &shadow[y * width + r.left], r.width() * sizeof(bgr888_t));
+            dst += r.width();
+          }
+        }
+      }
+      update_requested = false;
+
+      out.clear();
+      out.push_back(0);
+      out.push_back(0);
+      put16(out, rects.size());
+      auto src = pixels.data();
+      for (auto& r : rects)
+      {
+        size_t w = r.width();
+        size_t h = r.height();
+        put16(out, r.left);
+        put16(out, r.top);
+        put16(out, w);
+        put16(out, h);
+        put32(out, encoding);
+        values.resize(w * h);
+        for (size_t i = 0; i < w * h; ++i)
+        {
+          values[i] = lut[0][src[i].r] | lut[1][src[i].g] | lut[2][src[i].b];
+        }
+        switch (encoding)
+        {
+        case rfb_enc_rre:     encode_rre(w, h); break;
+        case rfb_enc_hextile: encode_hextile(w, h); break;
+        case rfb_enc_zrle:    encode_zrle(w, h); break;
+        default:              encode_raw(values.data(), w * h); break;
+        }
+        src += w * h;
+      }
+      return send_all(out.data(), out.size());
+    }
+
+    void put_pixel(std::vector<uint8_t>& v, uint32_t value)
+    {
+      switch (pf.bpp)
+      {
+      case 8:
+        v.push_back(value);
+        break;
+      case 16:
+        if (pf.big_endian) { v.push_back(value >> 8); v.push_back(value); }
+        else               { v.push_back(value); v.push_back(value >> 8); }
+        break;
+      default:
+        if (pf.big_endian) { put32(v, value); }
+        else               { v.push_back(value); v.push_back(value >> 8); v.push_back(value >> 16); v.push_back(value >> 24); }
+        break;
+      }
+    }
+
+    void put_cpixel(std::vector<uint8_t>& v, uint32_t value)
+    {
+      if (cpixel_bytes != 3) { put_pixel(v, value); return; }
+      size_t pos = v.size();
+      put_pixel(v, value);
+      v.erase(v.begin() + pos + (cpixel_offset ? 0 : 3));
+    }
+
+    void encode_raw(const uint32_t* src, size_t len)
+    {
+      for (size_t i = 0; i < len; ++i) { put_pixel(out, src[i]); }
+    }
+
+    /// 左上の色を背景とし、背景以外の横方向の連続を副矩形として送る;
+    void encode_rre(size_t w, size_t h)
+    {
+      size_t count_pos = out.size();
+      put32(out, 0);
+      uint32_t bg = values[0];
+      put_pixel(out, bg);
+      uint32_t count = 0;
+      for (size_t y = 0; y < h; ++y)
+      {
+        auto row = &values[y * w];
+        for (size_t x = 0; x < w; )
+        {
+          uint32_t c = row[x];
+          if (c == bg) { ++x; continue; }
+          size_t xs = x;
+          while (++x < w && row[x] == c) {}
+          put_pixel(out, c);
+          put16(out, xs);
+          put16(out, y);
+          put16(out, x - xs);
+          put16(out, 1);
+          ++count;
+        }
+      }
+      out[count_pos    ] = count >> 24;
+      out[count_pos + 1] = count >> 16;
+      out[count_pos + 2] = count >> 8;
+      out[count_pos + 3] = count;
+    }
+
+    /// 16x16 のタイル毎に、単色なら背景色のみ、それ以外は Raw で送る;
+    void encode_hextile(size_t w, size_t h)
+    {
+      for (size_t ty = 0; ty < h; ty += 16)
+      {
+        size_t th = std::min<size_t>(16, h - ty);
+        for (size_t tx = 0; tx < w; tx += 16)
+        {
+          size_t tw = std::min<size_t>(16, w - tx);
+          uint32_t c = values[ty * w + tx];
+          bool solid = true;
+          for (size_t y = 0; solid && y < th; ++y)
+          {
+            auto row = &values[(ty + y) * w + tx];
+            for (size_t x = 0; x < tw; ++x)
+            {
+              if (row[x] != c) { solid = false; break; }
+            }
+          }
+          if (solid)
+          {
+            out.push_back(2); // BackgroundSpecified
+            put_pixel(out, c);
+          }
+          else
+          {
+            out.push_back(1); // Raw
+            for (size_t y = 0; y < th; ++y)
+            {
+              encode_raw(&values[(ty + y) * w + tx], tw);
+            }
+          }
+        }
+      }
+    }
+
+    /// 64x64 のタイル毎に、単色 / 16色以下のパレット / Raw のいずれかで符号化して zlib で圧縮する;
+    void encode_zrle(size_t w, size_t h)
+    {
+      zin.clear();
+      uint32_t palette[16];
+      for (size_t ty = 0; ty < h; ty += 64)
+      {
+        size_t th = std::min<size_t>(64, h - ty);
+        for (size_t tx = 0; tx < w; tx += 64)
+        {
+          size_t tw = std::min<size_t>(64, w - tx);
+          size_t n = 0;
+          for (size_t y = 0; n <= 16 && y < th; ++y)
+          {
+            auto row = &values[(ty + y) * w + tx];
+            for (size_t x = 0; x < tw; ++x)
+            {
+              uint32_t c = row[x];
+              size_t i = 0;
+              while (i < n && palette[i] != c) { ++i; }
+              if (i == n)
+              {
+                if (n == 16) { n = 17; break; }
+                palette[n++] = c;
+              }
+            }
+          }
+
+          if (n == 1)
+          {
+            zin.push_back(1);
+            put_cpixel(zin, palette[0]);
+          }
+          else if (n <= 16)
+          {
+            zin.push_back(n);
+            for (size_t i = 0; i < n; ++i) { put_cpixel(zin, palette[i]); }
+            uint_fast8_t bits = (n <= 2) ? 1 : (n <= 4) ? 2 : 4;
+            for (size_t y = 0; y < th; ++y)
+            {
+              auto row = &values[(ty + y) * w + tx];
+              uint_fast8_t acc = 0;
+              uint_fast8_t filled = 0;
+              for (size_t x = 0; x < tw; ++x)
+              {
+                size_t i = 0;
+                while (palette[i] != row[x]) { ++i; }
+                acc = (acc << bits) | i;
+                filled += bits;
+                if (filled == 8) { zin.push_back(acc); acc = 0; filled = 0; }
+              }
+              if (filled) { zin.push_back(acc << (8 - filled)); }
+            }
+          }
+          else
+          {
+            zin.push_back(0);
+            for (size_t y = 0; y < th; ++y)
+            {
+              auto row = &values[(ty + y) * w + tx];
+              for (size_t x = 0; x < tw; ++x) { put_cpixel(zin, row[x]); }
+            }
+          }
+        }
+      }
+      zout.clear();
+      tdefl_compress_buffer(zrle, zin.data(), zin.size(), TDEFL_SYNC_FLUSH);
+      put32(out, zout.size());
+      out.insert(out.end(), zout.begin(), zout.end());
+    }
+  };
+
+//----------------------------------------------------------------------------
+
+  Panel_VNC::Panel_VNC(void) : Panel_Memory()
+  {
+  }
+
+  Panel_VNC::~Panel_VNC(void)
+  {
+    close();
+  }
+
+  bool Panel_VNC::init(bool use_reset)
+  {
+    close();
+    if (!Panel_Memory::init(use_reset))
+    {
+      return false;
+    }
+
+    auto server = new server_t();
+    server->width  = _cfg.panel_width;
+    server->height = _cfg.panel_height;
+    server->shadow.resize(server->width * server->height);
+    server->touch = {};
+    if (!server->start(_config_detail))
+    {
+      server->stop();
+      delete server;
+      return false;
+    }
+    _server = server;
+
+    _modified_all();
+    return true;
+  }
+
+  void Panel_VNC::close(void)
+  {
+    auto server = _server;
+    if (server == nullptr) { return; }
+    _server = nullptr;
+    server->stop();
+    if (_config_detail.unix_path != nullptr)
+    {
+      unlink(_config_detail.unix_path);
+    }
+    delete server;
+  }
+
+  bool Panel_VNC::isConnected(void) const
+  {
+    return _server != nullptr && _server->connected;
+  }
+
+  color_depth_t Panel_VNC::setColorDepth(color_depth_t depth)
+  {
+    depth = Panel_Memory::setColorDepth(depth);
+    /// ラインの配置が変わるため、全体を更新対象にする;
+    _modified_all();
+    return depth;
+  }
+
+  void Panel_VNC::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
+  {
+    auto server = _server;
+    if (server == nullptr) { return; }
+    if (0 < w && 0 < h)
+    {
+      _update_modified_rect(x, y, w, h);
+    }
+    if (_range_mod.empty()) { return; }
+
+    uint32_t (*fp_copy)(void*, uint32_t, uint32_t, pixelcopy_t*);
+    switch (_write_depth)
+    {
+    case rgb565_2Byte:   fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, swap565_t  >; break;
+    case rgb332_1Byte:   fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, rgb332_t   >; break;
+    case grayscale_8bit: fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, grayscale_t>; break;
+    default:             fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, bgr888_t   >; break;
+    }
+
+    /// 変更範囲をサーバ用の画面 (R,G,B) へ変換して複写する。エンコードと送信はサーバスレッドで行う;
+    {
+      std::lock_guard<std::mutex> lock(server->mtx);
+      pixelcopy_t pc;
+      size_t width = server->width;
+      for (int_fast16_t yy = _range_mod.top; yy <= _range_mod.bottom; ++yy)
+      {
+        pc.src_data = _lines_buffer[yy];
+        pc.src_x32 = _range_mod.left;
+        fp_copy(&server->shadow[yy * width], _range_mod.left, _range_mod.right + 1, &pc);
+      }
+      add_rect(server->dirty, _range_mod);
+    }
+    server->wake();
+
+    _clear_modified_rect();
+  }
+
+  uint_fast8_t Panel_VNC::getTouchRaw(touch_point_t* tp, uint_fast8_t count)
+  {
+    if (_server == nullptr) { return 0; }
+    std::lock_guard<std::mutex> lock(_server->mtx);
+    *tp = _server->touch;
+    return _server->touch.size ? 1 : 0;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
+
+#endif
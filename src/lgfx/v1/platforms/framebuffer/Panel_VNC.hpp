@@ -0,0 +1,93 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "../../panel/Panel_Memory.hpp"
+#include "../../misc/range.hpp"
+#include "../../Touch.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// 描画内容を RFB (VNC) プロトコルで配信するパネル。変更範囲のみを Raw / RRE / Hextile / ZRLE で送信し、
+  /// ポインタ操作は getTouchRaw で読み出せる。通信と圧縮は別スレッドで行うため描画側は待たされない;
+  /// Panel that serves its contents over the RFB (VNC) protocol on a TCP or Unix socket.
+  /// Only modified rectangles are sent, encoded as Raw, RRE, Hextile or ZRLE (zlib from the bundled
+  /// miniz). Pointer events are available through getTouchRaw. Networking and encoding run on a
+  /// server thread; display() only copies the dirty rows, so a slow viewer never stalls drawing.
+  /// One viewer is served at a time, without authentication.
+  struct Panel_VNC : public Panel_Memory
+  {
+  public:
+    struct config_detail_t
+    {
+      /// TCP の待受けポート;
+      /// TCP port to listen on.
+      uint16_t port = 5900;
+
+      /// true の場合は全てのアドレスで待ち受ける (既定はループバックのみ) ;
+      /// listen on every interface instead of loopback only.
+      bool bind_any = false;
+
+      /// 指定した場合は TCP の代わりに Unix ドメインソケットで待ち受ける;
+      /// when set, listen on this Unix domain socket path instead of TCP.
+      const char* unix_path = nullptr;
+
+      /// ServerInit で通知するデスクトップ名;
+      /// desktop name sent in ServerInit.
+      const char* name = "LovyanGFX";
+    };
+
+    Panel_VNC(void);
+    virtual ~Panel_VNC(void);
+
+    bool init(bool use_reset) override;
+
+    color_depth_t setColorDepth(color_depth_t depth) override;
+
+    void display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h) override;
+
+
+    uint_fast8_t getTouchRaw(touch_point_t* tp, uint_fast8_t count) override;
+
+    const config_detail_t& config_detail(void) const { return _config_detail; }
+    void config_detail(const config_detail_t& config_detail) { _config_detail = config_detail; }
+
+    /// 待受けを終了し、サーバスレッドを停止する;
+    /// Stops listening and joins the server thread.
+    void close(void);
+
+    /// 接続中のビューアがあれば true ;
+    /// true while a viewer is connected.
+    bool isConnected(void) const;
+
+  protected:
+    struct server_t;
+
+    config_detail_t _config_detail;
+    server_t* _server = nullptr;
+
+
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -20,7 +20,7 @@ Porting for Linux FrameBuffer:
 /----------------------------------------------------------------------------*/
 #pragma once
 
-#include "../../panel/Panel_Device.hpp"
+#include "../../panel/Panel_FrameBufferBase.hpp"
 #include "../../misc/range.hpp"
 #include "../../Touch.hpp"
 
@@ -36,7 +36,11 @@ namespace lgfx
  {
 //----------------------------------------------------------------------------
 
-  struct Panel_fb : public Panel_Device
+  /// 描画はメインメモリ上のシャドウバッファに対して行い、display() で変更範囲だけを
+  /// フレームバッファデバイスの形式に変換して書き込む;
+  /// Drawing goes to a shadow buffer in system memory. display() converts only the
+  /// modified area into the device's pixel format and writes it to the mmapped framebuffer.
+  struct Panel_fb : public Panel_FrameBufferBase
   {
 
   public:
@@ -47,34 +51,18 @@ namespace lgfx
     {
       // 操作対象とするフレームバッファのパス名、または、デバイス名称 ("st7789") 等の文字列へのポインタを指定する。
       const char* device_name = "/dev/fb0";
+
+      /// yres_virtual を2画面分に広げ、FBIOPAN_DISPLAY で表示ページを切り替える (ドライバが対応している場合のみ) ;
+      /// Double yres_virtual and flip pages with FBIOPAN_DISPLAY for tear-free updates, when the driver allows it.
+      bool use_page_flip = false;
     };
 
     bool init(bool use_reset) override;
-    void beginTransaction(void) override;
-    void endTransaction(void) override;
-
-    color_depth_t setColorDepth(color_depth_t depth);
-    void setRotation(uint_fast8_t r) override;
-    void setInvert(bool invert) override {}
-    void setSleep(bool flg) override {}
-    void setPowerSave(bool) override {}
 
-    void waitDisplay(void) override {}
-    bool displayBusy(void) override { return false; }
+    color_depth_t setColorDepth(color_depth_t depth) override;
 
-    void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) override;
-    void writeBlock(uint32_t rawcolor, uint32_t length) override;
     void display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h) override;
-    void setWindow(uint_fast16_t xs, uint_fast16_t ys, uint_fast16_t xe, uint_fast16_t ye) override;
-    void drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) override;
-    void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor) override;
-    void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) override;
-    void writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param) override;
 
-    uint32_t readCommand(uint_fast16_t cmd, uint_fast8_t index, uint_fast8_t len) override { return 0; }
-    uint32_t readData(uint_fast8_t index, uint_fast8_t len) override { return 0; }
-    void readRect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, void* dst, pixelcopy_t* param) override;
-    void copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y) override;
 
     uint_fast8_t getTouchRaw(touch_point_t* tp, uint_fast8_t count) override;
 
@@ -90,20 +78,27 @@ namespace lgfx
 
     touch_point_t _touch_point;
     // framebuffer
-    int _fbfd = 0;
-    char* _fbp = 0;
+    int _fbfd = -1;
+    char* _fbp = nullptr;
     long int _screensize = 0;
     struct fb_var_screeninfo _var_info;
+    struct fb_var_screeninfo _var_info_orig;
     struct fb_fix_screeninfo _fix_info;
 
-    int32_t _xpos = 0;
-    int32_t _ypos = 0;
-
-    void _rotate_pixelcopy(uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& w, uint_fast16_t& h, pixelcopy_t* param, uint32_t& nextx, uint32_t& nexty);
-
-  private:
-    void fb_draw_rgb_pixel(int x, int y, uint32_t rawcolor);
-    void fb_draw_argb_pixel(int x, int y, uint32_t rawcolor);
+    /// ページ切替時、裏ページに未反映の前回の変更範囲;
+    /// with page flipping, the previous frame's area that the back page has not seen yet.
+    range_rect_t _range_prev;
+    uint32_t (*_fp_flush)(void*, uint32_t, uint32_t, pixelcopy_t*) = nullptr;
+    uint_fast8_t _fb_bytes = 0;
+    /// 表示中のページ (ページ切替を使用しない場合は 0) ;
+    uint_fast8_t _page = 0;
+    bool _page_flip = false;
+    /// FBIOPUT_VSCREENINFO で表示モードを変更したか (終了時に元に戻す) ;
+    bool _mode_changed = false;
+
+    bool _init_shadow(void);
+    void _deinit_shadow(void);
+    void _flush_rect(const range_rect_t& range, uint_fast8_t page);
   };
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,239 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#if defined ( LGFX_LINUX_FB )
+
+#include "Panel_shm.hpp"
+
+#include "../common.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// ヘッダの大きさ。画素データの先頭をキャッシュライン境界に揃える;
+  static constexpr size_t shm_header_size = (sizeof(Panel_shm::shm_header_t) + 63) & ~63u;
+
+  static long futex(uint32_t* addr, int op, uint32_t val, const struct timespec* timeout)
+  {
+    return syscall(SYS_futex, addr, op, val, timeout, nullptr, 0);
+  }
+
+  Panel_shm::Panel_shm(void) : Panel_FrameBufferBase()
+  {
+    /// 描画は共有メモリに直接行われ、endWrite 時に display() を呼んでフレームを公開する;
+    _auto_display = true;
+  }
+
+  Panel_shm::~Panel_shm(void)
+  {
+    _deinit_shm();
+  }
+
+  void Panel_shm::_deinit_shm(void)
+  {
+    if (_lines_buffer != nullptr)
+    {
+      heap_free(_lines_buffer);
+      _lines_buffer = nullptr;
+    }
+    if (_header != nullptr)
+    {
+      munmap(_header, _shm_size);
+      _header = nullptr;
+    }
+    if (_shm_fd >= 0)
+    {
+      close(_shm_fd);
+      _shm_fd = -1;
+      if (_config_detail.unlink_on_close)
+      {
+        shm_unlink(_config_detail.shm_name);
+      }
+    }
+  }
+
+  bool Panel_shm::init(bool use_reset)
+  {
+    _deinit_shm();
+
+    size_t width  = _cfg.panel_width;
+    size_t height = _cfg.panel_height;
+    /// 色深度の変更に備えて1画素あたり3Byte分を確保し、8Byte境界に揃える;
+    size_t stride = (width * 3 + 7) & ~7u;
+    size_t size = shm_header_size + stride * height;
+
+    _shm_fd = shm_open(_config_detail.shm_name, O_CREAT | O_RDWR, 0600);
+    if (_shm_fd < 0)
+    {
+      perror("Error: shm_open");
+      return false;
+    }
+    if (ftruncate(_shm_fd, size))
+    {
+      perror("Error: ftruncate");
+      _deinit_shm();
+      return false;
+    }
+    auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _shm_fd, 0);
+    if (ptr == MAP_FAILED)
+    {
+      perror("Error: failed to map shared memory");
+      _deinit_shm();
+      return false;
+    }
+    _shm_size = size;
+    _header = (shm_header_t*)ptr;
+
+    auto lines = (uint8_t**)heap_alloc(height * sizeof(uint8_t*));
+    if (lines == nullptr)
+    {
+      _deinit_shm();
+      return false;
+    }
+    auto buf = (uint8_t*)ptr + shm_header_size;
+    memset(buf, 0, stride * height);
+    for (size_t y = 0; y < height; ++y)
+    {
+      lines[y] = &buf[y * stride];
+    }
+    _lines_buffer = lines;
+
+    /// magic は最後に書き込み、受信側が不完全なヘッダを読まないようにする;
+    auto h = _header;
+    h->magic = 0;
+    h->version = shm_header_t::version_value;
+    h->header_size = shm_header_size;
+    h->width  = width;
+    h->height = height;
+    h->stride = stride;
+    h->sequence = 0;
+    h->dirty_left   = 0;
+    h->dirty_top    = 0;
+    h->dirty_right  = -1;
+    h->dirty_bottom = -1;
+    _drawing = false;
+    setColorDepth(_write_depth);
+    __atomic_store_n(&h->magic, shm_header_t::magic_value, __ATOMIC_RELEASE);
+
+    return Panel_FrameBufferBase::init(use_reset);
+  }
+
+  color_depth_t Panel_shm::setColorDepth(color_depth_t depth)
+  {
+    auto bits = depth & color_depth_t::bit_mask;
+    if (bits >= 16) {
+      depth = (bits > 16)
+            ? rgb888_3Byte
+            : rgb565_2Byte;
+    } else {
+      depth = (depth == color_depth_t::grayscale_8bit)
+            ? grayscale_8bit
+            : rgb332_1Byte;
+    }
+    _write_depth = depth;
+    _read_depth = depth;
+
+    if (_header != nullptr)
+    {
+      /// 形式が変わると画面全体の解釈が変わるため、全体を更新対象にする;
+      _begin_frame();
+      _modified_all();
+      _header->depth = depth;
+      _header->bits_per_pixel = depth & color_depth_t::bit_mask;
+    }
+    return depth;
+  }
+
+  void Panel_shm::_begin_frame(void)
+  {
+    if (!_drawing && _header != nullptr)
+    {
+      /// フレームの描画開始を奇数のシーケンス番号で示す;
+      _drawing = true;
+      __atomic_add_fetch(&_header->sequence, 1, __ATOMIC_RELEASE);
+    }
+  }
+
+  void Panel_shm::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
+  {
+    if (_header == nullptr) { return; }
+    if (0 < w && 0 < h)
+    {
+      _update_modified_rect(x, y, w, h);
+    }
+    if (!_drawing) { return; }
+    _drawing = false;
+
+    auto hdr = _header;
+    hdr->dirty_left   = _range_mod.left;
+    hdr->dirty_top    = _range_mod.top;
+    hdr->dirty_right  = _range_mod.right;
+    hdr->dirty_bottom = _range_mod.bottom;
+    /// 偶数に戻してフレームを公開し、待機中のプロセスを起こす;
+    __atomic_add_fetch(&hdr->sequence, 1, __ATOMIC_RELEASE);
+    futex(&hdr->sequence, FUTEX_WAKE, INT32_MAX, nullptr);
+
+    _clear_modified_rect();
+  }
+
+  uint32_t Panel_shm::waitFrame(const shm_header_t* header, uint32_t last_sequence, int timeout_ms)
+  {
+    auto seq = const_cast<uint32_t*>(&header->sequence);
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if (timeout_ms >= 0)
+    {
+      deadline.tv_sec  += timeout_ms / 1000;
+      deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+      if (deadline.tv_nsec >= 1000000000L) { deadline.tv_nsec -= 1000000000L; ++deadline.tv_sec; }
+    }
+    for (;;)
+    {
+      uint32_t s = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+      if (s != last_sequence && !(s & 1)) { return s; }
+
+      struct timespec rel;
+      struct timespec* timeout = nullptr;
+      if (timeout_ms >= 0)
+      {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        rel.tv_sec  = deadline.tv_sec  - now.tv_sec;
+        rel.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+        if (rel.tv_nsec < 0) { rel.tv_nsec += 1000000000L; --rel.tv_sec; }
+        if (rel.tv_sec < 0) { return last_sequence; }
+        timeout = &rel;
+      }
+      futex(seq, FUTEX_WAIT, s, timeout);
+    }
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "../../panel/Panel_FrameBufferBase.hpp"
+#include "../../misc/range.hpp"
+
+#include <stdint.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// 描画バッファを POSIX 共有メモリ上に置き、別プロセスのビューア等から直接参照できるようにする。
+  /// display() (endWrite 時に自動で呼ばれる) で変更範囲とフレーム番号を公開し、futex で通知する;
+  /// The panel's line buffers live in a POSIX shared-memory segment, so viewers, recorders or
+  /// test oracles in other processes can read the frames without a copy.
+  /// display() (called automatically by endWrite) publishes the dirty rect and a new frame number
+  /// and wakes the waiters through a futex on that number.
+  struct Panel_shm : public Panel_FrameBufferBase
+  {
+  public:
+    /// 共有メモリ先頭のヘッダ。画素データは header_size バイト目から stride バイト間隔で並ぶ;
+    /// Header at the start of the segment. Pixel rows start at header_size, stride bytes apart.
+    struct shm_header_t
+    {
+      static constexpr uint32_t magic_value = 0x5846474C; // "LGFX"
+      static constexpr uint16_t version_value = 1;
+
+      uint32_t magic;
+      uint16_t version;
+      uint16_t header_size;
+      uint16_t width;
+      uint16_t height;
+      uint32_t stride;
+      /// 画素の形式 (color_depth_t の値) 。画素は本ライブラリの書込み形式
+      /// (rgb565 はビッグエンディアン、rgb888 は R,G,B の順) で格納される;
+      /// pixel format as a color_depth_t value, stored in the library's write format
+      /// (rgb565 big-endian, rgb888 as R,G,B bytes).
+      uint16_t depth;
+      uint16_t bits_per_pixel;
+      /// 描画中は奇数、フレーム公開時に偶数になる (futex の待機対象) ;
+      /// odd while a frame is being drawn, even once published; this is the futex word.
+      uint32_t sequence;
+      /// 直前に公開したフレームの変更範囲 (両端を含む) ;
+      /// dirty rect of the last published frame, inclusive.
+      int16_t dirty_left;
+      int16_t dirty_top;
+      int16_t dirty_right;
+      int16_t dirty_bottom;
+
+      const uint8_t* pixels(void) const { return reinterpret_cast<const uint8_t*>(this) + header_size; }
+      const uint8_t* line(uint_fast16_t y) const { return pixels() + y * stride; }
+    };
+
+    struct config_detail_t
+    {
+      /// shm_open に渡す名前 ('/' で始まる) ;
+      /// name passed to shm_open, starting with '/'.
+      const char* shm_name = "/lgfx_panel";
+
+      /// 破棄時に shm_unlink する;
+      /// shm_unlink the segment when the panel is destroyed.
+      bool unlink_on_close = true;
+    };
+
+    Panel_shm(void);
+    virtual ~Panel_shm(void);
+
+    bool init(bool use_reset) override;
+
+    color_depth_t setColorDepth(color_depth_t depth) override;
+
+    void display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h) override;
+
+
+    const config_detail_t& config_detail(void) const { return _config_detail; }
+    void config_detail(const config_detail_t& config_detail) { _config_detail = config_detail; }
+
+    const shm_header_t* getHeader(void) const { return _header; }
+
+    /// 受信側のプロセス用。last_sequence より新しいフレームが公開されるまで待ち、その番号を返す。
+    /// タイムアウト時は last_sequence を返す (timeout_ms < 0 で無期限) ;
+    /// For the consuming process: waits until a frame newer than last_sequence is published and
+    /// returns its sequence number, or last_sequence on timeout (timeout_ms < 0 waits forever).
+    static uint32_t waitFrame(const shm_header_t* header, uint32_t last_sequence, int timeout_ms = -1);
+
+  protected:
+    config_detail_t _config_detail;
+
+    int _shm_fd = -1;
+    size_t _shm_size = 0;
+    shm_header_t* _header = nullptr;
+
+    bool _drawing = false;
+
+    void _deinit_shm(void);
+    void _begin_frame(void);
+    void _begin_modified(void) override { _begin_frame(); }
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -20,6 +20,7 @@ Porting for Linux FrameBuffer:
 /----------------------------------------------------------------------------*/
 #pragma once
 
+#include "../../misc/Allocator.hpp"
 #include "../../misc/DataWrapper.hpp"
 #include "../../misc/enum.hpp"
 #include "../../../utility/result.hpp"
@@ -41,10 +42,10 @@ namespace lgfx
 
   void delayMicroseconds(unsigned int us);
 
-  static inline void* heap_alloc(      size_t length) { return malloc(length); }
-  static inline void* heap_alloc_psram(size_t length) { return malloc(length); }
-  static inline void* heap_alloc_dma(  size_t length) { return malloc(length); } // aligned_alloc(16, length);
-  static inline void heap_free(void* buf) { free(buf); }
+  static inline void* platform_heap_alloc(      size_t length) { return malloc(length); }
+  static inline void* platform_heap_alloc_psram(size_t length) { return malloc(length); }
+  static inline void* platform_heap_alloc_dma(  size_t length) { return malloc(length); } // aligned_alloc(16, length);
+  static inline void platform_heap_free(void* buf) { free(buf); }
 
   void gpio_hi(uint32_t pin);
   void gpio_lo(uint32_t pin);
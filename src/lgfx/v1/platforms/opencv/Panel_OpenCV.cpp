@@ -43,7 +43,7 @@ namespace lgfx
 
   static void memset_multi(uint8_t* buf, uint32_t c, size_t size, size_t length)
   {
-    if (size == 1 || ((c & 0xFF) == ((c >> 8) & 0xFF) && (size == 2 || ((c & 0xFF) == ((c >> 16) & 0xFF)))))
+    if (size == 1 || ((c & 0xFF) == ((c >> 8) & 0xFF) && (size == 2 || ((c & 0xFF) == ((c >> 16) & 0xFF) && (size == 3 || (c & 0xFF) == (c >> 24))))))
     {
       memset(buf, c, size * length);
       return;
@@ -98,9 +98,35 @@ namespace lgfx
     }
   }
 
+  /// cv::Mat の1ライン (BGR / BGRA) とパネルの書込み形式 (bgr888_t) の相互変換;
+  /// conversion between a cv::Mat row (BGR / BGRA) and the panel's write format (bgr888_t).
+  static void store_pixels(uint8_t* dst, const bgr888_t* src, size_t len, size_t bytes)
+  {
+    do
+    {
+      dst[0] = src->b;
+      dst[1] = src->g;
+      dst[2] = src->r;
+      if (bytes == 4) { dst[3] = 0xFF; }
+      dst += bytes;
+      ++src;
+    } while (--len);
+  }
+
+  static void load_pixels(bgr888_t* dst, const uint8_t* src, size_t len, size_t bytes)
+  {
+    do
+    {
+      dst->r = src[2];
+      dst->g = src[1];
+      dst->b = src[0];
+      src += bytes;
+      ++dst;
+    } while (--len);
+  }
+
   void Panel_OpenCV::imshowall(void)
   {
-    cv::Mat mat;
     for (auto& info : _list_mat)
     {
       if (-1 == cv::getWindowProperty(info.window_name, cv::WND_PROP_AUTOSIZE))
@@ -108,43 +134,70 @@ namespace lgfx
         cv::namedWindow(info.window_name, cv::WINDOW_AUTOSIZE);
         cv::setMouseCallback(info.window_name, cv_mouse_callback, &(info.panel->_touch_point));
       }
-      cv::cvtColor(*(info.cvmat), mat, cv::COLOR_BGR2RGB);
-      cv::imshow(info.window_name, mat);
-      mat.release();
+      cv::imshow(info.window_name, *(info.cvmat));
     }
     cv::waitKey(10);
   }
 
   Panel_OpenCV::~Panel_OpenCV(void)
   {
-    _img = nullptr;
+    _remove_window();
     _cv_mat.release();
   }
 
-  Panel_OpenCV::Panel_OpenCV(void) : Panel_Device(), _img(nullptr), _window_name( "" )
+  Panel_OpenCV::Panel_OpenCV(void) : Panel_Device(), _window_name( "" )
   {
-    _img = nullptr;
   }
 
-  bool Panel_OpenCV::init(bool use_reset)
+  void Panel_OpenCV::_remove_window(void)
+  {
+    if (!_has_window) { return; }
+    _has_window = false;
+    for (auto it = _list_mat.begin(); it != _list_mat.end(); ++it)
+    {
+      if (it->panel == this)
+      {
+        _list_mat.erase(it);
+        break;
+      }
+    }
+  }
+
+  bool Panel_OpenCV::setMat(const cv::Mat& mat)
   {
-    _cv_mat = cv::Mat(_cfg.memory_height, _cfg.memory_width, CV_8UC3);
-    _img = _cv_mat.data;
-    sprintf(_window_name, "LGFX_OpenCV_%d", ++_window_no);
+    if (mat.empty() || (mat.type() != CV_8UC3 && mat.type() != CV_8UC4))
+    {
+      return false;
+    }
+    _remove_window();
+
+    /// ヘッダのみ共有し、画素データはコピーしない;
+    /// only the header is shared; the pixel data stays where the caller put it.
+    _cv_mat = mat;
+    _cfg.panel_width  = _cfg.memory_width  = mat.cols;
+    _cfg.panel_height = _cfg.memory_height = mat.rows;
+    _line_buf.resize(mat.cols);
+    setRotation(_rotation);
+    return true;
+  }
 
-    _list_mat.emplace_back(cvmat_info_t{ this, &_cv_mat, _window_name });
-//  _list_mat.push_back(std::make_pair(_window_name, &_cv_mat));
+  bool Panel_OpenCV::init(bool use_reset)
+  {
+    if (_cv_mat.empty())
+    {
+      _cv_mat = cv::Mat(_cfg.memory_height, _cfg.memory_width, CV_8UC3);
+      _line_buf.resize(_cfg.memory_width);
+      sprintf(_window_name, "LGFX_OpenCV_%d", ++_window_no);
 
-//    cv::imshow(_window_name, _cv_mat);
-//    cv::setMouseCallback(_window_name, cv_mouse_callback, &_touch_point);
+      _list_mat.emplace_back(cvmat_info_t{ this, &_cv_mat, _window_name });
+      _has_window = true;
+    }
 
     return Panel_Device::init(use_reset);
   }
 
   void Panel_OpenCV::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
   {
-//    cv::imshow(_window_name, _cv_mat);
-//    cv::pollKey();
   }
 
   color_depth_t Panel_OpenCV::setColorDepth(color_depth_t depth)
@@ -185,6 +238,18 @@ namespace lgfx
     _ye = ye;
   }
 
+  bgr888_t* Panel_OpenCV::_load_line(uint_fast16_t x, uint_fast16_t y, uint_fast16_t len)
+  {
+    auto buf = _line_buf.data();
+    load_pixels(&buf[x], _cv_mat.ptr<uint8_t>(y) + x * _cv_mat.channels(), len, _cv_mat.channels());
+    return buf;
+  }
+
+  void Panel_OpenCV::_store_line(uint_fast16_t x, uint_fast16_t y, uint_fast16_t len)
+  {
+    store_pixels(_cv_mat.ptr<uint8_t>(y) + x * _cv_mat.channels(), &_line_buf[x], len, _cv_mat.channels());
+  }
+
   void Panel_OpenCV::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
   {
     uint_fast8_t r = _internal_rotation;
@@ -195,12 +260,10 @@ namespace lgfx
       if (r & 1) { std::swap(x, y); }
     }
 
-    size_t bw = _cfg.panel_width;
-    size_t index = x + y * bw;
-    {
-      auto img = &((bgr888_t*)_img)[index];
-      *img = rawcolor;
-    }
+    bgr888_t color;
+    color = rawcolor;
+    size_t bytes = _cv_mat.channels();
+    store_pixels(_cv_mat.ptr<uint8_t>(y) + x * bytes, &color, 1, bytes);
 
     if (!getStartCount())
     {
@@ -218,39 +281,18 @@ namespace lgfx
       if (r & 1) { std::swap(x, y);  std::swap(w, h); }
     }
 
-    if (w > 1)
-    {
-      uint_fast8_t bytes = 3;
-      uint_fast16_t bw = _cfg.panel_width;
-      uint8_t* dst = &_img[(x + y * bw) * bytes];
-      uint8_t* src = dst;
-      uint_fast16_t add_dst = bw * bytes;
-      uint_fast16_t len = w * bytes;
-
-      if (w != bw)
-      {
-        dst += add_dst;
-      }
-      else
-      {
-        w *= h;
-        h = 1;
-      }
-      memset_multi(src, rawcolor, bytes, w);
-      while (--h)
-      {
-        memcpy(dst, src, len);
-        dst += add_dst;
-      }
-    }
-    else
+    bgr888_t color;
+    color = rawcolor;
+    uint32_t c = 0;
+    size_t bytes = _cv_mat.channels();
+    store_pixels((uint8_t*)&c, &color, 1, bytes);
+
+    uint8_t* src = _cv_mat.ptr<uint8_t>(y) + x * bytes;
+    memset_multi(src, c, bytes, w);
+    size_t len = w * bytes;
+    while (--h)
     {
-      size_t bw = _cfg.panel_width;
-      size_t index = x + y * bw;
-      {
-        auto img = &((bgr888_t*)_img)[index];
-        do { *img = rawcolor; img += bw; } while (--h);
-      }
+      memcpy(_cv_mat.ptr<uint8_t>(++y) + x * bytes, src, len);
     }
   }
 
@@ -311,8 +353,7 @@ namespace lgfx
     uint_fast16_t ye = _ye;
     uint_fast16_t x = _xpos;
     uint_fast16_t y = _ypos;
-    const size_t bits = _write_bits;
-    auto k = _cfg.panel_width * bits >> 3;
+    auto buf = _line_buf.data();
 
     uint_fast8_t r = _internal_rotation;
     if (!r)
@@ -320,7 +361,8 @@ namespace lgfx
       uint_fast16_t linelength;
       do {
         linelength = std::min<uint_fast16_t>(xe - x + 1, length);
-        param->fp_copy(&_img[y * k], x, x + linelength, param);
+        param->fp_copy(buf, x, x + linelength, param);
+        _store_line(x, y, linelength);
         if ((x += linelength) > xe)
         {
           x = xs;
@@ -336,70 +378,28 @@ namespace lgfx
     int_fast16_t ay = 1;
     if ((1u << r) & 0b10010110) { y = _height - (y + 1); ys = _height - (ys + 1); ye = _height - (ye + 1); ay = -1; }
     if (r & 2)                  { x = _width  - (x + 1); xs = _width  - (xs + 1); xe = _width  - (xe + 1); ax = -1; }
-    if (param->no_convert)
-    {
-      size_t bytes = bits >> 3;
-      size_t xw = 1;
-      size_t yw = _cfg.panel_width;
-      if (r & 1) std::swap(xw, yw);
-      size_t idx = y * yw + x * xw;
-      auto data = (uint8_t*)param->src_data;
-      do
-      {
-        auto dst = &_img[idx * bytes];
-        size_t b = 0;
-        do
-        {
-          dst[b] = *data++;
-        } while (++b < bytes);
-        if (x != xe)
-        {
-          idx += xw * ax;
-          x += ax;
-        }
-        else
-        {
-          x = xs;
-          y = (y != ye) ? (y + ay) : ys;
-          idx = y * yw + x * xw;
-        }
-      } while (--length);
-    }
-    else
+    do
     {
       if (r & 1)
+      { /// xとyを入れ替えて処理する;
+        param->fp_copy(buf, y, y + 1, param);
+        _store_line(y, x, 1);
+      }
+      else
       {
-        do
-        {
-          param->fp_copy(&_img[x * k], y, y + 1, param); /// xとyを入れ替えて処理する;
-          if (x != xe)
-          {
-            x += ax;
-          }
-          else
-          {
-            x = xs;
-            y = (y != ye) ? (y + ay) : ys;
-          }
-        } while (--length);
+        param->fp_copy(buf, x, x + 1, param);
+        _store_line(x, y, 1);
+      }
+      if (x != xe)
+      {
+        x += ax;
       }
       else
       {
-        do
-        {
-          param->fp_copy(&_img[y * k], x, x + 1, param);
-          if (x != xe)
-          {
-            x += ax;
-          }
-          else
-          {
-            x = xs;
-            y = (y != ye) ? (y + ay) : ys;
-          }
-        } while (--length);
+        x = xs;
+        y = (y != ye) ? (y + ay) : ys;
       }
-    }
+    } while (--length);
     if ((1u << r) & 0b10010110) { y = _height - (y + 1); }
     if (r & 2)                  { x = _width  - (x + 1); }
     _xpos = x;
@@ -408,51 +408,30 @@ namespace lgfx
 
   void Panel_OpenCV::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool)
   {
-    uint_fast8_t r = _internal_rotation;
-    if (r == 0 && param->transp == pixelcopy_t::NON_TRANSP && param->no_convert)
-    {
-      auto sx = param->src_x;
-      auto bits = param->src_bits;
-
-      auto bw = _cfg.panel_width * bits >> 3;
-      auto dst = &_img[bw * y];
-      auto sw = param->src_bitwidth * bits >> 3;
-      auto src = &((uint8_t*)param->src_data)[param->src_y * sw];
-      if (sw == bw && this->_cfg.panel_width == w && sx == 0 && x == 0)
-      {
-        memcpy(dst, src, bw * h);
-        return;
-      }
-      y = 0;
-      dst +=  x * bits >> 3;
-      src += sx * bits >> 3;
-      w    =  w * bits >> 3;
-      do
-      {
-        memcpy(&dst[y * bw], &src[y * sw], w);
-      } while (++y != h);
-      return;
-    }
-
     uint32_t nextx = 0;
     uint32_t nexty = 1 << pixelcopy_t::FP_SCALE;
-    if (r)
+    if (_internal_rotation)
     {
       _rotate_pixelcopy(x, y, w, h, param, nextx, nexty);
     }
     uint32_t sx32 = param->src_x32;
     uint32_t sy32 = param->src_y32;
 
-    y *= _cfg.panel_width;
+    /// 透過色がある場合は描画されない画素を保持するため先に読み込んでおく;
+    /// with a transparent colour the skipped pixels must survive, so the row is loaded first.
+    bool transp = param->transp != pixelcopy_t::NON_TRANSP;
+    auto buf = _line_buf.data();
     do
     {
-      int32_t pos = x + y;
+      if (transp) { _load_line(x, y, w); }
+      int32_t pos = x;
       int32_t end = pos + w;
-      while (end != (pos = param->fp_copy(_img, pos, end, param))
-         &&  end != (pos = param->fp_skip(      pos, end, param)));
+      while (end != (pos = param->fp_copy(buf, pos, end, param))
+         &&  end != (pos = param->fp_skip(     pos, end, param)));
+      _store_line(x, y, w);
       param->src_x32 = (sx32 += nextx);
       param->src_y32 = (sy32 += nexty);
-      y += _cfg.panel_width;
+      ++y;
     } while (--h);
   }
 
@@ -467,82 +446,97 @@ namespace lgfx
     uint32_t sx32 = param->src_x32;
     uint32_t sy32 = param->src_y32;
 
-    uint32_t pos = x + y * _cfg.panel_width;
-    uint32_t end = pos + w;
-    param->fp_copy(_img, pos, end, param);
-    while (--h)
+    /// 既存のフレームの上にアルファブレンドする;
+    /// blended onto whatever the mat already holds.
+    do
     {
-      pos += _cfg.panel_width;
-      end = pos + w;
+      param->fp_copy(_load_line(x, y, w), x, x + w, param);
+      _store_line(x, y, w);
       param->src_x32 = (sx32 += nextx);
       param->src_y32 = (sy32 += nexty);
-      param->fp_copy(_img, pos, end, param);
-    }
+      ++y;
+    } while (--h);
   }
 
   void Panel_OpenCV::readRect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, void* dst, pixelcopy_t* param)
   {
     uint_fast8_t r = _internal_rotation;
+
+    /// 読出し範囲に相当する mat 上の矩形;
+    /// the area of the mat covered by the request.
+    uint_fast16_t mx = x, my = y, mw = w, mh = h;
+    if (r)
+    {
+      if ((1u << r) & 0b10010110) { my = _height - (my + mh); }
+      if (r & 2)                  { mx = _width  - (mx + mw); }
+      if (r & 1) { std::swap(mx, my);  std::swap(mw, mh); }
+    }
+
     if (0 == r && param->no_convert)
     {
-      h += y;
-      auto bytes = _write_bits >> 3;
-      auto bw = _cfg.panel_width;
-      auto d = (uint8_t*)dst;
-      w *= bytes;
-      do {
-        memcpy(d, &_img[(x + y * bw) * bytes], w);
+      auto d = (bgr888_t*)dst;
+      do
+      {
+        memcpy(d, &_load_line(x, y, w)[x], w * sizeof(bgr888_t));
         d += w;
-      } while (++y != h);
+        ++y;
+      } while (--h);
+      return;
     }
-    else
+
+    /// mat の色順はパネルの書込み形式と異なるため、範囲分だけ bgr888_t に変換してから読み出す;
+    /// the mat's channel order differs from the write format, so only the requested area is converted first.
+    /// bgr888_t::get は4バイト読むため1画素分の余裕を持たせる;
+    /// one spare pixel, since bgr888_t::get reads four bytes.
+    std::vector<bgr888_t> area(mw * mh + 1);
+    for (uint_fast16_t i = 0; i < mh; ++i)
+    {
+      load_pixels(&area[i * mw], _cv_mat.ptr<uint8_t>(my + i) + mx * _cv_mat.channels(), mw, _cv_mat.channels());
+    }
+
+    param->src_bitwidth = mw;
+    param->src_data = area.data();
+    uint32_t nextx = 0;
+    uint32_t nexty = 1 << pixelcopy_t::FP_SCALE;
+    if (r)
     {
-      param->src_bitwidth = _cfg.panel_width;
-      param->src_data = _img;
-      uint32_t nextx = 0;
-      uint32_t nexty = 1 << pixelcopy_t::FP_SCALE;
-      if (r)
+      uint32_t addx = param->src_x32_add;
+      uint32_t addy = param->src_y32_add;
+      uint_fast8_t rb = 1 << r;
+      if (rb & 0b10010110) // case 1:2:4:7:
       {
-        uint32_t addx = param->src_x32_add;
-        uint32_t addy = param->src_y32_add;
-        uint_fast8_t rb = 1 << r;
-        if (rb & 0b10010110) // case 1:2:4:7:
-        {
-          nexty = -(int32_t)nexty;
-          y = _height - (y + 1);
-        }
-        if (r & 2)
-        {
-          addx = -(int32_t)addx;
-          x = _width - (x + 1);
-        }
-        if ((r+1) & 2)
-        {
-          addy  = -(int32_t)addy;
-        }
-        if (r & 1)
-        {
-          std::swap(x, y);
-          std::swap(addx, addy);
-          std::swap(nextx, nexty);
-        }
-        param->src_x32_add = addx;
-        param->src_y32_add = addy;
+        nexty = -(int32_t)nexty;
+        y = _height - (y + 1);
       }
-      size_t dstindex = 0;
-      uint32_t x32 = x << pixelcopy_t::FP_SCALE;
-      uint32_t y32 = y << pixelcopy_t::FP_SCALE;
-      param->src_x32 = x32;
-      param->src_y32 = y32;
-      do
+      if (r & 2)
       {
-        param->src_x32 = x32;
-        x32 += nextx;
-        param->src_y32 = y32;
-        y32 += nexty;
-        dstindex = param->fp_copy(dst, dstindex, dstindex + w, param);
-      } while (--h);
+        addx = -(int32_t)addx;
+        x = _width - (x + 1);
+      }
+      if ((r+1) & 2)
+      {
+        addy  = -(int32_t)addy;
+      }
+      if (r & 1)
+      {
+        std::swap(x, y);
+        std::swap(addx, addy);
+        std::swap(nextx, nexty);
+      }
+      param->src_x32_add = addx;
+      param->src_y32_add = addy;
     }
+    size_t dstindex = 0;
+    uint32_t x32 = (x - mx) << pixelcopy_t::FP_SCALE;
+    uint32_t y32 = (y - my) << pixelcopy_t::FP_SCALE;
+    do
+    {
+      param->src_x32 = x32;
+      x32 += nextx;
+      param->src_y32 = y32;
+      y32 += nexty;
+      dstindex = param->fp_copy(dst, dstindex, dstindex + w, param);
+    } while (--h);
   }
 
   void Panel_OpenCV::copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y)
@@ -555,18 +549,15 @@ namespace lgfx
       if (r & 1) { std::swap(src_x, src_y);  std::swap(dst_x, dst_y);  std::swap(w, h); }
     }
 
-    size_t bytes = _write_bits >> 3;
+    size_t bytes = _cv_mat.channels();
     size_t len = w * bytes;
-    int32_t add = _cfg.panel_width * bytes;
-    if (src_y < dst_y) add = -add;
+    int32_t add = (src_y < dst_y) ? -1 : 1;
     int32_t pos = (src_y < dst_y) ? h - 1 : 0;
-    uint8_t* src = &_img[(src_x + (src_y + pos) * _cfg.panel_width) * bytes];
-    uint8_t* dst = &_img[(dst_x + (dst_y + pos) * _cfg.panel_width) * bytes];
     do
     {
-      memmove(dst, src, len);
-      src += add;
-      dst += add;
+      memmove(_cv_mat.ptr<uint8_t>(dst_y + pos) + dst_x * bytes
+             , _cv_mat.ptr<uint8_t>(src_y + pos) + src_x * bytes, len);
+      pos += add;
     } while (--h);
   }
 
@@ -22,6 +22,7 @@ Contributors:
 #include "../../Touch.hpp"
 
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 namespace lgfx
 {
@@ -29,6 +30,8 @@ namespace lgfx
  {
 //----------------------------------------------------------------------------
 
+  /// 描画先は OpenCV の並び順 (CV_8UC3 は BGR / CV_8UC4 は BGRA) の cv::Mat;
+  /// The panel draws into a cv::Mat in OpenCV's own channel order (CV_8UC3 BGR / CV_8UC4 BGRA).
   struct Panel_OpenCV : public Panel_Device
   {
 
@@ -39,6 +42,15 @@ namespace lgfx
     virtual ~Panel_OpenCV(void);
 
     bool init(bool use_reset) override;
+
+    /// 外部で確保された cv::Mat (CV_8UC3 / CV_8UC4、step は任意) に直接描画する。
+    /// ウィンドウは作成せず、画素のコピーも行わない。パネルの大きさは mat に合わせて変更される;
+    /// Render straight into an externally owned cv::Mat (CV_8UC3 or CV_8UC4, any step, ROIs included).
+    /// No window is created and no pixels are copied; the panel size follows the mat.
+    /// ARGB images and sprites pushed to the panel are alpha-blended onto the existing frame.
+    bool setMat(const cv::Mat& mat);
+    const cv::Mat& getMat(void) const { return _cv_mat; }
+
     void beginTransaction(void) override;
     void endTransaction(void) override;
 
@@ -70,12 +82,18 @@ namespace lgfx
   protected:
     char _window_name[32];
     touch_point_t _touch_point;
-    uint8_t* _img;
     cv::Mat _cv_mat;
+    /// 1ライン分の変換用バッファ (パネルの書込み形式 bgr888_t) ;
+    /// one line in the panel's write format, used to convert to and from the mat.
+    std::vector<bgr888_t> _line_buf;
     int32_t _xpos = 0;
     int32_t _ypos = 0;
+    bool _has_window = false;
 
     void _rotate_pixelcopy(uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& w, uint_fast16_t& h, pixelcopy_t* param, uint32_t& nextx, uint32_t& nexty);
+    void _remove_window(void);
+    bgr888_t* _load_line(uint_fast16_t x, uint_fast16_t y, uint_fast16_t len);
+    void _store_line(uint_fast16_t x, uint_fast16_t y, uint_fast16_t len);
   };
 
 //----------------------------------------------------------------------------
@@ -17,6 +17,7 @@ Contributors:
 /----------------------------------------------------------------------------*/
 #pragma once
 
+#include "../../misc/Allocator.hpp"
 #include "../../misc/DataWrapper.hpp"
 #include "../../misc/enum.hpp"
 #include "../../../utility/result.hpp"
@@ -38,10 +39,10 @@ namespace lgfx
 
   void delayMicroseconds(unsigned int us);
 
-  static inline void* heap_alloc(      size_t length) { return malloc(length); }
-  static inline void* heap_alloc_psram(size_t length) { return malloc(length); }
-  static inline void* heap_alloc_dma(  size_t length) { return malloc(length); } // aligned_alloc(16, length);
-  static inline void heap_free(void* buf) { free(buf); }
+  static inline void* platform_heap_alloc(      size_t length) { return malloc(length); }
+  static inline void* platform_heap_alloc_psram(size_t length) { return malloc(length); }
+  static inline void* platform_heap_alloc_dma(  size_t length) { return malloc(length); } // aligned_alloc(16, length);
+  static inline void platform_heap_free(void* buf) { free(buf); }
 
   static inline void gpio_hi(uint32_t pin) { }
   static inline void gpio_lo(uint32_t pin) { }
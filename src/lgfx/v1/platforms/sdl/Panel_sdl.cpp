@@ -240,6 +240,8 @@ namespace lgfx
     initFrameBuffer(_cfg.panel_width * 4, _cfg.panel_height);
     bool res = Panel_FrameBufferBase::init(use_reset);
 
+    _modified_all();
+
     _list_monitor.push_back(&monitor);
 
     return res;
@@ -260,9 +262,20 @@ namespace lgfx
     _write_depth = depth;
     _read_depth = depth;
 
+    /// 色深度が変わるとバッファ全体の解釈が変わるため、全体を更新対象にする;
+    _modified_all();
+
     return depth;
   }
 
+  void Panel_sdl::_modified_all(void)
+  {
+    SDL_LockMutex(_sdl_mutex);
+    Panel_FrameBufferBase::_modified_all();
+    ++_modified_counter;
+    SDL_UnlockMutex(_sdl_mutex);
+  }
+
   Panel_sdl::lock_t::lock_t(Panel_sdl* parent)
   : _parent { parent }
   {
@@ -285,7 +298,8 @@ namespace lgfx
   void Panel_sdl::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
   {
     lock_t lock(this);
-    Panel_FrameBufferBase::drawPixelPreclipped(x, y, rawcolor);
+    /// ロック中に display() を呼ぶと更新スレッドを待ち続けるため、反映は更新スレッドに任せる;
+    _draw_pixel(x, y, rawcolor);
   }
 
   void Panel_sdl::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
@@ -318,6 +332,13 @@ namespace lgfx
     Panel_FrameBufferBase::writePixels(param, len, use_dma);
   }
 
+  void Panel_sdl::copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y)
+  {
+    lock_t lock(this);
+    /// ロック中に display() を呼ぶと更新スレッドを待ち続けるため、反映は endWrite に任せる;
+    _copy_rect(dst_x, dst_y, w, h, src_x, src_y);
+  }
+
   void Panel_sdl::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
   {
     if (_in_step_exec)
@@ -360,9 +381,15 @@ namespace lgfx
                               _cfg.panel_width * m->scaling_x, _cfg.panel_height * m->scaling_y, flag);       /*last param. SDL_WINDOW_BORDERLESS to hide borders*/
 
     m->renderer = SDL_CreateRenderer(m->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    m->texture = SDL_CreateTexture(m->renderer, SDL_PIXELFORMAT_RGB24,
+  }
+
+  void Panel_sdl::sdl_create_texture(monitor_t * m, uint32_t format)
+  {
+    if (m->texture) { SDL_DestroyTexture(m->texture); }
+    m->texture = SDL_CreateTexture(m->renderer, format,
                      SDL_TEXTUREACCESS_STATIC, _cfg.panel_width, _cfg.panel_height);
     SDL_SetTextureBlendMode(m->texture, SDL_BLENDMODE_NONE);
+    m->texture_format = format;
   }
 
   void Panel_sdl::sdl_update(void)
@@ -374,29 +401,65 @@ namespace lgfx
 
     bool step_exec = _in_step_exec;
 
+    /// テクスチャの形式を書込み形式に合わせる。rgb888 と rgb332 は変換なし、rgb565 はバイト順の入替えのみで転送できる;
+    /// The texture format follows the write depth: rgb888 and rgb332 upload as is,
+    /// rgb565 only needs a byte swap. Grayscale is expanded to RGB24.
+    uint32_t texture_format = SDL_PIXELFORMAT_RGB24;
+    if      (_write_depth == rgb565_2Byte) { texture_format = SDL_PIXELFORMAT_RGB565; }
+    else if (_write_depth == rgb332_1Byte) { texture_format = SDL_PIXELFORMAT_RGB332; }
+    if (monitor.texture_format != texture_format)
+    {
+      sdl_create_texture(&monitor, texture_format);
+      _modified_all();
+    }
+
     if (_texupdate_counter != _modified_counter) {
       pixelcopy_t pc(nullptr, color_depth_t::rgb888_3Byte, _write_depth, false);
+      size_t texel_bytes = sizeof(bgr888_t);
       if (_write_depth == rgb565_2Byte) {
-        pc.fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, swap565_t>;
-      } else if (_write_depth == rgb888_3Byte) {
-        pc.fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, bgr888_t>;
-      } else if (_write_depth == rgb332_1Byte) {
-        pc.fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, rgb332_t>;
+        pc.fp_copy = pixelcopy_t::copy_rgb_fast<rgb565_t, swap565_t>;
+        texel_bytes = sizeof(rgb565_t);
       } else if (_write_depth == grayscale_8bit) {
         pc.fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, grayscale_t>;
+      } else {
+        /// フレームバッファとテクスチャの形式が一致するので変換不要;
+        pc.fp_copy = nullptr;
       }
 
       if (0 == SDL_LockMutex(_sdl_mutex))
       {
         _texupdate_counter = _modified_counter;
-        for (int y = 0; y < _cfg.panel_height; ++y)
+        /// 変更された範囲だけを変換・転送する;
+        auto range = _range_mod;
+        _clear_modified_rect();
+        if (!range.empty())
+        {
+          SDL_Rect rect = { (int)range.left, (int)range.top, (int)range.width(), (int)range.height() };
+          if (pc.fp_copy == nullptr)
+          {
+            /// フレームバッファは連続した領域なので、1回の転送で済む;
+            size_t bytes = _write_bits >> 3;
+            SDL_UpdateTexture(monitor.texture, &rect, &_lines_buffer[range.top][range.left * bytes], _line_stride);
+            SDL_UnlockMutex(_sdl_mutex);
+          }
+          else
+          {
+            size_t pitch = _cfg.panel_width * texel_bytes;
+            auto texbuf = reinterpret_cast<uint8_t*>(_texturebuf);
+            for (int y = range.top; y <= range.bottom; ++y)
+            {
+              pc.src_x32 = range.left;
+              pc.src_data = _lines_buffer[y];
+              pc.fp_copy(&texbuf[y * pitch], range.left, range.right + 1, &pc);
+            }
+            SDL_UnlockMutex(_sdl_mutex);
+            SDL_UpdateTexture(monitor.texture, &rect, &texbuf[range.top * pitch + range.left * texel_bytes], pitch);
+          }
+        }
+        else
         {
-          pc.src_x32 = 0;
-          pc.src_data = _lines_buffer[y];
-          pc.fp_copy(&_texturebuf[y * _cfg.panel_width], 0, _cfg.panel_width, &pc);
+          SDL_UnlockMutex(_sdl_mutex);
         }
-        SDL_UnlockMutex(_sdl_mutex);
-        SDL_UpdateTexture(monitor.texture, nullptr, _texturebuf, _cfg.panel_width * sizeof(rgb888_t));
       }
     }
 
@@ -430,6 +493,7 @@ namespace lgfx
 
     /// 8byte alignment;
     width = (width + 7) & ~7u;
+    _line_stride = width;
 
     _lines_buffer = lineArray;
     memset(lineArray, 0, height * sizeof(uint8_t*));
@@ -36,6 +36,7 @@ namespace lgfx
     SDL_Window* window = nullptr;
     SDL_Renderer* renderer = nullptr;
     SDL_Texture* texture = nullptr;
+    uint32_t texture_format = 0;
     Panel_sdl* panel = nullptr;
     int scaling_x = 1;
     int scaling_y = 1;
@@ -75,6 +76,7 @@ namespace lgfx
     void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) override;
     void writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param) override;
     void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) override;
+    void copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y) override;
 
     uint_fast8_t getTouchRaw(touch_point_t* tp, uint_fast8_t count) override;
 
@@ -92,12 +94,14 @@ namespace lgfx
     SDL_mutex *_sdl_mutex = nullptr;
 
     void sdl_create(monitor_t * m);
+    void sdl_create_texture(monitor_t * m, uint32_t format);
     void sdl_update(void);
 
     touch_point_t _touch_point;
     monitor_t monitor;
 
     rgb888_t* _texturebuf = nullptr;
+    size_t _line_stride = 0;
     uint_fast16_t _modified_counter;
     uint_fast16_t _texupdate_counter;
     uint_fast16_t _display_counter;
@@ -106,6 +110,8 @@ namespace lgfx
     static void _event_proc(void);
     static void _update_proc(void);
     void sdl_invalidate(void) { _invalidated = true; }
+    /// 描画スレッドと更新スレッドの双方から呼ばれるため、ロックを取って全体を更新対象にする;
+    void _modified_all(void);
     bool initFrameBuffer(size_t width, size_t height);
     void deinitFrameBuffer(void);
 
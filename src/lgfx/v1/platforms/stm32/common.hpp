@@ -17,6 +17,7 @@ Contributors:
 /----------------------------------------------------------------------------*/
 #pragma once
 
+#include "../../misc/Allocator.hpp"
 #include "../../misc/DataWrapper.hpp"
 
 #include <malloc.h>
@@ -69,10 +70,10 @@ namespace lgfx
     ::delayMicroseconds(us);
   }
 
-  static inline void* heap_alloc(      size_t length) { return malloc(length); }
-  static inline void* heap_alloc_psram(size_t length) { return malloc(length); }
-  static inline void* heap_alloc_dma(  size_t length) { return memalign(16, length); }
-  static inline void heap_free(void* buf) { free(buf); }
+  static inline void* platform_heap_alloc(      size_t length) { return malloc(length); }
+  static inline void* platform_heap_alloc_psram(size_t length) { return malloc(length); }
+  static inline void* platform_heap_alloc_dma(  size_t length) { return memalign(16, length); }
+  static inline void platform_heap_free(void* buf) { free(buf); }
 
   static inline volatile uint32_t* get_gpio_out_reg(int_fast8_t pin)
   {
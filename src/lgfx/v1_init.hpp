@@ -25,6 +25,9 @@ Contributors:
 #include "v1/LGFXBase.hpp"
 #include "v1/LGFX_Sprite.hpp"
 #include "v1/LGFX_Button.hpp"
+#include "v1/LGFX_Compositor.hpp"
+#include "v1/LGFX_TiledSprite.hpp"
+#include "v1/LGFX_PackedSprite.hpp"
 #include "v1/Light.hpp"
 
 // LCD / OLED
@@ -56,6 +59,7 @@ Contributors:
 // other
 #include "v1/panel/Panel_HUB75.hpp"
 #include "v1/panel/Panel_M5UnitLCD.hpp"
+#include "v1/panel/Panel_Memory.hpp"
 
 // TouchScreen
 #include "v1/touch/Touch_CST816S.hpp"